@@ -0,0 +1,867 @@
+//===-- Benchmarks/SyntheticDwarf.cpp ---------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the synthetic DWARF generator.
+///
+//===----------------------------------------------------------------------===//
+
+#include "SyntheticDwarf.h"
+#include "Error.h"
+
+// Disable some clang warnings for dwarf.h and libdwarf.h.
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wreserved-id-macro"
+#pragma clang diagnostic ignored "-Wundef"
+#endif
+
+#include "dwarf.h"
+#include "libdwarf.h"
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace SyntheticDwarf;
+
+namespace {
+
+/// \brief Small deterministic PRNG (splitmix64). The standard distributions
+/// are implementation defined, so they can't be used for reproducible output.
+class Random {
+public:
+  explicit Random(uint64_t Seed) : State(Seed) {}
+
+  uint64_t next() {
+    uint64_t Z = (State += 0x9E3779B97F4A7C15ULL);
+    Z = (Z ^ (Z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    Z = (Z ^ (Z >> 27)) * 0x94D049BB133111EBULL;
+    return Z ^ (Z >> 31);
+  }
+
+  /// \brief Return a value in [0, Bound), or 0 if Bound is 0.
+  unsigned below(size_t Bound) {
+    return Bound ? static_cast<unsigned>(next() % Bound) : 0;
+  }
+
+  /// \brief Return a value in [Low, High].
+  unsigned between(unsigned Low, unsigned High) {
+    return Low + below(High - Low + 1);
+  }
+
+  /// \brief Return true Percent% of the time.
+  bool percent(unsigned Percent) { return below(100) < Percent; }
+
+private:
+  uint64_t State;
+};
+
+[[noreturn]] void producerError(const char *Function, Dwarf_Error Err) {
+  std::string Detail(Function);
+  if (Err)
+    Detail += std::string(": ") + dwarf_errmsg(Err);
+  LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_WRITE_FAILED,
+                            "synthetic DWARF", Detail);
+}
+
+uint64_t readLE(const uint8_t *Data, unsigned Size) {
+  uint64_t Value = 0;
+  for (unsigned I = Size; I > 0; --I)
+    Value = (Value << 8) | Data[I - 1];
+  return Value;
+}
+
+void writeLE(uint8_t *Data, uint64_t Value, unsigned Size) {
+  for (unsigned I = 0; I < Size; ++I, Value >>= 8)
+    Data[I] = static_cast<uint8_t>(Value);
+}
+
+void appendLE(std::vector<uint8_t> &Out, uint64_t Value, unsigned Size) {
+  Out.resize(Out.size() + Size);
+  writeLE(Out.data() + Out.size() - Size, Value, Size);
+}
+
+/// \brief The DWARF sections of the linked object.
+enum SectionKind { SK_None, SK_Abbrev, SK_Info, SK_Line, SK_Count };
+
+const char *const SectionNames[SK_Count] = {"", ".debug_abbrev",
+                                            ".debug_info", ".debug_line"};
+
+SectionKind getSectionKind(const std::string &Name) {
+  for (unsigned Kind = SK_Abbrev; Kind < SK_Count; ++Kind)
+    if (Name == SectionNames[Kind])
+      return static_cast<SectionKind>(Kind);
+  return SK_None;
+}
+
+/// \brief A reference to a type, either in the unit being generated or in an
+/// earlier one that has already been linked.
+struct TypeRef {
+  Dwarf_P_Die Local;
+  uint32_t LinkedOffset;
+  uint32_t NameIndex;
+};
+
+/// \brief State shared by all the compile units of one object.
+struct ObjectState {
+  ObjectState(const Options &Opts) : Opts(Opts) {}
+
+  const Options &Opts;
+  Statistics Stats;
+
+  // Linked section contents.
+  std::vector<uint8_t> Sections[SK_Count];
+
+  // Final .debug_info offsets of the types in the units already linked, used
+  // as the targets of cross unit references.
+  std::vector<TypeRef> LinkedTypes;
+  // Names of all types, indexed by TypeRef::NameIndex.
+  std::vector<std::string> TypeNames;
+
+  // Every name generated so far for each kind of declaration, for reuse.
+  std::map<std::string, std::vector<std::string>> Names;
+  uint64_t NextNameID = 0;
+
+  // Next free code address.
+  uint32_t NextAddress = 0x1000;
+};
+
+/// \brief Generates one compile unit with its own producer instance and links
+/// the result into the ObjectState.
+class CompileUnitWriter {
+public:
+  CompileUnitWriter(ObjectState &State, unsigned UnitIndex);
+  ~CompileUnitWriter();
+
+  CompileUnitWriter(const CompileUnitWriter &) = delete;
+  CompileUnitWriter &operator=(const CompileUnitWriter &) = delete;
+
+  void generate();
+  void link();
+
+private:
+  static int createSection(const char *Name, int Size, Dwarf_Unsigned Type,
+                           Dwarf_Unsigned Flags, Dwarf_Unsigned Link,
+                           Dwarf_Unsigned Info, Dwarf_Unsigned *SectNameIndex,
+                           void *UserData, int *Error);
+
+  Dwarf_P_Die newDie(Dwarf_Half Tag, Dwarf_P_Die Parent);
+  void checkAttr(Dwarf_P_Attribute Attr, const char *Function);
+  void addName(Dwarf_P_Die Die, const std::string &Name);
+  void addUnsigned(Dwarf_P_Die Die, Dwarf_Half Attr, Dwarf_Unsigned Value);
+  void addFlag(Dwarf_P_Die Die, Dwarf_Half Attr);
+  void addAddress(Dwarf_P_Die Die, Dwarf_Half Attr, Dwarf_Addr Address);
+  void addDecl(Dwarf_P_Die Die, Dwarf_Unsigned File, Dwarf_Unsigned Line);
+  void addType(Dwarf_P_Die Die, const TypeRef &Type);
+  TypeRef addLocalType(Dwarf_P_Die Die, const std::string &Name);
+
+  std::string makeName(const char *Prefix);
+  TypeRef chooseType();
+  bool hasBudget() const { return DIECount < Opts.DIEsPerCU; }
+
+  void generateBaseTypes();
+  void generateDeclaration(Dwarf_P_Die Parent, unsigned Depth);
+  void generateNamespace(Dwarf_P_Die Parent, unsigned Depth);
+  void generateStruct(Dwarf_P_Die Parent);
+  void generateTemplates(Dwarf_P_Die Parent);
+  void generateEnumeration(Dwarf_P_Die Parent);
+  void generateTypedef(Dwarf_P_Die Parent);
+  void generateFunction(Dwarf_P_Die Parent);
+  void generateVariable(Dwarf_P_Die Parent, Dwarf_Half Tag);
+
+  static const size_t MaxArgumentName = 256;
+
+  ObjectState &State;
+  const Options &Opts;
+  unsigned UnitIndex;
+  Random Rng;
+  Dwarf_P_Debug Dbg;
+  Dwarf_Error Err;
+
+  // Producer section index to SectionKind, indexed from 1.
+  std::vector<SectionKind> SectionKinds;
+
+  // Target offsets of the DW_FORM_ref_addr references in this unit. Each one
+  // is given its own relocation symbol, CrossReferenceSymbol + index, since
+  // the producer leaves the value to be filled in by relocation.
+  static const Dwarf_Unsigned CrossReferenceSymbol = 0x10000;
+  std::vector<uint32_t> CrossReferences;
+
+  Dwarf_P_Die UnitDie;
+  uint64_t DIECount;
+  std::vector<TypeRef> LocalTypes;
+  std::vector<Dwarf_Unsigned> Files;
+};
+
+CompileUnitWriter::CompileUnitWriter(ObjectState &State, unsigned UnitIndex)
+    : State(State), Opts(State.Opts), UnitIndex(UnitIndex),
+      Rng(State.Opts.Seed * 0x100000001B3ULL + UnitIndex), Dbg(nullptr),
+      Err(nullptr), SectionKinds(1, SK_None), UnitDie(nullptr), DIECount(0) {
+  Dwarf_Unsigned Flags = DW_DLC_WRITE | DW_DLC_SIZE_32 |
+                         DW_DLC_SYMBOLIC_RELOCATIONS |
+                         DW_DLC_TARGET_LITTLEENDIAN;
+  // The producer writes version 2 unit headers, where DW_FORM_ref_addr is
+  // the size of an address. Strings are left in the default DW_FORM_string:
+  // the producer's .debug_str buffer is shared by every instance in the
+  // process and never reset, so using DW_FORM_strp here would make each unit
+  // carry the strings of all the units before it.
+  if (dwarf_producer_init(Flags, createSection, nullptr, nullptr, this, "x86",
+                          "V2", nullptr, &Dbg, &Err) != DW_DLV_OK)
+    producerError("dwarf_producer_init", Err);
+}
+
+CompileUnitWriter::~CompileUnitWriter() {
+  if (Dbg)
+    dwarf_producer_finish_a(Dbg, &Err);
+}
+
+int CompileUnitWriter::createSection(const char *Name, int, Dwarf_Unsigned,
+                                     Dwarf_Unsigned, Dwarf_Unsigned,
+                                     Dwarf_Unsigned,
+                                     Dwarf_Unsigned *SectNameIndex,
+                                     void *UserData, int *) {
+  // The section index doubles as the symbol index of the section, so the
+  // symbolic relocations identify the section they refer to.
+  auto *Writer = static_cast<CompileUnitWriter *>(UserData);
+  int Index = static_cast<int>(Writer->SectionKinds.size());
+  Writer->SectionKinds.push_back(getSectionKind(Name));
+  *SectNameIndex = static_cast<Dwarf_Unsigned>(Index);
+  return Index;
+}
+
+Dwarf_P_Die CompileUnitWriter::newDie(Dwarf_Half Tag, Dwarf_P_Die Parent) {
+  Dwarf_P_Die Die = nullptr;
+  if (dwarf_new_die_a(Dbg, Tag, Parent, nullptr, nullptr, nullptr, &Die,
+                      &Err) != DW_DLV_OK)
+    producerError("dwarf_new_die_a", Err);
+  ++DIECount;
+  return Die;
+}
+
+void CompileUnitWriter::checkAttr(Dwarf_P_Attribute Attr,
+                                  const char *Function) {
+  if (Attr == reinterpret_cast<Dwarf_P_Attribute>(DW_DLV_BADADDR))
+    producerError(Function, Err);
+}
+
+void CompileUnitWriter::addName(Dwarf_P_Die Die, const std::string &Name) {
+  checkAttr(dwarf_add_AT_name(Die, const_cast<char *>(Name.c_str()), &Err),
+            "dwarf_add_AT_name");
+}
+
+void CompileUnitWriter::addUnsigned(Dwarf_P_Die Die, Dwarf_Half Attr,
+                                    Dwarf_Unsigned Value) {
+  checkAttr(dwarf_add_AT_unsigned_const(Dbg, Die, Attr, Value, &Err),
+            "dwarf_add_AT_unsigned_const");
+}
+
+void CompileUnitWriter::addFlag(Dwarf_P_Die Die, Dwarf_Half Attr) {
+  checkAttr(dwarf_add_AT_flag(Dbg, Die, Attr, 1, &Err), "dwarf_add_AT_flag");
+}
+
+void CompileUnitWriter::addAddress(Dwarf_P_Die Die, Dwarf_Half Attr,
+                                   Dwarf_Addr Address) {
+  // Symbol index 0 writes the absolute address with no relocation.
+  checkAttr(dwarf_add_AT_targ_address_b(Dbg, Die, Attr, Address, 0, &Err),
+            "dwarf_add_AT_targ_address_b");
+}
+
+void CompileUnitWriter::addDecl(Dwarf_P_Die Die, Dwarf_Unsigned File,
+                                Dwarf_Unsigned Line) {
+  addUnsigned(Die, DW_AT_decl_file, File);
+  addUnsigned(Die, DW_AT_decl_line, Line);
+}
+
+void CompileUnitWriter::addType(Dwarf_P_Die Die, const TypeRef &Type) {
+  if (Type.Local) {
+    checkAttr(dwarf_add_AT_reference(Dbg, Die, DW_AT_type, Type.Local, &Err),
+              "dwarf_add_AT_reference");
+    return;
+  }
+  // A DW_FORM_ref_addr to the final offset of the type, which is known
+  // because the unit containing it has already been linked.
+  checkAttr(dwarf_add_AT_ref_address(
+                Dbg, Die, DW_AT_type, 0,
+                CrossReferenceSymbol + CrossReferences.size(), &Err),
+            "dwarf_add_AT_ref_address");
+  CrossReferences.push_back(Type.LinkedOffset);
+  ++State.Stats.CrossCUReferences;
+}
+
+TypeRef CompileUnitWriter::addLocalType(Dwarf_P_Die Die,
+                                        const std::string &Name) {
+  TypeRef Type = {Die, 0, static_cast<uint32_t>(State.TypeNames.size())};
+  State.TypeNames.push_back(Name);
+  LocalTypes.push_back(Type);
+  // Markers are used to find the offset of each type after transformation.
+  if (dwarf_add_die_marker(Dbg, Die, LocalTypes.size(), &Err) ==
+      static_cast<Dwarf_Unsigned>(DW_DLV_NOCOUNT))
+    producerError("dwarf_add_die_marker", Err);
+  return Type;
+}
+
+std::string CompileUnitWriter::makeName(const char *Prefix) {
+  std::vector<std::string> &Names = State.Names[Prefix];
+  if (!Names.empty() && Rng.percent(Opts.StringReuse))
+    return Names[Rng.below(Names.size())];
+  std::string Name(Prefix);
+  Name += "_";
+  Name += std::to_string(State.NextNameID++);
+  Names.push_back(Name);
+  return Name;
+}
+
+TypeRef CompileUnitWriter::chooseType() {
+  if (!State.LinkedTypes.empty() && Rng.percent(Opts.CrossCUReferences))
+    return State.LinkedTypes[Rng.below(State.LinkedTypes.size())];
+  return LocalTypes[Rng.below(LocalTypes.size())];
+}
+
+void CompileUnitWriter::generate() {
+  UnitDie = newDie(DW_TAG_compile_unit, nullptr);
+  std::string UnitName("cu_" + std::to_string(UnitIndex) + ".cpp");
+  addName(UnitDie, UnitName);
+  checkAttr(dwarf_add_AT_producer(UnitDie,
+                                  const_cast<char *>("divasynth"), &Err),
+            "dwarf_add_AT_producer");
+  checkAttr(dwarf_add_AT_comp_dir(UnitDie, const_cast<char *>("/synthetic"),
+                                  &Err),
+            "dwarf_add_AT_comp_dir");
+  addUnsigned(UnitDie, DW_AT_language, DW_LANG_C_plus_plus);
+
+  // One main file and a few headers. File 0 is reserved in DWARF 4.
+  Dwarf_Unsigned IncludeDir = dwarf_add_directory_decl(
+      Dbg, const_cast<char *>("/synthetic/include"), &Err);
+  if (IncludeDir == static_cast<Dwarf_Unsigned>(DW_DLV_NOCOUNT))
+    producerError("dwarf_add_directory_decl", Err);
+  unsigned HeaderCount = Rng.between(1, 4);
+  for (unsigned I = 0; I <= HeaderCount; ++I) {
+    std::string FileName(I == 0 ? UnitName
+                                : "header_" + std::to_string(UnitIndex) +
+                                      "_" + std::to_string(I) + ".h");
+    Dwarf_Unsigned File =
+        dwarf_add_file_decl(Dbg, const_cast<char *>(FileName.c_str()),
+                            I == 0 ? 0 : IncludeDir, 0, 0, &Err);
+    if (File == static_cast<Dwarf_Unsigned>(DW_DLV_NOCOUNT))
+      producerError("dwarf_add_file_decl", Err);
+    Files.push_back(File);
+  }
+
+  Dwarf_Addr LowPC = State.NextAddress;
+  generateBaseTypes();
+  while (hasBudget())
+    generateDeclaration(UnitDie, 0);
+  addAddress(UnitDie, DW_AT_low_pc, LowPC);
+  addAddress(UnitDie, DW_AT_high_pc, State.NextAddress);
+
+  if (dwarf_add_die_to_debug_a(Dbg, UnitDie, &Err) != DW_DLV_OK)
+    producerError("dwarf_add_die_to_debug_a", Err);
+}
+
+void CompileUnitWriter::generateBaseTypes() {
+  static const struct {
+    const char *Name;
+    unsigned Encoding;
+    unsigned Size;
+  } BaseTypes[] = {
+      {"bool", DW_ATE_boolean, 1},     {"char", DW_ATE_signed_char, 1},
+      {"int", DW_ATE_signed, 4},       {"unsigned int", DW_ATE_unsigned, 4},
+      {"long long", DW_ATE_signed, 8}, {"float", DW_ATE_float, 4},
+      {"double", DW_ATE_float, 8},
+  };
+  for (const auto &Base : BaseTypes) {
+    Dwarf_P_Die Die = newDie(DW_TAG_base_type, UnitDie);
+    addName(Die, Base.Name);
+    addUnsigned(Die, DW_AT_encoding, Base.Encoding);
+    addUnsigned(Die, DW_AT_byte_size, Base.Size);
+    addLocalType(Die, Base.Name);
+  }
+}
+
+void CompileUnitWriter::generateDeclaration(Dwarf_P_Die Parent,
+                                            unsigned Depth) {
+  const TagMix &Mix = Opts.Mix;
+  unsigned Weights[] = {Depth < Opts.NamespaceDepth ? Mix.Namespaces : 0,
+                        Mix.Structs,
+                        Mix.Templates,
+                        Mix.Enumerations,
+                        Mix.Typedefs,
+                        Mix.Functions,
+                        Mix.Variables};
+  unsigned Total = 0;
+  for (unsigned Weight : Weights)
+    Total += Weight;
+
+  // With nothing to choose from, fall back to variables so the unit still
+  // reaches its DIE budget.
+  unsigned Choice = Rng.below(Total);
+  unsigned Kind = 0;
+  for (; Kind < 7 && Total; ++Kind) {
+    if (Choice < Weights[Kind])
+      break;
+    Choice -= Weights[Kind];
+  }
+
+  switch (Total ? Kind : 6) {
+  case 0:
+    generateNamespace(Parent, Depth);
+    break;
+  case 1:
+    generateStruct(Parent);
+    break;
+  case 2:
+    generateTemplates(Parent);
+    break;
+  case 3:
+    generateEnumeration(Parent);
+    break;
+  case 4:
+    generateTypedef(Parent);
+    break;
+  case 5:
+    generateFunction(Parent);
+    break;
+  default:
+    generateVariable(Parent, DW_TAG_variable);
+    break;
+  }
+}
+
+void CompileUnitWriter::generateNamespace(Dwarf_P_Die Parent, unsigned Depth) {
+  Dwarf_P_Die Die = newDie(DW_TAG_namespace, Parent);
+  addName(Die, makeName("ns"));
+  for (unsigned I = Rng.between(1, 8); I > 0 && hasBudget(); --I)
+    generateDeclaration(Die, Depth + 1);
+}
+
+void CompileUnitWriter::generateStruct(Dwarf_P_Die Parent) {
+  bool IsClass = Rng.percent(50);
+  Dwarf_P_Die Die =
+      newDie(IsClass ? DW_TAG_class_type : DW_TAG_structure_type, Parent);
+  std::string Name(makeName(IsClass ? "Class" : "Struct"));
+  addName(Die, Name);
+  addDecl(Die, Files[Rng.below(Files.size())], Rng.between(1, 5000));
+
+  unsigned Offset = 0;
+  for (unsigned I = Rng.between(1, 6); I > 0; --I) {
+    Dwarf_P_Die Member = newDie(DW_TAG_member, Die);
+    addName(Member, makeName("member"));
+    addType(Member, chooseType());
+    checkAttr(dwarf_add_AT_any_value_uleb(Member, DW_AT_data_member_location,
+                                          Offset, &Err),
+              "dwarf_add_AT_any_value_uleb");
+    if (IsClass)
+      addUnsigned(Member, DW_AT_accessibility, DW_ACCESS_private);
+    Offset += 8;
+  }
+  addUnsigned(Die, DW_AT_byte_size, Offset);
+  addLocalType(Die, Name);
+}
+
+void CompileUnitWriter::generateTemplates(Dwarf_P_Die Parent) {
+  // A chain of instantiations, each one an argument of the next. Chains
+  // started from an instance of another chain would make the names grow
+  // without bound, so long arguments are replaced with 'int'.
+  TypeRef Argument = chooseType();
+  if (State.TypeNames[Argument.NameIndex].size() > MaxArgumentName)
+    Argument = LocalTypes[2];
+  std::string Template(makeName("Template"));
+  for (unsigned Level = 0; Level < Opts.TemplateDepth && hasBudget();
+       ++Level) {
+    std::string Instance(Template + "<" + State.TypeNames[Argument.NameIndex] +
+                         ">");
+    Dwarf_P_Die Die = newDie(DW_TAG_class_type, Parent);
+    addName(Die, Instance);
+    addUnsigned(Die, DW_AT_byte_size, 8);
+
+    Dwarf_P_Die Param = newDie(DW_TAG_template_type_parameter, Die);
+    addName(Param, "T");
+    addType(Param, Argument);
+
+    Dwarf_P_Die Member = newDie(DW_TAG_member, Die);
+    addName(Member, "Value");
+    addType(Member, Argument);
+    checkAttr(dwarf_add_AT_any_value_uleb(Member, DW_AT_data_member_location,
+                                          0, &Err),
+              "dwarf_add_AT_any_value_uleb");
+
+    Argument = addLocalType(Die, Instance);
+  }
+}
+
+void CompileUnitWriter::generateEnumeration(Dwarf_P_Die Parent) {
+  Dwarf_P_Die Die = newDie(DW_TAG_enumeration_type, Parent);
+  std::string Name(makeName("Enum"));
+  addName(Die, Name);
+  addUnsigned(Die, DW_AT_byte_size, 4);
+  for (unsigned I = 0, E = Rng.between(2, 8); I < E; ++I) {
+    Dwarf_P_Die Enumerator = newDie(DW_TAG_enumerator, Die);
+    addName(Enumerator, makeName("Enumerator"));
+    checkAttr(dwarf_add_AT_signed_const(Dbg, Enumerator, DW_AT_const_value, I,
+                                        &Err),
+              "dwarf_add_AT_signed_const");
+  }
+  addLocalType(Die, Name);
+}
+
+void CompileUnitWriter::generateTypedef(Dwarf_P_Die Parent) {
+  Dwarf_P_Die Die = newDie(DW_TAG_typedef, Parent);
+  std::string Name(makeName("Typedef"));
+  addName(Die, Name);
+  addType(Die, chooseType());
+  addLocalType(Die, Name);
+}
+
+void CompileUnitWriter::generateFunction(Dwarf_P_Die Parent) {
+  Dwarf_Unsigned File = Files[Rng.below(Files.size())];
+  unsigned Line = Rng.between(1, 5000);
+  unsigned Rows = std::max(Opts.LinesPerFunction, 1u);
+  Dwarf_Addr LowPC = State.NextAddress;
+  Dwarf_Addr HighPC = LowPC + Rows * 4;
+  State.NextAddress = static_cast<uint32_t>(HighPC + 12);
+
+  Dwarf_P_Die Die = newDie(DW_TAG_subprogram, Parent);
+  addName(Die, makeName("function"));
+  addFlag(Die, DW_AT_external);
+  addDecl(Die, File, Line);
+  if (Rng.percent(75))
+    addType(Die, chooseType());
+  addAddress(Die, DW_AT_low_pc, LowPC);
+  addAddress(Die, DW_AT_high_pc, HighPC);
+
+  for (unsigned I = Rng.between(0, 4); I > 0; --I)
+    generateVariable(Die, DW_TAG_formal_parameter);
+  for (unsigned I = Rng.between(0, 3); I > 0; --I)
+    generateVariable(Die, DW_TAG_variable);
+  if (Rng.percent(30)) {
+    Dwarf_P_Die Block = newDie(DW_TAG_lexical_block, Die);
+    addAddress(Block, DW_AT_low_pc, LowPC + 4);
+    addAddress(Block, DW_AT_high_pc, HighPC - 4);
+    generateVariable(Block, DW_TAG_variable);
+  }
+
+  if (dwarf_lne_set_address(Dbg, LowPC, 0, &Err) ==
+      static_cast<Dwarf_Unsigned>(DW_DLV_NOCOUNT))
+    producerError("dwarf_lne_set_address", Err);
+  for (unsigned Row = 0; Row < Rows; ++Row) {
+    Line += Rng.between(0, 3);
+    if (dwarf_add_line_entry(Dbg, File, LowPC + Row * 4, Line,
+                             Rng.between(1, 80), 1, 0, &Err) ==
+        static_cast<Dwarf_Unsigned>(DW_DLV_NOCOUNT))
+      producerError("dwarf_add_line_entry", Err);
+  }
+  if (dwarf_lne_end_sequence(Dbg, HighPC, &Err) ==
+      static_cast<Dwarf_Unsigned>(DW_DLV_NOCOUNT))
+    producerError("dwarf_lne_end_sequence", Err);
+  State.Stats.LineRows += Rows + 1;
+}
+
+void CompileUnitWriter::generateVariable(Dwarf_P_Die Parent, Dwarf_Half Tag) {
+  Dwarf_P_Die Die = newDie(Tag, Parent);
+  addName(Die, makeName(Tag == DW_TAG_formal_parameter ? "param" : "var"));
+  addDecl(Die, Files[Rng.below(Files.size())], Rng.between(1, 5000));
+  addType(Die, chooseType());
+  if (Tag == DW_TAG_variable && Parent == UnitDie)
+    addFlag(Die, DW_AT_external);
+}
+
+void CompileUnitWriter::link() {
+  Dwarf_Signed BufferCount = 0;
+  if (dwarf_transform_to_disk_form_a(Dbg, &BufferCount, &Err) != DW_DLV_OK)
+    producerError("dwarf_transform_to_disk_form_a", Err);
+
+  // Gather the bytes of each section; a section may span several buffers.
+  std::vector<uint8_t> Pieces[SK_Count];
+  for (Dwarf_Signed Buffer = 0; Buffer < BufferCount; ++Buffer) {
+    Dwarf_Signed SectionIndex = 0;
+    Dwarf_Unsigned Length = 0;
+    Dwarf_Ptr Bytes = nullptr;
+    if (dwarf_get_section_bytes_a(Dbg, Buffer, &SectionIndex, &Length, &Bytes,
+                                  &Err) != DW_DLV_OK)
+      producerError("dwarf_get_section_bytes_a", Err);
+    assert(SectionIndex > 0 &&
+           static_cast<size_t>(SectionIndex) < SectionKinds.size());
+    auto *Data = static_cast<const uint8_t *>(Bytes);
+    Pieces[SectionKinds[SectionIndex]].insert(
+        Pieces[SectionKinds[SectionIndex]].end(), Data, Data + Length);
+  }
+
+  uint64_t Bases[SK_Count] = {};
+  for (unsigned Kind = SK_Abbrev; Kind < SK_Count; ++Kind) {
+    Bases[Kind] = State.Sections[Kind].size();
+    State.Sections[Kind].insert(State.Sections[Kind].end(),
+                                Pieces[Kind].begin(), Pieces[Kind].end());
+  }
+
+  // Apply the relocations: offsets into another section are rebased, cross
+  // unit references are filled in and anything against symbol 0 is already
+  // absolute.
+  Dwarf_Unsigned RelocationSections = 0;
+  int DRDVersion = 0;
+  if (dwarf_get_relocation_info_count(Dbg, &RelocationSections, &DRDVersion,
+                                      &Err) != DW_DLV_OK)
+    producerError("dwarf_get_relocation_info_count", Err);
+  for (Dwarf_Unsigned I = 0; I < RelocationSections; ++I) {
+    Dwarf_Signed RelocationIndex = 0;
+    Dwarf_Signed LinkIndex = 0;
+    Dwarf_Unsigned Count = 0;
+    Dwarf_Relocation_Data Data = nullptr;
+    if (dwarf_get_relocation_info(Dbg, &RelocationIndex, &LinkIndex, &Count,
+                                  &Data, &Err) != DW_DLV_OK)
+      producerError("dwarf_get_relocation_info", Err);
+
+    SectionKind Relocated = SectionKinds[LinkIndex];
+    for (Dwarf_Unsigned R = 0; R < Count; ++R) {
+      const Dwarf_Relocation_Data_s &Reloc = Data[R];
+      if (Reloc.drd_symbol_index == 0)
+        continue;
+      uint8_t *Location = State.Sections[Relocated].data() +
+                          Bases[Relocated] + Reloc.drd_offset;
+      if (Reloc.drd_symbol_index >= CrossReferenceSymbol) {
+        writeLE(Location,
+                CrossReferences[Reloc.drd_symbol_index - CrossReferenceSymbol],
+                Reloc.drd_length);
+        continue;
+      }
+
+      SectionKind Target = SectionKinds[Reloc.drd_symbol_index];
+      writeLE(Location,
+              readLE(Location, Reloc.drd_length) + Bases[Target],
+              Reloc.drd_length);
+    }
+  }
+
+  // Record where this unit's types ended up for later units to refer to.
+  Dwarf_P_Marker Markers = nullptr;
+  Dwarf_Unsigned MarkerCount = 0;
+  if (dwarf_get_die_markers(Dbg, &Markers, &MarkerCount, &Err) != DW_DLV_OK)
+    producerError("dwarf_get_die_markers", Err);
+  for (Dwarf_Unsigned M = 0; M < MarkerCount; ++M) {
+    TypeRef Type = LocalTypes[Markers[M].ma_marker - 1];
+    Type.Local = nullptr;
+    Type.LinkedOffset =
+        static_cast<uint32_t>(Bases[SK_Info] + Markers[M].ma_offset);
+    State.LinkedTypes.push_back(Type);
+  }
+
+  ++State.Stats.CompileUnits;
+  State.Stats.DIEs += DIECount;
+}
+
+/// \brief Wrap the linked sections in a 32-bit relocatable ELF object.
+std::vector<uint8_t> writeElf(const ObjectState &State) {
+  enum : uint32_t {
+    SHT_PROGBITS = 1,
+    SHT_STRTAB = 3,
+    SHT_NOBITS = 8,
+    SHF_ALLOC = 0x2,
+    SHF_EXECINSTR = 0x4,
+    ElfHeaderSize = 52,
+    SectionHeaderSize = 40,
+  };
+
+  struct Section {
+    std::string Name;
+    uint32_t Type;
+    uint32_t Flags;
+    const std::vector<uint8_t> *Data;
+    uint32_t Size;
+    uint32_t NameOffset;
+    uint32_t Offset;
+  };
+  std::vector<Section> Sections;
+  Sections.push_back({"", 0, 0, nullptr, 0, 0, 0});
+  Sections.push_back({".text", SHT_NOBITS, SHF_ALLOC | SHF_EXECINSTR, nullptr,
+                      State.NextAddress, 0, 0});
+  for (unsigned Kind = SK_Abbrev; Kind < SK_Count; ++Kind)
+    Sections.push_back({SectionNames[Kind], SHT_PROGBITS, 0,
+                        &State.Sections[Kind],
+                        static_cast<uint32_t>(State.Sections[Kind].size()), 0,
+                        0});
+  std::vector<uint8_t> SectionNameTable;
+  Sections.push_back({".shstrtab", SHT_STRTAB, 0, &SectionNameTable, 0, 0, 0});
+
+  SectionNameTable.push_back(0);
+  for (Section &Sec : Sections) {
+    if (Sec.Name.empty())
+      continue;
+    Sec.NameOffset = static_cast<uint32_t>(SectionNameTable.size());
+    SectionNameTable.insert(SectionNameTable.end(), Sec.Name.begin(),
+                            Sec.Name.end());
+    SectionNameTable.push_back(0);
+  }
+  Sections.back().Size = static_cast<uint32_t>(SectionNameTable.size());
+
+  uint32_t Offset = ElfHeaderSize;
+  for (Section &Sec : Sections) {
+    Sec.Offset = Offset;
+    if (Sec.Data)
+      Offset += Sec.Size;
+  }
+  uint32_t SectionHeaderOffset = (Offset + 3) & ~3u;
+
+  std::vector<uint8_t> Out;
+  const uint8_t Ident[16] = {0x7f, 'E', 'L', 'F', 1 /*ELFCLASS32*/,
+                             1 /*ELFDATA2LSB*/, 1 /*EV_CURRENT*/};
+  Out.insert(Out.end(), Ident, Ident + sizeof(Ident));
+  appendLE(Out, 1, 2); // e_type: ET_REL
+  appendLE(Out, 3, 2); // e_machine: EM_386
+  appendLE(Out, 1, 4); // e_version
+  appendLE(Out, 0, 4); // e_entry
+  appendLE(Out, 0, 4); // e_phoff
+  appendLE(Out, SectionHeaderOffset, 4);
+  appendLE(Out, 0, 4); // e_flags
+  appendLE(Out, ElfHeaderSize, 2);
+  appendLE(Out, 0, 2); // e_phentsize
+  appendLE(Out, 0, 2); // e_phnum
+  appendLE(Out, SectionHeaderSize, 2);
+  appendLE(Out, Sections.size(), 2);
+  appendLE(Out, Sections.size() - 1, 2); // e_shstrndx
+
+  for (const Section &Sec : Sections)
+    if (Sec.Data)
+      Out.insert(Out.end(), Sec.Data->begin(), Sec.Data->end());
+  Out.resize(SectionHeaderOffset, 0);
+
+  for (const Section &Sec : Sections) {
+    appendLE(Out, Sec.NameOffset, 4);
+    appendLE(Out, Sec.Type, 4);
+    appendLE(Out, Sec.Flags, 4);
+    appendLE(Out, 0, 4); // sh_addr
+    appendLE(Out, Sec.Type ? Sec.Offset : 0, 4);
+    appendLE(Out, Sec.Size, 4);
+    appendLE(Out, 0, 4); // sh_link
+    appendLE(Out, 0, 4); // sh_info
+    appendLE(Out, Sec.Type ? 1 : 0, 4); // sh_addralign
+    appendLE(Out, 0, 4);                // sh_entsize
+  }
+  return Out;
+}
+
+} // namespace
+
+std::vector<uint8_t> SyntheticDwarf::generateObject(const Options &Opts,
+                                                    Statistics *Stats) {
+  ObjectState State(Opts);
+  for (unsigned Unit = 0; Unit < Opts.CompileUnits; ++Unit) {
+    CompileUnitWriter Writer(State, Unit);
+    Writer.generate();
+    Writer.link();
+  }
+
+  std::vector<uint8_t> Object(writeElf(State));
+  if (Stats) {
+    *Stats = State.Stats;
+    Stats->Bytes = Object.size();
+  }
+  return Object;
+}
+
+void SyntheticDwarf::writeObject(const Options &Opts,
+                                 const std::string &FileName,
+                                 Statistics *Stats) {
+  std::vector<uint8_t> Object(generateObject(Opts, Stats));
+  std::ofstream Out(FileName, std::ios::binary);
+  if (!Out)
+    LibScopeError::fatalError(
+        LibScopeError::ErrorCode::ERR_FILEIO_OPEN_FAILURE, FileName);
+  Out.write(reinterpret_cast<const char *>(Object.data()),
+            static_cast<std::streamsize>(Object.size()));
+  if (!Out)
+    LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_WRITE_FAILED,
+                              FileName, "write error");
+}
+
+bool SyntheticDwarf::parseTagMix(const std::string &Text, TagMix &Mix) {
+  TagMix Result(Mix);
+  std::stringstream Stream(Text);
+  std::string Item;
+  while (std::getline(Stream, Item, ',')) {
+    size_t Equals = Item.find('=');
+    if (Equals == std::string::npos)
+      return false;
+    std::string Kind(Item.substr(0, Equals));
+    std::string Value(Item.substr(Equals + 1));
+    if (Value.empty() ||
+        Value.find_first_not_of("0123456789") != std::string::npos)
+      return false;
+    unsigned Weight = static_cast<unsigned>(std::stoul(Value));
+
+    if (Kind == "namespace")
+      Result.Namespaces = Weight;
+    else if (Kind == "struct")
+      Result.Structs = Weight;
+    else if (Kind == "template")
+      Result.Templates = Weight;
+    else if (Kind == "enum")
+      Result.Enumerations = Weight;
+    else if (Kind == "typedef")
+      Result.Typedefs = Weight;
+    else if (Kind == "function")
+      Result.Functions = Weight;
+    else if (Kind == "variable")
+      Result.Variables = Weight;
+    else
+      return false;
+  }
+  Mix = Result;
+  return true;
+}
+
+bool SyntheticDwarf::getPreset(const std::string &Name, Options &Opts) {
+  Options Preset;
+  if (Name == "small") {
+    Preset.CompileUnits = 4;
+    Preset.DIEsPerCU = 2000;
+  } else if (Name == "medium") {
+    Preset.CompileUnits = 32;
+    Preset.DIEsPerCU = 10000;
+  } else if (Name == "large") {
+    Preset.CompileUnits = 128;
+    Preset.DIEsPerCU = 20000;
+    Preset.TemplateDepth = 8;
+  } else if (Name == "huge") {
+    Preset.CompileUnits = 512;
+    Preset.DIEsPerCU = 20000;
+    Preset.TemplateDepth = 12;
+    Preset.LinesPerFunction = 32;
+  } else {
+    return false;
+  }
+  Opts = Preset;
+  return true;
+}
+
+const std::vector<std::string> &SyntheticDwarf::getPresetNames() {
+  static const std::vector<std::string> Names({"small", "medium", "large",
+                                               "huge"});
+  return Names;
+}
@@ -0,0 +1,111 @@
+//===-- Benchmarks/SyntheticDwarf.h -----------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Generator for synthetic ELF objects with large amounts of DWARF, built on
+/// the libdwarf producer, used to benchmark and stress diva reproducibly.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SYNTHETIC_DWARF_H
+#define SYNTHETIC_DWARF_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SyntheticDwarf {
+
+/// \brief Relative weights of the kinds of declaration generated in each
+/// compile unit. A weight of zero disables that kind.
+struct TagMix {
+  unsigned Namespaces = 1;
+  unsigned Structs = 3;
+  unsigned Templates = 2;
+  unsigned Enumerations = 1;
+  unsigned Typedefs = 2;
+  unsigned Functions = 6;
+  unsigned Variables = 3;
+};
+
+/// \brief Shape of a generated object. The same options (including the seed)
+/// always produce the same bytes.
+struct Options {
+  uint64_t Seed = 1;
+  unsigned CompileUnits = 4;
+  /// \brief Approximate number of DIEs in each compile unit.
+  unsigned DIEsPerCU = 2000;
+  /// \brief Maximum depth of nested namespaces.
+  unsigned NamespaceDepth = 3;
+  /// \brief Number of nested instantiations in each template chain, e.g. a
+  /// depth of 3 produces 'Box<Box<Box<int>>>'.
+  unsigned TemplateDepth = 4;
+  TagMix Mix;
+  /// \brief Percentage of type references that refer to a type in an
+  /// earlier compile unit (DW_FORM_ref_addr).
+  unsigned CrossCUReferences = 10;
+  /// \brief Percentage of names that reuse a previously generated name.
+  unsigned StringReuse = 50;
+  /// \brief Number of line table rows generated for each function.
+  unsigned LinesPerFunction = 8;
+};
+
+/// \brief Counts of what was generated.
+struct Statistics {
+  uint64_t CompileUnits = 0;
+  uint64_t DIEs = 0;
+  uint64_t CrossCUReferences = 0;
+  uint64_t LineRows = 0;
+  uint64_t Bytes = 0;
+};
+
+/// \brief Generate a 32-bit x86 relocatable ELF object containing DWARF 2
+/// debug information shaped by Opts.
+///
+/// Each compile unit is produced by its own libdwarf producer instance. The
+/// per unit sections are then linked into one object: section offsets are
+/// rebased and references between units are resolved, so the object needs no
+/// relocation when read.
+std::vector<uint8_t> generateObject(const Options &Opts,
+                                    Statistics *Stats = nullptr);
+
+/// \brief Generate an object (see generateObject) and write it to FileName.
+void writeObject(const Options &Opts, const std::string &FileName,
+                 Statistics *Stats = nullptr);
+
+/// \brief Parse a tag mix such as 'struct=3,function=6,template=0' into Mix.
+/// Kinds that are not mentioned keep their current weight. Returns false if
+/// the text is not valid.
+bool parseTagMix(const std::string &Text, TagMix &Mix);
+
+/// \brief Get the options of a named preset ('small', 'medium', 'large' or
+/// 'huge'). Returns false if Name is not a preset.
+bool getPreset(const std::string &Name, Options &Opts);
+
+/// \brief Names of all the presets, smallest first.
+const std::vector<std::string> &getPresetNames();
+
+} // namespace SyntheticDwarf
+
+#endif // SYNTHETIC_DWARF_H
@@ -0,0 +1,181 @@
+//===-- Benchmarks/SyntheticMain.cpp ----------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Entry point for DivaSynth, which writes synthetic ELF objects for
+/// benchmarking diva on large amounts of DWARF.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ArgumentParser.h"
+#include "Error.h"
+#include "SyntheticDwarf.h"
+#include "Utilities.h"
+
+#include <iostream>
+
+namespace {
+
+unsigned parseUnsigned(const std::string &Arg, const std::string &Value,
+                       unsigned Max) {
+  try {
+    size_t End = 0;
+    unsigned long Result = std::stoul(Value, &End);
+    if (End == Value.size() && Result <= Max)
+      return static_cast<unsigned>(Result);
+  } catch (std::exception &) {
+  }
+  LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_CMD_INVALID_VALUE,
+                            Arg, Value);
+}
+
+/// \brief An argument taking an unsigned value no greater than Max.
+ArgumentParser::Argument unsignedArg(const std::string &Name,
+                                     const std::string &Help, unsigned Max,
+                                     unsigned &Value) {
+  return ArgumentParser::Argument(
+      ArgumentParser::Argument::NoShortcut, Name, "=<n>", Help, 1, nullptr,
+      [Name, Max, &Value](const ArgumentParser::Parser &,
+                          const std::string &ArgValue) {
+        Value = parseUnsigned(Name, ArgValue, Max);
+      },
+      nullptr);
+}
+
+std::string parseOptions(const std::vector<std::string> &CMDArgs,
+                         SyntheticDwarf::Options &Opts) {
+  using namespace ArgumentParser;
+
+  static const char NSC = Argument::NoShortcut;
+  static const std::string Usage("DivaSynth [options] output_file");
+  static const Argument::HelpLevel GeneralHelp = 1;
+  static const unsigned MaxCount = 100000000;
+
+  bool HelpPrinted = false;
+  unsigned SeedValue = static_cast<unsigned>(Opts.Seed);
+
+  // clang-format off
+  Parser SynthArgParser({
+    ArgumentGroup("General options", {
+      Argument::helpArg('h', "help", "Display help information", GeneralHelp,
+                        Usage, {GeneralHelp}, HelpPrinted, std::cout),
+      Argument(NSC, "preset", "=<name>",
+               "Start from a preset shape: small, medium, large or huge. "
+               "Must come before any other shape option.", GeneralHelp,
+               nullptr,
+               [&](const Parser &, const std::string &Value) {
+                 if (!SyntheticDwarf::getPreset(Value, Opts))
+                   LibScopeError::fatalError(
+                       LibScopeError::ErrorCode::ERR_CMD_INVALID_VALUE,
+                       "preset", Value);
+               },
+               nullptr),
+      unsignedArg("seed", "Seed for the generated content (default 1).",
+                  ~0u, SeedValue)
+    }),
+
+    ArgumentGroup("Shape options", {
+      unsignedArg("cus", "Number of compile units (default 4).", MaxCount,
+                  Opts.CompileUnits),
+      unsignedArg("dies", "Approximate DIEs per compile unit (default 2000).",
+                  MaxCount, Opts.DIEsPerCU),
+      unsignedArg("namespace-depth",
+                  "Maximum depth of nested namespaces (default 3).", 64,
+                  Opts.NamespaceDepth),
+      unsignedArg("template-depth",
+                  "Nested instantiations per template chain (default 4).",
+                  64, Opts.TemplateDepth),
+      Argument(NSC, "tag-mix", "=<kind=weight,...>",
+               "Relative weights of namespace, struct, template, enum, "
+               "typedef, function and variable declarations.", GeneralHelp,
+               nullptr,
+               [&](const Parser &, const std::string &Value) {
+                 if (!SyntheticDwarf::parseTagMix(Value, Opts.Mix))
+                   LibScopeError::fatalError(
+                       LibScopeError::ErrorCode::ERR_CMD_INVALID_VALUE,
+                       "tag-mix", Value);
+               },
+               nullptr),
+      unsignedArg("cross-cu",
+                  "Percentage of type references to earlier compile units "
+                  "(default 10).", 100, Opts.CrossCUReferences),
+      unsignedArg("string-reuse",
+                  "Percentage of names that repeat an earlier name "
+                  "(default 50).", 100, Opts.StringReuse),
+      unsignedArg("lines", "Line table rows per function (default 8).",
+                  MaxCount, Opts.LinesPerFunction)
+    })
+  });
+  // clang-format on
+
+  if (CMDArgs.empty()) {
+    SynthArgParser.outputHelp(Usage, GeneralHelp, std::cout);
+    std::exit(1);
+  }
+
+  std::vector<std::string> Files;
+  try {
+    Files = SynthArgParser.parseCommandLineArgs(CMDArgs);
+  } catch (ArgumentParser::ArgumentValueRequired &Err) {
+    LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_CMD_MISSING_VALUE,
+                              Err.Arg);
+  } catch (ArgumentParser::UnexpectedArgumentValue &Err) {
+    LibScopeError::fatalError(
+        LibScopeError::ErrorCode::ERR_CMD_UNEXPECTED_VALUE, Err.Arg,
+        Err.ArgVal);
+  } catch (ArgumentParser::ArgumentException &Err) {
+    LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_CMD_UNKNOWN_ARG,
+                              Err.Arg);
+  }
+  if (HelpPrinted)
+    std::exit(0);
+
+  if (Files.size() != 1) {
+    SynthArgParser.outputHelp(Usage, GeneralHelp, std::cout);
+    std::exit(1);
+  }
+  Opts.Seed = SeedValue;
+  return Files.front();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  LibScopeView::initialize();
+
+  const std::vector<std::string> CMDArgs(argv + 1, argv + argc);
+  SyntheticDwarf::Options Opts;
+  std::string OutputFile(parseOptions(CMDArgs, Opts));
+
+  SyntheticDwarf::Statistics Stats;
+  SyntheticDwarf::writeObject(Opts, OutputFile, &Stats);
+
+  std::cout << OutputFile << ": " << Stats.CompileUnits << " compile units, "
+            << Stats.DIEs << " DIEs, " << Stats.CrossCUReferences
+            << " cross unit references, " << Stats.LineRows
+            << " line rows, " << Stats.Bytes << " bytes\n";
+
+  LibScopeView::terminate();
+  return 0;
+}
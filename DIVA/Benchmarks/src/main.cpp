@@ -0,0 +1,439 @@
+//===-- Benchmarks/main.cpp -------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Entry point for DivaBenchmarks, which times each stage of reading and
+/// printing a corpus of input files and compares the results to a baseline.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ArgumentParser.h"
+#include "ElfDwarfReader.h"
+#include "Error.h"
+#include "FileUtilities.h"
+#include "PrintSettings.h"
+#include "ScopeTextPrinter.h"
+#include "ScopeYAMLPrinter.h"
+#include "SyntheticDwarf.h"
+#include "Trace.h"
+#include "Utilities.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <streambuf>
+
+namespace {
+
+/// \brief Stages reported for each input, in the order they run.
+const std::vector<std::string> &getStageNames() {
+  static const std::vector<std::string> Stages({
+      "ReadFile", "ReadDIEs", "ReadLines", "ResolveNames", "ResolveReferences",
+      "ResolveGlobals", "Sort", "PrintText", "PrintYAML", "PrintSplitText",
+      "PrintSplitYAML"});
+  return Stages;
+}
+
+/// \brief Options for a benchmark run.
+struct BenchmarkOptions {
+  std::vector<std::string> InputFiles;
+  std::vector<std::string> SyntheticPresets;
+  std::string CorpusFile;
+  std::string SyntheticDirectory;
+  std::string ResultsFile;
+  std::string BaselineFile;
+  std::string SplitDirectory;
+  unsigned Repeat = 5;
+  double Threshold = 10.0;
+  bool PrintText = true;
+  bool PrintYAML = true;
+  bool PrintSplit = true;
+};
+
+unsigned parseUnsigned(const std::string &Arg, const std::string &Value) {
+  try {
+    size_t End = 0;
+    unsigned long Result = std::stoul(Value, &End);
+    if (End == Value.size() && Result > 0)
+      return static_cast<unsigned>(Result);
+  } catch (std::exception &) {
+  }
+  LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_CMD_INVALID_VALUE,
+                            Arg, Value);
+}
+
+double parsePercentage(const std::string &Arg, const std::string &Value) {
+  try {
+    size_t End = 0;
+    double Result = std::stod(Value, &End);
+    if (End == Value.size() && Result >= 0.0)
+      return Result;
+  } catch (std::exception &) {
+  }
+  LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_CMD_INVALID_VALUE,
+                            Arg, Value);
+}
+
+BenchmarkOptions parseOptions(const std::vector<std::string> &CMDArgs) {
+  using namespace ArgumentParser;
+
+  static const char NSC = Argument::NoShortcut;
+  static const std::string Usage(
+      "DivaBenchmarks [options] input_file [input_file...]");
+  static const Argument::HelpLevel GeneralHelp = 1;
+
+  BenchmarkOptions Options;
+  bool HelpPrinted = false;
+
+  // clang-format off
+  Parser BenchmarkArgParser({
+    ArgumentGroup("General options", {
+      Argument::helpArg('h', "help", "Display help information", GeneralHelp,
+                        Usage, {GeneralHelp}, HelpPrinted, std::cout),
+      Argument::stringArg(NSC, "corpus", "file",
+                          "File listing one input file per line (lines "
+                          "starting with '#' are ignored).", GeneralHelp,
+                          Options.CorpusFile),
+      Argument(NSC, "repeat", "=<count>",
+               "Number of times each input is measured (default 5).",
+               GeneralHelp, nullptr,
+               [&](const Parser &, const std::string &Value) {
+                 Options.Repeat = parseUnsigned("repeat", Value);
+               },
+               nullptr),
+      Argument(NSC, "synthetic", "=<preset>",
+               "Generate a synthetic input from a preset (small, medium, "
+               "large or huge) and measure it too. May be repeated.",
+               GeneralHelp, nullptr,
+               [&](const Parser &, const std::string &Value) {
+                 SyntheticDwarf::Options Unused;
+                 if (!SyntheticDwarf::getPreset(Value, Unused))
+                   LibScopeError::fatalError(
+                       LibScopeError::ErrorCode::ERR_CMD_INVALID_VALUE,
+                       "synthetic", Value);
+                 Options.SyntheticPresets.push_back(Value);
+               },
+               nullptr),
+      Argument::stringArg(NSC, "synthetic-dir", "dir",
+                          "Directory the synthetic inputs are written to "
+                          "(default 'DivaBenchmarksSynthetic').", GeneralHelp,
+                          Options.SyntheticDirectory)
+    }),
+
+    ArgumentGroup("Stage options", {
+      Argument::switchArg(NSC, "text", "Measure text printing (default on)",
+                          GeneralHelp, Options.PrintText),
+      Argument::switchArg(NSC, "yaml", "Measure YAML printing (default on)",
+                          GeneralHelp, Options.PrintYAML),
+      Argument::switchArg(NSC, "split",
+                          "Measure split output to a directory (default on)",
+                          GeneralHelp, Options.PrintSplit),
+      Argument::stringArg(NSC, "split-dir", "dir",
+                          "Directory used for split output (default "
+                          "'DivaBenchmarksOutput').", GeneralHelp,
+                          Options.SplitDirectory)
+    }),
+
+    ArgumentGroup("Result options", {
+      Argument::stringArg(NSC, "results", "file",
+                          "Write the results as CSV to a file instead of "
+                          "stdout.", GeneralHelp, Options.ResultsFile),
+      Argument::stringArg(NSC, "baseline", "file",
+                          "Compare the results to a CSV file from a previous "
+                          "run and fail if any stage regressed.", GeneralHelp,
+                          Options.BaselineFile),
+      Argument(NSC, "threshold", "=<percent>",
+               "Slow down of a stage's median time that counts as a "
+               "regression (default 10).", GeneralHelp, nullptr,
+               [&](const Parser &, const std::string &Value) {
+                 Options.Threshold = parsePercentage("threshold", Value);
+               },
+               nullptr)
+    })
+  });
+  // clang-format on
+
+  if (CMDArgs.empty()) {
+    BenchmarkArgParser.outputHelp(Usage, GeneralHelp, std::cout);
+    std::exit(1);
+  }
+
+  try {
+    Options.InputFiles = BenchmarkArgParser.parseCommandLineArgs(CMDArgs);
+  } catch (ArgumentParser::ArgumentValueRequired &Err) {
+    LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_CMD_MISSING_VALUE,
+                              Err.Arg);
+  } catch (ArgumentParser::UnexpectedArgumentValue &Err) {
+    LibScopeError::fatalError(
+        LibScopeError::ErrorCode::ERR_CMD_UNEXPECTED_VALUE, Err.Arg,
+        Err.ArgVal);
+  } catch (ArgumentParser::ArgumentException &Err) {
+    LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_CMD_UNKNOWN_ARG,
+                              Err.Arg);
+  }
+  if (HelpPrinted)
+    std::exit(0);
+
+  if (Options.SplitDirectory.empty())
+    Options.SplitDirectory = "DivaBenchmarksOutput";
+  if (Options.SyntheticDirectory.empty())
+    Options.SyntheticDirectory = "DivaBenchmarksSynthetic";
+  return Options;
+}
+
+/// \brief Add the files listed in a corpus file to InputFiles.
+void readCorpusFile(const std::string &CorpusFile,
+                    std::vector<std::string> &InputFiles) {
+  std::ifstream Corpus(CorpusFile);
+  if (!Corpus)
+    LibScopeError::fatalError(
+        LibScopeError::ErrorCode::ERR_FILEIO_OPEN_FAILURE, CorpusFile);
+
+  std::string Line;
+  while (std::getline(Corpus, Line)) {
+    Line = LibScopeView::trim(Line);
+    if (!Line.empty() && Line[0] != '#')
+      InputFiles.push_back(Line);
+  }
+}
+
+/// \brief Generate the synthetic inputs and add them to InputFiles. They are
+/// regenerated on every run; the same preset always gives the same bytes.
+void generateSyntheticInputs(const BenchmarkOptions &Options,
+                             std::vector<std::string> &InputFiles) {
+  if (Options.SyntheticPresets.empty())
+    return;
+  if (!LibScopeView::recursiveMakeDir(Options.SyntheticDirectory))
+    LibScopeError::fatalError(
+        LibScopeError::ErrorCode::ERR_FILEIO_MAKE_DIR_FAILURE,
+        Options.SyntheticDirectory);
+
+  for (const std::string &Preset : Options.SyntheticPresets) {
+    SyntheticDwarf::Options Synthetic;
+    SyntheticDwarf::getPreset(Preset, Synthetic);
+    std::string FileName(Options.SyntheticDirectory + "/synthetic-" + Preset +
+                         ".o");
+    SyntheticDwarf::writeObject(Synthetic, FileName);
+    InputFiles.push_back(FileName);
+  }
+}
+
+/// \brief A stream buffer that discards everything written to it.
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int Char) override { return Char; }
+  std::streamsize xsputn(const char *, std::streamsize Count) override {
+    return Count;
+  }
+};
+
+/// \brief Stage times (in milliseconds) from every run of one input.
+using StageSamples = std::map<std::string, std::vector<double>>;
+
+/// \brief Read and print InputFile once, adding the time for each stage.
+void runOnce(const std::string &InputFile, const BenchmarkOptions &Options,
+             StageSamples &Samples) {
+  LibScopeView::PrintSettings Settings;
+  Settings.showAll();
+
+  LibScopeView::Tracer Trace;
+  LibScopeView::setActiveTracer(&Trace);
+  {
+    std::unique_ptr<LibScopeView::ScopeRoot> Root;
+    {
+      LibScopeView::TraceSpan Span("ReadFile");
+      ElfDwarfReader::DwarfReader Reader;
+      Root = Reader.loadFile(InputFile, Settings);
+    }
+
+    NullBuffer Discard;
+    std::ostream NullStream(&Discard);
+    LibScopeView::ScopeTextPrinter TextPrinter(Settings, InputFile);
+    LibScopeView::ScopeYAMLPrinter YAMLPrinter(Settings, InputFile,
+                                               YAML_OUTPUT_VERSION_STR);
+    if (Options.PrintText) {
+      LibScopeView::TraceSpan Span("PrintText");
+      TextPrinter.print(Root.get(), NullStream);
+    }
+    if (Options.PrintYAML) {
+      LibScopeView::TraceSpan Span("PrintYAML");
+      YAMLPrinter.print(Root.get(), NullStream);
+    }
+    if (Options.PrintSplit) {
+      std::string SplitDir(Options.SplitDirectory + "/" +
+                           LibScopeView::getFileName(InputFile));
+      {
+        LibScopeView::TraceSpan Span("PrintSplitText");
+        TextPrinter.print(Root.get(), SplitDir);
+      }
+      {
+        LibScopeView::TraceSpan Span("PrintSplitYAML");
+        YAMLPrinter.print(Root.get(), SplitDir);
+      }
+    }
+  }
+  LibScopeView::setActiveTracer(nullptr);
+
+  for (const auto &Stage : Trace.getSelfTimeByName())
+    Samples[Stage.first].push_back(double(Stage.second) / 1000.0);
+}
+
+/// \brief Summary of the samples for one stage of one input.
+struct StageResult {
+  std::string Input;
+  std::string Stage;
+  size_t Runs;
+  double Min;
+  double Median;
+  double Max;
+};
+
+StageResult summarize(const std::string &Input, const std::string &Stage,
+                      std::vector<double> Times) {
+  std::sort(Times.begin(), Times.end());
+  size_t Mid = Times.size() / 2;
+  double Median = Times.size() % 2 ? Times[Mid]
+                                   : (Times[Mid - 1] + Times[Mid]) / 2.0;
+  return {Input, Stage, Times.size(), Times.front(), Median, Times.back()};
+}
+
+void writeResults(const std::vector<StageResult> &Results, std::ostream &Out) {
+  Out << "input,stage,runs,min_ms,median_ms,max_ms\n";
+  Out << std::fixed << std::setprecision(3);
+  for (const StageResult &Result : Results)
+    Out << Result.Input << ',' << Result.Stage << ',' << Result.Runs << ','
+        << Result.Min << ',' << Result.Median << ',' << Result.Max << '\n';
+}
+
+/// \brief Read the median times from a results file, keyed on input/stage.
+std::map<std::pair<std::string, std::string>, double>
+readBaseline(const std::string &BaselineFile) {
+  std::ifstream Baseline(BaselineFile);
+  if (!Baseline)
+    LibScopeError::fatalError(
+        LibScopeError::ErrorCode::ERR_FILEIO_OPEN_FAILURE, BaselineFile);
+
+  std::map<std::pair<std::string, std::string>, double> Medians;
+  std::string Line;
+  std::getline(Baseline, Line); // Header.
+  while (std::getline(Baseline, Line)) {
+    std::vector<std::string> Fields;
+    std::stringstream LineStream(Line);
+    std::string Field;
+    while (std::getline(LineStream, Field, ','))
+      Fields.push_back(Field);
+    if (Fields.size() != 6)
+      continue;
+    Medians[std::make_pair(Fields[0], Fields[1])] = std::atof(Fields[4].c_str());
+  }
+  return Medians;
+}
+
+/// \brief Print a comparison of Results to the baseline, returning false if
+/// any stage is slower than the threshold allows.
+bool compareToBaseline(const std::vector<StageResult> &Results,
+                       const std::string &BaselineFile, double Threshold,
+                       std::ostream &Out) {
+  auto Baseline = readBaseline(BaselineFile);
+
+  bool Passed = true;
+  Out << "Comparison to baseline '" << BaselineFile << "':\n"
+      << std::fixed << std::setprecision(3);
+  for (const StageResult &Result : Results) {
+    auto Base = Baseline.find(std::make_pair(Result.Input, Result.Stage));
+    if (Base == Baseline.end())
+      continue;
+
+    // Ignore stages too short to be measured reliably.
+    double Change = 0.0;
+    if (Base->second >= 1.0)
+      Change = (Result.Median - Base->second) / Base->second * 100.0;
+    bool Regressed = Change > Threshold;
+    Passed &= !Regressed;
+
+    Out << "  " << std::setw(20) << std::left << Result.Stage << std::right
+        << std::setw(12) << Base->second << " ms -> " << std::setw(12)
+        << Result.Median << " ms  " << std::showpos << std::setprecision(1)
+        << Change << std::noshowpos << std::setprecision(3) << "%"
+        << (Regressed ? "  REGRESSED" : "") << "  (" << Result.Input << ")\n";
+  }
+  return Passed;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  LibScopeView::initialize();
+
+  const std::vector<std::string> CMDArgs(argv + 1, argv + argc);
+  BenchmarkOptions Options(parseOptions(CMDArgs));
+  if (!Options.CorpusFile.empty())
+    readCorpusFile(Options.CorpusFile, Options.InputFiles);
+  generateSyntheticInputs(Options, Options.InputFiles);
+
+  for (const std::string &InputFile : Options.InputFiles) {
+    if (!LibScopeView::doesFileExist(InputFile))
+      LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_FILE_NOT_FOUND,
+                                InputFile);
+    if (!LibScopeView::isFileFormatElf(InputFile))
+      LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_INVALID_FILE,
+                                InputFile);
+  }
+
+  std::vector<StageResult> Results;
+  for (const std::string &InputFile : Options.InputFiles) {
+    StageSamples Samples;
+    for (unsigned Run = 0; Run < Options.Repeat; ++Run)
+      runOnce(InputFile, Options, Samples);
+
+    for (const std::string &Stage : getStageNames()) {
+      auto StageSamples = Samples.find(Stage);
+      if (StageSamples != Samples.end())
+        Results.push_back(summarize(InputFile, Stage, StageSamples->second));
+    }
+  }
+
+  if (Options.ResultsFile.empty()) {
+    writeResults(Results, std::cout);
+  } else {
+    std::ofstream ResultsOut(Options.ResultsFile);
+    if (!ResultsOut)
+      LibScopeError::fatalError(
+          LibScopeError::ErrorCode::ERR_FILEIO_OPEN_FAILURE,
+          Options.ResultsFile);
+    writeResults(Results, ResultsOut);
+  }
+
+  bool Passed = true;
+  if (!Options.BaselineFile.empty())
+    Passed = compareToBaseline(Results, Options.BaselineFile,
+                               Options.Threshold, std::cerr);
+
+  LibScopeView::terminate();
+  return Passed ? 0 : 1;
+}
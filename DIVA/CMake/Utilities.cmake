@@ -27,7 +27,7 @@ macro(parse_all_arguments prefix opt one_val multi_val)
     endif()
 endmacro()
 
-# create_target([LIB | EXE] <name>
+# create_target([LIB | SHARED | EXE] <name>
 #               [OUTPUT_NAME <output_name>]
 #               [SOURCE [<source1> ...]]
 #               [HEADERS [<header1> ...]]
@@ -45,10 +45,12 @@ function(create_target project_type project_name)
     # Create target
     if(${project_type} STREQUAL "LIB")
         add_library(${project_name} STATIC ${ARG_SOURCE} ${ARG_HEADERS})
+    elseif(${project_type} STREQUAL "SHARED")
+        add_library(${project_name} SHARED ${ARG_SOURCE} ${ARG_HEADERS})
     elseif(${project_type} STREQUAL "EXE")
         add_executable(${project_name} ${ARG_SOURCE} ${ARG_HEADERS})
     else()
-        message(FATAL_ERROR "The first argument to create_target must be EXE or LIB")
+        message(FATAL_ERROR "The first argument to create_target must be EXE, LIB or SHARED")
     endif()
     if(ARG_OUTPUT_NAME)
         set_target_properties(${project_name} PROPERTIES OUTPUT_NAME
@@ -7,4 +7,5 @@ set(copyright_year "2017")
 set(diva_major_version "99")
 set(diva_minor_version "9")
 set(yaml_output_version "0.1")
+set(json_output_version "0.1")
 ################################################################################################
@@ -32,14 +32,16 @@
 #include "Error.h"
 #include "Platform.h"
 
+#include <stdexcept>
+
 namespace {
 
 const static std::string DIVA_VERSION_NUMBER(RC_VERSION_STR);
 const static std::string COPYRIGHT_YEAR(RC_COPYYEAR_STR);
 const static std::string COMPANY_NAME(RC_COMPANYNAME_STR);
 
-[[noreturn]] void earlyExitSuccess() { std::exit(0); }
-[[noreturn]] void earlyExitFailure() { std::exit(1); }
+[[noreturn]] void earlyExitSuccess() { LibScopeError::exitProcess(0); }
+[[noreturn]] void earlyExitFailure() { LibScopeError::exitProcess(1); }
 
 void printVersionDetails(std::ostream &VersionOut) {
 #ifndef NDEBUG
@@ -83,6 +85,17 @@ void compileRegexs(std::vector<std::string> &Patterns,
   }
 }
 
+// Parse a hexadecimal address, with or without a leading 0x.
+bool parseAddress(const std::string &Text, uint64_t &Address) {
+  size_t End = 0;
+  try {
+    Address = std::stoull(Text, &End, 16);
+  } catch (std::logic_error &) {
+    return false;
+  }
+  return End != 0 && End == Text.size() && Text[0] != '-';
+}
+
 } // end anonymous namespace.
 
 DivaOptions::DivaOptions(const std::vector<std::string> &CMDArgs,
@@ -118,6 +131,10 @@ DivaOptions::DivaOptions(const std::vector<std::string> &CMDArgs,
     OutputFormats.emplace(OutputFormat::TEXT);
   if (OutputFormatStrings.count("yaml"))
     OutputFormats.emplace(OutputFormat::YAML);
+  if (OutputFormatStrings.count("json"))
+    OutputFormats.emplace(OutputFormat::JSON);
+  if (OutputFormatStrings.count("ndjson"))
+    OutputFormats.emplace(OutputFormat::NDJSON);
 
   // Set sort key.
   if (SortKeyString == "line")
@@ -130,6 +147,73 @@ DivaOptions::DivaOptions(const std::vector<std::string> &CMDArgs,
   // Compile filter regexs.
   compileRegexs(RawFilters, PrintingSettings.Filters);
   compileRegexs(RawTreeFilters, PrintingSettings.TreeFilters);
+  compileRegexs(RawFindRegexs, FindRegexs);
+
+  // Convert the server cache size from megabytes.
+  if (!ServeCacheSizeString.empty()) {
+    size_t End = 0;
+    unsigned long long Megabytes = 0;
+    try {
+      Megabytes = std::stoull(ServeCacheSizeString, &End);
+    } catch (std::logic_error &) {
+      End = 0;
+    }
+    if (End == 0 || End != ServeCacheSizeString.size() ||
+        ServeCacheSizeString[0] == '-')
+      LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_CMD_INVALID_VALUE,
+                                "serve-cache-size", ServeCacheSizeString);
+    ServeCacheSize = Megabytes * 1024 * 1024;
+  }
+
+  // Standard input can only be read for one option.
+  if (LookupStdin && InputList == "-")
+    LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_CMD_INVALID_VALUE,
+                              "input-list", InputList);
+
+  // Convert the addresses to look up.
+  for (const std::string &RawAddress : RawLookupAddresses) {
+    uint64_t Address = 0;
+    if (!parseAddress(RawAddress, Address))
+      LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_CMD_INVALID_VALUE,
+                                "lookup", RawAddress);
+    LookupAddresses.push_back(Address);
+  }
+}
+
+void DivaOptions::addLookupAddresses(std::istream &In) {
+  std::string RawAddress;
+  while (In >> RawAddress) {
+    uint64_t Address = 0;
+    if (parseAddress(RawAddress, Address))
+      LookupAddresses.push_back(Address);
+    else
+      LibScopeError::warning("Ignoring invalid address '" + RawAddress +
+                             "'.");
+  }
+}
+
+std::vector<std::string> DivaOptions::getNameFilter() const {
+  std::vector<std::string> Names;
+  // The other views, the summary, the global flags and the width of the
+  // levels depend on the objects that aren't printed.
+  const LibScopeView::PrintSettings &Settings = PrintingSettings;
+  if (OutputFormats.size() != 1 || !OutputFormats.count(OutputFormat::TEXT) ||
+      Settings.SplitOutput || ShowSummary || ShowScopeAllocation ||
+      hasFindQueries() || hasLookups() || Incremental || Settings.ShowLevel ||
+      Settings.ShowIsGlobal || Settings.ShowOnlyGlobals ||
+      Settings.ShowOnlyLocals || !Settings.FilterAnys.empty() ||
+      !Settings.TreeFilterAnys.empty())
+    return Names;
+
+  for (const auto *Patterns : {&RawFilters, &RawTreeFilters}) {
+    for (const std::string &Pattern : *Patterns) {
+      // A pattern without special characters only matches itself.
+      if (Pattern.find_first_of("\\^$.|?*+()[]{}") != std::string::npos)
+        return std::vector<std::string>();
+      Names.push_back(Pattern);
+    }
+  }
+  return Names;
 }
 
 void DivaOptions::parseArgs(const std::vector<std::string> &CMDArgs,
@@ -174,6 +258,31 @@ void DivaOptions::parseArgs(const std::vector<std::string> &CMDArgs,
                           GeneralHelp, PrintingSettings.QuietMode)
     }),
 
+    ArgumentGroup("Input options", {
+      Argument::multiStringArg(
+          NSC, "input-dir", "dir",
+          "Read every ELF file with debug information, and every static "
+          "archive, in <dir> and its subdirectories. The files found are read "
+          "on a pool of threads, largest first, and printed in order. Any "
+          "summary table is of all the files.",
+          MoreHelp, InputDirectories),
+      Argument::multiStringArg(
+          NSC, "input-include", "glob",
+          "Only read the --input-dir files whose name matches <glob>, or "
+          "whose path under <dir> matches if <glob> contains a '/'.",
+          MoreHelp, InputIncludes),
+      Argument::multiStringArg(
+          NSC, "input-exclude", "glob",
+          "Skip the --input-dir files that match <glob>, as for "
+          "--input-include.",
+          MoreHelp, InputExcludes),
+      Argument::stringArg(
+          NSC, "input-list", "file",
+          "Same as --input-dir for the files listed in <file>, one per line, "
+          "or read from standard input if <file> is \"-\".",
+          MoreHelp, InputList),
+    }),
+
     ArgumentGroup("Output options", {
       Argument('a', "show-all",
                "Print all (expect advanced) objects and attributes", BasicHelp,
@@ -198,7 +307,12 @@ void DivaOptions::parseArgs(const std::vector<std::string> &CMDArgs,
       Argument::multiChoiceArg(
           NSC, "output",
           "A comma separated list of output formats.", BasicHelp,
-          {"text", "yaml"}, OutputFormatStrings)
+          {"text", "yaml", "json", "ndjson"}, OutputFormatStrings),
+      Argument::switchArg(
+          NSC, "compress",
+          "Compress the output with gzip. The --output-dir files are given a "
+          "\".gz\" extension.",
+          BasicHelp, PrintingSettings.CompressOutput)
     }),
 
     ArgumentGroup("Sort options", {
@@ -231,6 +345,65 @@ void DivaOptions::parseArgs(const std::vector<std::string> &CMDArgs,
         PrintingSettings.TreeFilterAnys),
     }),
 
+    ArgumentGroup("Find options", {
+      Argument::multiStringArg(
+          NSC, "find", "name",
+          "Instead of the logical view, print the objects named <name>, or "
+          "with the qualified name <name> (e.g. ns::Class::method), and the "
+          "scopes that contain them. The names are indexed once, so many "
+          "queries cost little more than one.",
+          BasicHelp, FindNames),
+      Argument::multiStringArg(
+          NSC, "find-prefix", "text",
+          "Same as --find for the names starting with <text>.", BasicHelp,
+          FindPrefixes),
+      Argument::multiStringArg(
+          NSC, "find-regex", "regex",
+          "Same as --find for the names matching <regex>.", BasicHelp,
+          RawFindRegexs),
+    }),
+
+    ArgumentGroup("Address lookup options", {
+      Argument::multiStringArg(
+          NSC, "lookup", "address",
+          "Instead of the logical view, print the innermost function, inlined "
+          "functions and blocks, and the line, that contain the hexadecimal "
+          "code <address>. Only the compile units .debug_aranges shows to "
+          "contain an address are read.",
+          BasicHelp, RawLookupAddresses),
+      Argument::switchArg(
+          NSC, "lookup-stdin",
+          "Same as --lookup for each address read from standard input, "
+          "separated by whitespace.",
+          BasicHelp, LookupStdin),
+    }),
+
+    ArgumentGroup("Compile unit options", {
+      Argument::switchArg(
+          NSC, "list-cus",
+          "Instead of the logical view, list the offset, size and DWARF "
+          "version of each compile unit from its header, and its language, "
+          "name and producer from its root DIE. No other DIEs are read.",
+          BasicHelp, ListCompileUnits),
+      Argument::multiStringArg(
+          NSC, "cu", "glob",
+          "Only read (or list) the compile units whose name matches <glob>, "
+          "or whose whole path matches if <glob> contains a '/'. The other "
+          "units are skipped, apart from the DIEs that the units read "
+          "reference in them, which are read with the scopes that contain "
+          "them.",
+          BasicHelp, CompileUnitPatterns),
+    }),
+
+    ArgumentGroup("Incremental options", {
+      Argument::switchArg(
+          NSC, "incremental",
+          "Save the objects read from each input file to <file>.divastate "
+          "and on later runs only read the compile units that have changed "
+          "since.",
+          MoreHelp, Incremental),
+    }),
+
     ArgumentGroup("More object options", {
       Argument(
           NSC, "show-none",
@@ -349,6 +522,36 @@ void DivaOptions::parseArgs(const std::vector<std::string> &CMDArgs,
                           DeveloperHelp, ShowPerformanceMemory),
       Argument::switchArg(NSC, "scope-allocation", "Print scope allocations",
                           DeveloperHelp, ShowScopeAllocation),
+      Argument::switchArg(NSC, "show-memory-breakdown",
+                          "Print the memory held by each owner (objects, "
+                          "string pool, reader maps, libdwarf, ...) at the "
+                          "end of each phase",
+                          DeveloperHelp, ShowMemoryBreakdown),
+      Argument::stringArg(
+          NSC, "trace-file", "file",
+          "Write the time taken by each phase, and counts of the DIEs, "
+          "attributes, objects and strings read, to <file> as Chrome trace "
+          "event JSON (for chrome://tracing or Perfetto).",
+          DeveloperHelp, TraceFile),
+    }),
+
+    ArgumentGroup("Server options", {
+      Argument::stringArg(
+          NSC, "serve", "socket",
+          "Run as a server listening on the local socket <socket>, keeping "
+          "the Scope trees of recently used input files in memory. Any input "
+          "files given are loaded when the server starts.",
+          MoreHelp, ServeSocket),
+      Argument::stringArg(
+          NSC, "serve-cache-size", "MB",
+          "The most memory the server's cached Scope trees may use, the least "
+          "recently used trees are discarded first. By default 1024.",
+          MoreHelp, ServeCacheSizeString),
+      Argument::stringArg(
+          NSC, "connect", "socket",
+          "Send the other options and input files to the server listening on "
+          "<socket> and print its output.",
+          MoreHelp, ConnectSocket),
     })
   });
   // clang-format on
@@ -32,12 +32,14 @@
 
 #include "PrintSettings.h"
 
+#include <cstdint>
 #include <iostream>
+#include <regex>
 #include <set>
 #include <string>
 #include <vector>
 
-enum class OutputFormat { TEXT, YAML };
+enum class OutputFormat { TEXT, YAML, JSON, NDJSON };
 
 /// \brief Class that parses command line arguments into DIVA's options (using
 /// ArgumentParser).
@@ -53,15 +55,92 @@ public:
 
   std::vector<std::string> InputFiles;
 
+  /// \brief Directories to search for input files, and the globs that the
+  /// files found in them must match (any include and no exclude).
+  std::vector<std::string> InputDirectories;
+  std::vector<std::string> InputIncludes;
+  std::vector<std::string> InputExcludes;
+  /// \brief A file listing input files, one per line, or "-" for stdin.
+  std::string InputList;
+
+  bool hasInputSearch() const {
+    return !InputDirectories.empty() || !InputList.empty();
+  }
+
   std::set<OutputFormat> OutputFormats;
 
   LibScopeView::PrintSettings PrintingSettings;
 
   bool ShowSummary = false;
 
+  /// \brief Names, name prefixes and name regexs to find instead of printing
+  /// the logical view.
+  std::vector<std::string> FindNames;
+  std::vector<std::string> FindPrefixes;
+  std::vector<std::regex> FindRegexs;
+  /// \brief The source of each of FindRegexs.
+  std::vector<std::string> RawFindRegexs;
+
+  bool hasFindQueries() const {
+    return !(FindNames.empty() && FindPrefixes.empty() && FindRegexs.empty());
+  }
+
+  /// \brief Code addresses to look up instead of printing the logical view.
+  std::vector<uint64_t> LookupAddresses;
+  /// \brief Also look up the addresses read from standard input.
+  bool LookupStdin = false;
+
+  bool hasLookups() const { return !LookupAddresses.empty() || LookupStdin; }
+
+  /// \brief Add the hexadecimal addresses in In (separated by whitespace) to
+  /// LookupAddresses, warning about any that are not valid.
+  void addLookupAddresses(std::istream &In);
+
+  /// \brief List the compile units of each input file, from their headers and
+  /// root DIEs, instead of printing the logical view.
+  bool ListCompileUnits = false;
+  /// \brief Globs selecting the compile units to read or list by name, or
+  /// empty for all of them.
+  std::vector<std::string> CompileUnitPatterns;
+
+  /// \brief Reuse the compile units that are unchanged since the last run,
+  /// from a state file saved next to each input file.
+  bool Incremental = false;
+
+  /// \brief The state file for an input file, or empty if not Incremental.
+  std::string getIncrementalStateFile(const std::string &InputFile) const {
+    return Incremental ? InputFile + ".divastate" : std::string();
+  }
+
   bool ShowPerformanceTime = false;
   bool ShowPerformanceMemory = false;
   bool ShowScopeAllocation = false;
+  bool ShowMemoryBreakdown = false;
+
+  /// \brief If not empty, the file to write the Chrome trace JSON to.
+  std::string TraceFile;
+
+  /// \brief True if only the summary table is printed for each input file,
+  /// so the objects can be counted without building the tree.
+  bool isSummaryOnly() const {
+    return ShowSummary && PrintingSettings.QuietMode &&
+           !PrintingSettings.SplitOutput && !hasFindQueries() &&
+           !hasLookups() && !ShowScopeAllocation && !Incremental &&
+           CompileUnitPatterns.empty();
+  }
+
+  /// \brief The names that the --filter and --tree patterns match, if they
+  /// are all plain names and only the text view of the matching objects is
+  /// printed, so that the reader can leave out the compile units that aren't
+  /// needed for it. Empty otherwise.
+  std::vector<std::string> getNameFilter() const;
+
+  /// \brief If not empty, run as a server listening on this socket.
+  std::string ServeSocket;
+  /// \brief The most memory (in bytes) the server's cached trees may use.
+  uint64_t ServeCacheSize = 1024 * 1024 * 1024;
+  /// \brief If not empty, forward the request to the server on this socket.
+  std::string ConnectSocket;
 
 private:
   void parseArgs(const std::vector<std::string> &CMDArgs, std::ostream &HelpOut,
@@ -70,6 +149,9 @@ private:
   // Some options need to be translated from input strings to enum values.
   std::set<std::string> OutputFormatStrings;
   std::string SortKeyString;
+  // Or from strings to numbers.
+  std::string ServeCacheSizeString;
+  std::vector<std::string> RawLookupAddresses;
   // Or from strings to regular expressions.
   std::vector<std::string> RawFilters;
   std::vector<std::string> RawTreeFilters;
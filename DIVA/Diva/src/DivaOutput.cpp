@@ -0,0 +1,551 @@
+//===-- Diva/DivaOutput.cpp -------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Reading input files and printing their Scope trees.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DivaOutput.h"
+#include "AddressIndex.h"
+#include "Archive.h"
+#include "DwarfSummaryScan.h"
+#include "DwarfUnitList.h"
+#include "ElfDwarfReader.h"
+#include "Error.h"
+#include "FileUtilities.h"
+#include "Line.h"
+#include "MemoryProfile.h"
+#include "NameIndex.h"
+#include "ScopeTextPrinter.h"
+#include "ScopeJSONPrinter.h"
+#include "ScopeNDJSONPrinter.h"
+#include "ScopeYAMLPrinter.h"
+#include "SummaryTable.h"
+#include "Trace.h"
+#include "Utilities.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+using LibScopeView::isa;
+
+namespace {
+
+/// \brief Print a chain of objects, each inside the one before, indented by
+/// level after a line number column. Only the first line of each object's
+/// text is printed, apart from Detailed which is printed in full.
+void printObjectChain(const std::vector<const LibScopeView::Object *> &Chain,
+                      const LibScopeView::Object *Detailed,
+                      const LibScopeView::PrintSettings &Settings,
+                      std::ostream &Out) {
+  const size_t IndentSize = 2;
+  size_t LineNumberWidth = 1;
+  for (const LibScopeView::Object *Obj : Chain)
+    LineNumberWidth = std::max(LineNumberWidth,
+                               std::to_string(Obj->getLineNumber()).size());
+
+  for (size_t Level = 0; Level < Chain.size(); ++Level) {
+    const LibScopeView::Object *Obj = Chain[Level];
+    auto LineNo = Obj->getLineNumber();
+    std::string LineNoStr = LineNo == 0 ? " " : std::to_string(LineNo);
+    std::string Indent(IndentSize * (Level + 1), ' ');
+
+    std::stringstream ObjText(Obj->getAsText(Settings));
+    std::string TextLine;
+    std::getline(ObjText, TextLine);
+    Out << std::setw(static_cast<int>(LineNumberWidth)) << LineNoStr << Indent
+        << TextLine;
+    // Lines have no name, so show their file.
+    if (isa<LibScopeView::Line>(*Obj))
+      Out << " \"" << Obj->getFilePath() << '"';
+    Out << '\n';
+    if (Obj != Detailed)
+      continue;
+    std::string FollowingIndent(LineNumberWidth + Indent.size(), ' ');
+    while (std::getline(ObjText, TextLine))
+      Out << FollowingIndent << TextLine << '\n';
+  }
+}
+
+/// \brief Print each match of a query under the scopes that contain it.
+void printFindMatches(const char *QueryKind, const std::string &Query,
+                      const std::vector<const LibScopeView::Object *> &Matches,
+                      const LibScopeView::PrintSettings &Settings,
+                      std::ostream &Out) {
+  Out << "\n{" << QueryKind << "} \"" << Query << "\" (" << Matches.size()
+      << (Matches.size() == 1 ? " match)\n" : " matches)\n");
+
+  for (const LibScopeView::Object *Match : Matches) {
+    std::vector<const LibScopeView::Object *> Chain(
+        LibScopeView::NameIndex::getAncestors(*Match));
+    Chain.push_back(Match);
+    Out << '\n';
+    // Only the match itself is printed with its attributes.
+    printObjectChain(Chain, Match, Settings, Out);
+  }
+}
+
+/// \brief Answer the --find queries from an index of the tree's names.
+void printFindResults(const LibScopeView::ScopeRoot &Root,
+                      const std::string &InputFilePath,
+                      const DivaOptions &Options, std::ostream &Out) {
+  LibScopeView::NameIndex Index(Root);
+  LibScopeView::sampleMemory("BuildNameIndex");
+  if (Options.PrintingSettings.QuietMode)
+    return;
+
+  const auto &Settings = Options.PrintingSettings;
+  Out << "{InputFile} \"" << InputFilePath << "\"\n";
+  for (const std::string &Name : Options.FindNames) {
+    LibScopeView::TraceSpan Span("FindQuery", Name);
+    printFindMatches("Find", Name, Index.findExact(Name), Settings, Out);
+  }
+  for (const std::string &Prefix : Options.FindPrefixes) {
+    LibScopeView::TraceSpan Span("FindQuery", Prefix);
+    printFindMatches("FindPrefix", Prefix, Index.findPrefix(Prefix), Settings,
+                     Out);
+  }
+  for (size_t I = 0; I < Options.FindRegexs.size(); ++I) {
+    const std::string &Pattern = Options.RawFindRegexs[I];
+    LibScopeView::TraceSpan Span("FindQuery", Pattern);
+    printFindMatches("FindRegex", Pattern,
+                     Index.findRegex(Options.FindRegexs[I]), Settings, Out);
+  }
+}
+
+/// \brief Answer the --lookup queries from an index of the tree's code
+/// addresses.
+void printLookupResults(const LibScopeView::ScopeRoot &Root,
+                        const std::string &InputFilePath,
+                        const DivaOptions &Options, std::ostream &Out) {
+  LibScopeView::AddressIndex Index(Root);
+  LibScopeView::sampleMemory("BuildAddressIndex");
+  if (Options.PrintingSettings.QuietMode)
+    return;
+
+  LibScopeView::TraceSpan Span("Lookup");
+  Out << "{InputFile} \"" << InputFilePath << "\"\n";
+  for (uint64_t Address : Options.LookupAddresses) {
+    const LibScopeView::Scope *Scp = Index.findScope(Address);
+    const LibScopeView::Line *Ln = Index.findLine(Address);
+    Out << "\n{Address} 0x" << std::hex << Address << std::dec;
+    if (!Scp && !Ln) {
+      Out << " (no match)\n";
+      continue;
+    }
+    Out << '\n';
+
+    std::vector<const LibScopeView::Object *> Chain;
+    if (Scp) {
+      Chain = LibScopeView::NameIndex::getAncestors(*Scp);
+      Chain.push_back(Scp);
+    }
+    if (Ln)
+      Chain.push_back(Ln);
+    printObjectChain(Chain, /*Detailed*/ nullptr, Options.PrintingSettings,
+                     Out);
+  }
+}
+
+/// \brief Print the compile units of an input file that match the --cu
+/// patterns, one per line.
+void printCompileUnitList(
+    const std::vector<ElfDwarfReader::CompileUnitListing> &Units,
+    const std::string &InputFilePath, const DivaOptions &Options,
+    std::ostream &Out) {
+  if (Options.PrintingSettings.QuietMode)
+    return;
+
+  // The columns are aligned to the widest value, apart from the producer.
+  std::vector<std::vector<std::string>> Rows;
+  Rows.push_back({"Offset", "Size", "Version", "Language", "Name"});
+  std::vector<std::string> Producers(1, "Producer");
+  for (const ElfDwarfReader::CompileUnitListing &Unit : Units) {
+    if (!Options.CompileUnitPatterns.empty() &&
+        !ElfDwarfReader::matchesCompileUnitName(Options.CompileUnitPatterns,
+                                                Unit.Name))
+      continue;
+    std::stringstream Offset;
+    Offset << "0x" << std::hex << std::setfill('0') << std::setw(8)
+           << Unit.Offset;
+    Rows.push_back({Offset.str(), std::to_string(Unit.Size),
+                    std::to_string(Unit.Version), Unit.Language,
+                    '"' + Unit.Name + '"'});
+    Producers.push_back('"' + Unit.Producer + '"');
+  }
+  std::vector<size_t> Widths(Rows.front().size());
+  for (const auto &Row : Rows)
+    for (size_t Column = 0; Column < Row.size(); ++Column)
+      Widths[Column] = std::max(Widths[Column], Row[Column].size());
+
+  Out << "{InputFile} \"" << InputFilePath << "\"\n\n";
+  for (size_t I = 0; I < Rows.size(); ++I) {
+    for (size_t Column = 0; Column < Rows[I].size(); ++Column)
+      Out << std::left << std::setw(static_cast<int>(Widths[Column] + 2))
+          << Rows[I][Column];
+    Out << Producers[I] << '\n';
+  }
+  Out << std::right;
+}
+
+/// \brief Get the settings the summary table counts printed objects with.
+const LibScopeView::PrintSettings *getSummarySettings(
+    const DivaOptions &Options) {
+  // Print settings were ignored for YAML and JSON.
+  if (Options.OutputFormats.count(OutputFormat::YAML) ||
+      Options.OutputFormats.count(OutputFormat::JSON) ||
+      Options.OutputFormats.count(OutputFormat::NDJSON))
+    return nullptr;
+  return &Options.PrintingSettings;
+}
+
+/// \brief Print or add to SummaryTotal a summary table.
+void printSummary(const LibScopeView::SummaryTable &Table, std::ostream &Out,
+                  LibScopeView::SummaryTable *SummaryTotal) {
+  if (SummaryTotal) {
+    SummaryTotal->add(Table);
+  } else {
+    Out << '\n';
+    Table.printSummaryTable(Out);
+  }
+}
+
+} // namespace
+
+std::unique_ptr<LibScopeView::ScopeRoot>
+readInputFile(const std::string &InputFilePath,
+              const LibScopeView::PrintSettings &Settings,
+              const std::vector<uint64_t> &AddressFilter,
+              const std::string &IncrementalStateFile,
+              const std::vector<std::string> &NameFilter,
+              const std::vector<std::string> &CompileUnitFilter) {
+  // Check that the file exists.
+  if (!LibScopeView::doesFileExist(InputFilePath))
+    fatalError(LibScopeError::ErrorCode::ERR_FILE_NOT_FOUND, InputFilePath);
+
+  // Create an appropriate reader.
+  std::unique_ptr<LibScopeView::Reader> Reader;
+  if (LibScopeView::isFileFormatElf(InputFilePath)) {
+    auto DwarfReader = std::make_unique<ElfDwarfReader::DwarfReader>();
+    DwarfReader->setAddressFilter(AddressFilter);
+    DwarfReader->setIncrementalStateFile(IncrementalStateFile);
+    DwarfReader->setNameFilter(NameFilter);
+    DwarfReader->setCompileUnitFilter(CompileUnitFilter);
+    Reader = std::move(DwarfReader);
+  }
+
+  if (!Reader)
+    fatalError(LibScopeError::ErrorCode::ERR_INVALID_FILE, InputFilePath);
+
+  // Load the file.
+  std::unique_ptr<LibScopeView::ScopeRoot> Root =
+      Reader->loadFile(InputFilePath, Settings);
+  if (!Root)
+    // Currently the ElfDwarfReader will always call fatalError itself so we
+    // should never reach this code.
+    fatalError(LibScopeError::ErrorCode::ERR_READ_FAILED, InputFilePath);
+
+  return Root;
+}
+
+namespace {
+
+/// \brief Get the ELF members of a static archive mapped at Archive.
+std::vector<LibScopeView::ArchiveMember>
+getElfMembers(const std::string &ArchivePath,
+              const LibScopeView::MappedFile &Archive) {
+  std::vector<LibScopeView::ArchiveMember> Members;
+  if (!LibScopeView::getArchiveMembers(Archive.data(), Archive.size(),
+                                       Members))
+    fatalError(LibScopeError::ErrorCode::ERR_INVALID_FILE, ArchivePath);
+
+  // Skip the members that are not ELF objects, such as text files.
+  Members.erase(
+      std::remove_if(Members.begin(), Members.end(),
+                     [&Archive](const LibScopeView::ArchiveMember &Member) {
+                       return Member.Size < 4 ||
+                              memcmp(Archive.data() + Member.Offset,
+                                     "\x7f"
+                                     "ELF",
+                                     4) != 0;
+                     }),
+      Members.end());
+  if (Members.empty())
+    LibScopeError::warning("No ELF objects found in '" + ArchivePath + "'.");
+  return Members;
+}
+
+/// \brief List the compile units of each ELF member of a static archive.
+void printArchiveUnitList(const std::string &ArchivePath,
+                          const DivaOptions &Options, std::ostream &Out) {
+  if (!LibScopeView::doesFileExist(ArchivePath))
+    fatalError(LibScopeError::ErrorCode::ERR_FILE_NOT_FOUND, ArchivePath);
+  LibScopeView::MappedFile Archive(ArchivePath);
+  for (const LibScopeView::ArchiveMember &Member :
+       getElfMembers(ArchivePath, Archive)) {
+    std::string Name(ArchivePath + "(" + Member.Name + ")");
+    printCompileUnitList(
+        ElfDwarfReader::listCompileUnits(Name, Archive.data() + Member.Offset,
+                                         static_cast<size_t>(Member.Size)),
+        Name, Options, Out);
+  }
+}
+
+} // namespace
+
+std::vector<ArchiveMemberTree>
+readArchive(const std::string &ArchivePath,
+            const LibScopeView::PrintSettings &Settings,
+            const std::vector<uint64_t> &AddressFilter, unsigned ThreadCount,
+            const std::vector<std::string> &CompileUnitFilter) {
+  if (!LibScopeView::doesFileExist(ArchivePath))
+    fatalError(LibScopeError::ErrorCode::ERR_FILE_NOT_FOUND, ArchivePath);
+
+  // The members are read from a private mapping of the archive, as libelf may
+  // modify the image it reads.
+  LibScopeView::MappedFile Archive(ArchivePath);
+  std::vector<LibScopeView::ArchiveMember> Members(
+      getElfMembers(ArchivePath, Archive));
+
+  // Archives may hold several members with the same name, so number the
+  // subdirectories of the repeats.
+  std::vector<ArchiveMemberTree> Trees(Members.size());
+  std::set<std::string> Subdirectories;
+  for (size_t I = 0; I < Members.size(); ++I) {
+    Trees[I].Name = ArchivePath + "(" + Members[I].Name + ")";
+    std::string Subdirectory(LibScopeView::flattenFilePath(Members[I].Name));
+    for (unsigned Repeat = 2; !Subdirectories.insert(Subdirectory).second;
+         ++Repeat)
+      Subdirectory =
+          LibScopeView::flattenFilePath(Members[I].Name) + "-" +
+          std::to_string(Repeat);
+    Trees[I].SplitSubdirectory = Subdirectory;
+  }
+
+  LibScopeView::runInParallel(Members.size(), ThreadCount, [&](size_t I) {
+    const LibScopeView::ArchiveMember &Member = Members[I];
+    LibScopeView::TraceSpan Span("ReadMember", Member.Name);
+    ElfDwarfReader::DwarfReader Reader;
+    Reader.setAddressFilter(AddressFilter);
+    Reader.setCompileUnitFilter(CompileUnitFilter);
+    Reader.setMemoryImage(Archive.data() + Member.Offset,
+                          static_cast<size_t>(Member.Size));
+    Trees[I].Root = Reader.loadFile(Trees[I].Name, Settings);
+    if (!Trees[I].Root)
+      fatalError(LibScopeError::ErrorCode::ERR_READ_FAILED, Trees[I].Name);
+  });
+  return Trees;
+}
+
+void printScopeView(const LibScopeView::ScopeRoot &Root,
+                    const std::string &InputFilePath,
+                    const DivaOptions &Options, std::ostream &Out,
+                    const std::string &SplitSubdirectory,
+                    LibScopeView::SummaryTable *SummaryTotal) {
+  if (Options.hasFindQueries()) {
+    printFindResults(Root, InputFilePath, Options, Out);
+    return;
+  }
+  if (Options.hasLookups()) {
+    printLookupResults(Root, InputFilePath, Options, Out);
+    return;
+  }
+
+  if (Options.ShowScopeAllocation)
+    LibScopeView::printAllocationInfo(Root, Out);
+
+  // Each printer with the name of its trace span.
+  std::vector<std::pair<const char *,
+                        std::unique_ptr<LibScopeView::ScopePrinter>>>
+      Printers;
+
+  // Create text printer.
+  if (Options.OutputFormats.count(OutputFormat::TEXT))
+    Printers.emplace_back(
+        "PrintText", std::make_unique<LibScopeView::ScopeTextPrinter>(
+                         Options.PrintingSettings, InputFilePath));
+  // Create YAML printer.
+  if (Options.OutputFormats.count(OutputFormat::YAML))
+    Printers.emplace_back(
+        "PrintYAML",
+        std::make_unique<LibScopeView::ScopeYAMLPrinter>(
+            Options.PrintingSettings, InputFilePath, YAML_OUTPUT_VERSION_STR));
+  // Create JSON printers.
+  if (Options.OutputFormats.count(OutputFormat::JSON))
+    Printers.emplace_back(
+        "PrintJSON",
+        std::make_unique<LibScopeView::ScopeJSONPrinter>(
+            Options.PrintingSettings, InputFilePath, JSON_OUTPUT_VERSION_STR));
+  if (Options.OutputFormats.count(OutputFormat::NDJSON))
+    Printers.emplace_back(
+        "PrintNDJSON",
+        std::make_unique<LibScopeView::ScopeNDJSONPrinter>(
+            Options.PrintingSettings, InputFilePath, JSON_OUTPUT_VERSION_STR));
+
+  LibScopeView::MemoryOwner PrintersOwner(
+      [&Printers](LibScopeView::MemoryOwnerBytes &OwnerBytes) {
+        for (auto &Printer : Printers)
+          OwnerBytes["Printers"] += Printer.second->getAllocatedBytes();
+      });
+
+  // Print the Logical Views.
+  auto RunPrinter = [&](size_t I) {
+    LibScopeView::TraceSpan Span(Printers[I].first);
+    if (Options.PrintingSettings.SplitOutput) {
+      std::string OutputDirectory(Options.PrintingSettings.OutputDirectory);
+      if (!SplitSubdirectory.empty())
+        OutputDirectory += "/" + SplitSubdirectory;
+      Printers[I].second->print(&Root, OutputDirectory);
+    } else if (!Options.PrintingSettings.QuietMode) {
+      Printers[I].second->print(&Root, Out);
+    }
+  };
+  if (Options.PrintingSettings.SplitOutput && Printers.size() > 1) {
+    // Each format is split into its own files, so the printers can run at
+    // the same time over the tree once its names are worked out.
+    bool AllQualifiedNames = false;
+    for (const auto &Printer : Printers)
+      AllQualifiedNames |= Printer.second->getPrintsAllQualifiedNames();
+    LibScopeView::materializeNames(Root, AllQualifiedNames);
+    LibScopeView::runInParallel(Printers.size(), /*ThreadCount*/ 0,
+                                RunPrinter);
+    LibScopeView::sampleMemory(Printers.back().first);
+  } else {
+    for (size_t I = 0; I < Printers.size(); ++I) {
+      RunPrinter(I);
+      LibScopeView::sampleMemory(Printers[I].first);
+    }
+  }
+
+  // Print summary.
+  if (Options.ShowSummary) {
+    LibScopeView::TraceSpan Span("PrintSummary");
+    printSummary(LibScopeView::SummaryTable(Root, getSummarySettings(Options)),
+                 Out, SummaryTotal);
+    LibScopeView::sampleMemory("PrintSummary");
+  }
+}
+
+void printArchive(const std::string &ArchivePath, const DivaOptions &Options,
+                  std::ostream &Out,
+                  const std::vector<uint64_t> &AddressFilter,
+                  LibScopeView::SummaryTable *SummaryTotal) {
+  std::vector<ArchiveMemberTree> Members;
+  {
+    LibScopeView::TraceSpan Span("ReadFile", ArchivePath);
+    Members = readArchive(ArchivePath, Options.PrintingSettings, AddressFilter,
+                          /*ThreadCount*/ 0, Options.CompileUnitPatterns);
+  }
+  {
+    LibScopeView::MemoryOwner TreesOwner(
+        [&Members](LibScopeView::MemoryOwnerBytes &OwnerBytes) {
+          for (const ArchiveMemberTree &Member : Members)
+            if (Member.Root)
+              LibScopeView::addObjectTreeBytes(*Member.Root, OwnerBytes);
+        });
+    LibScopeView::sampleMemory("ReadFile");
+    for (ArchiveMemberTree &Member : Members) {
+      printScopeView(*Member.Root, Member.Name, Options, Out,
+                     Member.SplitSubdirectory, SummaryTotal);
+      LibScopeView::TraceSpan Span("Teardown", Member.Name);
+      Member.Root.reset();
+    }
+  }
+  LibScopeView::sampleMemory("Teardown");
+}
+
+void printInputFile(const std::string &InputFilePath,
+                    const DivaOptions &Options, std::ostream &Out,
+                    const std::vector<uint64_t> &AddressFilter,
+                    LibScopeView::SummaryTable *SummaryTotal) {
+  // The members of a static archive are read in place, several at once.
+  if (LibScopeView::isFileFormatArchive(InputFilePath)) {
+    if (Options.Incremental)
+      LibScopeError::warning("--incremental is not supported for the "
+                             "archive '" + InputFilePath + "'.");
+    if (Options.ListCompileUnits)
+      printArchiveUnitList(InputFilePath, Options, Out);
+    else
+      printArchive(InputFilePath, Options, Out, AddressFilter, SummaryTotal);
+    return;
+  }
+
+  // Only the unit headers and root DIEs are read to list the units.
+  if (Options.ListCompileUnits) {
+    if (!LibScopeView::doesFileExist(InputFilePath))
+      fatalError(LibScopeError::ErrorCode::ERR_FILE_NOT_FOUND, InputFilePath);
+    if (!LibScopeView::isFileFormatElf(InputFilePath))
+      fatalError(LibScopeError::ErrorCode::ERR_INVALID_FILE, InputFilePath);
+    LibScopeView::TraceSpan Span("ListCUs", InputFilePath);
+    printCompileUnitList(ElfDwarfReader::listCompileUnits(InputFilePath),
+                         InputFilePath, Options, Out);
+    return;
+  }
+
+  // When only the summary is printed the objects are counted straight from
+  // the DWARF, unless it has something that only the full read handles.
+  if (Options.isSummaryOnly() && AddressFilter.empty()) {
+    LibScopeView::SummaryTable Table;
+    bool Scanned;
+    {
+      LibScopeView::TraceSpan Span("ScanFile", InputFilePath);
+      Scanned = ElfDwarfReader::scanSummaryTable(
+          InputFilePath, getSummarySettings(Options), Table);
+    }
+    LibScopeView::sampleMemory("ScanFile");
+    if (Scanned) {
+      printSummary(Table, Out, SummaryTotal);
+      return;
+    }
+  }
+
+  std::unique_ptr<LibScopeView::ScopeRoot> Root;
+  {
+    LibScopeView::TraceSpan Span("ReadFile", InputFilePath);
+    Root = readInputFile(InputFilePath, Options.PrintingSettings,
+                         AddressFilter,
+                         Options.getIncrementalStateFile(InputFilePath),
+                         Options.getNameFilter(), Options.CompileUnitPatterns);
+  }
+  {
+    LibScopeView::MemoryOwner TreeOwner(
+        [&Root](LibScopeView::MemoryOwnerBytes &OwnerBytes) {
+          LibScopeView::addObjectTreeBytes(*Root, OwnerBytes);
+        });
+    LibScopeView::sampleMemory("ReadFile");
+    printScopeView(*Root, InputFilePath, Options, Out, std::string(),
+                   SummaryTotal);
+  }
+  {
+    LibScopeView::TraceSpan Span("Teardown", InputFilePath);
+    Root.reset();
+  }
+  LibScopeView::sampleMemory("Teardown");
+}
@@ -0,0 +1,107 @@
+//===-- Diva/DivaOutput.h ---------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Reading input files and printing their Scope trees, shared by the command
+/// line and the server.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef DIVAOUTPUT_H_
+#define DIVAOUTPUT_H_
+
+#include "DivaOptions.h"
+#include "Scope.h"
+#include "SummaryTable.h"
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// \brief Read an input file, creating a Scope tree. If AddressFilter is not
+/// empty, compile units that contain none of its addresses may be skipped. If
+/// IncrementalStateFile is not empty, the compile units that are unchanged
+/// since it was saved are reused from it, and then it is saved again. If
+/// NameFilter is not empty (see DivaOptions::getNameFilter), compile units
+/// that the text view of the objects with those names doesn't need may be
+/// skipped. If CompileUnitFilter is not empty, only the compile units whose
+/// names match one of its globs are read, with the DIEs they reference in the
+/// other units.
+std::unique_ptr<LibScopeView::ScopeRoot>
+readInputFile(const std::string &InputFilePath,
+              const LibScopeView::PrintSettings &Settings,
+              const std::vector<uint64_t> &AddressFilter = {},
+              const std::string &IncrementalStateFile = std::string(),
+              const std::vector<std::string> &NameFilter = {},
+              const std::vector<std::string> &CompileUnitFilter = {});
+
+/// \brief The Scope tree of an object file in a static archive.
+struct ArchiveMemberTree {
+  /// \brief The member named as "archive.a(member.o)".
+  std::string Name;
+  /// \brief The subdirectory of the output directory for the split output.
+  std::string SplitSubdirectory;
+  std::unique_ptr<LibScopeView::ScopeRoot> Root;
+};
+
+/// \brief Read each ELF member of a static archive in place, reading up to
+/// ThreadCount members at once (0 for one per hardware thread). Members that
+/// are not ELF objects are skipped. The filters are as for readInputFile.
+std::vector<ArchiveMemberTree>
+readArchive(const std::string &ArchivePath,
+            const LibScopeView::PrintSettings &Settings,
+            const std::vector<uint64_t> &AddressFilter = {},
+            unsigned ThreadCount = 0,
+            const std::vector<std::string> &CompileUnitFilter = {});
+
+/// \brief Print the Scope tree of an input file in each of the output formats
+/// (and the summary table) selected by Options to Out, or to the output
+/// directory if the output is split, in SplitSubdirectory if it is not empty.
+/// If Options has --find queries, print their matches to Out instead, or if it
+/// has --lookup addresses, print the scopes and lines that contain them. If
+/// SummaryTotal is not null the summary table is added to it, not printed.
+void printScopeView(const LibScopeView::ScopeRoot &Root,
+                    const std::string &InputFilePath,
+                    const DivaOptions &Options, std::ostream &Out,
+                    const std::string &SplitSubdirectory = std::string(),
+                    LibScopeView::SummaryTable *SummaryTotal = nullptr);
+
+/// \brief Read a static archive and print the tree of each member as for
+/// printScopeView, with the split output of each in a subdirectory named
+/// after the member.
+void printArchive(const std::string &ArchivePath, const DivaOptions &Options,
+                  std::ostream &Out,
+                  const std::vector<uint64_t> &AddressFilter = {},
+                  LibScopeView::SummaryTable *SummaryTotal = nullptr);
+
+/// \brief Read an input file, or each member of a static archive, and print
+/// it as for printScopeView. With --list-cus only the compile units are
+/// listed, from their headers and root DIEs.
+void printInputFile(const std::string &InputFilePath,
+                    const DivaOptions &Options, std::ostream &Out,
+                    const std::vector<uint64_t> &AddressFilter = {},
+                    LibScopeView::SummaryTable *SummaryTotal = nullptr);
+
+#endif // DIVAOUTPUT_H_
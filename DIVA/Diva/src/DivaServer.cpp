@@ -0,0 +1,465 @@
+//===-- Diva/DivaServer.cpp -------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// The diva server and its client.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DivaServer.h"
+#include "DivaOutput.h"
+#include "Error.h"
+#include "FileUtilities.h"
+#include "GzipStream.h"
+#include "Platform.h"
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+
+#ifdef PLATFORM_LINUX
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif // PLATFORM_LINUX
+
+namespace {
+
+/// \brief Route errors to a stream and make them end the request, for the
+/// lifetime of the object.
+class RequestErrorScope {
+public:
+  explicit RequestErrorScope(std::ostream &Err) {
+    LibScopeError::setErrorOutput(&Err);
+    LibScopeError::setThrowOnExit(true);
+  }
+  ~RequestErrorScope() {
+    LibScopeError::setThrowOnExit(false);
+    LibScopeError::setErrorOutput(nullptr);
+  }
+};
+
+} // namespace
+
+int handleRequest(const std::vector<std::string> &Args, ScopeTreeCache &Cache,
+                  std::ostream &Out, std::ostream &Err) {
+  RequestErrorScope ErrorScope(Err);
+  try {
+    const DivaOptions Options(Args, /*HelpOut*/ Out, /*VersionOut*/ Err,
+                              /*ErrOut*/ Err);
+    // Anything printed before an error is still a complete gzip file.
+    std::unique_ptr<LibScopeView::GzipOutputStream> CompressedOut;
+    if (Options.PrintingSettings.CompressOutput)
+      CompressedOut = std::make_unique<LibScopeView::GzipOutputStream>(Out);
+    std::ostream &RequestOut = CompressedOut ? *CompressedOut : Out;
+    for (const std::string &InputFilePath : Options.InputFiles) {
+      // The cache holds one tree per file with every compile unit, so
+      // archives, unit lists and selected units are read each time, as
+      // without a server.
+      if (LibScopeView::isFileFormatArchive(InputFilePath) ||
+          Options.ListCompileUnits || !Options.CompileUnitPatterns.empty()) {
+        printInputFile(InputFilePath, Options, RequestOut);
+        continue;
+      }
+      const LibScopeView::ScopeRoot &Root =
+          Cache.getTree(InputFilePath, Options.PrintingSettings);
+      printScopeView(Root, InputFilePath, Options, RequestOut);
+    }
+  } catch (LibScopeError::ExitException &Exit) {
+    Out.flush();
+    return Exit.getStatus();
+  }
+  Out.flush();
+  return 0;
+}
+
+#ifdef PLATFORM_LINUX
+
+namespace {
+
+const char OutputFrame = 'O';
+const char ErrorFrame = 'E';
+const char ExitFrame = 'X';
+const size_t FrameHeaderSize = 5;
+// Requests are a command line, so anything larger is not a diva client.
+const size_t MaxRequestSize = 16 * 1024 * 1024;
+// Requests are answered one at a time, so a client that doesn't send its
+// request, or stops reading the response, must not hold up the others.
+const std::chrono::seconds RequestTimeout(10);
+
+volatile sig_atomic_t StopServer = 0;
+
+void stopServer(int) { StopServer = 1; }
+
+/// \brief Write all of Size bytes, returning false if the connection failed.
+bool writeAll(int FD, const char *Data, size_t Size) {
+  while (Size > 0) {
+    ssize_t Written = write(FD, Data, Size);
+    if (Written < 0 && errno == EINTR)
+      continue;
+    if (Written <= 0)
+      return false;
+    Data += Written;
+    Size -= static_cast<size_t>(Written);
+  }
+  return true;
+}
+
+/// \brief Read exactly Size bytes, returning false at the end of the
+/// connection.
+bool readAll(int FD, char *Data, size_t Size) {
+  while (Size > 0) {
+    ssize_t Read = read(FD, Data, Size);
+    if (Read < 0 && errno == EINTR)
+      continue;
+    if (Read <= 0)
+      return false;
+    Data += Read;
+    Size -= static_cast<size_t>(Read);
+  }
+  return true;
+}
+
+/// \brief Writes frames to a connection, discarding them once the client has
+/// gone.
+class FrameWriter {
+public:
+  explicit FrameWriter(int ConnectionFD) : FD(ConnectionFD) {}
+
+  void write(char Type, const char *Data, uint32_t Size) {
+    std::array<char, FrameHeaderSize> Header = {
+        {Type, static_cast<char>(Size & 0xff),
+         static_cast<char>((Size >> 8) & 0xff),
+         static_cast<char>((Size >> 16) & 0xff),
+         static_cast<char>((Size >> 24) & 0xff)}};
+    if (!Failed)
+      Failed = !writeAll(FD, Header.data(), Header.size()) ||
+               !writeAll(FD, Data, Size);
+  }
+
+private:
+  int FD;
+  bool Failed = false;
+};
+
+/// \brief A stream buffer that sends its contents as frames of one type.
+class FrameStreamBuf : public std::streambuf {
+public:
+  FrameStreamBuf(FrameWriter &FrameOut, char FrameType)
+      : Writer(FrameOut), Type(FrameType) {
+    setp(Buffer.data(), Buffer.data() + Buffer.size());
+  }
+  ~FrameStreamBuf() override { sync(); }
+
+protected:
+  int_type overflow(int_type C) override {
+    sync();
+    if (!traits_type::eq_int_type(C, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(C);
+      pbump(1);
+    }
+    return traits_type::not_eof(C);
+  }
+
+  int sync() override {
+    if (pptr() != pbase())
+      Writer.write(Type, pbase(), static_cast<uint32_t>(pptr() - pbase()));
+    setp(Buffer.data(), Buffer.data() + Buffer.size());
+    return 0;
+  }
+
+private:
+  FrameWriter &Writer;
+  char Type;
+  std::array<char, 64 * 1024> Buffer;
+};
+
+/// \brief Split a request into null terminated strings.
+std::vector<std::string> splitRequest(const std::string &Request) {
+  std::vector<std::string> Strings;
+  size_t Start = 0;
+  for (size_t End = Request.find('\0'); End != std::string::npos;
+       End = Request.find('\0', Start)) {
+    Strings.push_back(Request.substr(Start, End - Start));
+    Start = End + 1;
+  }
+  return Strings;
+}
+
+/// \brief Read a request, answer it and close the connection.
+void serveConnection(int FD, ScopeTreeCache &Cache,
+                     const std::string &ServerDir) {
+  std::string Request;
+  std::array<char, 4096> Buffer;
+  const auto Deadline = std::chrono::steady_clock::now() + RequestTimeout;
+  for (;;) {
+    auto Remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Deadline - std::chrono::steady_clock::now());
+    if (Remaining.count() <= 0)
+      return;
+    pollfd Poll = {FD, POLLIN, 0};
+    int Ready = poll(&Poll, 1, static_cast<int>(Remaining.count()));
+    if (Ready < 0 && errno == EINTR)
+      continue;
+    if (Ready <= 0)
+      return;
+    ssize_t Read = read(FD, Buffer.data(), Buffer.size());
+    if (Read < 0 && errno == EINTR)
+      continue;
+    if (Read <= 0)
+      break;
+    Request.append(Buffer.data(), static_cast<size_t>(Read));
+    if (Request.size() > MaxRequestSize)
+      return;
+  }
+  std::vector<std::string> Args = splitRequest(Request);
+
+  FrameWriter Writer(FD);
+  int Status = 1;
+  {
+    FrameStreamBuf OutBuf(Writer, OutputFrame);
+    FrameStreamBuf ErrBuf(Writer, ErrorFrame);
+    std::ostream Out(&OutBuf);
+    std::ostream Err(&ErrBuf);
+    if (Args.empty()) {
+      Err << "\nInvalid request.\n";
+    } else if (chdir(Args.front().c_str()) != 0) {
+      Err << "\nUnable to change to the directory '" << Args.front()
+          << "'.\n";
+    } else {
+      Args.erase(Args.begin());
+      Status = handleRequest(Args, Cache, Out, Err);
+    }
+    Out.flush();
+    Err.flush();
+  }
+  std::array<char, 4> StatusBytes;
+  for (size_t I = 0; I < StatusBytes.size(); ++I)
+    StatusBytes[I] = static_cast<char>((static_cast<uint32_t>(Status) >>
+                                        (I * 8)) & 0xff);
+  Writer.write(ExitFrame, StatusBytes.data(), StatusBytes.size());
+
+  if (chdir(ServerDir.c_str()) != 0)
+    fatalError(LibScopeError::ErrorCode::ERR_FILEIO_GET_CWD);
+}
+
+bool makeSocketAddress(const std::string &SocketPath, sockaddr_un &Address) {
+  std::memset(&Address, 0, sizeof(Address));
+  Address.sun_family = AF_UNIX;
+  if (SocketPath.size() >= sizeof(Address.sun_path))
+    return false;
+  std::memcpy(Address.sun_path, SocketPath.c_str(), SocketPath.size() + 1);
+  return true;
+}
+
+/// \brief RAII wrapper around a socket.
+class Socket {
+public:
+  Socket() : FD(socket(AF_UNIX, SOCK_STREAM, 0)) {}
+  explicit Socket(int SocketFD) : FD(SocketFD) {}
+  ~Socket() {
+    if (FD >= 0)
+      close(FD);
+  }
+  Socket(const Socket &) = delete;
+  Socket &operator=(const Socket &) = delete;
+
+  int get() const { return FD; }
+
+private:
+  int FD;
+};
+
+/// \brief Return true if a server is accepting connections on Address.
+bool isServerListening(const sockaddr_un &Address) {
+  Socket Probe;
+  return Probe.get() >= 0 &&
+         connect(Probe.get(), reinterpret_cast<const sockaddr *>(&Address),
+                 sizeof(Address)) == 0;
+}
+
+/// \brief Return true if the process at the other end of a connection runs
+/// as the same user as the server.
+bool isPeerServerUser(int FD) {
+  ucred Credentials;
+  socklen_t Length = sizeof(Credentials);
+  return getsockopt(FD, SOL_SOCKET, SO_PEERCRED, &Credentials, &Length) == 0 &&
+         Credentials.uid == geteuid();
+}
+
+} // namespace
+
+int runServer(const DivaOptions &Options) {
+  const std::string &SocketPath = Options.ServeSocket;
+  sockaddr_un Address;
+  if (!makeSocketAddress(SocketPath, Address))
+    fatalError(LibScopeError::ErrorCode::ERR_SERVE_FAILED, SocketPath,
+               "path too long");
+
+  // Cached trees are shared by requests, so every compile unit is read.
+  ScopeTreeCache Cache(Options.ServeCacheSize,
+                       [](const std::string &InputFilePath,
+                          const LibScopeView::PrintSettings &Settings) {
+                         return readInputFile(InputFilePath, Settings);
+                       });
+  for (const std::string &InputFilePath : Options.InputFiles)
+    if (!LibScopeView::isFileFormatArchive(InputFilePath))
+      Cache.getTree(InputFilePath, Options.PrintingSettings);
+
+  Socket Listener;
+  if (Listener.get() < 0)
+    fatalError(LibScopeError::ErrorCode::ERR_SERVE_FAILED, SocketPath,
+               std::strerror(errno));
+  const sockaddr *Addr = reinterpret_cast<const sockaddr *>(&Address);
+  // Requests read any file the server can, so only the user running the
+  // server may connect. The socket is created without group and other
+  // permissions, and the peer of each connection is checked as well.
+  mode_t OldMask = umask(S_IRWXG | S_IRWXO | S_IXUSR);
+  bool Bound = bind(Listener.get(), Addr, sizeof(Address)) == 0;
+  if (!Bound) {
+    // Replace a socket left behind by a server that has stopped.
+    struct stat SB;
+    Bound = errno == EADDRINUSE && stat(SocketPath.c_str(), &SB) == 0 &&
+            S_ISSOCK(SB.st_mode) && !isServerListening(Address) &&
+            unlink(SocketPath.c_str()) == 0 &&
+            bind(Listener.get(), Addr, sizeof(Address)) == 0;
+  }
+  int BindError = errno;
+  umask(OldMask);
+  if (!Bound)
+    fatalError(LibScopeError::ErrorCode::ERR_SERVE_FAILED, SocketPath,
+               std::strerror(BindError));
+  if (listen(Listener.get(), SOMAXCONN) != 0)
+    fatalError(LibScopeError::ErrorCode::ERR_SERVE_FAILED, SocketPath,
+               std::strerror(errno));
+
+  // Stop cleanly on SIGINT and SIGTERM, without restarting accept, and
+  // survive clients that disconnect early.
+  struct sigaction Action;
+  std::memset(&Action, 0, sizeof(Action));
+  Action.sa_handler = stopServer;
+  sigemptyset(&Action.sa_mask);
+  sigaction(SIGINT, &Action, nullptr);
+  sigaction(SIGTERM, &Action, nullptr);
+  signal(SIGPIPE, SIG_IGN);
+
+  const std::string ServerDir = LibScopeView::getCurrentDir(/*Unify*/ false);
+  while (!StopServer) {
+    Socket Connection(accept(Listener.get(), nullptr, nullptr));
+    if (Connection.get() < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      fatalError(LibScopeError::ErrorCode::ERR_SERVE_FAILED, SocketPath,
+                 std::strerror(errno));
+    }
+    if (!isPeerServerUser(Connection.get()))
+      continue;
+    timeval SendTimeout = {static_cast<time_t>(RequestTimeout.count()), 0};
+    setsockopt(Connection.get(), SOL_SOCKET, SO_SNDTIMEO, &SendTimeout,
+               sizeof(SendTimeout));
+    serveConnection(Connection.get(), Cache, ServerDir);
+  }
+
+  unlink(SocketPath.c_str());
+  return 0;
+}
+
+int runClient(const std::string &SocketPath,
+              const std::vector<std::string> &Args) {
+  sockaddr_un Address;
+  if (!makeSocketAddress(SocketPath, Address))
+    fatalError(LibScopeError::ErrorCode::ERR_CONNECT_FAILED, SocketPath,
+               "path too long");
+  Socket Connection;
+  if (Connection.get() < 0 ||
+      connect(Connection.get(), reinterpret_cast<const sockaddr *>(&Address),
+              sizeof(Address)) != 0)
+    fatalError(LibScopeError::ErrorCode::ERR_CONNECT_FAILED, SocketPath,
+               std::strerror(errno));
+
+  // Send the request.
+  std::string Request = LibScopeView::getCurrentDir(/*Unify*/ false);
+  Request.push_back('\0');
+  for (const std::string &Arg : Args) {
+    Request += Arg;
+    Request.push_back('\0');
+  }
+  signal(SIGPIPE, SIG_IGN);
+  if (!writeAll(Connection.get(), Request.data(), Request.size()) ||
+      shutdown(Connection.get(), SHUT_WR) != 0)
+    fatalError(LibScopeError::ErrorCode::ERR_CONNECT_FAILED, SocketPath,
+               std::strerror(errno));
+
+  // Copy the response until the exit status arrives.
+  std::vector<char> Data;
+  std::array<char, FrameHeaderSize> Header;
+  while (readAll(Connection.get(), Header.data(), Header.size())) {
+    uint32_t Size = 0;
+    for (size_t I = 1; I < Header.size(); ++I)
+      Size |= static_cast<uint32_t>(static_cast<unsigned char>(Header[I]))
+              << ((I - 1) * 8);
+    Data.resize(Size);
+    if (!readAll(Connection.get(), Data.data(), Size))
+      break;
+    if (Header[0] == OutputFrame) {
+      std::cout.write(Data.data(), Size);
+    } else if (Header[0] == ErrorFrame) {
+      std::cout.flush();
+      std::cerr.write(Data.data(), Size);
+      std::cerr.flush();
+    } else if (Header[0] == ExitFrame && Size == 4) {
+      std::cout.flush();
+      uint32_t Status = 0;
+      for (size_t I = 0; I < Size; ++I)
+        Status |= static_cast<uint32_t>(static_cast<unsigned char>(Data[I]))
+                  << (I * 8);
+      return static_cast<int>(Status);
+    }
+  }
+  fatalError(LibScopeError::ErrorCode::ERR_CONNECT_FAILED, SocketPath,
+             "the connection was closed");
+}
+
+#else
+
+int runServer(const DivaOptions &Options) {
+  fatalError(LibScopeError::ErrorCode::ERR_SERVE_FAILED, Options.ServeSocket,
+             "not supported on this platform");
+}
+
+int runClient(const std::string &SocketPath,
+              const std::vector<std::string> &) {
+  fatalError(LibScopeError::ErrorCode::ERR_CONNECT_FAILED, SocketPath,
+             "not supported on this platform");
+}
+
+#endif // PLATFORM_LINUX
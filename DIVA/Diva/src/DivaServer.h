@@ -0,0 +1,72 @@
+//===-- Diva/DivaServer.h ---------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// The diva server, which keeps parsed Scope trees in memory and answers
+/// requests from diva --connect over a local socket.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef DIVASERVER_H_
+#define DIVASERVER_H_
+
+#include "DivaOptions.h"
+#include "ScopeTreeCache.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// \brief Answer one request: parse Args as a diva command line and print the
+/// output of each input file to Out, and any errors to Err, reading the trees
+/// through Cache.
+///
+/// Archives, --list-cus and --cu are handled as without a server, by reading
+/// the files again, as the cached trees hold every compile unit.
+///
+/// Errors and early exits (e.g. --help) end the request rather than the
+/// process. Returns the exit status diva would have returned.
+int handleRequest(const std::vector<std::string> &Args, ScopeTreeCache &Cache,
+                  std::ostream &Out, std::ostream &Err);
+
+/// \brief Listen on Options.ServeSocket and answer requests (one at a time)
+/// until interrupted. Options.InputFiles are read into the cache first.
+///
+/// Only processes of the server's user may connect. A client that takes more
+/// than 10 seconds to send its request, or to accept a write of the response,
+/// is dropped.
+///
+/// A request is the client's working directory followed by its command line
+/// arguments, each terminated by a null character, after which the client
+/// shuts down its side of the connection. The response is a sequence of
+/// frames: a type byte, a 32 bit little endian length and the data. The types
+/// are 'O' (output), 'E' (errors) and finally 'X' (the 32 bit exit status).
+int runServer(const DivaOptions &Options);
+
+/// \brief Send Args, as a request, to the server listening on SocketPath and
+/// copy its output to stdout and stderr. Returns the request's exit status.
+int runClient(const std::string &SocketPath,
+              const std::vector<std::string> &Args);
+
+#endif // DIVASERVER_H_
@@ -0,0 +1,219 @@
+//===-- Diva/InputFiles.cpp -------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Searching directories and lists for input files, and reading many input
+/// files in parallel.
+///
+//===----------------------------------------------------------------------===//
+
+#include "InputFiles.h"
+#include "DebugSections.h"
+#include "DivaOutput.h"
+#include "Error.h"
+#include "FileUtilities.h"
+#include "SummaryTable.h"
+#include "Trace.h"
+#include "Utilities.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+/// \brief Return true if Patterns has a glob that matches the file at Path,
+/// relative to the directory searched.
+bool matchesAnyGlob(const std::vector<std::string> &Patterns,
+                    const std::string &Path) {
+  std::string Name(LibScopeView::getFileName(Path));
+  for (const std::string &Pattern : Patterns) {
+    bool MatchPath = Pattern.find('/') != std::string::npos;
+    if (LibScopeView::matchGlob(Pattern, MatchPath ? Path : Name))
+      return true;
+  }
+  return false;
+}
+
+/// \brief Get the size used to order an input file, returning false if it is
+/// not an ELF file with debug information or a static archive.
+bool getInputFileSize(const std::string &Path, uint64_t &Size) {
+  if (ElfDwarfReader::getDebugSectionsSize(Path, Size))
+    return true;
+  // The debug sections of the members aren't known until they are read, so
+  // archives are ordered by their whole size.
+  LibScopeView::FileStatus Status;
+  if (LibScopeView::isFileFormatArchive(Path) &&
+      LibScopeView::getFileStatus(Path, Status)) {
+    Size = Status.Size;
+    return true;
+  }
+  return false;
+}
+
+} // namespace
+
+std::vector<InputFile> findInputFiles(const DivaOptions &Options,
+                                      std::istream &ListIn,
+                                      bool IncludeInputFiles) {
+  LibScopeView::TraceSpan Span("FindInputFiles");
+  std::vector<InputFile> Files;
+  if (IncludeInputFiles) {
+    for (const std::string &Path : Options.InputFiles) {
+      Files.emplace_back();
+      Files.back().Path = Path;
+      getInputFileSize(Path, Files.back().DebugSize);
+    }
+  }
+
+  std::vector<std::string> Candidates;
+  for (const std::string &Directory : Options.InputDirectories) {
+    std::string Root(LibScopeView::unifyFilePath(Directory));
+    while (Root.size() > 1 && Root.back() == '/')
+      Root.pop_back();
+    std::vector<std::string> Found;
+    if (!LibScopeView::listFilesRecursively(Root, Found))
+      fatalError(LibScopeError::ErrorCode::ERR_FILE_NOT_FOUND, Directory);
+    for (const std::string &Path : Found) {
+      std::string Relative(Path.substr(Root.size() + 1));
+      if ((Options.InputIncludes.empty() ||
+           matchesAnyGlob(Options.InputIncludes, Relative)) &&
+          !matchesAnyGlob(Options.InputExcludes, Relative))
+        Candidates.push_back(Path);
+    }
+  }
+
+  if (!Options.InputList.empty()) {
+    std::ifstream ListFile;
+    std::istream *List = &ListIn;
+    if (Options.InputList != "-") {
+      ListFile.open(Options.InputList);
+      if (!ListFile)
+        fatalError(LibScopeError::ErrorCode::ERR_FILEIO_OPEN_FAILURE,
+                   Options.InputList);
+      List = &ListFile;
+    }
+    std::string Line;
+    while (std::getline(*List, Line)) {
+      if (!Line.empty() && Line.back() == '\r')
+        Line.pop_back();
+      Line = LibScopeView::trim(Line);
+      if (!Line.empty())
+        Candidates.push_back(Line);
+    }
+  }
+
+  // Only the headers of the candidates are read, so libdwarf is never asked
+  // to open a file without debug information.
+  std::vector<InputFile> Screened(Candidates.size());
+  std::vector<char> Keep(Candidates.size(), false);
+  LibScopeView::runInParallel(Candidates.size(), 0, [&](size_t I) {
+    Screened[I].Path = Candidates[I];
+    Keep[I] = getInputFileSize(Candidates[I], Screened[I].DebugSize);
+  });
+  for (size_t I = 0; I < Screened.size(); ++I)
+    if (Keep[I])
+      Files.push_back(std::move(Screened[I]));
+
+  if (LibScopeView::Tracer *ActiveTracer = LibScopeView::getActiveTracer()) {
+    ActiveTracer->addCounter("InputFilesScreened", Candidates.size());
+    ActiveTracer->addCounter("InputFilesSkipped",
+                             Candidates.size() -
+                                 std::count(Keep.begin(), Keep.end(), true));
+  }
+  return Files;
+}
+
+void printInputFiles(const std::vector<InputFile> &Files,
+                     const DivaOptions &Options, std::ostream &Out,
+                     const std::vector<uint64_t> &AddressFilter,
+                     unsigned ThreadCount) {
+  // Each thread reads the largest file not yet started among the next
+  // WindowSize files to be written, so that large files are started early
+  // while the output of only a few files is held until the files before them
+  // are written.
+  unsigned Threads = ThreadCount ? ThreadCount
+                                 : std::thread::hardware_concurrency();
+  size_t WindowSize = 2 * std::max<size_t>(1, Threads);
+  auto IsLarger = [&Files](size_t A, size_t B) {
+    return Files[A].DebugSize > Files[B].DebugSize ||
+           (Files[A].DebugSize == Files[B].DebugSize && A < B);
+  };
+  std::set<size_t, decltype(IsLarger)> Ready(IsLarger);
+  for (size_t I = 0; I < std::min(WindowSize, Files.size()); ++I)
+    Ready.insert(I);
+
+  std::mutex Mutex;
+  std::condition_variable Changed;
+  bool Stop = false;
+  std::vector<std::string> Outputs(Files.size());
+  std::vector<char> Printed(Files.size(), false);
+  size_t NextOutput = 0;
+  LibScopeView::SummaryTable Summary;
+
+  // There is one task per file, but a task reads whichever file is next.
+  LibScopeView::runInParallel(Files.size(), ThreadCount, [&](size_t) {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    Changed.wait(Lock, [&]() { return Stop || !Ready.empty(); });
+    if (Stop)
+      return;
+    size_t I = *Ready.begin();
+    Ready.erase(Ready.begin());
+    Lock.unlock();
+
+    std::ostringstream FileOut;
+    LibScopeView::SummaryTable FileSummary;
+    try {
+      printInputFile(Files[I].Path, Options, FileOut, AddressFilter,
+                     &FileSummary);
+    } catch (...) {
+      // Wake the threads waiting for a file, as none will be written.
+      Lock.lock();
+      Stop = true;
+      Changed.notify_all();
+      throw;
+    }
+
+    Lock.lock();
+    Summary.add(FileSummary);
+    Outputs[I] = FileOut.str();
+    Printed[I] = true;
+    for (; NextOutput < Files.size() && Printed[NextOutput]; ++NextOutput) {
+      Out << Outputs[NextOutput];
+      std::string().swap(Outputs[NextOutput]);
+      if (NextOutput + WindowSize < Files.size())
+        Ready.insert(NextOutput + WindowSize);
+    }
+    Changed.notify_all();
+  });
+
+  if (Options.ShowSummary) {
+    Out << '\n';
+    Summary.printSummaryTable(Out);
+  }
+}
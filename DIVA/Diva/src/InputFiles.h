@@ -0,0 +1,69 @@
+//===-- Diva/InputFiles.h ---------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Searching directories and lists for input files, and reading many input
+/// files in parallel.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef INPUTFILES_H_
+#define INPUTFILES_H_
+
+#include "DivaOptions.h"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// \brief An input file and the size of its debug sections, which is used to
+/// read the largest files first.
+struct InputFile {
+  std::string Path;
+  uint64_t DebugSize = 0;
+};
+
+/// \brief Get the input files of Options: the InputFiles (unless
+/// IncludeInputFiles is false), then the files in each --input-dir that match
+/// its globs, then the files in the --input-list (read from ListIn if it is
+/// "-"). The files that are searched for are screened from their headers, and
+/// only those that are ELF files with a .debug_info section, or static
+/// archives, are kept.
+std::vector<InputFile> findInputFiles(const DivaOptions &Options,
+                                      std::istream &ListIn,
+                                      bool IncludeInputFiles = true);
+
+/// \brief Read and print Files on a pool of threads, taking the largest files
+/// first, and write the output of each file to Out in the order of Files. A
+/// file is only started once it is among the next few to be written, which
+/// bounds the output held in memory. If Options has --show-summary, one
+/// summary table of all the files is printed at the end.
+void printInputFiles(const std::vector<InputFile> &Files,
+                     const DivaOptions &Options, std::ostream &Out,
+                     const std::vector<uint64_t> &AddressFilter = {},
+                     unsigned ThreadCount = 0);
+
+#endif // INPUTFILES_H_
@@ -0,0 +1,101 @@
+//===-- Diva/ScopeTreeCache.cpp ---------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// A cache of the Scope trees of recently used input files.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ScopeTreeCache.h"
+#include "Error.h"
+#include "StringPool.h"
+#include "Trace.h"
+
+ScopeTreeCache::ScopeTreeCache(uint64_t Limit, LoadFunction LoadTree)
+    : SizeLimit(Limit), Load(std::move(LoadTree)),
+      InitialPoolBytes(
+          LibScopeView::getGlobalStringPool().getAllocatedBytes()) {}
+
+const LibScopeView::ScopeRoot &
+ScopeTreeCache::getTree(const std::string &InputFilePath,
+                        const LibScopeView::PrintSettings &Settings) {
+  LibScopeView::FileStatus Status;
+  if (!LibScopeView::getFileStatus(InputFilePath, Status))
+    fatalError(LibScopeError::ErrorCode::ERR_FILE_NOT_FOUND, InputFilePath);
+  Key TreeKey(LibScopeView::getAbsolutePath(InputFilePath), Settings.ShowVoid);
+
+  auto It = Index.find(TreeKey);
+  if (It != Index.end()) {
+    Entry &Cached = *It->second;
+    if (Cached.Status.Size == Status.Size &&
+        Cached.Status.ModificationTime == Status.ModificationTime) {
+      ++Hits;
+      Entries.splice(Entries.begin(), Entries, It->second);
+      if (Cached.SortKey != Settings.SortKey) {
+        LibScopeView::TraceSpan Span("Sort");
+        Cached.Root->sortScopes(Settings.SortKey);
+        Cached.SortKey = Settings.SortKey;
+      }
+      return *Cached.Root;
+    }
+    // The file has changed since it was read.
+    CachedBytes -= Cached.Bytes;
+    Entries.erase(It->second);
+    Index.erase(It);
+  }
+
+  ++Misses;
+  std::unique_ptr<LibScopeView::ScopeRoot> Root;
+  {
+    LibScopeView::TraceSpan Span("ReadFile", InputFilePath);
+    Root = Load(InputFilePath, Settings);
+  }
+  LibScopeView::ObjectTreeMemory Memory =
+      LibScopeView::getObjectTreeMemory(*Root);
+  uint64_t Bytes = Memory.ObjectBytes + Memory.VectorBytes;
+  uint64_t CurrentPoolBytes =
+      LibScopeView::getGlobalStringPool().getAllocatedBytes();
+  PoolBytes = CurrentPoolBytes > InitialPoolBytes
+                  ? CurrentPoolBytes - InitialPoolBytes
+                  : 0;
+
+  Entries.push_front(
+      Entry{TreeKey, Status, Settings.SortKey, std::move(Root), Bytes});
+  Index[TreeKey] = Entries.begin();
+  CachedBytes += Bytes;
+  evict();
+  return *Entries.front().Root;
+}
+
+void ScopeTreeCache::evict() {
+  // Never discard the most recently used tree, even if it alone is larger
+  // than the limit, as it is about to be printed. Discarding trees doesn't
+  // shrink the pool, but it is the only memory that can be released.
+  while (CachedBytes + PoolBytes > SizeLimit && Entries.size() > 1) {
+    Entry &Oldest = Entries.back();
+    CachedBytes -= Oldest.Bytes;
+    Index.erase(Oldest.EntryKey);
+    Entries.pop_back();
+  }
+}
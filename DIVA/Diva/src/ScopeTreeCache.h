@@ -0,0 +1,110 @@
+//===-- Diva/ScopeTreeCache.h -----------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// A cache of the Scope trees of recently used input files.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SCOPETREECACHE_H_
+#define SCOPETREECACHE_H_
+
+#include "FileUtilities.h"
+#include "PrintSettings.h"
+#include "Scope.h"
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+/// \brief Keeps the Scope trees of recently used input files in memory.
+///
+/// A tree is reused while its file's size and modification time are unchanged
+/// and it was read with the same "void" setting (which changes the formulated
+/// type names), it is re-sorted if a different sort key is requested.
+///
+/// The growth of the global StringPool since the cache was created counts
+/// towards the size limit along with the cached trees. When they use more than
+/// the limit, the least recently used trees are discarded. Strings interned
+/// into the pool are never released, so once the pool alone is over the limit
+/// only the most recently used tree is kept.
+class ScopeTreeCache {
+public:
+  using LoadFunction = std::function<std::unique_ptr<LibScopeView::ScopeRoot>(
+      const std::string &, const LibScopeView::PrintSettings &)>;
+
+  /// \brief Create a cache holding at most SizeLimit bytes of trees, which are
+  /// read with Load.
+  ScopeTreeCache(uint64_t SizeLimit, LoadFunction Load);
+
+  ScopeTreeCache(const ScopeTreeCache &) = delete;
+  ScopeTreeCache &operator=(const ScopeTreeCache &) = delete;
+
+  /// \brief Get the tree of InputFilePath, sorted by Settings.SortKey, reading
+  /// it if it is not cached or the file has changed.
+  ///
+  /// The tree is valid until the next call to getTree.
+  const LibScopeView::ScopeRoot &
+  getTree(const std::string &InputFilePath,
+          const LibScopeView::PrintSettings &Settings);
+
+  size_t getTreeCount() const { return Entries.size(); }
+  uint64_t getCachedBytes() const { return CachedBytes; }
+  /// \brief Growth of the StringPool since the cache was created.
+  uint64_t getPoolBytes() const { return PoolBytes; }
+  uint64_t getHitCount() const { return Hits; }
+  uint64_t getMissCount() const { return Misses; }
+
+private:
+  // The absolute path of the file and the "void" setting.
+  using Key = std::pair<std::string, bool>;
+
+  struct Entry {
+    Key EntryKey;
+    LibScopeView::FileStatus Status;
+    LibScopeView::SortingKey SortKey;
+    std::unique_ptr<LibScopeView::ScopeRoot> Root;
+    uint64_t Bytes;
+  };
+
+  void evict();
+
+  uint64_t SizeLimit;
+  LoadFunction Load;
+  // Most recently used first.
+  std::list<Entry> Entries;
+  std::map<Key, std::list<Entry>::iterator> Index;
+  uint64_t CachedBytes = 0;
+  // Size of the StringPool when the cache was created.
+  uint64_t InitialPoolBytes;
+  uint64_t PoolBytes = 0;
+  uint64_t Hits = 0;
+  uint64_t Misses = 0;
+};
+
+#endif // SCOPETREECACHE_H_
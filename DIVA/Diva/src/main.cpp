@@ -28,87 +28,20 @@
 //===----------------------------------------------------------------------===//
 
 #include "DivaOptions.h"
-#include "ElfDwarfReader.h"
+#include "DivaOutput.h"
+#include "DivaServer.h"
 #include "Error.h"
 #include "FileUtilities.h"
-#include "PrintSettings.h"
-#include "ScopeTextPrinter.h"
-#include "ScopeYAMLPrinter.h"
-#include "StringPool.h"
-#include "SummaryTable.h"
+#include "GzipStream.h"
+#include "InputFiles.h"
+#include "MemoryProfile.h"
+#include "Trace.h"
 #include "Utilities.h"
 
-#include <assert.h>
+#include <algorithm>
+#include <fstream>
 #include <memory>
-
-namespace {
-
-/// \brief Read an input file, creating a Scope tree.
-std::unique_ptr<LibScopeView::ScopeRoot>
-readInputFile(const std::string &InputFilePath,
-              const LibScopeView::PrintSettings &Settings) {
-  // Check that the file exists.
-  if (!LibScopeView::doesFileExist(InputFilePath))
-    fatalError(LibScopeError::ErrorCode::ERR_FILE_NOT_FOUND, InputFilePath);
-
-  // Create an appropriate reader.
-  std::unique_ptr<LibScopeView::Reader> Reader;
-  if (LibScopeView::isFileFormatElf(InputFilePath))
-    Reader = std::make_unique<ElfDwarfReader::DwarfReader>();
-
-  if (!Reader)
-    fatalError(LibScopeError::ErrorCode::ERR_INVALID_FILE, InputFilePath);
-
-  // Load the file.
-  std::unique_ptr<LibScopeView::ScopeRoot> Root =
-      Reader->loadFile(InputFilePath, Settings);
-  if (!Root)
-    // Currently the ElfDwarfReader will always call fatalError itself so we
-    // should never reach this code.
-    fatalError(LibScopeError::ErrorCode::ERR_READ_FAILED, InputFilePath);
-
-  return Root;
-}
-
-void printScopeView(const LibScopeView::ScopeRoot &Root,
-                    const std::string &InputFilePath,
-                    const DivaOptions &Options) {
-  if (Options.ShowScopeAllocation)
-    LibScopeView::printAllocationInfo(Root, std::cout);
-
-  std::vector<std::unique_ptr<LibScopeView::ScopePrinter>> Printers;
-
-  // Create text printer.
-  if (Options.OutputFormats.count(OutputFormat::TEXT))
-    Printers.emplace_back(std::make_unique<LibScopeView::ScopeTextPrinter>(
-        Options.PrintingSettings, InputFilePath));
-  // Create YAML printer.
-  if (Options.OutputFormats.count(OutputFormat::YAML))
-    Printers.emplace_back(std::make_unique<LibScopeView::ScopeYAMLPrinter>(
-        Options.PrintingSettings, InputFilePath, YAML_OUTPUT_VERSION_STR));
-
-  // Print the Logical Views.
-  for (auto &Printer : Printers) {
-    if (Options.PrintingSettings.SplitOutput) {
-      Printer->print(&Root, Options.PrintingSettings.OutputDirectory);
-    } else if (!Options.PrintingSettings.QuietMode) {
-      Printer->print(&Root, std::cout);
-    }
-  }
-
-  // Print summary.
-  if (Options.ShowSummary) {
-    const auto *Settings = &Options.PrintingSettings;
-    // Print settings were ignored for YAML.
-    if (Options.OutputFormats.count(OutputFormat::YAML))
-      Settings = nullptr;
-    LibScopeView::SummaryTable Table(Root, Settings);
-    std::cout << '\n';
-    Table.printSummaryTable(std::cout);
-  }
-}
-
-} // namespace
+#include <sstream>
 
 int main(int argc, char *argv[]) {
   auto StartTime = LibScopeView::getCurrentTime();
@@ -118,27 +51,128 @@ int main(int argc, char *argv[]) {
 
   // Argument parsing.
   const std::vector<std::string> CMDArgs(argv + 1, argv + argc);
-  const DivaOptions Options(CMDArgs, /*HelpOut*/ std::cout,
-                            /*VersionOut*/ std::cerr,
-                            /*ErrOut*/ std::cerr);
-
-  // Load and print each input file.
-  for (const std::string &InputFilePath : Options.InputFiles) {
-    auto Root = readInputFile(InputFilePath, Options.PrintingSettings);
-    printScopeView(*Root, InputFilePath, Options);
+  DivaOptions Options(CMDArgs, /*HelpOut*/ std::cout,
+                      /*VersionOut*/ std::cerr,
+                      /*ErrOut*/ std::cerr);
+
+  // Read the addresses to look up before the input files, so only the compile
+  // units containing them need to be read.
+  size_t FirstStdinAddress = Options.LookupAddresses.size();
+  if (Options.LookupStdin && Options.ServeSocket.empty())
+    Options.addLookupAddresses(std::cin);
+
+  // Let a server do the work.
+  if (!Options.ConnectSocket.empty()) {
+    // The server can't read this process's standard input, so pass the
+    // addresses read from it as arguments.
+    std::vector<std::string> ServerArgs(CMDArgs);
+    if (Options.LookupStdin) {
+      ServerArgs.erase(
+          std::remove(ServerArgs.begin(), ServerArgs.end(), "--lookup-stdin"),
+          ServerArgs.end());
+      for (size_t I = FirstStdinAddress; I < Options.LookupAddresses.size();
+           ++I) {
+        std::stringstream Arg;
+        Arg << "--lookup=" << std::hex << Options.LookupAddresses[I];
+        ServerArgs.push_back(Arg.str());
+      }
+    }
+    // The server is only given input files, so search for them here.
+    if (Options.hasInputSearch()) {
+      ServerArgs.erase(std::remove_if(ServerArgs.begin(), ServerArgs.end(),
+                                      [](const std::string &Arg) {
+                                        return Arg.compare(0, 8, "--input-") ==
+                                               0;
+                                      }),
+                       ServerArgs.end());
+      for (const InputFile &File :
+           findInputFiles(Options, std::cin, /*IncludeInputFiles*/ false))
+        ServerArgs.push_back(File.Path);
+    }
+    return runClient(Options.ConnectSocket, ServerArgs);
   }
 
-  // Library termination.
-  LibScopeView::terminate();
-
-  // Print performance data.
-  if (Options.ShowPerformanceTime) {
-    auto EndTime = LibScopeView::getCurrentTime();
-    LibScopeView::printTimeTaken(StartTime, EndTime);
+  // Compress everything written to stdout if requested.
+  std::unique_ptr<LibScopeView::GzipOutputStream> CompressedOut;
+  if (Options.PrintingSettings.CompressOutput) {
+    LibScopeView::setStdoutBinaryMode();
+    CompressedOut = std::make_unique<LibScopeView::GzipOutputStream>(std::cout);
   }
-  if (Options.ShowPerformanceMemory) {
-    LibScopeView::printMemoryUsage(LibScopeView::getPeakMemoryUsage());
+  std::ostream &Out = CompressedOut ? *CompressedOut : std::cout;
+
+  // A fatal error exits the process, which would lose the end of the
+  // compressed output and so everything printed before it. Errors are
+  // thrown instead (worker threads already pass theirs back to this one)
+  // and the output is closed before exiting.
+  if (CompressedOut)
+    LibScopeError::setThreadThrowOnExit(true);
+  try {
+    // Record the time spent in each phase if a trace was requested.
+    std::unique_ptr<LibScopeView::Tracer> Trace;
+    if (!Options.TraceFile.empty()) {
+      Trace = std::make_unique<LibScopeView::Tracer>();
+      LibScopeView::setActiveTracer(Trace.get());
+    }
+
+    LibScopeView::MemoryProfile MemoryBreakdown;
+    if (!Options.ServeSocket.empty()) {
+      // Keep the trees in memory and answer requests until interrupted.
+      runServer(Options);
+    } else {
+      // Sample the memory held by each owner at the end of each phase.
+      if (Options.ShowMemoryBreakdown)
+        LibScopeView::setActiveMemoryProfile(&MemoryBreakdown);
+
+      // Only the compile units containing the addresses to look up are
+      // needed, unless --find queries are printed instead.
+      std::vector<uint64_t> AddressFilter;
+      if (!Options.hasFindQueries())
+        AddressFilter = Options.LookupAddresses;
+
+      // Load and print each input file, or search for the input files and
+      // read them in parallel.
+      if (Options.hasInputSearch()) {
+        printInputFiles(findInputFiles(Options, std::cin), Options, Out,
+                        AddressFilter);
+      } else {
+        for (const std::string &InputFilePath : Options.InputFiles)
+          printInputFile(InputFilePath, Options, Out, AddressFilter);
+      }
+      LibScopeView::setActiveMemoryProfile(nullptr);
+    }
+
+    // Library termination.
+    LibScopeView::terminate();
+
+    if (Trace) {
+      LibScopeView::setActiveTracer(nullptr);
+      std::ofstream TraceOut(Options.TraceFile);
+      if (!TraceOut)
+        fatalError(LibScopeError::ErrorCode::ERR_FILEIO_OPEN_FAILURE,
+                   Options.TraceFile);
+      Trace->writeChromeTrace(TraceOut);
+      if (!TraceOut)
+        fatalError(LibScopeError::ErrorCode::ERR_WRITE_FAILED,
+                   Options.TraceFile, "write error");
+    }
+
+    // Print performance data.
+    if (Options.ShowPerformanceTime) {
+      auto EndTime = LibScopeView::getCurrentTime();
+      LibScopeView::printTimeTaken(StartTime, EndTime, Out);
+    }
+    if (Options.ShowPerformanceMemory) {
+      LibScopeView::printMemoryUsage(LibScopeView::getPeakMemoryUsage(), Out);
+    }
+    if (Options.ShowMemoryBreakdown && Options.ServeSocket.empty())
+      MemoryBreakdown.print(Out);
+  } catch (LibScopeError::ExitException &Exit) {
+    CompressedOut->close();
+    return Exit.getStatus();
   }
 
+  if (CompressedOut)
+    CompressedOut->close();
+
   return 0;
 }
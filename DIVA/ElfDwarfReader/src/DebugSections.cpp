@@ -0,0 +1,451 @@
+//===-- ElfDwarfReader/DebugSections.cpp ------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the reading of DWARF sections straight from an ELF file.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DebugSections.h"
+#include "ElfDwarfReader.h"
+#include "Object.h"
+
+// Disable some clang warnings for dwarf.h.
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wreserved-id-macro"
+#endif
+
+#include "dwarf.h"
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#include <algorithm>
+#include <fstream>
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+bool startsWith(const std::string &Str, const char *Prefix) {
+  return Str.compare(0, strlen(Prefix), Prefix) == 0;
+}
+
+/// \brief The section headers of an ELF file, with their names.
+class SectionTable {
+public:
+  struct Section {
+    std::string Name;
+    uint64_t Type, Flags, Offset, Size;
+  };
+
+  /// \brief Read the ELF header and section headers, returning false if the
+  /// file is not ELF or is malformed.
+  bool read(const std::string &FileName) {
+    File.open(FileName, std::ios::binary);
+    if (!File)
+      return false;
+    File.seekg(0, std::ios::end);
+    FileSize = static_cast<uint64_t>(File.tellg());
+
+    std::vector<uint8_t> Header;
+    if (!readBytes(0, std::min<uint64_t>(FileSize, 64), Header) ||
+        Header.size() < 52 || memcmp(Header.data(), "\x7f" "ELF", 4) != 0)
+      return false;
+    bool Is64Bit = Header[4] == 2;
+    BigEndian = Header[5] == 2;
+    if (Is64Bit && Header.size() < 64)
+      return false;
+
+    DataReader HeaderReader(Header, BigEndian);
+    HeaderReader.seek(Is64Bit ? 0x28 : 0x20);
+    uint64_t SectionsOffset = HeaderReader.readUnsigned(Is64Bit ? 8 : 4);
+    HeaderReader.seek(Is64Bit ? 0x3a : 0x2e);
+    uint64_t EntrySize = HeaderReader.readUnsigned(2);
+    uint64_t SectionCount = HeaderReader.readUnsigned(2);
+    uint64_t NamesIndex = HeaderReader.readUnsigned(2);
+    if (SectionsOffset == 0 || EntrySize < (Is64Bit ? 64u : 40u))
+      return false;
+
+    struct SectionHeader {
+      uint64_t Name, Type, Flags, Offset, Size, Link;
+    };
+    auto ReadSectionHeader = [&](uint64_t Index, SectionHeader &Section) {
+      std::vector<uint8_t> Bytes;
+      if (!readBytes(SectionsOffset + Index * EntrySize, EntrySize, Bytes))
+        return false;
+      DataReader Reader(Bytes, BigEndian);
+      unsigned WordSize = Is64Bit ? 8 : 4;
+      Section.Name = Reader.readUnsigned(4);
+      Section.Type = Reader.readUnsigned(4);
+      Section.Flags = Reader.readUnsigned(WordSize);
+      Reader.readUnsigned(WordSize); // sh_addr.
+      Section.Offset = Reader.readUnsigned(WordSize);
+      Section.Size = Reader.readUnsigned(WordSize);
+      Section.Link = Reader.readUnsigned(4);
+      return !Reader.failed();
+    };
+
+    // Large section counts and indices are held in the first section header.
+    SectionHeader First;
+    if (!ReadSectionHeader(0, First))
+      return false;
+    if (SectionCount == 0)
+      SectionCount = First.Size;
+    if (NamesIndex == 0xffff)
+      NamesIndex = First.Link;
+
+    std::vector<SectionHeader> Headers(static_cast<size_t>(SectionCount));
+    for (uint64_t I = 0; I < SectionCount; ++I)
+      if (!ReadSectionHeader(I, Headers[static_cast<size_t>(I)]))
+        return false;
+    if (NamesIndex >= SectionCount)
+      return false;
+    std::vector<uint8_t> Names;
+    const SectionHeader &NamesHeader =
+        Headers[static_cast<size_t>(NamesIndex)];
+    if (!readBytes(NamesHeader.Offset, NamesHeader.Size, Names))
+      return false;
+    Names.push_back(0);
+
+    for (const SectionHeader &Header : Headers) {
+      if (Header.Name >= Names.size())
+        return false;
+      Sections.push_back(
+          {reinterpret_cast<const char *>(&Names[Header.Name]), Header.Type,
+           Header.Flags, Header.Offset, Header.Size});
+    }
+    return true;
+  }
+
+  /// \brief Read Size bytes at Offset in the file.
+  bool readBytes(uint64_t Offset, uint64_t Size, std::vector<uint8_t> &Bytes) {
+    if (Offset > FileSize || Size > FileSize - Offset)
+      return false;
+    Bytes.resize(static_cast<size_t>(Size));
+    File.seekg(static_cast<std::streamoff>(Offset));
+    File.read(reinterpret_cast<char *>(Bytes.data()),
+              static_cast<std::streamsize>(Size));
+    return static_cast<bool>(File);
+  }
+
+  bool BigEndian = false;
+  std::vector<Section> Sections;
+
+private:
+  std::ifstream File;
+  uint64_t FileSize = 0;
+};
+
+const uint64_t NoBits = 8;
+const uint64_t Compressed = 0x800;
+
+// DWARF 5 unit types missing from the libdwarf headers.
+const unsigned UnitTypeSkeleton = 0x04;
+const unsigned UnitTypeSplitCompile = 0x05;
+const unsigned UnitTypeSplitType = 0x06;
+
+// DWARF 5 forms missing from the libdwarf headers.
+const uint64_t FormStrx1 = 0x25;
+const uint64_t FormStrx4 = 0x28;
+const uint64_t FormAddrx1 = 0x29;
+const uint64_t FormAddrx4 = 0x2c;
+const uint64_t FormRefSup8 = 0x24;
+
+} // end anonymous namespace
+
+bool ElfDwarfReader::readDebugSections(const std::string &FileName,
+                                       unsigned Wanted,
+                                       DebugSections &Sections) {
+  SectionTable Table;
+  if (!Table.read(FileName))
+    return false;
+  Sections.BigEndian = Table.BigEndian;
+
+  const struct {
+    const char *Name;
+    unsigned Flag;
+    std::vector<uint8_t> DebugSections::*Bytes;
+  } KnownSections[] = {
+      {"info", DebugSections::InfoSection, &DebugSections::Info},
+      {"abbrev", DebugSections::AbbrevSection, &DebugSections::Abbrev},
+      {"str", DebugSections::StrSection, &DebugSections::Str},
+      {"line", DebugSections::LineSection, &DebugSections::Line},
+      {"ranges", DebugSections::RangesSection, &DebugSections::Ranges},
+      {"addr", DebugSections::AddrSection, &DebugSections::Addr},
+  };
+  for (const SectionTable::Section &Section : Table.Sections) {
+    const std::string &Name = Section.Name;
+    if (startsWith(Name, ".zdebug") ||
+        (startsWith(Name, ".debug") && (Section.Flags & Compressed)))
+      return false;
+
+    bool IsRelocations = false;
+    if (startsWith(Name, ".rel.debug_") || startsWith(Name, ".rela.debug_")) {
+      IsRelocations = true;
+      if (Wanted & DebugSections::InfoSection) {
+        std::vector<uint8_t> Relocs;
+        if (!Table.readBytes(Section.Offset, Section.Size, Relocs))
+          return false;
+        Sections.Relocations.insert(Sections.Relocations.end(), Name.begin(),
+                                    Name.end());
+        Sections.Relocations.insert(Sections.Relocations.end(),
+                                    Relocs.begin(), Relocs.end());
+      }
+    } else if (!startsWith(Name, ".debug_")) {
+      continue;
+    }
+    std::string Suffix(Name.substr(Name.find(".debug_") + 7));
+    for (const auto &Known : KnownSections) {
+      if (Suffix != Known.Name)
+        continue;
+      if (IsRelocations)
+        Sections.RelocatedSections |= Known.Flag;
+      else if ((Wanted & Known.Flag) && Section.Type != NoBits &&
+               !Table.readBytes(Section.Offset, Section.Size,
+                                Sections.*Known.Bytes))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool ElfDwarfReader::getDebugSectionsSize(const std::string &FileName,
+                                          uint64_t &Size) {
+  SectionTable Table;
+  if (!Table.read(FileName))
+    return false;
+
+  bool HasInfo = false;
+  Size = 0;
+  for (const SectionTable::Section &Section : Table.Sections) {
+    if (!startsWith(Section.Name, ".debug_") &&
+        !startsWith(Section.Name, ".zdebug_"))
+      continue;
+    if (Section.Name == ".debug_info" || Section.Name == ".zdebug_info")
+      HasInfo = Section.Type != NoBits && Section.Size != 0;
+    if (Section.Type != NoBits)
+      Size += Section.Size;
+  }
+  return HasInfo;
+}
+
+bool ElfDwarfReader::readUnitHeaders(const DebugSections &Sections,
+                                     std::vector<UnitHeader> &Headers) {
+  DataReader Reader(Sections.Info, Sections.BigEndian);
+  while (Reader.tell() < Sections.Info.size()) {
+    UnitHeader Header;
+    Header.Offset = Reader.tell();
+    uint64_t Length = Reader.readUnsigned(4);
+    if (Length == 0xffffffff) {
+      Header.OffsetSize = 8;
+      Length = Reader.readUnsigned(8);
+    } else if (Length >= 0xfffffff0)
+      return false;
+    Header.NextOffset = Reader.tell() + Length;
+    if (Header.NextOffset > Sections.Info.size() ||
+        Header.NextOffset < Reader.tell())
+      return false;
+
+    Header.Version = static_cast<unsigned>(Reader.readUnsigned(2));
+    if (Header.Version >= 5) {
+      Header.UnitType = static_cast<unsigned>(Reader.readUnsigned(1));
+      Header.AddressSize = static_cast<unsigned>(Reader.readUnsigned(1));
+      Header.AbbrevOffset = Reader.readUnsigned(Header.OffsetSize);
+      if (Header.UnitType == UnitTypeSkeleton ||
+          Header.UnitType == UnitTypeSplitCompile)
+        Reader.skip(8);
+      else if (Header.UnitType == DW_UT_type ||
+               Header.UnitType == UnitTypeSplitType)
+        Reader.skip(8 + Header.OffsetSize);
+    } else {
+      Header.AbbrevOffset = Reader.readUnsigned(Header.OffsetSize);
+      Header.AddressSize = static_cast<unsigned>(Reader.readUnsigned(1));
+    }
+    if (Reader.failed())
+      return false;
+    Header.DIEsOffset = Reader.tell();
+    Headers.push_back(Header);
+    Reader.seek(Header.NextOffset);
+  }
+  return true;
+}
+
+bool ElfDwarfReader::skipAttrValue(DataReader &Reader, const UnitHeader &Header,
+                                   uint64_t Form) {
+  switch (Form) {
+  case DW_FORM_flag_present:
+  case DW_FORM_implicit_const:
+    return true;
+  case DW_FORM_addr:
+    Reader.skip(Header.AddressSize);
+    return true;
+  case DW_FORM_data1:
+  case DW_FORM_ref1:
+  case DW_FORM_flag:
+    Reader.skip(1);
+    return true;
+  case DW_FORM_data2:
+  case DW_FORM_ref2:
+    Reader.skip(2);
+    return true;
+  case DW_FORM_data4:
+  case DW_FORM_ref4:
+  case DW_FORM_ref_sup:
+    Reader.skip(4);
+    return true;
+  case DW_FORM_data8:
+  case DW_FORM_ref8:
+  case DW_FORM_ref_sig8:
+  case FormRefSup8:
+    Reader.skip(8);
+    return true;
+  case DW_FORM_data16:
+    Reader.skip(16);
+    return true;
+  case DW_FORM_udata:
+  case DW_FORM_ref_udata:
+  case DW_FORM_strx:
+  case DW_FORM_addrx:
+  case DW_FORM_loclistx:
+  case DW_FORM_rnglistx:
+  case DW_FORM_GNU_addr_index:
+  case DW_FORM_GNU_str_index:
+    Reader.readULEB128();
+    return true;
+  case DW_FORM_sdata:
+    Reader.readSLEB128();
+    return true;
+  case DW_FORM_string:
+    Reader.skipCString();
+    return true;
+  case DW_FORM_block1:
+    Reader.skip(Reader.readUnsigned(1));
+    return true;
+  case DW_FORM_block2:
+    Reader.skip(Reader.readUnsigned(2));
+    return true;
+  case DW_FORM_block4:
+    Reader.skip(Reader.readUnsigned(4));
+    return true;
+  case DW_FORM_block:
+  case DW_FORM_exprloc:
+    Reader.skip(Reader.readULEB128());
+    return true;
+  case DW_FORM_strp:
+  case DW_FORM_line_strp:
+  case DW_FORM_strp_sup:
+  case DW_FORM_sec_offset:
+  case DW_FORM_GNU_ref_alt:
+  case DW_FORM_GNU_strp_alt:
+    Reader.skip(Header.OffsetSize);
+    return true;
+  case DW_FORM_ref_addr:
+    Reader.skip(Header.Version == 2 ? Header.AddressSize : Header.OffsetSize);
+    return true;
+  case DW_FORM_indirect: {
+    uint64_t ActualForm = Reader.readULEB128();
+    return ActualForm != DW_FORM_indirect &&
+           skipAttrValue(Reader, Header, ActualForm);
+  }
+  default:
+    if (Form >= FormStrx1 && Form <= FormStrx4) {
+      Reader.skip(Form - FormStrx1 + 1);
+      return true;
+    }
+    if (Form >= FormAddrx1 && Form <= FormAddrx4) {
+      Reader.skip(Form - FormAddrx1 + 1);
+      return true;
+    }
+    return false;
+  }
+}
+
+bool ElfDwarfReader::readAbbreviations(
+    const DebugSections &Sections, uint64_t Offset,
+    std::unordered_map<uint64_t, Abbreviation> &Table, uint64_t &End) {
+  DataReader Reader(Sections.Abbrev, Sections.BigEndian);
+  Reader.seek(Offset);
+  while (!Reader.failed()) {
+    uint64_t Code = Reader.readULEB128();
+    if (Code == 0)
+      break;
+    Abbreviation &Abbrev = Table[Code];
+    Abbrev.Tag = Reader.readULEB128();
+    Abbrev.HasChildren = Reader.readUnsigned(1) != 0;
+    while (!Reader.failed()) {
+      uint64_t Attr = Reader.readULEB128();
+      uint64_t Form = Reader.readULEB128();
+      if (Attr == 0 && Form == 0)
+        break;
+      // The value of an implicit constant is held in the table.
+      if (Form == DW_FORM_implicit_const)
+        Reader.readSLEB128();
+      Abbrev.AttrForms.emplace_back(Attr, Form);
+    }
+  }
+  End = Reader.tell();
+  return !Reader.failed();
+}
+
+bool ElfDwarfReader::readScanAbbreviations(
+    const DebugSections &Sections, const std::vector<UnitHeader> &Headers,
+    ScanAbbreviations &Abbrevs) {
+  std::map<uint64_t, size_t> TagIndices;
+  for (const UnitHeader &Header : Headers) {
+    if (Header.Version < 2 || Header.Version > 5 ||
+        (Header.Version == 5 && Header.UnitType != DW_UT_compile))
+      return false;
+    if (Abbrevs.Tables.count(Header.AbbrevOffset))
+      continue;
+    ScanAbbreviationTable &Table = Abbrevs.Tables[Header.AbbrevOffset];
+    uint64_t End = 0;
+    if (!readAbbreviations(Sections, Header.AbbrevOffset, Table.Abbreviations,
+                           End))
+      return false;
+    for (const auto &Entry : Table.Abbreviations) {
+      if (Entry.first > 4 * Table.Abbreviations.size() + 64)
+        return false;
+      if (Entry.first >= Table.ByCode.size())
+        Table.ByCode.resize(Entry.first + 1);
+      auto Index = TagIndices.emplace(Entry.second.Tag, Abbrevs.Tags.size());
+      if (Index.second)
+        Abbrevs.Tags.push_back(Entry.second.Tag);
+      Table.ByCode[Entry.first] = {&Entry.second, Index.first->second};
+    }
+  }
+  for (const UnitHeader &Header : Headers)
+    Abbrevs.UnitTables.push_back(&Abbrevs.Tables[Header.AbbrevOffset]);
+  return true;
+}
+
+std::unique_ptr<LibScopeView::Object>
+ElfDwarfReader::createObjectForAbbrevTag(uint64_t Tag) {
+  if (Tag > 0xffff)
+    return nullptr;
+  return std::unique_ptr<LibScopeView::Object>(
+      createObjectForTag(static_cast<Dwarf_Half>(Tag)));
+}
@@ -0,0 +1,272 @@
+//===-- ElfDwarfReader/DebugSections.h --------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the reading of DWARF sections straight from an ELF file,
+/// for the parts of the DWARF that are decoded without libdwarf.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef DEBUG_SECTIONS_H
+#define DEBUG_SECTIONS_H
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace LibScopeView {
+class Object;
+} // namespace LibScopeView
+
+namespace ElfDwarfReader {
+
+/// \brief Bounds checked reading of ELF and DWARF data. Reading past the end
+/// returns zero and marks the reader as failed.
+class DataReader {
+public:
+  DataReader(const std::vector<uint8_t> &Bytes, bool IsBigEndian)
+      : Data(Bytes.data()), Size(Bytes.size()), BigEndian(IsBigEndian) {}
+
+  bool failed() const { return Failed; }
+  size_t tell() const { return Pos; }
+  void seek(uint64_t Offset) {
+    if (Offset > Size)
+      Failed = true;
+    else
+      Pos = static_cast<size_t>(Offset);
+  }
+  const uint8_t *getData() const { return Data; }
+
+  /// \brief Return true if Bytes more bytes can be read.
+  bool canRead(uint64_t Bytes) {
+    if (Failed || Bytes > Size - Pos) {
+      Failed = true;
+      return false;
+    }
+    return true;
+  }
+
+  uint8_t readByte() { return canRead(1) ? Data[Pos++] : 0; }
+
+  uint64_t readUnsigned(unsigned Bytes) {
+    if (!canRead(Bytes))
+      return 0;
+    uint64_t Value = 0;
+    for (unsigned I = 0; I < Bytes; ++I) {
+      uint64_t Byte = Data[Pos + (BigEndian ? I : Bytes - 1 - I)];
+      Value = (Value << 8) | Byte;
+    }
+    Pos += Bytes;
+    return Value;
+  }
+
+  uint64_t readULEB128() {
+    uint64_t Value = 0;
+    unsigned Shift = 0;
+    while (canRead(1)) {
+      uint8_t Byte = Data[Pos++];
+      if (Shift < 64)
+        Value |= uint64_t(Byte & 0x7f) << Shift;
+      Shift += 7;
+      if (!(Byte & 0x80))
+        return Value;
+    }
+    return 0;
+  }
+
+  int64_t readSLEB128() {
+    uint64_t Value = 0;
+    unsigned Shift = 0;
+    while (canRead(1)) {
+      uint8_t Byte = Data[Pos++];
+      if (Shift < 64)
+        Value |= uint64_t(Byte & 0x7f) << Shift;
+      Shift += 7;
+      if (!(Byte & 0x80)) {
+        if (Shift < 64 && (Byte & 0x40))
+          Value |= ~uint64_t(0) << Shift;
+        return static_cast<int64_t>(Value);
+      }
+    }
+    return 0;
+  }
+
+  /// \brief Skip Bytes, returning a pointer to the skipped data.
+  const uint8_t *skip(uint64_t Bytes) {
+    if (!canRead(Bytes))
+      return nullptr;
+    const uint8_t *Start = Data + Pos;
+    Pos += static_cast<size_t>(Bytes);
+    return Start;
+  }
+
+  /// \brief Skip a null terminated string, returning its length.
+  size_t skipCString() {
+    const void *End = Pos < Size ? memchr(Data + Pos, 0, Size - Pos) : nullptr;
+    if (!End) {
+      Failed = true;
+      return 0;
+    }
+    size_t Length = static_cast<size_t>(static_cast<const uint8_t *>(End) -
+                                        (Data + Pos));
+    Pos += Length + 1;
+    return Length;
+  }
+
+private:
+  const uint8_t *Data;
+  size_t Size;
+  size_t Pos = 0;
+  bool BigEndian;
+  bool Failed = false;
+};
+
+/// \brief The contents of the debug sections of an ELF file.
+struct DebugSections {
+  /// \brief Flags selecting the sections to read.
+  enum SectionFlags : unsigned {
+    InfoSection = 1 << 0,
+    AbbrevSection = 1 << 1,
+    StrSection = 1 << 2,
+    LineSection = 1 << 3,
+    RangesSection = 1 << 4,
+    AddrSection = 1 << 5,
+    AllSections = (1 << 6) - 1,
+  };
+
+  bool BigEndian = false;
+  std::vector<uint8_t> Info;
+  std::vector<uint8_t> Abbrev;
+  std::vector<uint8_t> Str;
+  std::vector<uint8_t> Line;
+  std::vector<uint8_t> Ranges;
+  std::vector<uint8_t> Addr;
+  /// \brief The SectionFlags of the sections that have relocations, which
+  /// are only present in relocatable files where the section contents are
+  /// not final.
+  unsigned RelocatedSections = 0;
+  /// \brief The names and contents of the relocation sections of all the
+  /// debug sections, only read when .debug_info is read.
+  std::vector<uint8_t> Relocations;
+};
+
+/// \brief Read the debug sections selected by Wanted (a combination of
+/// DebugSections::SectionFlags) from an ELF file. Returns false if the file
+/// is not ELF or its debug sections can't be read directly, for example
+/// because they are compressed.
+bool readDebugSections(const std::string &FileName, unsigned Wanted,
+                       DebugSections &Sections);
+
+/// \brief Get the total size of the debug sections of an ELF file from its
+/// section headers, without reading the sections. Returns false if the file
+/// is not ELF or has no .debug_info section.
+bool getDebugSectionsSize(const std::string &FileName, uint64_t &Size);
+
+/// \brief The header of a unit in .debug_info.
+struct UnitHeader {
+  uint64_t Offset = 0;
+  uint64_t NextOffset = 0;
+  size_t DIEsOffset = 0;
+  unsigned Version = 0;
+  unsigned UnitType = 0;
+  unsigned OffsetSize = 4;
+  unsigned AddressSize = 0;
+  uint64_t AbbrevOffset = 0;
+};
+
+/// \brief Read the headers of all the units in the .debug_info of Sections,
+/// returning false if the section is corrupt.
+bool readUnitHeaders(const DebugSections &Sections,
+                     std::vector<UnitHeader> &Headers);
+
+/// \brief An abbreviation from .debug_abbrev, with the attributes and forms
+/// of the DIEs that use it.
+struct Abbreviation {
+  uint64_t Tag = 0;
+  bool HasChildren = false;
+  std::vector<std::pair<uint64_t, uint64_t>> AttrForms;
+};
+
+/// \brief Read the abbreviation table at Offset in the .debug_abbrev of
+/// Sections, indexed by code, and set End to the offset after the table.
+/// Returns false if the table is corrupt.
+bool readAbbreviations(const DebugSections &Sections, uint64_t Offset,
+                       std::unordered_map<uint64_t, Abbreviation> &Table,
+                       uint64_t &End);
+
+/// \brief An abbreviation table of a unit, indexed by code for scanning its
+/// DIEs without libdwarf.
+struct ScanAbbreviationTable {
+  /// \brief An abbreviation and the index of its tag in
+  /// ScanAbbreviations::Tags.
+  struct Entry {
+    const Abbreviation *Abbrev = nullptr;
+    size_t TagIndex = 0;
+  };
+
+  std::unordered_map<uint64_t, Abbreviation> Abbreviations;
+  /// \brief The entries by code, as the codes are almost always numbered
+  /// from one. Unused codes have no Abbrev.
+  std::vector<Entry> ByCode;
+};
+
+/// \brief The abbreviation tables of the units of a file, read up front so
+/// that the units can be scanned in parallel.
+struct ScanAbbreviations {
+  ScanAbbreviations() = default;
+  // The entries point into the tables.
+  ScanAbbreviations(const ScanAbbreviations &) = delete;
+  ScanAbbreviations &operator=(const ScanAbbreviations &) = delete;
+
+  /// \brief The tables by their offset in .debug_abbrev.
+  std::map<uint64_t, ScanAbbreviationTable> Tables;
+  /// \brief The table of each unit, in the order of its header.
+  std::vector<const ScanAbbreviationTable *> UnitTables;
+  /// \brief The tags used by the tables, each once, so that a scan can look
+  /// up what is created for each tag before scanning.
+  std::vector<uint64_t> Tags;
+};
+
+/// \brief Read the abbreviation tables of the units with Headers for a scan.
+/// Returns false if a unit is not a DWARF 2 to 5 compile unit, or a table is
+/// corrupt or has codes too sparse to index.
+bool readScanAbbreviations(const DebugSections &Sections,
+                           const std::vector<UnitHeader> &Headers,
+                           ScanAbbreviations &Abbrevs);
+
+/// \brief Create the object that the reader creates for a DIE with Tag, or
+/// return null if it creates none.
+std::unique_ptr<LibScopeView::Object> createObjectForAbbrevTag(uint64_t Tag);
+
+/// \brief Skip a DIE attribute value of Form in a unit with Header, returning
+/// false if the form isn't known.
+bool skipAttrValue(DataReader &Reader, const UnitHeader &Header, uint64_t Form);
+
+} // end namespace ElfDwarfReader
+
+#endif // DEBUG_SECTIONS_H
@@ -0,0 +1,379 @@
+//===-- ElfDwarfReader/DwarfFingerprint.cpp ---------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the fingerprinting of the compile units in the DWARF of
+/// an ELF file, reading the sections directly rather than through libdwarf.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfFingerprint.h"
+#include "DebugSections.h"
+
+// Disable some clang warnings for dwarf.h.
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wreserved-id-macro"
+#endif
+
+#include "dwarf.h"
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+// 64-bit FNV-1a hash.
+class Hasher {
+public:
+  void addBytes(const uint8_t *Data, size_t Size) {
+    for (size_t I = 0; I < Size; ++I) {
+      Hash ^= Data[I];
+      Hash *= Prime;
+    }
+  }
+  void addValue(uint64_t Value) {
+    for (unsigned I = 0; I < 8; ++I, Value >>= 8) {
+      Hash ^= Value & 0xff;
+      Hash *= Prime;
+    }
+  }
+  uint64_t get() const { return Hash; }
+
+private:
+  static const uint64_t Prime = 0x100000001b3ULL;
+  uint64_t Hash = 0xcbf29ce484222325ULL;
+};
+
+// An abbreviation table and the hash of its bytes.
+struct AbbreviationTable {
+  bool Valid = false;
+  uint64_t Hash = 0;
+  std::unordered_map<uint64_t, Abbreviation> Abbreviations;
+};
+
+AbbreviationTable readAbbreviationTable(const DebugSections &Sections,
+                                        uint64_t Offset) {
+  AbbreviationTable Table;
+  uint64_t End = 0;
+  if (!readAbbreviations(Sections, Offset, Table.Abbreviations, End))
+    return Table;
+
+  // Any implicit constants are part of the table, so they are covered by
+  // the hash.
+  Hasher Hash;
+  Hash.addBytes(Sections.Abbrev.data() + Offset,
+                static_cast<size_t>(End - Offset));
+  Table.Hash = Hash.get();
+  Table.Valid = true;
+  return Table;
+}
+
+// Computes the hash of a single unit from its DIEs.
+class UnitHasher {
+public:
+  UnitHasher(const DebugSections &DebugSections,
+             const std::vector<UnitHeader> &AllHeaders, size_t Index)
+      : Sections(DebugSections), Headers(AllHeaders),
+        Header(AllHeaders[Index]), UnitIndex(Index),
+        Reader(DebugSections.Info, DebugSections.BigEndian) {}
+
+  // Hash the unit's DIEs, returning false if they couldn't all be followed.
+  bool hashDIEs(const AbbreviationTable &Table) {
+    Hash.addValue(Header.Version);
+    Hash.addValue(Header.UnitType);
+    Hash.addValue(Header.AddressSize);
+    Hash.addValue(Header.OffsetSize);
+    Hash.addValue(Table.Hash);
+
+    Reader.seek(Header.DIEsOffset);
+    while (Reader.tell() < Header.NextOffset) {
+      uint64_t Code = Reader.readULEB128();
+      Hash.addValue(Code);
+      if (Code == 0)
+        continue;
+      auto IT = Table.Abbreviations.find(Code);
+      if (IT == Table.Abbreviations.end())
+        return false;
+      for (const auto &AttrForm : IT->second.AttrForms)
+        if (!hashValue(AttrForm.first, AttrForm.second))
+          return false;
+      if (Reader.failed())
+        return false;
+    }
+    return Reader.tell() == Header.NextOffset;
+  }
+
+  uint64_t getHash() const { return Hash.get(); }
+  const std::vector<uint32_t> &getReferencedUnits() const {
+    return ReferencedUnits;
+  }
+
+private:
+  // Hash an attribute value of the given form.
+  bool hashValue(uint64_t Attr, uint64_t Form) {
+    switch (Form) {
+    case DW_FORM_addr:
+      Hash.addValue(Reader.readUnsigned(Header.AddressSize));
+      return true;
+    case DW_FORM_data1:
+    case DW_FORM_ref1:
+    case DW_FORM_flag:
+      Hash.addValue(Reader.readUnsigned(1));
+      return true;
+    case DW_FORM_data2:
+    case DW_FORM_ref2:
+      Hash.addValue(Reader.readUnsigned(2));
+      return true;
+    case DW_FORM_data4:
+      // DWARF 2 and 3 hold section offsets in data4 and data8.
+      return hashConstantOrOffset(Attr, Reader.readUnsigned(4));
+    case DW_FORM_data8:
+      return hashConstantOrOffset(Attr, Reader.readUnsigned(8));
+    case DW_FORM_ref4:
+      Hash.addValue(Reader.readUnsigned(4));
+      return true;
+    case DW_FORM_ref8:
+      Hash.addValue(Reader.readUnsigned(8));
+      return true;
+    case DW_FORM_data16:
+      return hashBytes(16);
+    case DW_FORM_udata:
+    case DW_FORM_ref_udata:
+      Hash.addValue(Reader.readULEB128());
+      return true;
+    case DW_FORM_sdata:
+      Hash.addValue(static_cast<uint64_t>(Reader.readSLEB128()));
+      return true;
+    case DW_FORM_string: {
+      size_t Start = Reader.tell();
+      size_t Length = Reader.skipCString();
+      Hash.addBytes(Reader.getData() + Start, Length);
+      Hash.addValue(Length);
+      return true;
+    }
+    case DW_FORM_block1:
+      return hashBytes(Reader.readUnsigned(1));
+    case DW_FORM_block2:
+      return hashBytes(Reader.readUnsigned(2));
+    case DW_FORM_block4:
+      return hashBytes(Reader.readUnsigned(4));
+    case DW_FORM_block:
+    case DW_FORM_exprloc:
+      return hashBytes(Reader.readULEB128());
+    case DW_FORM_strp:
+      hashString(Sections.Str, Reader.readUnsigned(Header.OffsetSize));
+      return true;
+    case DW_FORM_sec_offset:
+      return hashSectionOffset(Attr, Reader.readUnsigned(Header.OffsetSize));
+    case DW_FORM_ref_addr:
+      return hashReferenceAddress(Reader.readUnsigned(
+          Header.Version == 2 ? Header.AddressSize : Header.OffsetSize));
+    case DW_FORM_flag_present:
+    case DW_FORM_implicit_const:
+      // The value is held in the abbreviation table.
+      return true;
+    case DW_FORM_indirect: {
+      uint64_t ActualForm = Reader.readULEB128();
+      Hash.addValue(ActualForm);
+      return ActualForm != DW_FORM_indirect && hashValue(Attr, ActualForm);
+    }
+    default:
+      // Indexed forms (DWARF 5 or split DWARF), type signatures and references
+      // to supplementary files point at data that isn't followed here.
+      return false;
+    }
+  }
+
+  bool hashBytes(uint64_t Size) {
+    const uint8_t *Bytes = Reader.skip(Size);
+    if (!Bytes)
+      return false;
+    Hash.addBytes(Bytes, static_cast<size_t>(Size));
+    Hash.addValue(Size);
+    return true;
+  }
+
+  bool hashConstantOrOffset(uint64_t Attr, uint64_t Value) {
+    if (Header.Version < 4 &&
+        (Attr == DW_AT_stmt_list || Attr == DW_AT_ranges))
+      return hashSectionOffset(Attr, Value);
+    Hash.addValue(Value);
+    return true;
+  }
+
+  // Hash the data at a section offset, rather than the offset, for the
+  // sections that are read when creating objects.
+  bool hashSectionOffset(uint64_t Attr, uint64_t Offset) {
+    if (Attr == DW_AT_stmt_list)
+      return hashLineProgram(Offset);
+    if (Attr == DW_AT_ranges) {
+      // DWARF 5 range lists are in .debug_rnglists.
+      if (Header.Version >= 5)
+        return false;
+      return hashRangeList(Offset);
+    }
+    Hash.addValue(Offset);
+    return true;
+  }
+
+  void hashString(const std::vector<uint8_t> &Section, uint64_t Offset) {
+    if (Offset >= Section.size()) {
+      Hash.addValue(~uint64_t(0));
+      return;
+    }
+    const uint8_t *Start = Section.data() + Offset;
+    const void *End = memchr(Start, 0, Section.size() - Offset);
+    size_t Length = End ? static_cast<size_t>(
+                              static_cast<const uint8_t *>(End) - Start)
+                        : Section.size() - Offset;
+    Hash.addBytes(Start, Length);
+    Hash.addValue(Length);
+  }
+
+  bool hashLineProgram(uint64_t Offset) {
+    DataReader LineReader(Sections.Line, Sections.BigEndian);
+    LineReader.seek(Offset);
+    uint64_t Length = LineReader.readUnsigned(4);
+    if (Length == 0xffffffff)
+      Length = LineReader.readUnsigned(8);
+    size_t Start = LineReader.tell();
+    // DWARF 5 line tables hold their file names in .debug_line_str.
+    if (LineReader.readUnsigned(2) >= 5)
+      return false;
+    LineReader.seek(Start);
+    const uint8_t *Program = LineReader.skip(Length);
+    if (!Program)
+      return false;
+    Hash.addBytes(Program, static_cast<size_t>(Length));
+    return true;
+  }
+
+  bool hashRangeList(uint64_t Offset) {
+    DataReader RangesReader(Sections.Ranges, Sections.BigEndian);
+    RangesReader.seek(Offset);
+    while (!RangesReader.failed()) {
+      uint64_t Start = RangesReader.readUnsigned(Header.AddressSize);
+      uint64_t End = RangesReader.readUnsigned(Header.AddressSize);
+      Hash.addValue(Start);
+      Hash.addValue(End);
+      if (Start == 0 && End == 0)
+        return true;
+    }
+    return false;
+  }
+
+  // Hash a reference as an offset into the unit holding it.
+  bool hashReferenceAddress(uint64_t Offset) {
+    auto IT = std::upper_bound(
+        Headers.begin(), Headers.end(), Offset,
+        [](uint64_t Value, const UnitHeader &H) { return Value < H.Offset; });
+    if (IT == Headers.begin() || Offset >= std::prev(IT)->NextOffset)
+      return false;
+    const UnitHeader &Target = *std::prev(IT);
+    uint32_t TargetIndex =
+        static_cast<uint32_t>(std::prev(IT) - Headers.begin());
+    Hash.addValue(Offset - Target.Offset);
+    Hash.addValue(TargetIndex == UnitIndex);
+    if (TargetIndex != UnitIndex)
+      ReferencedUnits.push_back(TargetIndex);
+    return true;
+  }
+
+  const DebugSections &Sections;
+  const std::vector<UnitHeader> &Headers;
+  const UnitHeader &Header;
+  size_t UnitIndex;
+  DataReader Reader;
+  Hasher Hash;
+  std::vector<uint32_t> ReferencedUnits;
+};
+
+} // end anonymous namespace
+
+std::vector<CompileUnitFingerprint>
+ElfDwarfReader::fingerprintCompileUnits(const std::string &FileName) {
+  std::vector<CompileUnitFingerprint> Fingerprints;
+  DebugSections Sections;
+  std::vector<UnitHeader> Headers;
+  if (!readDebugSections(FileName, DebugSections::AllSections, Sections) ||
+      Sections.Info.empty() || !readUnitHeaders(Sections, Headers))
+    return Fingerprints;
+
+  std::map<uint64_t, AbbreviationTable> AbbreviationTables;
+  Fingerprints.resize(Headers.size());
+  for (size_t I = 0; I < Headers.size(); ++I) {
+    const UnitHeader &Header = Headers[I];
+    CompileUnitFingerprint &Fingerprint = Fingerprints[I];
+    Fingerprint.HeaderOffset = Header.Offset;
+    Fingerprint.NextHeaderOffset = Header.NextOffset;
+
+    auto Table = AbbreviationTables.find(Header.AbbrevOffset);
+    if (Table == AbbreviationTables.end())
+      Table = AbbreviationTables
+                  .emplace(Header.AbbrevOffset,
+                           readAbbreviationTable(Sections, Header.AbbrevOffset))
+                  .first;
+
+    UnitHasher Hasher(Sections, Headers, I);
+    Fingerprint.Complete = Header.Version >= 2 && Header.Version <= 5 &&
+                           Table->second.Valid &&
+                           Hasher.hashDIEs(Table->second);
+    Fingerprint.Hash = Hasher.getHash();
+    Fingerprint.ReferencedUnits = Hasher.getReferencedUnits();
+    std::sort(Fingerprint.ReferencedUnits.begin(),
+              Fingerprint.ReferencedUnits.end());
+    Fingerprint.ReferencedUnits.erase(
+        std::unique(Fingerprint.ReferencedUnits.begin(),
+                    Fingerprint.ReferencedUnits.end()),
+        Fingerprint.ReferencedUnits.end());
+  }
+
+  // Fold in the hashes of the referenced units and the relocations, once all
+  // the units have their own hash.
+  // Any change to the relocations changes every unit.
+  Hasher Relocations;
+  Relocations.addBytes(Sections.Relocations.data(),
+                       Sections.Relocations.size());
+  std::vector<uint64_t> UnitHashes;
+  for (const CompileUnitFingerprint &Fingerprint : Fingerprints)
+    UnitHashes.push_back(Fingerprint.Hash);
+  for (CompileUnitFingerprint &Fingerprint : Fingerprints) {
+    Hasher Hash;
+    Hash.addValue(Fingerprint.Hash);
+    Hash.addValue(Relocations.get());
+    for (uint32_t Target : Fingerprint.ReferencedUnits)
+      Hash.addValue(UnitHashes[Target]);
+    Fingerprint.Hash = Hash.get();
+  }
+  return Fingerprints;
+}
@@ -0,0 +1,70 @@
+//===-- ElfDwarfReader/DwarfFingerprint.h -----------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the fingerprinting of the compile units in the DWARF of
+/// an ELF file, used to find the units that are unchanged since a previous run.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef DWARF_FINGERPRINT_H
+#define DWARF_FINGERPRINT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ElfDwarfReader {
+
+/// \brief The fingerprint of one compile unit in .debug_info.
+struct CompileUnitFingerprint {
+  /// \brief Offsets of the unit header and of the header after the unit.
+  uint64_t HeaderOffset = 0;
+  uint64_t NextHeaderOffset = 0;
+  /// \brief Hash of everything the unit's objects are created from.
+  uint64_t Hash = 0;
+  /// \brief False if the unit uses DWARF that could not be followed, so it
+  /// must always be read again.
+  bool Complete = true;
+  /// \brief Indices of the other units that DW_FORM_ref_addr values point
+  /// into, in ascending order.
+  std::vector<uint32_t> ReferencedUnits;
+};
+
+/// \brief Fingerprint each compile unit in the .debug_info of an ELF file.
+///
+/// A unit's hash covers its DIEs, its abbreviation table and the strings, line
+/// program and range lists that it refers to. Section offsets are hashed as
+/// the data they point at, so a unit keeps its hash when the units around it
+/// change. DW_FORM_ref_addr values are hashed as offsets into the target unit,
+/// together with the target unit's own hash.
+///
+/// Returns no fingerprints if the file can't be fingerprinted, for example if
+/// it isn't ELF or its debug sections are compressed.
+std::vector<CompileUnitFingerprint>
+fingerprintCompileUnits(const std::string &FileName);
+
+} // end namespace ElfDwarfReader
+
+#endif // DWARF_FINGERPRINT_H
@@ -0,0 +1,225 @@
+//===-- ElfDwarfReader/DwarfLineProgram.cpp ---------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implementation of the DWARF line number program
+/// decoder.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfLineProgram.h"
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+// The number of operands of each standard opcode, DW_LNS_copy onwards.
+const uint8_t StandardOpcodeLengths[] = {0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1};
+const unsigned StandardOpcodeCount =
+    sizeof(StandardOpcodeLengths) / sizeof(StandardOpcodeLengths[0]);
+
+// The line number state machine registers.
+struct LineRegisters {
+  explicit LineRegisters(bool DefaultIsStmt) : IsStmt(DefaultIsStmt) {}
+
+  Dwarf_Addr Address = 0;
+  Dwarf_Unsigned File = 1;
+  Dwarf_Unsigned Line = 1;
+  Dwarf_Unsigned ISA = 0;
+  Dwarf_Unsigned Discriminator = 0;
+  bool IsStmt;
+  bool BasicBlock = false;
+  bool PrologueEnd = false;
+  bool EpilogueBegin = false;
+};
+
+void appendRow(const LineRegisters &Regs, bool EndSequence,
+               DwarfLineTable &Table) {
+  uint8_t Flags =
+      (Regs.IsStmt ? DwarfLineTable::BeginStatement : 0) |
+      (EndSequence ? DwarfLineTable::EndSequence : 0) |
+      (Regs.BasicBlock ? DwarfLineTable::BeginBlock : 0) |
+      (Regs.PrologueEnd ? DwarfLineTable::PrologEnd : 0) |
+      (Regs.EpilogueBegin ? DwarfLineTable::EpilogueBegin : 0);
+  Table.addRow(Regs.Address, Regs.Line, Regs.File, Flags, Regs.ISA,
+               Regs.Discriminator);
+}
+
+bool decodeProgram(const DebugSections &Sections, uint64_t Offset,
+                   unsigned AddressSize, DwarfLineTable &Table) {
+  DataReader Data(Sections.Line, Sections.BigEndian);
+  Data.seek(Offset);
+
+  // Header.
+  unsigned OffsetSize = 4;
+  uint64_t UnitLength = Data.readUnsigned(4);
+  if (UnitLength == 0xffffffff) {
+    OffsetSize = 8;
+    UnitLength = Data.readUnsigned(8);
+  } else if (UnitLength == 0 || UnitLength >= 0xfffffff0) {
+    return false;
+  }
+  if (!Data.canRead(UnitLength))
+    return false;
+  uint64_t UnitEnd = Data.tell() + UnitLength;
+
+  uint16_t Version = static_cast<uint16_t>(Data.readUnsigned(2));
+  if (Version < 2 || Version > 4)
+    return false;
+  uint64_t HeaderLength = Data.readUnsigned(OffsetSize);
+  uint64_t ProgramStart = Data.tell() + HeaderLength;
+  if (Data.failed() || HeaderLength > UnitEnd - Data.tell())
+    return false;
+
+  uint8_t MinInstLength = Data.readByte();
+  if (Version >= 4 && Data.readByte() > 1)
+    return false;
+  bool DefaultIsStmt = Data.readByte() != 0;
+  int8_t LineBase = static_cast<int8_t>(Data.readByte());
+  uint8_t LineRange = Data.readByte();
+  uint8_t OpcodeBase = Data.readByte();
+  if (LineRange == 0 || OpcodeBase == 0 || OpcodeBase > StandardOpcodeCount + 1)
+    return false;
+  for (unsigned Opcode = 1; Opcode < OpcodeBase; ++Opcode)
+    if (Data.readByte() != StandardOpcodeLengths[Opcode - 1])
+      return false;
+
+  // The file names are read by libdwarf when the source files are listed,
+  // so only check that the directory and file tables are well formed.
+  while (Data.skipCString() != 0)
+    ;
+  while (Data.skipCString() != 0) {
+    Data.readULEB128();
+    Data.readULEB128();
+    Data.readULEB128();
+  }
+  if (Data.failed() || Data.tell() != ProgramStart)
+    return false;
+
+  // Program.
+  LineRegisters Regs(DefaultIsStmt);
+  while (Data.tell() < UnitEnd) {
+    uint8_t Opcode = Data.readByte();
+
+    if (Opcode >= OpcodeBase) {
+      unsigned Adjusted = Opcode - OpcodeBase;
+      Regs.Address += (Adjusted / LineRange) * MinInstLength;
+      Regs.Line += LineBase + Adjusted % LineRange;
+      // libdwarf reports the epilogue_begin register as the end_sequence of
+      // rows from special opcodes, so do the same to give identical output.
+      appendRow(Regs, Regs.EpilogueBegin, Table);
+      Regs.BasicBlock = false;
+      Regs.PrologueEnd = false;
+      Regs.EpilogueBegin = false;
+      Regs.Discriminator = 0;
+      continue;
+    }
+
+    switch (Opcode) {
+    case 0: {
+      uint64_t Length = Data.readULEB128();
+      if (Length == 0 || !Data.canRead(Length))
+        return false;
+      uint64_t InstEnd = Data.tell() + Length;
+      uint8_t ExtOpcode = Data.readByte();
+      switch (ExtOpcode) {
+      case DW_LNE_end_sequence:
+        appendRow(Regs, true, Table);
+        Regs = LineRegisters(DefaultIsStmt);
+        break;
+      case DW_LNE_set_address:
+        // libdwarf reads the CU address size whatever the operand length.
+        Regs.Address = Data.readUnsigned(AddressSize);
+        break;
+      case DW_LNE_set_discriminator:
+        Regs.Discriminator = Data.readULEB128();
+        break;
+      case DW_LNE_define_file:
+        return false;
+      default:
+        Data.seek(InstEnd);
+        break;
+      }
+      break;
+    }
+    case DW_LNS_copy:
+      appendRow(Regs, false, Table);
+      Regs.BasicBlock = false;
+      Regs.PrologueEnd = false;
+      Regs.EpilogueBegin = false;
+      Regs.Discriminator = 0;
+      break;
+    case DW_LNS_advance_pc:
+      Regs.Address += MinInstLength * Data.readULEB128();
+      break;
+    case DW_LNS_advance_line:
+      Regs.Line += Data.readSLEB128();
+      break;
+    case DW_LNS_set_file:
+      Regs.File = Data.readULEB128();
+      break;
+    case DW_LNS_set_column:
+      Data.readULEB128();
+      break;
+    case DW_LNS_negate_stmt:
+      Regs.IsStmt = !Regs.IsStmt;
+      break;
+    case DW_LNS_set_basic_block:
+      Regs.BasicBlock = true;
+      break;
+    case DW_LNS_const_add_pc:
+      Regs.Address += ((255 - OpcodeBase) / LineRange) * MinInstLength;
+      break;
+    case DW_LNS_fixed_advance_pc:
+      Regs.Address += Data.readUnsigned(2);
+      break;
+    case DW_LNS_set_prologue_end:
+      Regs.PrologueEnd = true;
+      break;
+    case DW_LNS_set_epilogue_begin:
+      Regs.EpilogueBegin = true;
+      break;
+    case DW_LNS_set_isa:
+      Regs.ISA = Data.readULEB128();
+      break;
+    }
+    if (Data.failed() || Data.tell() > UnitEnd)
+      return false;
+  }
+  return true;
+}
+
+} // end anonymous namespace
+
+bool ElfDwarfReader::decodeLineProgram(const DebugSections &Sections,
+                                       uint64_t Offset, unsigned AddressSize,
+                                       DwarfLineTable &Table) {
+  if (AddressSize != 4 && AddressSize != 8)
+    return false;
+  Table.clear();
+  if (decodeProgram(Sections, Offset, AddressSize, Table))
+    return true;
+  Table.clear();
+  return false;
+}
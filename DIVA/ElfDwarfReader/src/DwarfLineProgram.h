@@ -0,0 +1,52 @@
+//===-- ElfDwarfReader/DwarfLineProgram.h -----------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains a decoder for DWARF line number programs that reads the
+/// .debug_line section directly, avoiding the per-row cost of libdwarf.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef DWARF_LINE_PROGRAM_H
+#define DWARF_LINE_PROGRAM_H
+
+#include "DebugSections.h"
+#include "LibDwarfHelpers.h"
+
+namespace ElfDwarfReader {
+
+/// \brief Decode the line number program at Offset in the .debug_line section
+/// of Sections, appending its rows to Table.
+///
+/// The rows are the same as libdwarf produces for the program. Returns false,
+/// leaving Table empty, if the program is malformed or uses a feature that
+/// only libdwarf handles (DWARF 5, VLIW operation indexes, nonstandard opcode
+/// lengths or files defined by DW_LNE_define_file), in which case the caller
+/// should read the table through libdwarf instead.
+bool decodeLineProgram(const DebugSections &Sections, uint64_t Offset,
+                       unsigned AddressSize, DwarfLineTable &Table);
+
+} // end namespace ElfDwarfReader
+
+#endif // DWARF_LINE_PROGRAM_H
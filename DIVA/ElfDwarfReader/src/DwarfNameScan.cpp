@@ -0,0 +1,488 @@
+//===-- ElfDwarfReader/DwarfNameScan.cpp ------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implementation of the scan that finds the compile
+/// units of an ELF file that a view filtered by name can leave unread.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfNameScan.h"
+#include "DebugSections.h"
+#include "DwarfLineProgram.h"
+#include "ElfDwarfReader.h"
+#include "FileUtilities.h"
+#include "Object.h"
+#include "Trace.h"
+#include "Utilities.h"
+
+// Disable some clang warnings for dwarf.h.
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wreserved-id-macro"
+#endif
+
+#include "dwarf.h"
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#include <algorithm>
+#include <memory>
+#include <unordered_set>
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+// Return true if an object can only be named Name by its DW_AT_name, or that
+// of a DIE it refers to. The names formulated for types, arrays and function
+// pointers have a space, or are a single qualifier, modifier or void, and
+// the names of subranges are in brackets.
+bool isScannableName(const std::string &Name) {
+  if (Name.empty() || Name.find_first_of(" *&[") != std::string::npos)
+    return false;
+  for (const char *Word : {"void", "const", "volatile", "restrict"})
+    if (Name == Word)
+      return false;
+  return true;
+}
+
+// What the reader creates for a DIE tag.
+struct TagInfo {
+  // False if no object is created for the tag.
+  bool Known = false;
+  // The length of the tag's name, which sets the width of --show-DWARF-tag.
+  size_t NameLength = 0;
+};
+
+TagInfo getTagInfo(uint64_t Tag) {
+  TagInfo Info;
+  if (!createObjectForAbbrevTag(Tag))
+    return Info;
+  Info.Known = true;
+  const char *TagName = "";
+  dwarf_get_TAG_name(static_cast<Dwarf_Half>(Tag), &TagName);
+  Info.NameLength = strlen(TagName);
+  return Info;
+}
+
+// The names being looked for, with the offsets of the strings in .debug_str
+// that are equal to one of them.
+class NameMatcher {
+public:
+  NameMatcher(const DebugSections &Sections,
+              const std::vector<std::string> &Names)
+      : Names(Names), Str(Sections.Str) {
+    // A string may be the tail of a longer one, so each name is found with
+    // its terminator wherever it is in the section.
+    for (const std::string &Name : Names) {
+      std::vector<uint8_t> Key(Name.begin(), Name.end());
+      Key.push_back(0);
+      for (auto IT = std::search(Str.begin(), Str.end(), Key.begin(),
+                                 Key.end());
+           IT != Str.end();
+           IT = std::search(IT + 1, Str.end(), Key.begin(), Key.end()))
+        StrOffsets.push_back(static_cast<uint64_t>(IT - Str.begin()));
+    }
+    std::sort(StrOffsets.begin(), StrOffsets.end());
+  }
+
+  // Match a DW_AT_name of Form, setting Matches to true if it is one of the
+  // names or can't be read here. Returns false if the form is unknown.
+  bool match(DataReader &Reader, const UnitHeader &Header, uint64_t Form,
+             bool IsUnitName, bool &Matches) const {
+    if (Form == DW_FORM_string) {
+      size_t Start = Reader.tell();
+      size_t Length = Reader.skipCString();
+      Matches |= matchString(
+          reinterpret_cast<const char *>(Reader.getData() + Start), Length,
+          IsUnitName);
+      return true;
+    }
+    if (Form == DW_FORM_strp) {
+      uint64_t Offset = Reader.readUnsigned(Header.OffsetSize);
+      if (!IsUnitName) {
+        Matches |= std::binary_search(StrOffsets.begin(), StrOffsets.end(),
+                                      Offset);
+      } else if (Offset < Str.size()) {
+        const char *Start = reinterpret_cast<const char *>(Str.data()) + Offset;
+        const void *End = memchr(Start, 0, Str.size() - Offset);
+        if (End)
+          Matches |= matchString(Start,
+                                 static_cast<size_t>(
+                                     static_cast<const char *>(End) - Start),
+                                 true);
+      }
+      return true;
+    }
+    // The string is in another section or file.
+    Matches = true;
+    return skipAttrValue(Reader, Header, Form);
+  }
+
+private:
+  // Compile unit names are file paths, which are made uniform when read.
+  bool matchString(const char *Chars, size_t Length, bool IsUnitName) const {
+    std::string Name(Chars, Length);
+    if (IsUnitName)
+      Name = LibScopeView::unifyFilePath(Name);
+    return std::find(Names.begin(), Names.end(), Name) != Names.end();
+  }
+
+  const std::vector<std::string> &Names;
+  const std::vector<uint8_t> &Str;
+  std::vector<uint64_t> StrOffsets;
+};
+
+// A DW_AT_specification, DW_AT_abstract_origin or DW_AT_extension, through
+// which the object of the DIE at Offset in unit Unit takes the name and line
+// of the object of the DIE at Target.
+struct NameReference {
+  uint64_t Target;
+  uint64_t Offset;
+  uint32_t Unit;
+};
+
+// What is found in one compile unit.
+struct UnitScan {
+  // The DIEs named one of the names, or with a name that can't be read here.
+  std::vector<uint64_t> Named;
+  std::vector<NameReference> References;
+  // The DIEs in other units that the DIEs of this unit refer to.
+  std::vector<uint64_t> OtherUnitTargets;
+  // The largest line number of an object that keeps its own line, and of any
+  // object before its references are resolved.
+  uint64_t KeptLine = 0;
+  uint64_t AnyLine = 0;
+  // The longest tag name of an object.
+  size_t TagLength = 0;
+  bool Complete = false;
+};
+
+// Read a reference as an offset in .debug_info, returning false if it isn't
+// to a DIE in .debug_info.
+bool readReference(DataReader &Reader, const UnitHeader &Header, uint64_t Form,
+                   uint64_t &Target) {
+  switch (Form) {
+  case DW_FORM_ref1:
+    Target = Header.Offset + Reader.readUnsigned(1);
+    return true;
+  case DW_FORM_ref2:
+    Target = Header.Offset + Reader.readUnsigned(2);
+    return true;
+  case DW_FORM_ref4:
+    Target = Header.Offset + Reader.readUnsigned(4);
+    return true;
+  case DW_FORM_ref8:
+    Target = Header.Offset + Reader.readUnsigned(8);
+    return true;
+  case DW_FORM_ref_udata:
+    Target = Header.Offset + Reader.readULEB128();
+    return true;
+  case DW_FORM_ref_addr:
+    Target = Reader.readUnsigned(Header.Version == 2 ? Header.AddressSize
+                                                     : Header.OffsetSize);
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Read an unsigned constant, returning false for other forms.
+bool readUnsignedConstant(DataReader &Reader, uint64_t Form, uint64_t &Value) {
+  switch (Form) {
+  case DW_FORM_data1:
+    Value = Reader.readUnsigned(1);
+    return true;
+  case DW_FORM_data2:
+    Value = Reader.readUnsigned(2);
+    return true;
+  case DW_FORM_data4:
+    Value = Reader.readUnsigned(4);
+    return true;
+  case DW_FORM_data8:
+    Value = Reader.readUnsigned(8);
+    return true;
+  case DW_FORM_udata:
+    Value = Reader.readULEB128();
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Scan one compile unit, returning false if it can't all be scanned.
+bool scanUnit(const DebugSections &Sections, const UnitHeader &Header,
+              uint32_t UnitIndex, const ScanAbbreviationTable &Table,
+              const std::vector<TagInfo> &Tags, const NameMatcher &Matcher,
+              UnitScan &Scan) {
+  // The number of DIEs whose children are being scanned.
+  size_t OpenDIEs = 0;
+  bool IsUnitDIE = true;
+  bool HasLines = false;
+  uint64_t LineOffset = 0;
+
+  DataReader Reader(Sections.Info, Sections.BigEndian);
+  Reader.seek(Header.DIEsOffset);
+  while (Reader.tell() < Header.NextOffset) {
+    uint64_t Offset = Reader.tell();
+    uint64_t Code = Reader.readULEB128();
+    if (Code == 0) {
+      // The end of a list of children, or padding after the unit DIE.
+      if (OpenDIEs)
+        --OpenDIEs;
+      continue;
+    }
+    if (Code >= Table.ByCode.size() || !Table.ByCode[Code].Abbrev)
+      return false;
+    const ScanAbbreviationTable::Entry &Entry = Table.ByCode[Code];
+    const TagInfo &Tag = Tags[Entry.TagIndex];
+    // DIEs whose tags aren't read are left to the full read, which warns
+    // about them.
+    if (!Tag.Known)
+      return false;
+    Scan.TagLength = std::max(Scan.TagLength, Tag.NameLength);
+
+    bool Named = false;
+    bool HasReference = false;
+    uint64_t Line = 0;
+    for (const auto &AttrForm : Entry.Abbrev->AttrForms) {
+      uint64_t Attr = AttrForm.first;
+      uint64_t Form = AttrForm.second;
+      if (Attr == DW_AT_name) {
+        if (!Matcher.match(Reader, Header, Form, IsUnitDIE, Named))
+          return false;
+      } else if (Attr == DW_AT_decl_line) {
+        if (!readUnsignedConstant(Reader, Form, Line))
+          return false;
+      } else if (Attr == DW_AT_type || Attr == DW_AT_import ||
+                 Attr == DW_AT_specification ||
+                 Attr == DW_AT_abstract_origin || Attr == DW_AT_extension) {
+        uint64_t Target = 0;
+        if (!readReference(Reader, Header, Form, Target))
+          return false;
+        if (Target < Header.Offset || Target >= Header.NextOffset)
+          Scan.OtherUnitTargets.push_back(Target);
+        if (Attr != DW_AT_type && Attr != DW_AT_import) {
+          HasReference = true;
+          Scan.References.push_back({Target, Offset, UnitIndex});
+        }
+      } else if (IsUnitDIE && Attr == DW_AT_stmt_list) {
+        if (Form != DW_FORM_data4 && Form != DW_FORM_data8 &&
+            Form != DW_FORM_sec_offset)
+          return false;
+        HasLines = true;
+        LineOffset = Reader.readUnsigned(Form == DW_FORM_data4
+                                             ? 4
+                                             : Form == DW_FORM_data8
+                                                   ? 8
+                                                   : Header.OffsetSize);
+      } else if (!skipAttrValue(Reader, Header, Form)) {
+        return false;
+      }
+    }
+    if (Reader.failed())
+      return false;
+
+    if (Named)
+      Scan.Named.push_back(Offset);
+    Scan.AnyLine = std::max(Scan.AnyLine, Line);
+    if (!HasReference)
+      Scan.KeptLine = std::max(Scan.KeptLine, Line);
+    if (Entry.Abbrev->HasChildren)
+      ++OpenDIEs;
+    IsUnitDIE = false;
+  }
+  if (Reader.failed() || Reader.tell() != Header.NextOffset || OpenDIEs)
+    return false;
+
+  if (HasLines) {
+    DwarfLineTable LineTable;
+    if (!decodeLineProgram(Sections, LineOffset, Header.AddressSize,
+                           LineTable))
+      return false;
+    for (size_t Row = 0; Row < LineTable.size(); ++Row)
+      Scan.KeptLine = std::max<uint64_t>(Scan.KeptLine,
+                                         LineTable.getLineNo(Row));
+    Scan.AnyLine = std::max(Scan.AnyLine, Scan.KeptLine);
+  }
+  Scan.Complete = true;
+  return true;
+}
+
+size_t getDigitCount(uint64_t Value) { return std::to_string(Value).size(); }
+
+} // end anonymous namespace
+
+bool ElfDwarfReader::scanUnitsToSkip(const std::string &FileName,
+                                     const std::vector<std::string> &Names,
+                                     std::vector<uint64_t> &UnitsToSkip,
+                                     unsigned ThreadCount) {
+  if (Names.empty() ||
+      !std::all_of(Names.begin(), Names.end(), isScannableName))
+    return false;
+
+  LibScopeView::TraceSpan Span("ScanNames");
+  DebugSections Sections;
+  std::vector<UnitHeader> Headers;
+  if (!readDebugSections(FileName,
+                         DebugSections::InfoSection |
+                             DebugSections::AbbrevSection |
+                             DebugSections::StrSection |
+                             DebugSections::LineSection,
+                         Sections) ||
+      !readUnitHeaders(Sections, Headers) || Headers.size() < 2)
+    return false;
+  // The unit headers and line program offsets of a relocatable file are only
+  // correct once relocated.
+  if (Sections.RelocatedSections & DebugSections::InfoSection)
+    return false;
+
+  // Read each abbreviation table and look up its tags up front, so that the
+  // units can be scanned in parallel.
+  ScanAbbreviations Abbrevs;
+  if (!readScanAbbreviations(Sections, Headers, Abbrevs))
+    return false;
+  std::vector<TagInfo> Tags;
+  for (uint64_t Tag : Abbrevs.Tags)
+    Tags.push_back(getTagInfo(Tag));
+
+  NameMatcher Matcher(Sections, Names);
+  std::vector<UnitScan> Units(Headers.size());
+  LibScopeView::runInParallel(Headers.size(), ThreadCount, [&](size_t I) {
+    scanUnit(Sections, Headers[I], static_cast<uint32_t>(I),
+             *Abbrevs.UnitTables[I], Tags, Matcher, Units[I]);
+  });
+  for (const UnitScan &Unit : Units)
+    if (!Unit.Complete)
+      return false;
+
+  // Read a unit and the units it refers to, so that the objects it reads
+  // have the same types and references as when the whole file is read.
+  std::vector<bool> Read(Headers.size());
+  auto ReadUnit = [&](size_t First) {
+    std::vector<size_t> Pending(1, First);
+    while (!Pending.empty()) {
+      size_t I = Pending.back();
+      Pending.pop_back();
+      if (Read[I])
+        continue;
+      Read[I] = true;
+      for (uint64_t Target : Units[I].OtherUnitTargets) {
+        auto IT = std::upper_bound(Headers.begin(), Headers.end(), Target,
+                                   [](uint64_t Value, const UnitHeader &H) {
+                                     return Value < H.Offset;
+                                   });
+        if (IT != Headers.begin() && Target < std::prev(IT)->NextOffset)
+          Pending.push_back(
+              static_cast<size_t>(std::prev(IT) - Headers.begin()));
+      }
+    }
+  };
+
+  // Find the DIEs that take one of the names from the DIEs they refer to.
+  std::vector<NameReference> References;
+  std::vector<uint64_t> Pending;
+  std::vector<size_t> NamedUnits;
+  for (size_t I = 0; I < Units.size(); ++I) {
+    References.insert(References.end(), Units[I].References.begin(),
+                      Units[I].References.end());
+    Pending.insert(Pending.end(), Units[I].Named.begin(),
+                   Units[I].Named.end());
+    if (!Units[I].Named.empty())
+      NamedUnits.push_back(I);
+    std::vector<NameReference>().swap(Units[I].References);
+  }
+  std::sort(References.begin(), References.end(),
+            [](const NameReference &A, const NameReference &B) {
+              return A.Target < B.Target;
+            });
+  std::unordered_set<uint64_t> Seen(Pending.begin(), Pending.end());
+  while (!Pending.empty()) {
+    uint64_t Target = Pending.back();
+    Pending.pop_back();
+    auto IT = std::lower_bound(References.begin(), References.end(), Target,
+                               [](const NameReference &R, uint64_t Value) {
+                                 return R.Target < Value;
+                               });
+    for (; IT != References.end() && IT->Target == Target; ++IT) {
+      if (!Seen.insert(IT->Offset).second)
+        continue;
+      NamedUnits.push_back(IT->Unit);
+      Pending.push_back(IT->Offset);
+    }
+  }
+  for (size_t I : NamedUnits)
+    ReadUnit(I);
+
+  // A file with no units read warns that it has no debug data, so the
+  // smallest unit is read if no unit has one of the names.
+  if (NamedUnits.empty()) {
+    size_t Smallest = 0;
+    for (size_t I = 1; I < Headers.size(); ++I)
+      if (Headers[I].NextOffset - Headers[I].Offset <
+          Headers[Smallest].NextOffset - Headers[Smallest].Offset)
+        Smallest = I;
+    ReadUnit(Smallest);
+  }
+
+  // Read the units that hold the widest line number or tag name, while those
+  // of the unread units are wider than those of the units read. Only a line
+  // that isn't replaced by that of a reference is sure to be read.
+  for (;;) {
+    uint64_t ReadLine = 0, SkippedLine = 0;
+    size_t ReadTag = 0, SkippedTag = 0;
+    size_t LineUnit = 0, TagUnit = 0;
+    for (size_t I = 0; I < Units.size(); ++I) {
+      const UnitScan &Unit = Units[I];
+      if (Read[I]) {
+        ReadLine = std::max(ReadLine, Unit.KeptLine);
+        ReadTag = std::max(ReadTag, Unit.TagLength);
+        continue;
+      }
+      SkippedLine = std::max(SkippedLine, Unit.AnyLine);
+      SkippedTag = std::max(SkippedTag, Unit.TagLength);
+      if (Read[LineUnit] || Unit.KeptLine > Units[LineUnit].KeptLine)
+        LineUnit = I;
+      if (Read[TagUnit] || Unit.TagLength > Units[TagUnit].TagLength)
+        TagUnit = I;
+    }
+    if (getDigitCount(SkippedLine) > getDigitCount(ReadLine)) {
+      if (getDigitCount(Units[LineUnit].KeptLine) < getDigitCount(SkippedLine))
+        return false;
+      ReadUnit(LineUnit);
+    } else if (SkippedTag > ReadTag) {
+      ReadUnit(TagUnit);
+    } else {
+      break;
+    }
+  }
+
+  for (size_t I = 0; I < Headers.size(); ++I)
+    if (!Read[I])
+      UnitsToSkip.push_back(Headers[I].Offset);
+  return true;
+}
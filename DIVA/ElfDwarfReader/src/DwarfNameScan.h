@@ -0,0 +1,65 @@
+//===-- ElfDwarfReader/DwarfNameScan.h --------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file declares the scan that finds the compile units of an ELF file
+/// that a view filtered by name can leave unread.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef DWARF_NAME_SCAN_H
+#define DWARF_NAME_SCAN_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ElfDwarfReader {
+
+/// \brief Find the compile units of an ELF file that don't need to be read
+/// to print the text view of only the objects named one of Names.
+///
+/// The DIEs of each unit are skipped over in .debug_info, on up to
+/// ThreadCount threads (0 for one per hardware thread), to find the units
+/// with a DIE named one of Names, directly or through the DIEs it refers to
+/// with DW_AT_specification, DW_AT_abstract_origin or DW_AT_extension. Those
+/// units are read, with the units that they refer to. So that the columns of
+/// the view are as wide as when the whole file is read, units are also read
+/// that hold as large a line number and DWARF tag name as those that are
+/// left unread. The header offsets of the other units are added to
+/// UnitsToSkip.
+///
+/// Returns false, leaving UnitsToSkip unchanged, if every unit must be read:
+/// if a name might be formulated rather than read from DW_AT_name (such as
+/// "const int" or "[4]"), if the file isn't ELF, its debug sections are
+/// compressed, a unit uses DWARF that can't be skipped or a tag that isn't
+/// read, or its line programs can only be read through libdwarf.
+bool scanUnitsToSkip(const std::string &FileName,
+                     const std::vector<std::string> &Names,
+                     std::vector<uint64_t> &UnitsToSkip,
+                     unsigned ThreadCount = 0);
+
+} // end namespace ElfDwarfReader
+
+#endif // DWARF_NAME_SCAN_H
@@ -0,0 +1,254 @@
+//===-- ElfDwarfReader/DwarfSummaryScan.cpp ---------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implementation of the scan that counts the objects
+/// of a summary table straight from the DWARF of an ELF file.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfSummaryScan.h"
+#include "DebugSections.h"
+#include "DwarfLineProgram.h"
+#include "Line.h"
+#include "PrintSettings.h"
+#include "Scope.h"
+#include "SummaryTable.h"
+#include "Trace.h"
+#include "Type.h"
+#include "Utilities.h"
+
+// Disable some clang warnings for dwarf.h.
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wreserved-id-macro"
+#endif
+
+#include "dwarf.h"
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#include <memory>
+
+using namespace ElfDwarfReader;
+using LibScopeView::SummaryTable;
+
+namespace {
+
+// How the objects created from a DIE tag are counted.
+struct TagClass {
+  // False if no object is created for the tag.
+  bool Known = false;
+  // The object is a Scope, which is printed as a template if it has template
+  // parameters.
+  bool IsScope = false;
+  // The object is a template parameter, which makes a Scope parent a
+  // template.
+  bool IsTemplateParam = false;
+  SummaryTable::RowKind Row = SummaryTable::RowCount;
+  bool Printed = false;
+  bool PrintedAsTemplate = false;
+};
+
+// Classify a tag from the object the reader creates for it, so that the
+// objects are counted exactly as SummaryTable counts the tree.
+TagClass classifyTag(uint64_t Tag,
+                     const LibScopeView::PrintSettings *Settings) {
+  TagClass Class;
+  std::unique_ptr<LibScopeView::Object> Obj(createObjectForAbbrevTag(Tag));
+  if (!Obj)
+    return Class;
+  Class.Known = true;
+  Class.Row = SummaryTable::getRowKind(*Obj);
+  Class.Printed = !Settings || Settings->printObject(*Obj);
+  Class.PrintedAsTemplate = Class.Printed;
+  if (auto *Scp = LibScopeView::dyn_cast<LibScopeView::Scope>(Obj.get())) {
+    Class.IsScope = true;
+    Scp->setIsTemplate();
+    Class.PrintedAsTemplate = !Settings || Settings->printObject(*Scp);
+  }
+  Class.IsTemplateParam =
+      LibScopeView::isa<LibScopeView::TypeTemplateParam>(*Obj) ||
+      LibScopeView::isa<LibScopeView::ScopeTemplatePack>(*Obj);
+  return Class;
+}
+
+// The counts of one compile unit.
+struct UnitCounts {
+  SummaryTable Table;
+  uint64_t DIECount = 0;
+  bool Complete = false;
+};
+
+// Count the objects of one compile unit, returning false if they can't all
+// be counted.
+bool scanUnit(const DebugSections &Sections, const UnitHeader &Header,
+              const ScanAbbreviationTable &Table,
+              const std::vector<TagClass> &Classes, const TagClass &LineClass,
+              UnitCounts &Counts) {
+  auto Count = [&Counts](const TagClass &Class, bool IsTemplate) {
+    if (Class.Row != SummaryTable::RowCount)
+      Counts.Table.addObjects(
+          Class.Row, 1, IsTemplate ? Class.PrintedAsTemplate : Class.Printed);
+  };
+
+  // The scopes whose children are being scanned, which are only counted once
+  // it is known whether they are templates.
+  struct OpenScope {
+    const TagClass *Class;
+    bool IsTemplate;
+  };
+  std::vector<OpenScope> OpenScopes;
+  bool HasLines = false;
+  uint64_t LineOffset = 0;
+
+  DataReader Reader(Sections.Info, Sections.BigEndian);
+  Reader.seek(Header.DIEsOffset);
+  while (Reader.tell() < Header.NextOffset) {
+    uint64_t Code = Reader.readULEB128();
+    if (Code == 0) {
+      // The end of a list of children, or padding after the unit DIE.
+      if (!OpenScopes.empty()) {
+        Count(*OpenScopes.back().Class, OpenScopes.back().IsTemplate);
+        OpenScopes.pop_back();
+      }
+      continue;
+    }
+    if (Code >= Table.ByCode.size() || !Table.ByCode[Code].Abbrev)
+      return false;
+    const ScanAbbreviationTable::Entry &Entry = Table.ByCode[Code];
+    const TagClass &Class = Classes[Entry.TagIndex];
+    // DIEs whose tags aren't read are left to the full read, which warns
+    // about them.
+    if (!Class.Known)
+      return false;
+
+    bool IsUnitDIE = Counts.DIECount++ == 0;
+    for (const auto &AttrForm : Entry.Abbrev->AttrForms) {
+      if (IsUnitDIE && AttrForm.first == DW_AT_stmt_list) {
+        if (AttrForm.second != DW_FORM_data4 &&
+            AttrForm.second != DW_FORM_data8 &&
+            AttrForm.second != DW_FORM_sec_offset)
+          return false;
+        HasLines = true;
+        LineOffset = Reader.readUnsigned(
+            AttrForm.second == DW_FORM_data4
+                ? 4
+                : AttrForm.second == DW_FORM_data8 ? 8 : Header.OffsetSize);
+      } else if (!skipAttrValue(Reader, Header, AttrForm.second)) {
+        return false;
+      }
+    }
+    if (Reader.failed())
+      return false;
+
+    if (Class.IsTemplateParam && !OpenScopes.empty() &&
+        OpenScopes.back().Class->IsScope)
+      OpenScopes.back().IsTemplate = true;
+    if (Entry.Abbrev->HasChildren)
+      OpenScopes.push_back({&Class, false});
+    else
+      Count(Class, false);
+  }
+  if (Reader.failed() || Reader.tell() != Header.NextOffset ||
+      !OpenScopes.empty())
+    return false;
+
+  if (HasLines) {
+    DwarfLineTable LineTable;
+    if (!decodeLineProgram(Sections, LineOffset, Header.AddressSize,
+                           LineTable))
+      return false;
+    Counts.Table.addObjects(LineClass.Row, LineTable.size(),
+                            LineClass.Printed ? LineTable.size() : 0);
+  }
+  Counts.Complete = true;
+  return true;
+}
+
+} // end anonymous namespace
+
+bool ElfDwarfReader::scanSummaryTable(
+    const std::string &FileName, const LibScopeView::PrintSettings *Settings,
+    SummaryTable &Table, unsigned ThreadCount) {
+  // Whether an object is global is only known once the references are
+  // resolved.
+  if (Settings && (Settings->ShowOnlyGlobals || Settings->ShowOnlyLocals))
+    return false;
+
+  LibScopeView::TraceSpan Span("ScanObjects");
+  DebugSections Sections;
+  std::vector<UnitHeader> Headers;
+  if (!readDebugSections(FileName,
+                         DebugSections::InfoSection |
+                             DebugSections::AbbrevSection |
+                             DebugSections::LineSection,
+                         Sections) ||
+      !readUnitHeaders(Sections, Headers) || Headers.empty())
+    return false;
+  // The unit headers and line program offsets of a relocatable file are only
+  // correct once relocated, unless there is a single unit at offset zero.
+  if ((Sections.RelocatedSections & DebugSections::InfoSection) &&
+      Headers.size() > 1)
+    return false;
+
+  // Read each abbreviation table and classify its tags up front, so that the
+  // units can be scanned in parallel.
+  ScanAbbreviations Abbrevs;
+  if (!readScanAbbreviations(Sections, Headers, Abbrevs))
+    return false;
+  std::vector<TagClass> Classes;
+  for (uint64_t Tag : Abbrevs.Tags)
+    Classes.push_back(classifyTag(Tag, Settings));
+  TagClass LineClass;
+  {
+    LibScopeView::Line Ln;
+    LineClass.Row = SummaryTable::getRowKind(Ln);
+    LineClass.Printed = !Settings || Settings->printObject(Ln);
+  }
+
+  std::vector<UnitCounts> Units(Headers.size());
+  LibScopeView::runInParallel(Headers.size(), ThreadCount, [&](size_t I) {
+    scanUnit(Sections, Headers[I], *Abbrevs.UnitTables[I], Classes, LineClass,
+             Units[I]);
+  });
+
+  SummaryTable FileTable;
+  uint64_t DIECount = 0;
+  for (const UnitCounts &Unit : Units) {
+    if (!Unit.Complete)
+      return false;
+    FileTable.add(Unit.Table);
+    DIECount += Unit.DIECount;
+  }
+  Table.add(FileTable);
+
+  if (LibScopeView::Tracer *ActiveTracer = LibScopeView::getActiveTracer()) {
+    ActiveTracer->addCounter("DIEs", DIECount);
+    ActiveTracer->addCounter("CUsScanned", Units.size());
+  }
+  return true;
+}
@@ -0,0 +1,63 @@
+//===-- ElfDwarfReader/DwarfSummaryScan.h -----------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file declares the scan that counts the objects of a summary table
+/// straight from the DWARF of an ELF file.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef DWARF_SUMMARY_SCAN_H
+#define DWARF_SUMMARY_SCAN_H
+
+#include <string>
+
+namespace LibScopeView {
+class PrintSettings;
+class SummaryTable;
+} // namespace LibScopeView
+
+namespace ElfDwarfReader {
+
+/// \brief Add the objects that reading an ELF file would create to Table, as
+/// if it were the SummaryTable of the file's tree, without creating them.
+///
+/// The DIEs of each compile unit are classified by their tags as they are
+/// skipped over in .debug_info, with the units scanned on up to ThreadCount
+/// threads (0 for one per hardware thread), and the code lines are counted
+/// from .debug_line. Settings are used as for SummaryTable, except that
+/// --show-only-globals and --show-only-locals need the full read.
+///
+/// Returns false, leaving Table unchanged, if the file must be read instead:
+/// if it isn't ELF, its debug sections are compressed, a unit uses DWARF
+/// that can't be skipped or a tag that isn't read, or its line programs can
+/// only be read through libdwarf.
+bool scanSummaryTable(const std::string &FileName,
+                      const LibScopeView::PrintSettings *Settings,
+                      LibScopeView::SummaryTable &Table,
+                      unsigned ThreadCount = 0);
+
+} // end namespace ElfDwarfReader
+
+#endif // DWARF_SUMMARY_SCAN_H
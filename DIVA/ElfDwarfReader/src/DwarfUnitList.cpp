@@ -0,0 +1,140 @@
+//===-- ElfDwarfReader/DwarfUnitList.cpp ------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements the listing of the compile units of an ELF file
+/// from the unit headers and root DIEs.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfUnitList.h"
+#include "Error.h"
+#include "FileUtilities.h"
+#include "LibDwarfHelpers.h"
+#include "SplitDwarf.h"
+
+#include <memory>
+#include <sstream>
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+// Get a string attribute of Die, or an empty string if it doesn't have one.
+std::string getStringAttr(const DwarfDie &Die, Dwarf_Half Attr) {
+  DwarfAttrValue Value = Die.getAttr(Attr);
+  if (Value.getKind() != DwarfAttrValueKind::String)
+    return std::string();
+  return Value.getString();
+}
+
+// Get the name of the DW_AT_language of Die, in hexadecimal if it isn't
+// known, or an empty string if it doesn't have one.
+std::string getLanguage(const DwarfDie &Die) {
+  DwarfAttrValue Value = Die.getAttr(DW_AT_language);
+  if (Value.getKind() != DwarfAttrValueKind::Unsigned)
+    return std::string();
+  const char *Name = nullptr;
+  if (dwarf_get_LANG_name(static_cast<unsigned>(Value.getUnsigned()),
+                          &Name) == DW_DLV_OK)
+    return Name;
+  std::stringstream Hex;
+  Hex << "0x" << std::hex << Value.getUnsigned();
+  return Hex.str();
+}
+
+// List the compile units of DebugData. The split units of any skeleton
+// units are looked for next to FileName if FindSplitUnits is true.
+std::vector<CompileUnitListing> listUnits(const std::string &FileName,
+                                          const DwarfDebugData &DebugData,
+                                          bool FindSplitUnits) {
+  std::vector<DwarfCompileUnit> CompileUnits(DebugData.getCompileUnits());
+  std::unique_ptr<SplitDwarf> Split;
+  if (FindSplitUnits)
+    Split = std::make_unique<SplitDwarf>(FileName, CompileUnits);
+
+  std::vector<CompileUnitListing> Result(CompileUnits.size());
+  for (size_t I = 0; I < CompileUnits.size(); ++I) {
+    const DwarfCompileUnit &CU = CompileUnits[I];
+    CompileUnitListing &Unit = Result[I];
+    Unit.Offset = CU.HeaderOffset;
+    Unit.Size = CU.NextHeaderOffset - CU.HeaderOffset;
+    Unit.Version = CU.Version;
+    Unit.Name = CU.CUDie.getName();
+    Unit.Producer = getStringAttr(CU.CUDie, DW_AT_producer);
+    Unit.Language = getLanguage(CU.CUDie);
+
+    // A skeleton may leave its attributes to the split unit.
+    const DwarfCompileUnit *SplitCU =
+        Split ? Split->getSplitUnit(I).Unit : nullptr;
+    if (!SplitCU)
+      continue;
+    if (Unit.Name.empty())
+      Unit.Name = SplitCU->CUDie.getName();
+    if (Unit.Producer.empty())
+      Unit.Producer = getStringAttr(SplitCU->CUDie, DW_AT_producer);
+    if (Unit.Language.empty())
+      Unit.Language = getLanguage(SplitCU->CUDie);
+  }
+  return Result;
+}
+
+} // end anonymous namespace
+
+std::vector<CompileUnitListing>
+ElfDwarfReader::listCompileUnits(const std::string &FileName) {
+  try {
+    LibScopeView::FileDescriptor FD(FileName);
+    DwarfDebugData DebugData(FD.get());
+    return listUnits(FileName, DebugData, /*FindSplitUnits*/ true);
+  } catch (LibDwarfError &) {
+    LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_INVALID_DWARF,
+                              FileName);
+  }
+}
+
+std::vector<CompileUnitListing>
+ElfDwarfReader::listCompileUnits(const std::string &FileName, char *Image,
+                                 size_t Size) {
+  try {
+    DwarfDebugData DebugData(Image, Size);
+    return listUnits(FileName, DebugData, /*FindSplitUnits*/ false);
+  } catch (LibDwarfError &) {
+    LibScopeError::fatalError(LibScopeError::ErrorCode::ERR_INVALID_DWARF,
+                              FileName);
+  }
+}
+
+bool ElfDwarfReader::matchesCompileUnitName(
+    const std::vector<std::string> &Patterns, const std::string &Name) {
+  std::string UnifiedName(LibScopeView::unifyFilePath(Name));
+  std::string FileName(LibScopeView::getFileName(UnifiedName));
+  for (const std::string &RawPattern : Patterns) {
+    std::string Pattern(LibScopeView::unifyFilePath(RawPattern));
+    bool MatchPath = Pattern.find('/') != std::string::npos;
+    if (LibScopeView::matchGlob(Pattern, MatchPath ? UnifiedName : FileName))
+      return true;
+  }
+  return false;
+}
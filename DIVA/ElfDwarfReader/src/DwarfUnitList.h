@@ -0,0 +1,71 @@
+//===-- ElfDwarfReader/DwarfUnitList.h --------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file declares the listing of the compile units of an ELF file from
+/// the unit headers and root DIEs.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef DWARF_UNIT_LIST_H
+#define DWARF_UNIT_LIST_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ElfDwarfReader {
+
+/// \brief A compile unit as described by its header and root DIE. Language
+/// is the name of its DW_AT_language (e.g. DW_LANG_C_plus_plus), and Size is
+/// the size of the unit in .debug_info, header included.
+struct CompileUnitListing {
+  uint64_t Offset;
+  uint64_t Size;
+  unsigned Version;
+  std::string Name;
+  std::string Producer;
+  std::string Language;
+};
+
+/// \brief List the compile units of an ELF file, reading only the header and
+/// root DIE of each. The name, producer and language of a skeleton unit
+/// missing them are read from its split unit.
+std::vector<CompileUnitListing> listCompileUnits(const std::string &FileName);
+
+/// \brief List the compile units of the ELF object in memory at Image, such
+/// as a member of a static archive, as for listCompileUnits. FileName is only
+/// used for errors. The image must be writable.
+std::vector<CompileUnitListing> listCompileUnits(const std::string &FileName,
+                                                 char *Image, size_t Size);
+
+/// \brief Return true if the compile unit named Name matches one of Patterns,
+/// globs as for LibScopeView::matchGlob. A pattern is matched against the
+/// file name of the unit, or its whole name if the pattern has a '/'.
+bool matchesCompileUnitName(const std::vector<std::string> &Patterns,
+                            const std::string &Name);
+
+} // end namespace ElfDwarfReader
+
+#endif // DWARF_UNIT_LIST_H
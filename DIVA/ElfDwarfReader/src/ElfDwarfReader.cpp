@@ -29,15 +29,22 @@
 //===----------------------------------------------------------------------===//
 
 #include "ElfDwarfReader.h"
+#include "DwarfLineProgram.h"
+#include "DwarfNameScan.h"
+#include "DwarfUnitList.h"
 #include "Error.h"
 #include "FileUtilities.h"
 #include "LibDwarfHelpers.h"
 #include "Line.h"
+#include "SplitDwarf.h"
 #include "Symbol.h"
+#include "Trace.h"
 #include "Type.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <sstream>
 
 using namespace ElfDwarfReader;
@@ -103,6 +110,17 @@ void addObjectReference(LibScopeView::Object *Obj,
   }
 }
 
+// Set the type or reference of Obj to Target, from a type unit. Type units
+// are always another unit, so Target is marked as global.
+void linkToTypeUnit(LibScopeView::Object &Obj, LibScopeView::Object &Target,
+                    bool IsType) {
+  if (IsType)
+    Obj.setType(&Target);
+  else
+    addObjectReference(&Obj, &Target);
+  Target.setIsGlobalReference();
+}
+
 // Write the Str to Out, unless it is empty then write Val as hex.
 //
 // Used when printing DWARF codes.
@@ -116,15 +134,65 @@ void writeStringOrHex(std::ostream &Out, const std::string Str,
 
 } // end anonymous namespace
 
+DwarfReader::DwarfReader()
+    : MapsOwner([this](LibScopeView::MemoryOwnerBytes &OwnerBytes) {
+        addMapBytes(OwnerBytes);
+      }) {}
+
 std::unique_ptr<LibScopeView::ScopeRoot>
 DwarfReader::createScopes(const std::string &FileName) {
   auto Root = std::make_unique<LibScopeView::ScopeRoot>();
   Root->setName(FileName.c_str());
-
-  LibScopeView::FileDescriptor FD(FileName);
+  LibScopeView::MemoryOwner TreeOwner(
+      [&Root](LibScopeView::MemoryOwnerBytes &OwnerBytes) {
+        LibScopeView::addObjectTreeBytes(*Root, OwnerBytes);
+      });
+
+  std::unique_ptr<LibScopeView::FileDescriptor> FD;
+  if (!MemoryImage) {
+    {
+      LibScopeView::TraceSpan Span("OpenFile");
+      FD = std::make_unique<LibScopeView::FileDescriptor>(FileName);
+    }
+    if (!IncrementalStateFile.empty()) {
+      LibScopeView::TraceSpan Span("FingerprintCUs");
+      Fingerprints = fingerprintCompileUnits(FileName);
+    }
+    if (!NameFilter.empty() && AddressFilter.empty() &&
+        !scanUnitsToSkip(FileName, NameFilter, UnitsWithoutNames))
+      UnitsWithoutNames.clear();
+    // The line tables of a relocatable file are only correct once libdwarf
+    // has applied the relocations, so they are left to libdwarf. That is
+    // always the case for the objects of an archive held in memory.
+    LibScopeView::TraceSpan Span("ReadLineSection");
+    UseLineSections =
+        readDebugSections(FileName, DebugSections::LineSection,
+                          LineSections) &&
+        !(LineSections.RelocatedSections & DebugSections::LineSection);
+    if (!UseLineSections)
+      LineSections = DebugSections();
+  }
   try {
-    const DwarfDebugData DebugData(FD.get());
-    createCompileUnits(DebugData, *Root);
+    // libdwarf's allocations can't be measured directly, so it is charged
+    // with the heap growth that no other owner accounts for while the file is
+    // open.
+    LibScopeView::UnattributedMemoryOwner DwarfOwner("LibDwarf");
+    std::unique_ptr<const DwarfDebugData> DebugData;
+    {
+      LibScopeView::TraceSpan Span("DwarfInit");
+      DebugData = MemoryImage ? std::make_unique<const DwarfDebugData>(
+                                    MemoryImage, MemoryImageSize)
+                              : std::make_unique<const DwarfDebugData>(
+                                    FD->get());
+    }
+    LibScopeView::sampleMemory("DwarfInit");
+    createCompileUnits(FileName, *DebugData, *Root);
+    LibScopeView::sampleMemory("ReadDIEs");
+    {
+      LibScopeView::TraceSpan Span("DwarfFinish");
+      DebugData.reset();
+    }
+    LibScopeView::sampleMemory("DwarfFinish");
   } catch (LibDwarfError &Err) {
 #ifndef NDEBUG
     std::cerr << Err.getErrorMessage();
@@ -135,37 +203,466 @@ DwarfReader::createScopes(const std::string &FileName) {
                               FileName);
   }
 
-  if (Root->getChildren().empty())
+  LineSections = DebugSections();
+  UseLineSections = false;
+
+  // Units skipped by a filter aren't missing.
+  if (Root->getChildren().empty() && SkippedCUCount == 0)
     LibScopeError::warning("No DWARF debug data found.");
 
+  if (LibScopeView::Tracer *ActiveTracer = LibScopeView::getActiveTracer()) {
+    ActiveTracer->addCounter("DIEs", DIECount);
+    ActiveTracer->addCounter("AttributesDecoded", AttributeCount);
+    ActiveTracer->addCounter("LineTablesDecoded", DecodedLineTableCount);
+    if (!AddressFilter.empty() || !NameFilter.empty() ||
+        !CompileUnitFilter.empty())
+      ActiveTracer->addCounter("CUsSkipped", SkippedCUCount);
+    if (!IncrementalStateFile.empty())
+      ActiveTracer->addCounter("CUsReused", ReusedCUCount);
+  }
+
   return Root;
 }
 
-void DwarfReader::createCompileUnits(const DwarfDebugData &DebugData,
+void DwarfReader::createCompileUnits(const std::string &FileName,
+                                     const DwarfDebugData &DebugData,
                                      LibScopeView::ScopeRoot &Root) {
-  for (const auto &CU : DebugData.getCompileUnits()) {
+  std::vector<DwarfCompileUnit> CompileUnits;
+  std::vector<DwarfCompileUnit> TypeUnits;
+  {
+    LibScopeView::TraceSpan Span("ReadCUHeaders");
+    CompileUnits = DebugData.getCompileUnits();
+    TypeUnits = DebugData.getTypeUnits();
+  }
+  // The links to type units can't be saved, so a file with type units is
+  // always read in full.
+  if (!TypeUnits.empty())
+    Fingerprints.clear();
+  // The split units of any skeleton units are found and opened first. Their
+  // DIEs aren't seen by the fingerprints or the name scan, so every unit is
+  // read.
+  std::unique_ptr<SplitDwarf> Split;
+  {
+    LibScopeView::TraceSpan Span("ReadSplitDwarf");
+    Split = std::make_unique<SplitDwarf>(FileName, CompileUnits);
+  }
+  if (!Split->empty()) {
+    Fingerprints.clear();
+    UnitsWithoutNames.clear();
+  }
+  std::set<Dwarf_Off> CUsToSkip(getCompileUnitsToSkip(DebugData));
+  // The units that don't match the CompileUnitFilter are skipped by their
+  // header, and the DIEs that the others reference in them are read later.
+  // The offsets of split units are in their own files, so their links are
+  // never followed into the skipped units.
+  if (!CompileUnitFilter.empty()) {
+    for (size_t I = 0; I < CompileUnits.size(); ++I) {
+      const DwarfCompileUnit &CU = CompileUnits[I];
+      std::string Name(CU.CUDie.getName());
+      SplitDwarf::SplitUnit SplitCU = Split->getSplitUnit(I);
+      if (Name.empty() && SplitCU.Unit)
+        Name = SplitCU.Unit->CUDie.getName();
+      if (matchesCompileUnitName(CompileUnitFilter, Name))
+        continue;
+      CUsToSkip.insert(CU.HeaderOffset);
+      if (Split->empty())
+        FilteredUnitRanges.emplace_back(CU.HeaderOffset, CU.NextHeaderOffset);
+    }
+  }
+  std::vector<const CompileUnitState *> ReusableUnits(
+      getReusableUnits(CompileUnits));
+  std::vector<const LibScopeView::Object *> UnitObjects(CompileUnits.size());
+  for (size_t I = 0; I < CompileUnits.size(); ++I) {
+    const auto &CU = CompileUnits[I];
+    if (CUsToSkip.count(CU.HeaderOffset)) {
+      ++SkippedCUCount;
+      continue;
+    }
     CurrentCURange = std::make_pair(CU.HeaderOffset, CU.NextHeaderOffset);
-    SourceFileMapping = getSourceFileMapping(DebugData, CU.CUDie);
+    CurrentUnit = NextUnits.empty() ? nullptr : &NextUnits[I];
+    size_t ChildCount = Root.getChildren().size();
+
+    if (!ReusableUnits[I] || !reuseCompileUnit(*ReusableUnits[I], CU, Root)) {
+      SourceFileMapping = getSourceFileMapping(DebugData, CU.CUDie);
+
+      // Recursively create the tree of Objects from the CU and down. The CU
+      // name is only looked up when it will be recorded.
+      LibScopeView::TraceSpan Span(
+          "ReadDIEs",
+          LibScopeView::getActiveTracer() ? CU.CUDie.getName() : std::string());
+      createObject(DebugData, CU.CUDie, Root);
+      SplitDwarf::SplitUnit SplitCU = Split->getSplitUnit(I);
+      if (SplitCU.Unit && Root.getChildren().size() > ChildCount)
+        createSplitUnit(*SplitCU.DebugData, *SplitCU.Unit,
+                        *Root.getChildren().back());
+    }
+    resolvePendingLinks(CU.NextHeaderOffset);
+    if (Root.getChildren().size() > ChildCount)
+      UnitObjects[I] = Root.getChildren().back();
+  }
+  CurrentUnit = nullptr;
+  resolvePendingLinks(std::numeric_limits<Dwarf_Off>::max());
+  createReferencedDies(DebugData, CompileUnits, Root);
+
+  createTypeUnits(DebugData, TypeUnits, Root);
+  for (const auto &File : Split->getFiles())
+    if (File && File->DebugData)
+      createTypeUnits(*File->DebugData, File->TypeUnits, Root);
+  // Link the objects to the types of the units read after them.
+  resolveSignatureLinks();
+
+  // If we didn't skip any Dies (because of unknown tags or the address
+  // filter) then we should have resolved all the types and references.
+  assert(!(UnresolvedLinkCount != 0 && UnknownDWTags.empty() &&
+           SkippedCUCount == 0) &&
+         "Some objects had a type or reference that was not created");
+
+  if (!IncrementalStateFile.empty())
+    saveIncrementalState(CompileUnits, UnitObjects);
+}
+
+void DwarfReader::createTypeUnits(
+    const DwarfDebugData &DebugData,
+    const std::vector<DwarfCompileUnit> &TypeUnits,
+    LibScopeView::ScopeRoot &Root) {
+  if (TypeUnits.empty())
+    return;
+
+  // The offsets of .debug_types overlap those of .debug_info, but the objects
+  // of the compile units can no longer be linked to by offset, so the table is
+  // reused for the type units.
+  CreatedObjects.clear();
+  SignatureIndex.reserve(TypeUnits.size());
+  for (const auto &TU : TypeUnits) {
+    // The type units of a relocatable file may repeat a signature, which only
+    // a linker would merge, so only the first unit with each one is read.
+    if (!SignatureIndex.emplace(TU.Signature, nullptr).second)
+      continue;
+    CurrentCURange = std::make_pair(TU.HeaderOffset, TU.NextHeaderOffset);
+    size_t ChildCount = Root.getChildren().size();
+    SourceFileMapping = getSourceFileMapping(DebugData, TU.CUDie);
+    {
+      LibScopeView::TraceSpan Span("ReadDIEs");
+      createObject(DebugData, TU.CUDie, Root);
+    }
+    resolvePendingLinks(TU.NextHeaderOffset);
+
+    // Type units have no name, so each is named after the type it holds.
+    LibScopeView::Object *Ty = CreatedObjects.find(TU.TypeOffset);
+    SignatureIndex[TU.Signature] = Ty;
+    if (Ty && Root.getChildren().size() > ChildCount)
+      Root.getChildren().back()->setName(Ty->getName());
+  }
+  resolvePendingLinks(std::numeric_limits<Dwarf_Off>::max());
+}
+
+void DwarfReader::createSplitUnit(const DwarfDebugData &DebugData,
+                                  const DwarfCompileUnit &CU,
+                                  LibScopeView::Object &CUObj) {
+  // The skeleton has the code ranges and lines of the unit, and the split
+  // unit has its name and the rest of its DIEs.
+  CUObj.setName(CU.CUDie.getName().c_str());
+
+  // The offsets of the split unit are in its own .debug_info.dwo, so its
+  // objects and links are kept apart from those of the file.
+  ObjectTable FileObjects;
+  FileObjects.swap(CreatedObjects);
+  std::vector<PendingLink> FileLinks;
+  FileLinks.swap(PendingLinks);
+  std::pair<Dwarf_Off, Dwarf_Off> FileCURange = CurrentCURange;
+  CurrentCURange = std::make_pair(CU.HeaderOffset, CU.NextHeaderOffset);
+  // libdwarf can't read the file names of a .debug_line.dwo, which has no
+  // line program, so those of the skeleton's line table are used, which are
+  // numbered the same.
+  std::vector<std::string> SplitSourceMapping =
+      getSourceFileMapping(DebugData, CU.CUDie);
+  if (!SplitSourceMapping.empty())
+    SourceFileMapping.swap(SplitSourceMapping);
+
+  for (auto IT = CU.CUDie.childrenBegin(), End = CU.CUDie.childrenEnd();
+       IT != End; ++IT)
+    createObject(DebugData, *IT, CUObj);
+  resolvePendingLinks(std::numeric_limits<Dwarf_Off>::max());
+
+  CreatedObjects.swap(FileObjects);
+  PendingLinks.swap(FileLinks);
+  CurrentCURange = FileCURange;
+}
+
+std::vector<const CompileUnitState *> DwarfReader::getReusableUnits(
+    const std::vector<DwarfCompileUnit> &CompileUnits) {
+  std::vector<const CompileUnitState *> ReusableUnits(CompileUnits.size());
+  if (IncrementalStateFile.empty())
+    return ReusableUnits;
+
+  // The fingerprints must be of the same units that libdwarf reads.
+  bool SameUnits = Fingerprints.size() == CompileUnits.size();
+  for (size_t I = 0; SameUnits && I < CompileUnits.size(); ++I)
+    SameUnits = Fingerprints[I].HeaderOffset == CompileUnits[I].HeaderOffset &&
+                Fingerprints[I].NextHeaderOffset ==
+                    CompileUnits[I].NextHeaderOffset;
+  if (!SameUnits) {
+    Fingerprints.clear();
+    return ReusableUnits;
+  }
+  NextUnits.resize(CompileUnits.size());
+
+  LibScopeView::TraceSpan Span("LoadState");
+  if (!PreviousState.load(IncrementalStateFile)) {
+    if (LibScopeView::doesFileExist(IncrementalStateFile))
+      LibScopeError::warning("Ignoring invalid incremental state file '" +
+                             IncrementalStateFile + "'.");
+    return ReusableUnits;
+  }
+
+  // Match each unit to the first unused saved unit with the same hash.
+  const size_t NoMatch = std::numeric_limits<size_t>::max();
+  std::unordered_map<uint64_t, std::vector<uint32_t>> SavedUnitsByHash;
+  for (size_t I = PreviousState.Units.size(); I > 0; --I)
+    SavedUnitsByHash[PreviousState.Units[I - 1].Hash].push_back(
+        static_cast<uint32_t>(I - 1));
+  std::vector<size_t> SavedIndices(CompileUnits.size(), NoMatch);
+  std::vector<uint32_t> CurrentIndices(PreviousState.Units.size());
+  SavedUnitOffsets.assign(PreviousState.Units.size(),
+                          IncrementalState::InvalidUnitOffset);
+  for (size_t I = 0; I < CompileUnits.size(); ++I) {
+    auto IT = SavedUnitsByHash.find(Fingerprints[I].Hash);
+    if (!Fingerprints[I].Complete || IT == SavedUnitsByHash.end() ||
+        IT->second.empty())
+      continue;
+    uint32_t SavedIndex = IT->second.back();
+    IT->second.pop_back();
+    SavedIndices[I] = SavedIndex;
+    CurrentIndices[SavedIndex] = static_cast<uint32_t>(I);
+    SavedUnitOffsets[SavedIndex] = CompileUnits[I].HeaderOffset;
+  }
+
+  // A matched unit is reused if the units that it references are matched to
+  // the units that it references now. Those units may still be read again
+  // (if their own references changed), but their objects are at the same
+  // offsets within them.
+  for (size_t I = 0; I < CompileUnits.size(); ++I) {
+    if (SavedIndices[I] == NoMatch)
+      continue;
+    const CompileUnitState &Saved = PreviousState.Units[SavedIndices[I]];
+    if (!Saved.Reusable)
+      continue;
+    std::vector<uint32_t> Referenced;
+    for (uint32_t SavedIndex : Saved.ReferencedUnits) {
+      if (SavedIndex >= SavedUnitOffsets.size() ||
+          SavedUnitOffsets[SavedIndex] == IncrementalState::InvalidUnitOffset)
+        break;
+      Referenced.push_back(CurrentIndices[SavedIndex]);
+    }
+    std::sort(Referenced.begin(), Referenced.end());
+    if (Referenced.size() == Saved.ReferencedUnits.size() &&
+        Referenced == Fingerprints[I].ReferencedUnits)
+      ReusableUnits[I] = &Saved;
+  }
+
+  SavedStateMatches = PreviousState.Units.size() == CompileUnits.size();
+  for (size_t I = 0; SavedStateMatches && I < CompileUnits.size(); ++I)
+    SavedStateMatches = ReusableUnits[I] == &PreviousState.Units[I];
+  return ReusableUnits;
+}
+
+bool DwarfReader::reuseCompileUnit(const CompileUnitState &Unit,
+                                   const DwarfCompileUnit &CU,
+                                   LibScopeView::ScopeRoot &Root) {
+  std::unique_ptr<LibScopeView::Object> UnitObject;
+  CreatedObjectList Created;
+  LibScopeView::TraceSpan Span("ReuseCU");
+  if (!PreviousState.decodeUnit(Unit, CU.HeaderOffset, SavedUnitOffsets,
+                                UnitObject, Created))
+    return false;
+  ++ReusedCUCount;
+
+  for (Dwarf_Half Tag : Unit.UnknownTags)
+    warnUnknownTag(Tag);
+  for (const auto &AttrForm : Unit.UnknownAttrForms)
+    warnUnknownAttrForm(AttrForm.first, AttrForm.second);
+  if (UnitObject)
+    Root.addChild(UnitObject.release());
+
+  // Record and link the objects in the order they were read.
+  for (const auto &ObjLinks : Created) {
+    LibScopeView::Object &Obj = *ObjLinks.first;
+    assert(!CreatedObjects.find(Obj.getDieOffset()) &&
+           "DWARF offset seen twice");
+    CreatedObjects.insert(Obj.getDieOffset(), &Obj);
+    linkObject(Obj, ObjLinks.second);
+  }
+  return true;
+}
+
+void DwarfReader::saveIncrementalState(
+    const std::vector<DwarfCompileUnit> &CompileUnits,
+    const std::vector<const LibScopeView::Object *> &UnitObjects) {
+  // A partial read is not saved, as the skipped units would never be reused.
+  if (Fingerprints.empty() || SkippedCUCount != 0)
+    return;
+  // Nothing has changed if every unit was reused in the same order.
+  if (SavedStateMatches && ReusedCUCount == CompileUnits.size())
+    return;
+
+  LibScopeView::TraceSpan Span("SaveState");
+  std::vector<Dwarf_Off> UnitOffsets;
+  for (const auto &CU : CompileUnits)
+    UnitOffsets.push_back(CU.HeaderOffset);
+  auto GetLinks = [this](const LibScopeView::Object &Obj) {
+    auto IT = RecordedLinks.find(&Obj);
+    return IT == RecordedLinks.end() ? ObjectLinks() : IT->second;
+  };
+
+  IncrementalState NextState;
+  for (size_t I = 0; I < CompileUnits.size(); ++I) {
+    CompileUnitState &Unit = NextUnits[I];
+    Unit.Hash = Fingerprints[I].Hash;
+    Unit.ReferencedUnits = Fingerprints[I].ReferencedUnits;
+    Unit.Reusable = Fingerprints[I].Complete &&
+                    NextState.encodeUnit(UnitObjects[I], GetLinks,
+                                         UnitOffsets, Unit);
+    if (!Unit.Reusable)
+      Unit.Objects.clear();
+  }
+  NextState.Units = std::move(NextUnits);
+  if (!NextState.save(IncrementalStateFile))
+    LibScopeError::warning("Unable to write incremental state file '" +
+                           IncrementalStateFile + "'.");
+}
+
+std::set<Dwarf_Off>
+DwarfReader::getCompileUnitsToSkip(const DwarfDebugData &DebugData) {
+  std::set<Dwarf_Off> CUsToSkip;
+  if (AddressFilter.empty()) {
+    CUsToSkip.insert(UnitsWithoutNames.begin(), UnitsWithoutNames.end());
+    return CUsToSkip;
+  }
+
+  LibScopeView::TraceSpan Span("ReadAranges");
+  std::vector<Dwarf_Addr> Addresses(AddressFilter);
+  std::sort(Addresses.begin(), Addresses.end());
+
+  // A CU is skipped if it has aranges and none of them contain an address.
+  std::set<Dwarf_Off> CUsToRead;
+  for (const DwarfArange &Arange : DebugData.getAranges()) {
+    auto IT =
+        std::lower_bound(Addresses.begin(), Addresses.end(), Arange.Start);
+    if (IT != Addresses.end() && *IT - Arange.Start < Arange.Length)
+      CUsToRead.insert(Arange.CUHeaderOffset);
+    else
+      CUsToSkip.insert(Arange.CUHeaderOffset);
+  }
+  for (Dwarf_Off Offset : CUsToRead)
+    CUsToSkip.erase(Offset);
+  return CUsToSkip;
+}
 
-    // Recursively create the tree of Objects from the CU and down.
-    createObject(DebugData, CU.CUDie, Root);
+void DwarfReader::createReferencedDies(
+    const DwarfDebugData &DebugData,
+    const std::vector<DwarfCompileUnit> &CompileUnits,
+    LibScopeView::ScopeRoot &Root) {
+  if (ReferencedLinks.empty()) {
+    FilteredUnitRanges.clear();
+    return;
+  }
+
+  LibScopeView::TraceSpan Span("ReadReferencedDIEs");
+  ReadingReferencedDies = true;
+  // The object of each unit that DIEs have been read from.
+  std::vector<LibScopeView::Object *> UnitObjects(CompileUnits.size());
+  // The DIEs read for the links may reference DIEs in other skipped units,
+  // which are read in the next round.
+  while (!ReferencedLinks.empty()) {
+    std::vector<Dwarf_Off> Targets;
+    for (const PendingLink &Link : ReferencedLinks)
+      if (ReferencedDies.insert(Link.TargetOffset).second &&
+          !CreatedObjects.find(Link.TargetOffset))
+        Targets.push_back(Link.TargetOffset);
+    std::sort(Targets.begin(), Targets.end());
+    PendingLinks.insert(PendingLinks.end(), ReferencedLinks.begin(),
+                        ReferencedLinks.end());
+    ReferencedLinks.clear();
+
+    // Each unit with targets is walked once, in offset order.
+    const Dwarf_Off *Target = Targets.data();
+    const Dwarf_Off *TargetsEnd = Target + Targets.size();
+    for (size_t I = 0; I < CompileUnits.size() && Target != TargetsEnd;
+         ++I) {
+      const DwarfCompileUnit &CU = CompileUnits[I];
+      if (*Target >= CU.NextHeaderOffset)
+        continue;
+      CurrentCURange = std::make_pair(CU.HeaderOffset, CU.NextHeaderOffset);
+      SourceFileMapping = getSourceFileMapping(DebugData, CU.CUDie);
+      DwarfAttrValue LowPC(CU.CUDie.getAttr(DW_AT_low_pc));
+      CurrentCUBaseAddress = LowPC.getKind() == DwarfAttrValueKind::Address
+                                 ? LowPC.getAddress()
+                                 : 0;
+      if (!UnitObjects[I]) {
+        size_t ChildCount = Root.getChildren().size();
+        createObject(DebugData, CU.CUDie, Root, /*WithChildren*/ false);
+        if (Root.getChildren().size() > ChildCount)
+          UnitObjects[I] = Root.getChildren().back();
+      }
+      if (UnitObjects[I])
+        createReferencedChildren(DebugData, CU.CUDie, CU.NextHeaderOffset,
+                                 *UnitObjects[I], Target, TargetsEnd);
+      while (Target != TargetsEnd && *Target < CU.NextHeaderOffset)
+        ++Target;
+    }
+    resolvePendingLinks(std::numeric_limits<Dwarf_Off>::max());
   }
+  ReadingReferencedDies = false;
+  FilteredUnitRanges.clear();
+}
 
-  // If we didn't skip any Dies (because of unknown tags) then we should have
-  // resolved all the types and references.
-  assert(!(!TypesToBeSet.empty() && UnknownDWTags.empty()) &&
-         "Some objects had a type that was not created");
-  assert(!(!ReferencesToBeSet.empty() && UnknownDWTags.empty()) &&
-         "Some objects had a reference that was not created");
+void DwarfReader::createReferencedChildren(const DwarfDebugData &DebugData,
+                                           const DwarfDie &Die, Dwarf_Off End,
+                                           LibScopeView::Object &Obj,
+                                           const Dwarf_Off *&Target,
+                                           const Dwarf_Off *TargetsEnd) {
+  // Each target is in the subtree of the child of Die that starts at or
+  // before it and ends after it, so the other children are skipped over.
+  for (DwarfDieChildIterator Child = Die.childrenBegin();
+       !Child.atEnd() && Target != TargetsEnd && *Target < End;) {
+    DwarfDieChildIterator Sibling = Child;
+    ++Sibling;
+    Dwarf_Off Offset = Child->getGlobalOffset();
+    Dwarf_Off ChildEnd = Sibling.atEnd() ? End : Sibling->getGlobalOffset();
+    while (Target != TargetsEnd && *Target < Offset)
+      ++Target;
+    if (Target != TargetsEnd && *Target < ChildEnd) {
+      LibScopeView::Object *ChildObj = CreatedObjects.find(Offset);
+      if (!ChildObj && *Target == Offset) {
+        // The whole subtree of a target is read.
+        createObject(DebugData, *Child, Obj);
+      } else {
+        // The scopes containing a target are read without their other
+        // children.
+        if (!ChildObj) {
+          createObject(DebugData, *Child, Obj, /*WithChildren*/ false);
+          ChildObj = CreatedObjects.find(Offset);
+        }
+        if (ChildObj && isa<LibScopeView::Scope>(*ChildObj))
+          createReferencedChildren(DebugData, *Child, ChildEnd, *ChildObj,
+                                   Target, TargetsEnd);
+      }
+      while (Target != TargetsEnd && *Target < ChildEnd)
+        ++Target;
+    }
+    Child = Sibling;
+  }
 }
 
 void DwarfReader::createObject(const DwarfDebugData &DebugData,
                                const DwarfDie &Die,
-                               LibScopeView::Object &ParentObj) {
+                               LibScopeView::Object &ParentObj,
+                               bool WithChildren) {
   auto &ParentScope = cast<LibScopeView::Scope>(ParentObj);
 
   auto ObjOffset = Die.getGlobalOffset();
   auto ObjTag = Die.getTag();
+  ++DIECount;
 
   // Create the object from the DWARF tag.
   LibScopeView::Object *Obj = createObjectByTag(ObjTag);
@@ -176,10 +673,10 @@ void DwarfReader::createObject(const DwarfDebugData &DebugData,
   ParentScope.addChild(Obj);
 
   // Check this object hasn't been created before.
-  assert(CreatedObjects.count(ObjOffset) == 0U && "DWARF offset seen twice");
+  assert(!CreatedObjects.find(ObjOffset) && "DWARF offset seen twice");
 
   // Record the Object by offset for lookup when creating other objects.
-  CreatedObjects[ObjOffset] = Obj;
+  CreatedObjects.insert(ObjOffset, Obj);
 
   // Set attributes.
   initObjectFromAttrs(*Obj, Die, ObjOffset, ObjTag);
@@ -187,16 +684,22 @@ void DwarfReader::createObject(const DwarfDebugData &DebugData,
   // Set any references.
   initObjectReferences(*Obj, Die);
 
-  // Update any references to this object.
-  updateReferencesToObject(*Obj, ObjOffset);
-
   // Recurse on the DIE children.
+  if (!WithChildren)
+    return;
   for (auto IT = Die.childrenBegin(), End = Die.childrenEnd(); IT != End; ++IT)
     createObject(DebugData, *IT, *Obj);
 }
 
 LibScopeView::Object *
 DwarfReader::createObjectByTag(Dwarf_Half Tag) {
+  LibScopeView::Object *Obj = createObjectForTag(Tag);
+  if (!Obj)
+    warnUnknownTag(Tag);
+  return Obj;
+}
+
+LibScopeView::Object *ElfDwarfReader::createObjectForTag(Dwarf_Half Tag) {
   switch (Tag) {
   // Types.
   case DW_TAG_base_type: {
@@ -318,6 +821,7 @@ DwarfReader::createObjectByTag(Dwarf_Half Tag) {
     return Obj;
   }
   case DW_TAG_compile_unit:
+  case DW_TAG_type_unit:
     return new LibScopeView::ScopeCompileUnit;
   case DW_TAG_inlined_subroutine:
     return new LibScopeView::ScopeFunctionInlined;
@@ -367,14 +871,6 @@ DwarfReader::createObjectByTag(Dwarf_Half Tag) {
   case DW_TAG_GNU_template_parameter_pack:
     return new LibScopeView::ScopeTemplatePack;
   default:
-    if (!UnknownDWTags.count(Tag)) {
-      UnknownDWTags.insert(Tag);
-      std::stringstream Msg;
-      Msg << "Ignoring unknown/unsupported DWARF tag '";
-      writeStringOrHex(Msg, getDwarfTagAsString(Tag), Tag);
-      Msg << "'.";
-      LibScopeError::warning(Msg.str());
-    }
     return nullptr;
   }
 }
@@ -388,7 +884,7 @@ void DwarfReader::initObjectFromAttrs(LibScopeView::Object &Obj,
 
   DwarfAttrValue LineNo(
       getAttrExpectingKind(Die, DW_AT_decl_line, DwarfAttrValueKind::Unsigned));
-  Obj.setLineNumber(LineNo.empty() ? 0 : LineNo.getUnsigned());
+  Obj.setLineNumber(LineNo.empty() ? 0 : getLineNumber(LineNo.getUnsigned()));
 
   DwarfAttrValue DeclFileID(
       getAttrExpectingKind(Die, DW_AT_decl_file, DwarfAttrValueKind::Unsigned));
@@ -412,9 +908,17 @@ void DwarfReader::initScopeFromAttrs(LibScopeView::Scope &Scp,
     if (auto ScpParent = dyn_cast<LibScopeView::Scope>(Scp.getParent()))
       ScpParent->setIsTemplate();
 
-  // CU lines.
-  if (auto CU = dyn_cast<LibScopeView::ScopeCompileUnit>(&Scp))
-    createLines(Die, *CU);
+  // Code addresses, read before the CU lines so the CU base address is set.
+  if (isa<LibScopeView::ScopeCompileUnit>(Scp) ||
+      isa<LibScopeView::ScopeFunctionInlined>(Scp) || Scp.getIsSubprogram() ||
+      Scp.getIsBlock())
+    initScopeRanges(Scp, Die);
+
+  // CU lines. A type unit only uses the file names of its line table.
+  if (auto CU = dyn_cast<LibScopeView::ScopeCompileUnit>(&Scp)) {
+    if (CU->getDieTag() != DW_TAG_type_unit && !ReadingReferencedDies)
+      createLines(Die, *CU);
+  }
   // Enum class.
   else if (auto ScpEnum =
                dyn_cast<LibScopeView::ScopeEnumeration>(&Scp)) {
@@ -536,113 +1040,269 @@ void DwarfReader::initSymbolFromAttrs(LibScopeView::Symbol &Sym,
   }
 }
 
+void DwarfReader::initScopeRanges(LibScopeView::Scope &Scp,
+                                  const DwarfDie &Die) {
+  DwarfAttrValue LowPC(
+      getAttrExpectingKind(Die, DW_AT_low_pc, DwarfAttrValueKind::Address));
+  if (isa<LibScopeView::ScopeCompileUnit>(Scp))
+    CurrentCUBaseAddress = LowPC.empty() ? 0 : LowPC.getAddress();
+
+  // DW_AT_ranges is an offset into .debug_ranges.
+  DwarfAttrValue Ranges(getAttrExpectingKinds(
+      Die, DW_AT_ranges,
+      {DwarfAttrValueKind::Reference, DwarfAttrValueKind::Unsigned}));
+  if (!Ranges.empty()) {
+    Dwarf_Off RangesOffset =
+        Ranges.getKind() == DwarfAttrValueKind::Reference
+            ? Ranges.getReference()
+            : static_cast<Dwarf_Off>(Ranges.getUnsigned());
+    for (const DwarfAddressRange &Range :
+         Die.getRanges(RangesOffset, CurrentCUBaseAddress))
+      Scp.addRange(Range.LowPC, Range.HighPC);
+    return;
+  }
+
+  if (LowPC.empty())
+    return;
+  // DW_AT_high_pc is an address, or since DWARF 4 may be the size of the
+  // range.
+  DwarfAttrValue HighPC(getAttrExpectingKinds(
+      Die, DW_AT_high_pc,
+      {DwarfAttrValueKind::Address, DwarfAttrValueKind::Unsigned}));
+  Dwarf_Addr Low = LowPC.getAddress();
+  Dwarf_Addr High = Low;
+  if (HighPC.getKind() == DwarfAttrValueKind::Address)
+    High = HighPC.getAddress();
+  else if (HighPC.getKind() == DwarfAttrValueKind::Unsigned)
+    High = Low + HighPC.getUnsigned();
+  if (Low < High)
+    Scp.addRange(Low, High);
+}
+
 void DwarfReader::createLines(const DwarfDie &CUDie,
                               LibScopeView::ScopeCompileUnit &CUObj) {
-  auto LineTable = CUDie.getLineTable();
+  LibScopeView::TraceSpan Span("ReadLines");
+
+  // Decode the line program directly when possible, as it is much faster than
+  // reading each row through libdwarf, which remains the fallback.
+  DwarfLineTable LineTable;
+  bool Decoded = false;
+  if (UseLineSections) {
+    DwarfAttrValue StmtList(CUDie.getAttr(DW_AT_stmt_list));
+    Dwarf_Half AddressSize = 0;
+    if ((StmtList.getKind() == DwarfAttrValueKind::Reference ||
+         StmtList.getKind() == DwarfAttrValueKind::Unsigned) &&
+        dwarf_get_die_address_size(*CUDie, &AddressSize, nullptr) ==
+            DW_DLV_OK) {
+      Dwarf_Unsigned Offset =
+          StmtList.getKind() == DwarfAttrValueKind::Reference
+              ? StmtList.getReference()
+              : StmtList.getUnsigned();
+      Decoded = decodeLineProgram(LineSections, Offset, AddressSize, LineTable);
+    }
+  }
+  if (Decoded)
+    ++DecodedLineTableCount;
+  else
+    LineTable = CUDie.getLineTable();
 
   for (size_t LineIndex = 0; LineIndex < LineTable.size(); ++LineIndex) {
-    auto DwarfLine = LineTable[LineIndex];
+    Dwarf_Addr Address = LineTable.getAddress(LineIndex);
+    uint8_t Flags = LineTable.getFlags(LineIndex);
     auto *Ln = new LibScopeView::Line;
 
     CUObj.addChild(Ln);
-    Ln->setLineNumber(DwarfLine.LineNo);
-    Ln->setAddress(DwarfLine.LineAddr);
-    Ln->setDieOffset(static_cast<Dwarf_Off>(DwarfLine.LineAddr));
+    Ln->setLineNumber(getLineNumber(LineTable.getLineNo(LineIndex)));
+    Ln->setAddress(Address);
+    Ln->setDieOffset(static_cast<Dwarf_Off>(Address));
 
-    setSourceFile(*Ln, SourceFileMapping, DwarfLine.SrcFileID);
+    setSourceFile(*Ln, SourceFileMapping, LineTable.getSrcFileID(LineIndex));
 
     // set DWARF qualifiers.
-    Ln->setDiscriminator(static_cast<Dwarf_Half>(DwarfLine.Discriminator));
-    if (DwarfLine.IsBeginStatement)
+    Ln->setDiscriminator(
+        static_cast<Dwarf_Half>(LineTable.getDiscriminator(LineIndex)));
+    if (Flags & DwarfLineTable::BeginStatement)
       Ln->setIsNewStatement();
-    if (DwarfLine.IsBeginBlock)
+    if (Flags & DwarfLineTable::BeginBlock)
       Ln->setIsNewBasicBlock();
-    if (DwarfLine.IsEndSequence)
+    if (Flags & DwarfLineTable::EndSequence)
       Ln->setIsLineEndSequence();
-    if (DwarfLine.IsEpilogueBegin)
+    if (Flags & DwarfLineTable::EpilogueBegin)
       Ln->setIsEpilogueBegin();
-    if (DwarfLine.IsPrologEnd)
+    if (Flags & DwarfLineTable::PrologEnd)
       Ln->setIsPrologueEnd();
   }
 }
 
 void DwarfReader::initObjectReferences(LibScopeView::Object &Obj,
                                        const DwarfDie &Die) {
-  // Set type or add to missing list to be resolved later.
-  DwarfAttrValue TypeRef(
-      getAttrExpectingKind(Die, DW_AT_type, DwarfAttrValueKind::Reference));
+  ObjectLinks Links;
 
-  // DW_AT_import is treated as a type by LibScopeView.
+  // The type, with DW_AT_import treated as a type by LibScopeView. Types in
+  // type units are referenced by their signature.
+  const std::set<DwarfAttrValueKind> TypeKinds = {
+      DwarfAttrValueKind::Reference, DwarfAttrValueKind::Signature};
+  DwarfAttrValue TypeRef(getAttrExpectingKinds(Die, DW_AT_type, TypeKinds));
   if (TypeRef.empty())
-    TypeRef =
-        getAttrExpectingKind(Die, DW_AT_import, DwarfAttrValueKind::Reference);
-
+    TypeRef = getAttrExpectingKinds(Die, DW_AT_import, TypeKinds);
   if (!TypeRef.empty()) {
-    auto TypeOffset = TypeRef.getReference();
-    auto IT = CreatedObjects.find(TypeOffset);
-    if (IT != CreatedObjects.end()) {
-      Obj.setType(IT->second);
-      // If the type is in another CU mark it as global.
-      if (TypeOffset < CurrentCURange.first ||
-          TypeOffset > CurrentCURange.second)
-        IT->second->setIsGlobalReference();
-    } else
-      // Set the type for this Object when we encounter TypeOffset.
-      TypesToBeSet.emplace(TypeOffset, &Obj);
+    Links.HasType = true;
+    Links.TypeIsSignature =
+        TypeRef.getKind() == DwarfAttrValueKind::Signature;
+    Links.TypeOffset = Links.TypeIsSignature ? TypeRef.getSignature()
+                                             : TypeRef.getReference();
   }
 
-  // Set reference from a DW_AT_specification / DW_AT_abstract_origin /
-  // DW_AT_extension or add to list to be resolved later.
-  DwarfAttrValue ReferenceOffset(getAttrExpectingKind(
-      Die, DW_AT_specification, DwarfAttrValueKind::Reference));
+  // The reference from a DW_AT_specification / DW_AT_abstract_origin /
+  // DW_AT_extension. A declaration in a type unit may be specified by its
+  // signature.
+  DwarfAttrValue ReferenceOffset(
+      getAttrExpectingKinds(Die, DW_AT_specification, TypeKinds));
   if (ReferenceOffset.empty())
     ReferenceOffset = getAttrExpectingKind(Die, DW_AT_abstract_origin,
                                            DwarfAttrValueKind::Reference);
   if (ReferenceOffset.empty())
     ReferenceOffset = getAttrExpectingKind(Die, DW_AT_extension,
                                            DwarfAttrValueKind::Reference);
-
   if (!ReferenceOffset.empty()) {
-    auto RefOffset = ReferenceOffset.getReference();
-    auto IT = CreatedObjects.find(RefOffset);
+    Links.HasReference = true;
+    Links.ReferenceIsSignature =
+        ReferenceOffset.getKind() == DwarfAttrValueKind::Signature;
+    Links.ReferenceOffset = Links.ReferenceIsSignature
+                                ? ReferenceOffset.getSignature()
+                                : ReferenceOffset.getReference();
+  }
+
+  // GCC declares a type from a type unit with only its signature, and links
+  // to the declaration, which is named after the type once it has been read.
+  if ((isa<LibScopeView::ScopeAggregate>(Obj) ||
+       isa<LibScopeView::ScopeEnumeration>(Obj)) &&
+      Obj.getName().empty()) {
+    DwarfAttrValue Signature(getAttrExpectingKind(
+        Die, DW_AT_signature, DwarfAttrValueKind::Signature));
+    if (!Signature.empty())
+      SignatureStubs.emplace_back(Signature.getSignature(), &Obj);
+  }
+
+  linkObject(Obj, Links);
+}
+
+void DwarfReader::linkObject(LibScopeView::Object &Obj,
+                             const ObjectLinks &Links) {
+  if (CurrentUnit && (Links.HasType || Links.HasReference))
+    RecordedLinks[&Obj] = Links;
+
+  // Set type or add to missing list to be resolved later.
+  if (Links.HasType && Links.TypeIsSignature)
+    linkSignature(Obj, Links.TypeOffset, true);
+  else if (Links.HasType) {
+    auto TypeOffset = Links.TypeOffset;
+    bool IsGlobal = TypeOffset < CurrentCURange.first ||
+                    TypeOffset > CurrentCURange.second;
+    if (LibScopeView::Object *Ty = CreatedObjects.find(TypeOffset)) {
+      Obj.setType(Ty);
+      // If the type is in another CU mark it as global.
+      if (IsGlobal)
+        Ty->setIsGlobalReference();
+    } else
+      // Set the type for this Object when we encounter TypeOffset.
+      PendingLinks.push_back({TypeOffset, &Obj, true, IsGlobal});
+  }
+
+  // Set reference or add to list to be resolved later.
+  if (Links.HasReference && Links.ReferenceIsSignature)
+    linkSignature(Obj, Links.ReferenceOffset, false);
+  else if (Links.HasReference) {
+    auto RefOffset = Links.ReferenceOffset;
+    bool IsGlobal = RefOffset < CurrentCURange.first ||
+                    RefOffset > CurrentCURange.second;
     // If the referenced function hasn't been created yet, add to
-    // ReferencesToBeSet for later.
-    if (IT == CreatedObjects.end())
-      ReferencesToBeSet.emplace(RefOffset, &Obj);
-    else {
-      addObjectReference(&Obj, IT->second);
+    // PendingLinks for later.
+    if (LibScopeView::Object *Ref = CreatedObjects.find(RefOffset)) {
+      addObjectReference(&Obj, Ref);
       // If the reference is in another CU mark it as global.
-      if (RefOffset < CurrentCURange.first || RefOffset > CurrentCURange.second)
-        IT->second->setIsGlobalReference();
-    }
+      if (IsGlobal)
+        Ref->setIsGlobalReference();
+    } else
+      PendingLinks.push_back({RefOffset, &Obj, false, IsGlobal});
   }
 }
 
-void DwarfReader::updateReferencesToObject(LibScopeView::Object &Obj,
-                                           Dwarf_Off ObjOffset) {
-  // If there are other Objects that have this Object as their type, then update
-  // them.
-  auto TyFoundRange = TypesToBeSet.equal_range(ObjOffset);
-  for (auto IT = TyFoundRange.first; IT != TyFoundRange.second; ++IT) {
-    IT->second->setType(&Obj);
-    // If the other Object is in another CU mark this Object as global.
-    if (IT->second->getDieOffset() < CurrentCURange.first ||
-        IT->second->getDieOffset() > CurrentCURange.second)
-      Obj.setIsGlobalReference();
-  }
-  TypesToBeSet.erase(TyFoundRange.first, TyFoundRange.second);
-
-  // If there are other Objects that have this Object as a reference then update
-  // them.
-  auto RefFoundRange = ReferencesToBeSet.equal_range(ObjOffset);
-  for (auto IT = RefFoundRange.first; IT != RefFoundRange.second; ++IT) {
-    addObjectReference(IT->second, &Obj);
-    // If the other Object is in another CU mark this Object as global.
-    if (IT->second->getDieOffset() < CurrentCURange.first ||
-        IT->second->getDieOffset() > CurrentCURange.second)
+void DwarfReader::linkSignature(LibScopeView::Object &Obj, uint64_t Signature,
+                                bool IsType) {
+  // The type units are read after the compile units, so the link is pending
+  // until the unit with Signature has been read.
+  auto IT = SignatureIndex.find(Signature);
+  if (IT != SignatureIndex.end() && IT->second)
+    linkToTypeUnit(Obj, *IT->second, IsType);
+  else
+    PendingSignatureLinks.push_back({Signature, &Obj, IsType, true});
+}
+
+void DwarfReader::resolveSignatureLinks() {
+  for (const PendingLink &Link : PendingSignatureLinks) {
+    auto IT = SignatureIndex.find(Link.TargetOffset);
+    if (IT != SignatureIndex.end() && IT->second)
+      linkToTypeUnit(*Link.Obj, *IT->second, Link.IsType);
+    else
+      ++UnresolvedLinkCount;
+  }
+  PendingSignatureLinks.clear();
+
+  for (const auto &Stub : SignatureStubs) {
+    auto IT = SignatureIndex.find(Stub.first);
+    if (IT != SignatureIndex.end() && IT->second) {
+      Stub.second->setNameIndex(IT->second->getNameIndex());
       IT->second->setIsGlobalReference();
+    }
   }
-  ReferencesToBeSet.erase(RefFoundRange.first, RefFoundRange.second);
+  SignatureStubs.clear();
+}
+
+void DwarfReader::resolvePendingLinks(Dwarf_Off ReadEnd) {
+  // Visit the table in offset order.
+  std::sort(PendingLinks.begin(), PendingLinks.end(),
+            [](const PendingLink &A, const PendingLink &B) {
+              return A.TargetOffset < B.TargetOffset;
+            });
+
+  // Return true if Offset is in a unit skipped by the CompileUnitFilter.
+  auto IsInFilteredUnit = [this](Dwarf_Off Offset) {
+    auto IT = std::upper_bound(
+        FilteredUnitRanges.begin(), FilteredUnitRanges.end(), Offset,
+        [](Dwarf_Off Off, const std::pair<Dwarf_Off, Dwarf_Off> &Range) {
+          return Off < Range.first;
+        });
+    return IT != FilteredUnitRanges.begin() && Offset < std::prev(IT)->second;
+  };
+
+  auto Kept = PendingLinks.begin();
+  for (const PendingLink &Link : PendingLinks) {
+    LibScopeView::Object *Target = CreatedObjects.find(Link.TargetOffset);
+    if (!Target) {
+      // Read the target on its own if its unit is skipped, unless it has
+      // been already. Otherwise keep the link if its target may still be
+      // read.
+      if (!FilteredUnitRanges.empty() &&
+          !ReferencedDies.count(Link.TargetOffset) &&
+          IsInFilteredUnit(Link.TargetOffset))
+        ReferencedLinks.push_back(Link);
+      else if (Link.TargetOffset >= ReadEnd)
+        *Kept++ = Link;
+      else
+        ++UnresolvedLinkCount;
+    } else if (Link.IsType) {
+      Link.Obj->setType(Target);
+      // If the other Object is in another CU mark this Object as global.
+      if (Link.IsGlobal)
+        Target->setIsGlobalReference();
+    } else {
+      addObjectReference(Link.Obj, Target);
+      if (Link.IsGlobal)
+        Link.Obj->setIsGlobalReference();
+    }
+  }
+  PendingLinks.erase(Kept, PendingLinks.end());
 }
 
 DwarfAttrValue
@@ -655,22 +1315,72 @@ DwarfAttrValue DwarfReader::getAttrExpectingKinds(
     const DwarfDie &Die, const Dwarf_Half Attr,
     const std::set<DwarfAttrValueKind> &ExpectedKinds) {
   DwarfAttrValue AttrVal(Die.getAttr(Attr));
-  if (AttrVal.empty() || ExpectedKinds.count(AttrVal.getKind()))
+  if (AttrVal.empty())
     return AttrVal;
+  ++AttributeCount;
+  if (ExpectedKinds.count(AttrVal.getKind()))
+    return AttrVal;
+
+  warnUnknownAttrForm(Attr, AttrVal.getForm());
+  return DwarfAttrValue();
+}
 
-  auto Form = AttrVal.getForm();
+void DwarfReader::warnUnknownTag(Dwarf_Half Tag) {
+  if (CurrentUnit && std::find(CurrentUnit->UnknownTags.begin(),
+                               CurrentUnit->UnknownTags.end(),
+                               Tag) == CurrentUnit->UnknownTags.end())
+    CurrentUnit->UnknownTags.push_back(Tag);
+  if (!UnknownDWTags.insert(Tag).second)
+    return;
+  std::stringstream Msg;
+  Msg << "Ignoring unknown/unsupported DWARF tag '";
+  writeStringOrHex(Msg, getDwarfTagAsString(Tag), Tag);
+  Msg << "'.";
+  LibScopeError::warning(Msg.str());
+}
+
+void DwarfReader::warnUnknownAttrForm(Dwarf_Half Attr, Dwarf_Half Form) {
   auto AttrFormPair = std::make_pair(Attr, Form);
-  if (!UnknownAttrFormPairs.count(AttrFormPair)) {
-    UnknownAttrFormPairs.insert(AttrFormPair);
-    std::stringstream Msg;
-    Msg << "Ignoring unrecognised DW_AT, DW_FORM combination '";
-    writeStringOrHex(Msg, getDwarfAttrAsString(Attr), Attr);
-    Msg << "', '";
-    writeStringOrHex(Msg, getDwarfFormAsString(Form), Form);
-    Msg << "'.";
-    LibScopeError::warning(Msg.str());
+  if (CurrentUnit &&
+      std::find(CurrentUnit->UnknownAttrForms.begin(),
+                CurrentUnit->UnknownAttrForms.end(),
+                AttrFormPair) == CurrentUnit->UnknownAttrForms.end())
+    CurrentUnit->UnknownAttrForms.push_back(AttrFormPair);
+  if (!UnknownAttrFormPairs.insert(AttrFormPair).second)
+    return;
+  std::stringstream Msg;
+  Msg << "Ignoring unrecognised DW_AT, DW_FORM combination '";
+  writeStringOrHex(Msg, getDwarfAttrAsString(Attr), Attr);
+  Msg << "', '";
+  writeStringOrHex(Msg, getDwarfFormAsString(Form), Form);
+  Msg << "'.";
+  LibScopeError::warning(Msg.str());
+}
+
+uint32_t DwarfReader::getLineNumber(Dwarf_Unsigned Line) {
+  if (Line <= std::numeric_limits<uint32_t>::max())
+    return static_cast<uint32_t>(Line);
+  if (!WarnedLineNumber) {
+    WarnedLineNumber = true;
+    LibScopeError::warning("Ignoring line number " + std::to_string(Line) +
+                           " that is too large.");
   }
-  return DwarfAttrValue();
+  return 0;
+}
+
+void DwarfReader::addMapBytes(
+    LibScopeView::MemoryOwnerBytes &OwnerBytes) const {
+  uint64_t Bytes = CreatedObjects.getAllocatedBytes() +
+                   LibScopeView::getHeapBytes(PendingLinks) +
+                   LibScopeView::getHeapBytes(PendingSignatureLinks) +
+                   LibScopeView::getHeapBytes(SignatureStubs) +
+                   LibScopeView::getHashTableBytes(SignatureIndex) +
+                   LibScopeView::getHashTableBytes(RecordedLinks) +
+                   LibScopeView::getHeapBytes(SourceFileMapping) +
+                   LibScopeView::getHeapBytes(LineSections.Line);
+  for (const std::string &Path : SourceFileMapping)
+    Bytes += LibScopeView::getHeapBytes(Path);
+  OwnerBytes["ReaderMaps"] += Bytes;
 }
 
 bool DwarfReader::attrIsTrueFlag(const DwarfDie &Die, const Dwarf_Half Attr) {
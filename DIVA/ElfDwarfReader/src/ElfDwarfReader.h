@@ -32,6 +32,11 @@
 #ifndef ELF_DWARF_READER_H
 #define ELF_DWARF_READER_H
 
+#include "DebugSections.h"
+#include "DwarfFingerprint.h"
+#include "IncrementalState.h"
+#include "MemoryProfile.h"
+#include "ObjectTable.h"
 #include "Reader.h"
 
 #include <set>
@@ -40,6 +45,7 @@
 
 namespace ElfDwarfReader {
 
+struct DwarfCompileUnit;
 class DwarfDebugData;
 class DwarfDie;
 class DwarfAttrValue;
@@ -47,25 +53,114 @@ enum class DwarfAttrValueKind;
 
 class DwarfReader : public LibScopeView::Reader {
 public:
-  DwarfReader() = default;
+  DwarfReader();
   ~DwarfReader() override = default;
 
   DwarfReader(const DwarfReader &) = delete;
   DwarfReader &operator=(const DwarfReader &) = delete;
 
+  /// \brief Only read the compile units that .debug_aranges shows contain one
+  /// of Addresses. Compile units missing from .debug_aranges are still read.
+  void setAddressFilter(const std::vector<uint64_t> &Addresses) {
+    AddressFilter.assign(Addresses.begin(), Addresses.end());
+  }
+
+  /// \brief Only read the compile units needed to print the text view of the
+  /// objects named one of Names, which scanUnitsToSkip finds. Every unit is
+  /// read if they can't be found, or with an address filter.
+  void setNameFilter(const std::vector<std::string> &Names) {
+    NameFilter = Names;
+  }
+
+  /// \brief Only read the compile units whose name matches one of Patterns
+  /// (see matchesCompileUnitName). The types and other DIEs that
+  /// the units read reference in the other units are read on their own, with
+  /// the scopes that contain them, under an object for their unit.
+  void setCompileUnitFilter(const std::vector<std::string> &Patterns) {
+    CompileUnitFilter = Patterns;
+  }
+
+  /// \brief Reuse the objects of the compile units that are unchanged since
+  /// the state in StateFile was saved, and then save the state of this read
+  /// to StateFile.
+  void setIncrementalStateFile(const std::string &StateFile) {
+    IncrementalStateFile = StateFile;
+  }
+
+  /// \brief Read the ELF object in memory at Image, such as a member of a
+  /// static archive, instead of the file named by loadFile, which is then
+  /// only used as the name of the tree. The image must be writable and must
+  /// outlive the read. Incremental reading isn't supported for images.
+  void setMemoryImage(char *Image, size_t Size) {
+    MemoryImage = Image;
+    MemoryImageSize = Size;
+  }
+
 private:
   /// Create the full scope tree.
   std::unique_ptr<LibScopeView::ScopeRoot>
   createScopes(const std::string &FileName) override;
 
-  /// Create each compile unit.
-  void createCompileUnits(const DwarfDebugData &DebugData,
+  /// Create each compile unit of FileName, with the DIEs of the split units
+  /// of any skeleton units.
+  void createCompileUnits(const std::string &FileName,
+                          const DwarfDebugData &DebugData,
                           LibScopeView::ScopeRoot &Root);
 
+  /// Create the DIEs of the split unit CU, read by DebugData, under CUObj,
+  /// the object of its skeleton unit.
+  void createSplitUnit(const DwarfDebugData &DebugData,
+                       const DwarfCompileUnit &CU,
+                       LibScopeView::Object &CUObj);
+
+  /// Create each type unit once, after the compile units. The objects that
+  /// reference them by signature are linked by resolveSignatureLinks.
+  void createTypeUnits(const DwarfDebugData &DebugData,
+                       const std::vector<DwarfCompileUnit> &TypeUnits,
+                       LibScopeView::ScopeRoot &Root);
+
   /// Create a LibScopeView::Object from a Die and then recursivly create its
-  /// children.
+  /// children, unless WithChildren is false.
   void createObject(const DwarfDebugData &DebugData, const DwarfDie &Die,
-                    LibScopeView::Object &ParentObj);
+                    LibScopeView::Object &ParentObj, bool WithChildren = true);
+
+  /// Create the DIEs in the compile units skipped by the CompileUnitFilter
+  /// that ReferencedLinks point to, and then the DIEs that they reference in
+  /// turn, and resolve the links.
+  void createReferencedDies(const DwarfDebugData &DebugData,
+                            const std::vector<DwarfCompileUnit> &CompileUnits,
+                            LibScopeView::ScopeRoot &Root);
+
+  /// Create the DIEs at the sorted offsets from Target up to TargetsEnd that
+  /// are before End, the end of the subtree of Die, under Obj (the object of
+  /// Die), with the scopes that contain them but not their other children.
+  /// Target is moved past them.
+  void createReferencedChildren(const DwarfDebugData &DebugData,
+                                const DwarfDie &Die, Dwarf_Off End,
+                                LibScopeView::Object &Obj,
+                                const Dwarf_Off *&Target,
+                                const Dwarf_Off *TargetsEnd);
+
+  /// Get the header offsets of the compile units that can be skipped because
+  /// they contain none of the AddressFilter addresses, or aren't needed for
+  /// the NameFilter.
+  std::set<Dwarf_Off> getCompileUnitsToSkip(const DwarfDebugData &DebugData);
+
+  /// Get the saved state of each compile unit that can be reused from the
+  /// incremental state file, or null for the units that must be read.
+  std::vector<const CompileUnitState *>
+  getReusableUnits(const std::vector<DwarfCompileUnit> &CompileUnits);
+
+  /// Recreate a compile unit from its saved state, returning false if the
+  /// state is invalid and the unit must be read.
+  bool reuseCompileUnit(const CompileUnitState &Unit,
+                        const DwarfCompileUnit &CU,
+                        LibScopeView::ScopeRoot &Root);
+
+  /// Save the state of each compile unit to the incremental state file.
+  void saveIncrementalState(
+      const std::vector<DwarfCompileUnit> &CompileUnits,
+      const std::vector<const LibScopeView::Object *> &UnitObjects);
 
   /// Create the appropriate subclass of LibScopeView::Object for the given
   /// DWARF tag.
@@ -79,6 +174,10 @@ private:
   void initTypeFromAttrs(LibScopeView::Type &Ty, const DwarfDie &Die);
   void initSymbolFromAttrs(LibScopeView::Symbol &Sym, const DwarfDie &Die);
 
+  /// Add the code address ranges of a scope, from DW_AT_low_pc and
+  /// DW_AT_high_pc or from DW_AT_ranges.
+  void initScopeRanges(LibScopeView::Scope &Scp, const DwarfDie &Die);
+
   /// Create all the lines in a compile unit.
   void createLines(const DwarfDie &CUDie,
                    LibScopeView::ScopeCompileUnit &CUObj);
@@ -89,8 +188,25 @@ private:
   /// needs to be updated when the other object is created.
   void initObjectReferences(LibScopeView::Object &Obj, const DwarfDie &Die);
 
-  /// Set any references from other objects to this object now that it exists.
-  void updateReferencesToObject(LibScopeView::Object &Obj, Dwarf_Off ObjOffset);
+  /// Setup the references from an object to the objects at the offsets in
+  /// Links, as for initObjectReferences.
+  void linkObject(LibScopeView::Object &Obj, const ObjectLinks &Links);
+
+  /// Set the type (if IsType) or reference of Obj to the type of the type
+  /// unit with Signature, or add it to PendingSignatureLinks if the unit
+  /// hasn't been read yet.
+  void linkSignature(LibScopeView::Object &Obj, uint64_t Signature,
+                     bool IsType);
+
+  /// Set the types and references of PendingSignatureLinks, and the names of
+  /// SignatureStubs, once every type unit has been read.
+  void resolveSignatureLinks();
+
+  /// Set the types and references of PendingLinks to the objects that now
+  /// exist. The links to objects that can no longer be created, because they
+  /// are before ReadEnd, are dropped, apart from those into the units skipped
+  /// by the CompileUnitFilter, which are moved to ReferencedLinks.
+  void resolvePendingLinks(Dwarf_Off ReadEnd);
 
   /// Get an attribute, but produce a warning an return an empty DwarfAttrValue
   /// if the value is not the ExpectedKind or ValueKind::Empty.
@@ -104,37 +220,130 @@ private:
   getAttrExpectingKinds(const DwarfDie &Die, const Dwarf_Half Attr,
                         const std::set<DwarfAttrValueKind> &ExpectedKinds);
 
+  /// Warn about an unknown DWARF tag, or an unrecognised attribute and form
+  /// pair, the first time that it is seen.
+  void warnUnknownTag(Dwarf_Half Tag);
+  void warnUnknownAttrForm(Dwarf_Half Attr, Dwarf_Half Form);
+
+  /// Convert a DWARF line number to the 32 bits kept by an Object. A line
+  /// that doesn't fit is treated as no line, with a warning the first time.
+  uint32_t getLineNumber(Dwarf_Unsigned Line);
+
   /// Return true if Die has Attr and the value is a flag set to true.
   bool attrIsTrueFlag(const DwarfDie &Die, const Dwarf_Half Attr);
 
   /// Get the access specifier (Public, Private, etc.) of a Die.
   LibScopeView::AccessSpecifier getAccessSpecifier(const DwarfDie &Die);
 
+  /// Add the bytes held by the maps used while reading to OwnerBytes.
+  void addMapBytes(LibScopeView::MemoryOwnerBytes &OwnerBytes) const;
+
+  // The ELF object to read instead of the named file, if not null.
+  char *MemoryImage = nullptr;
+  size_t MemoryImageSize = 0;
+
   // Offset range of the current CU.
   std::pair<Dwarf_Off, Dwarf_Off> CurrentCURange;
 
+  // Base address of the current CU, for resolving DW_AT_ranges.
+  Dwarf_Addr CurrentCUBaseAddress = 0;
+
+  // The .debug_line section, for decoding the line tables without libdwarf,
+  // and whether it can be used.
+  DebugSections LineSections;
+  bool UseLineSections = false;
+
   // Mapping from DWARF file IDs to the file paths in the current CU.
   std::vector<std::string> SourceFileMapping;
 
   // Mapping from DWARF offsets to already created Objects.
-  std::unordered_map<Dwarf_Off, LibScopeView::Object *> CreatedObjects;
+  ObjectTable CreatedObjects;
+
+  // A type or reference from Obj to the Die at TargetOffset, which hadn't
+  // been read when Obj was created. IsGlobal is true if the Die is in another
+  // CU.
+  struct PendingLink {
+    Dwarf_Off TargetOffset;
+    LibScopeView::Object *Obj;
+    bool IsType;
+    bool IsGlobal;
+  };
+
+  // The links to resolve at the end of the current CU, or at the end of the
+  // CU that their target is in.
+  std::vector<PendingLink> PendingLinks;
+  // The links to type units that hadn't been read, with the signature of the
+  // unit as the TargetOffset, and the type of the unit with each signature
+  // (null until the unit has been read).
+  std::vector<PendingLink> PendingSignatureLinks;
+  std::unordered_map<uint64_t, LibScopeView::Object *> SignatureIndex;
+  // The declarations of types in type units that have only a DW_AT_signature
+  // (as GCC makes), with the signature, to be named after the type.
+  std::vector<std::pair<uint64_t, LibScopeView::Object *>> SignatureStubs;
+  // Number of links whose target was never created.
+  uint64_t UnresolvedLinkCount = 0;
 
-  // Map of DWARF offsets to multiple Objects, where the offset is of Die that
-  // hasn't been read yet, and each of the mapped objects needs to have its
-  // type set to the Object that will be created from that Die.
-  std::unordered_multimap<Dwarf_Off, LibScopeView::Object *> TypesToBeSet;
+  // Addresses selecting the compile units to read, or empty to read all.
+  std::vector<Dwarf_Addr> AddressFilter;
+  // Names selecting the compile units to read, or empty to read all, and the
+  // header offsets of the units that they don't need.
+  std::vector<std::string> NameFilter;
+  std::vector<uint64_t> UnitsWithoutNames;
+  // Patterns selecting the compile units to read, or empty to read all, and
+  // the offset ranges of the units that they skip.
+  std::vector<std::string> CompileUnitFilter;
+  std::vector<std::pair<Dwarf_Off, Dwarf_Off>> FilteredUnitRanges;
+  // The links into the units skipped by the CompileUnitFilter, and the DIEs
+  // that have been read from them for the links.
+  std::vector<PendingLink> ReferencedLinks;
+  std::unordered_set<Dwarf_Off> ReferencedDies;
+  // True while the ReferencedDies are read, whose units' lines aren't read.
+  bool ReadingReferencedDies = false;
+  // Number of compile units not read because of the AddressFilter,
+  // NameFilter or CompileUnitFilter.
+  uint64_t SkippedCUCount = 0;
 
-  // Map of DWARF offsets to multiple Objects, where the offset is of Die that
-  // hasn't been read yet, and each of the mapped objects needs to have its
-  // reference set to the Object that will be created from that Die.
-  std::unordered_multimap<Dwarf_Off, LibScopeView::Object *> ReferencesToBeSet;
+  // The incremental state file, or empty to read every compile unit.
+  std::string IncrementalStateFile;
+  // Fingerprints of the compile units, empty if they couldn't be worked out.
+  std::vector<CompileUnitFingerprint> Fingerprints;
+  // The state saved by a previous read, and the current header offsets of its
+  // units (InvalidUnitOffset for units that no longer exist).
+  IncrementalState PreviousState;
+  std::vector<Dwarf_Off> SavedUnitOffsets;
+  // True if every saved unit can be reused in the order it was saved.
+  bool SavedStateMatches = false;
+  // The state of each compile unit as it is read, saved once all are read.
+  std::vector<CompileUnitState> NextUnits;
+  CompileUnitState *CurrentUnit = nullptr;
+  // The links of each object, kept while an incremental state will be saved.
+  std::unordered_map<const LibScopeView::Object *, ObjectLinks> RecordedLinks;
+  // Number of compile units reused from the incremental state.
+  uint64_t ReusedCUCount = 0;
 
   // Unknown DWARF tags that have already been seen (avoids duplicate warnings).
   std::set<Dwarf_Half> UnknownDWTags;
   // Unrecognised Attr-Form combinations that have already been seen.
   std::set<std::pair<Dwarf_Half, Dwarf_Half>> UnknownAttrFormPairs;
+  // True once a line number too large for an Object has been seen.
+  bool WarnedLineNumber = false;
+
+  // Number of DIEs visited and attribute values read, reported to the active
+  // Tracer once the file has been read.
+  uint64_t DIECount = 0;
+  uint64_t AttributeCount = 0;
+  // Number of line tables decoded without libdwarf.
+  uint64_t DecodedLineTableCount = 0;
+
+  // Reports the maps above to the active MemoryProfile (declared last so that
+  // it is unregistered before they are destroyed).
+  LibScopeView::MemoryOwner MapsOwner;
 };
 
+/// \brief Create the object read from a DIE with Tag, with only the flags
+/// that the tag implies, or return null if DIEs with Tag aren't read.
+LibScopeView::Object *createObjectForTag(Dwarf_Half Tag);
+
 } // end namespace ElfDwarfReader
 
 #endif // ELF_DWARF_READER_H
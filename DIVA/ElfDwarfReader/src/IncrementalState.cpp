@@ -0,0 +1,684 @@
+//===-- ElfDwarfReader/IncrementalState.cpp ---------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the encoding of compile unit objects into the state
+/// that a DwarfReader saves after reading a file.
+///
+//===----------------------------------------------------------------------===//
+
+#include "IncrementalState.h"
+#include "ElfDwarfReader.h"
+#include "Line.h"
+#include "Scope.h"
+#include "Symbol.h"
+#include "Type.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+using namespace ElfDwarfReader;
+using namespace LibScopeView;
+
+namespace {
+
+// Identifies a state file, changed whenever the encoding changes.
+const char StateMagic[] = "DIVASTATE2";
+
+// The version of diva that wrote a state file. A file from another version is
+// ignored, as it may have read the DWARF differently.
+const char StateVersion[] = RC_VERSION_STR;
+
+// FNV-1a hash of the bytes after the checksum in a state file.
+uint64_t getChecksum(const std::string &Data, size_t Start) {
+  uint64_t Hash = 0xcbf29ce484222325ULL;
+  for (size_t I = Start; I < Data.size(); ++I) {
+    Hash ^= static_cast<uint8_t>(Data[I]);
+    Hash *= 0x100000001b3ULL;
+  }
+  return Hash;
+}
+
+// A flag of an Object subclass, by its getter and setter.
+template <class T> struct ObjectFlag {
+  bool (T::*Get)() const;
+  void (T::*Set)();
+};
+
+const ObjectFlag<Scope> ScopeFlags[] = {
+    {&Scope::getIsBlock, &Scope::setIsBlock},
+    {&Scope::getIsCatchBlock, &Scope::setIsCatchBlock},
+    {&Scope::getIsLexicalBlock, &Scope::setIsLexicalBlock},
+    {&Scope::getIsTryBlock, &Scope::setIsTryBlock},
+    {&Scope::getIsEntryPoint, &Scope::setIsEntryPoint},
+    {&Scope::getIsSubprogram, &Scope::setIsSubprogram},
+    {&Scope::getIsSubroutineType, &Scope::setIsSubroutineType},
+    {&Scope::getIsLabel, &Scope::setIsLabel},
+    {&Scope::getIsTemplate, &Scope::setIsTemplate},
+    {&Scope::getIsClassType, &Scope::setIsClassType},
+    {&Scope::getIsStructType, &Scope::setIsStructType},
+    {&Scope::getIsUnionType, &Scope::setIsUnionType},
+    {&Scope::getHasDiscriminator, &Scope::setHasDiscriminator},
+    {&Scope::getIsCombinedScope, &Scope::setIsCombinedScope},
+};
+
+const ObjectFlag<ScopeFunction> FunctionFlags[] = {
+    {&ScopeFunction::getIsStatic, &ScopeFunction::setIsStatic},
+    {&ScopeFunction::getIsDeclaredInline, &ScopeFunction::setIsDeclaredInline},
+    {&ScopeFunction::getIsDeclaration, &ScopeFunction::setIsDeclaration},
+};
+
+const ObjectFlag<ScopeEnumeration> EnumerationFlags[] = {
+    {&ScopeEnumeration::getIsClass, &ScopeEnumeration::setIsClass},
+};
+
+const ObjectFlag<Type> TypeFlags[] = {
+    {&Type::getIsBaseType, &Type::setIsBaseType},
+    {&Type::getIsConstType, &Type::setIsConstType},
+    {&Type::getIsImportedDeclaration, &Type::setIsImportedDeclaration},
+    {&Type::getIsImportedModule, &Type::setIsImportedModule},
+    {&Type::getIsInheritance, &Type::setIsInheritance},
+    {&Type::getIsPointerType, &Type::setIsPointerType},
+    {&Type::getIsPointerMemberType, &Type::setIsPointerMemberType},
+    {&Type::getIsReferenceType, &Type::setIsReferenceType},
+    {&Type::getIsRestrictType, &Type::setIsRestrictType},
+    {&Type::getIsRvalueReferenceType, &Type::setIsRvalueReferenceType},
+    {&Type::getIsTemplateType, &Type::setIsTemplateType},
+    {&Type::getIsTemplateValue, &Type::setIsTemplateValue},
+    {&Type::getIsTemplateTemplate, &Type::setIsTemplateTemplate},
+    {&Type::getIsUnspecifiedType, &Type::setIsUnspecifiedType},
+    {&Type::getIsVolatileType, &Type::setIsVolatileType},
+    {&Type::getIncludeInPrint, &Type::setIncludeInPrint},
+};
+
+const ObjectFlag<Symbol> SymbolFlags[] = {
+    {&Symbol::getIsMember, &Symbol::setIsMember},
+    {&Symbol::getIsParameter, &Symbol::setIsParameter},
+    {&Symbol::getIsUnspecifiedParameter, &Symbol::setIsUnspecifiedParameter},
+    {&Symbol::getIsVariable, &Symbol::setIsVariable},
+    {&Symbol::getIsStatic, &Symbol::setIsStatic},
+};
+
+const ObjectFlag<Line> LineFlags[] = {
+    {&Line::getIsLineEndSequence, &Line::setIsLineEndSequence},
+    {&Line::getIsNewBasicBlock, &Line::setIsNewBasicBlock},
+    {&Line::getIsNewStatement, &Line::setIsNewStatement},
+    {&Line::getIsEpilogueBegin, &Line::setIsEpilogueBegin},
+    {&Line::getIsPrologueEnd, &Line::setIsPrologueEnd},
+};
+
+template <class T, size_t N>
+uint64_t getFlags(const T &Obj, const ObjectFlag<T> (&Flags)[N]) {
+  uint64_t Bits = 0;
+  for (size_t I = 0; I < N; ++I)
+    if ((Obj.*Flags[I].Get)())
+      Bits |= uint64_t(1) << I;
+  return Bits;
+}
+
+template <class T, size_t N>
+void setFlags(T &Obj, const ObjectFlag<T> (&Flags)[N], uint64_t Bits) {
+  for (size_t I = 0; I < N; ++I)
+    if (Bits & (uint64_t(1) << I))
+      (Obj.*Flags[I].Set)();
+}
+
+// Appends values to a byte string.
+class ByteWriter {
+public:
+  ByteWriter(std::string &Output) : Out(Output) {}
+
+  void writeByte(uint8_t Value) { Out.push_back(static_cast<char>(Value)); }
+  void writeULEB128(uint64_t Value) {
+    do {
+      uint8_t Byte = Value & 0x7f;
+      Value >>= 7;
+      writeByte(Value ? Byte | 0x80 : Byte);
+    } while (Value);
+  }
+  void writeFixed64(uint64_t Value) {
+    for (unsigned I = 0; I < 8; ++I, Value >>= 8)
+      writeByte(Value & 0xff);
+  }
+  void writeString(const std::string &Str) {
+    writeULEB128(Str.size());
+    Out += Str;
+  }
+
+private:
+  std::string &Out;
+};
+
+// Reads the values written by ByteWriter. Reading past the end returns zero
+// and marks the reader as failed.
+class ByteReader {
+public:
+  ByteReader(const std::string &Input) : In(Input) {}
+
+  bool failed() const { return Failed; }
+  bool atEnd() const { return Pos == In.size(); }
+  size_t getPosition() const { return Pos; }
+
+  uint8_t readByte() {
+    if (Pos == In.size()) {
+      Failed = true;
+      return 0;
+    }
+    return static_cast<uint8_t>(In[Pos++]);
+  }
+  uint64_t readULEB128() {
+    uint64_t Value = 0;
+    for (unsigned Shift = 0; Shift < 64; Shift += 7) {
+      uint8_t Byte = readByte();
+      Value |= uint64_t(Byte & 0x7f) << Shift;
+      if (!(Byte & 0x80))
+        return Value;
+    }
+    Failed = true;
+    return 0;
+  }
+  uint64_t readFixed64() {
+    uint64_t Value = 0;
+    for (unsigned I = 0; I < 8; ++I)
+      Value |= uint64_t(readByte()) << (I * 8);
+    return Value;
+  }
+  std::string readString() {
+    uint64_t Size = readULEB128();
+    if (Failed || Size > In.size() - Pos) {
+      Failed = true;
+      return std::string();
+    }
+    std::string Str(In, Pos, static_cast<size_t>(Size));
+    Pos += static_cast<size_t>(Size);
+    return Str;
+  }
+  // Read a count of items that each take at least one byte, failing if there
+  // aren't enough bytes left for them.
+  size_t readCount() {
+    uint64_t Count = readULEB128();
+    if (Count > In.size() - Pos) {
+      Failed = true;
+      return 0;
+    }
+    return static_cast<size_t>(Count);
+  }
+
+private:
+  const std::string &In;
+  size_t Pos = 0;
+  bool Failed = false;
+};
+
+enum LinkBits : uint8_t { HasTypeLink = 1 << 0, HasReferenceLink = 1 << 1 };
+
+// Create the object for a DIE tag, returning null if it isn't of Kind. Lines
+// have no tag.
+Object *createObjectOfKind(uint64_t Kind, uint64_t Tag) {
+  if (Kind == Object::SV_Line)
+    return Tag == 0 ? new Line : nullptr;
+  if (Tag > std::numeric_limits<Dwarf_Half>::max())
+    return nullptr;
+  Object *Obj = createObjectForTag(static_cast<Dwarf_Half>(Tag));
+  if (Obj && Obj->getKind() != Kind) {
+    delete Obj;
+    return nullptr;
+  }
+  return Obj;
+}
+
+// Return true if an object read from the DWARF could have Obj's link to
+// Target, which is in the same unit.
+bool isValidLinkTarget(const Object &Obj, const Object &Target, bool IsType) {
+  if (isa<Line>(Target))
+    return false;
+  // DW_AT_type names a type (or a function type), and DW_AT_import any
+  // declaration. References are between objects of the same kind.
+  if (IsType)
+    return isa<TypeImport>(Obj) || isa<Type>(Target) || isa<Scope>(Target);
+  return (isa<Scope>(Obj) && isa<Scope>(Target)) ||
+         (isa<Symbol>(Obj) && isa<Symbol>(Target)) ||
+         (isa<Type>(Obj) && isa<Type>(Target));
+}
+
+} // end anonymous namespace
+
+namespace ElfDwarfReader {
+
+// Encodes the objects of one unit, children after their parent.
+class ObjectEncoder {
+public:
+  ObjectEncoder(
+      IncrementalState &TheState,
+      const std::function<ObjectLinks(const Object &)> &GetObjectLinks,
+      const std::vector<Dwarf_Off> &AllUnitOffsets, Dwarf_Off HeaderOffset,
+      std::string &Output)
+      : State(TheState), GetLinks(GetObjectLinks), UnitOffsets(AllUnitOffsets),
+        UnitOffset(HeaderOffset), Writer(Output) {}
+
+  bool encode(const Object &Obj) {
+    Writer.writeByte(Obj.getKind());
+    Writer.writeULEB128(Obj.getDieTag());
+    // Lines store their address in the DIE offset.
+    Writer.writeULEB128(isa<Line>(Obj) ? Obj.getDieOffset()
+                                       : Obj.getDieOffset() - UnitOffset);
+    Writer.writeULEB128(Obj.getLineNumber());
+    Writer.writeULEB128(getStringID(Obj.getNameIndex()));
+    Writer.writeULEB128(getStringID(Obj.getFilePathIndex()));
+    Writer.writeByte(Obj.getInvalidFileName());
+
+    if (auto *Ln = dyn_cast<Line>(&Obj)) {
+      Writer.writeULEB128(getFlags(*Ln, LineFlags));
+      Writer.writeULEB128(Ln->getDiscriminator());
+      return true;
+    }
+
+    ObjectLinks Links(GetLinks(Obj));
+    Writer.writeByte((Links.HasType ? HasTypeLink : 0) |
+                     (Links.HasReference ? HasReferenceLink : 0));
+    if ((Links.HasType && !encodeLink(Links.TypeOffset)) ||
+        (Links.HasReference && !encodeLink(Links.ReferenceOffset)))
+      return false;
+
+    if (auto *Scp = dyn_cast<Scope>(&Obj))
+      return encodeScope(*Scp);
+    if (auto *Ty = dyn_cast<Type>(&Obj)) {
+      Writer.writeULEB128(getFlags(*Ty, TypeFlags));
+      Writer.writeULEB128(Ty->getByteSize());
+      Writer.writeULEB128(getStringID(
+          Ty->getValue().empty()
+              ? 0
+              : getGlobalStringPool().getIndex(Ty->getValue())));
+      if (auto *Import = dyn_cast<TypeImport>(Ty))
+        Writer.writeByte(static_cast<uint8_t>(Import->getInheritanceAccess()));
+      return true;
+    }
+    if (auto *Sym = dyn_cast<Symbol>(&Obj)) {
+      Writer.writeULEB128(getFlags(*Sym, SymbolFlags));
+      if (Sym->getIsMember())
+        Writer.writeByte(static_cast<uint8_t>(Sym->getAccessSpecifier()));
+      Writer.writeULEB128(Sym->getLocation());
+    }
+    return true;
+  }
+
+private:
+  bool encodeScope(const Scope &Scp) {
+    Writer.writeULEB128(getFlags(Scp, ScopeFlags));
+    if (auto *Func = dyn_cast<ScopeFunction>(&Scp))
+      Writer.writeULEB128(getFlags(*Func, FunctionFlags));
+    else if (auto *Enum = dyn_cast<ScopeEnumeration>(&Scp))
+      Writer.writeULEB128(getFlags(*Enum, EnumerationFlags));
+
+    Writer.writeULEB128(Scp.getRanges().size());
+    for (const AddressRange &Range : Scp.getRanges()) {
+      Writer.writeULEB128(Range.LowPC);
+      Writer.writeULEB128(Range.HighPC);
+    }
+    Writer.writeULEB128(Scp.getLines().size());
+    for (const Line *Ln : Scp.getLines())
+      encode(*Ln);
+    Writer.writeULEB128(Scp.getChildren().size());
+    for (const Object *Child : Scp.getChildren())
+      if (!encode(*Child))
+        return false;
+    return true;
+  }
+
+  // Write a link as the index of the unit holding it and the offset in it.
+  bool encodeLink(Dwarf_Off Offset) {
+    auto IT = std::upper_bound(UnitOffsets.begin(), UnitOffsets.end(), Offset);
+    if (IT == UnitOffsets.begin())
+      return false;
+    --IT;
+    Writer.writeULEB128(static_cast<uint64_t>(IT - UnitOffsets.begin()));
+    Writer.writeULEB128(Offset - *IT);
+    return true;
+  }
+
+  uint64_t getStringID(StringPoolIndex Index) {
+    if (Index == 0)
+      return 0;
+    if (State.Strings.empty())
+      State.Strings.emplace_back();
+    auto Inserted = State.StringIDs.emplace(Index, State.Strings.size());
+    if (Inserted.second)
+      State.Strings.push_back(*getGlobalStringPool().getRef(Index));
+    return Inserted.first->second;
+  }
+
+  IncrementalState &State;
+  const std::function<ObjectLinks(const Object &)> &GetLinks;
+  const std::vector<Dwarf_Off> &UnitOffsets;
+  Dwarf_Off UnitOffset;
+  ByteWriter Writer;
+};
+
+// Recreates the objects of one unit from the output of ObjectEncoder.
+class ObjectDecoder {
+public:
+  ObjectDecoder(IncrementalState &TheState, const std::string &Input,
+                const std::vector<Dwarf_Off> &LinkedUnitOffsets,
+                Dwarf_Off HeaderOffset, CreatedObjectList &CreatedObjects)
+      : State(TheState), Reader(Input), UnitOffsets(LinkedUnitOffsets),
+        UnitOffset(HeaderOffset), Created(CreatedObjects) {}
+
+  std::unique_ptr<Object> decode() {
+    std::unique_ptr<Object> Obj(decodeObject());
+    if (!Reader.atEnd() || !validateLinks())
+      return nullptr;
+    return Obj;
+  }
+
+private:
+  // Returns null, after deleting any partly decoded objects, on failure.
+  Object *decodeObject() {
+    uint8_t Kind = Reader.readByte();
+    uint64_t Tag = Reader.readULEB128();
+    std::unique_ptr<Object> Obj(createObjectOfKind(Kind, Tag));
+    if (!Obj)
+      return nullptr;
+    Obj->setDieTag(static_cast<Dwarf_Half>(Tag));
+    Dwarf_Off Offset = Reader.readULEB128();
+    Obj->setDieOffset(isa<Line>(*Obj) ? Offset : Offset + UnitOffset);
+    uint64_t LineNumber = Reader.readULEB128();
+    if (LineNumber > std::numeric_limits<uint32_t>::max())
+      return nullptr;
+    Obj->setLineNumber(static_cast<uint32_t>(LineNumber));
+    StringPoolIndex Index = 0;
+    if (!getPoolIndex(Reader.readULEB128(), Index))
+      return nullptr;
+    Obj->setNameIndex(Index);
+    if (!getPoolIndex(Reader.readULEB128(), Index))
+      return nullptr;
+    Obj->setFilePathIndex(Index);
+    if (Reader.readByte())
+      Obj->setInvalidFileName();
+
+    if (auto *Ln = dyn_cast<Line>(Obj.get())) {
+      setFlags(*Ln, LineFlags, Reader.readULEB128());
+      Ln->setDiscriminator(static_cast<Dwarf_Half>(Reader.readULEB128()));
+      return Reader.failed() ? nullptr : Obj.release();
+    }
+
+    // Scopes and types have their qualified name resolved when read.
+    if (isa<Scope>(*Obj) || isa<Type>(*Obj))
+      Obj->resolveQualifiedName();
+
+    ObjectLinks Links;
+    uint8_t LinkBits = Reader.readByte();
+    Links.HasType = LinkBits & HasTypeLink;
+    Links.HasReference = LinkBits & HasReferenceLink;
+    if ((Links.HasType && !decodeLink(Links.TypeOffset)) ||
+        (Links.HasReference && !decodeLink(Links.ReferenceOffset)))
+      return nullptr;
+
+    if (auto *Scp = dyn_cast<Scope>(Obj.get()))
+      return decodeScope(*Scp, Links) ? Obj.release() : nullptr;
+
+    if (auto *Ty = dyn_cast<Type>(Obj.get())) {
+      setFlags(*Ty, TypeFlags, Reader.readULEB128());
+      Ty->setByteSize(static_cast<unsigned>(Reader.readULEB128()));
+      if (!getPoolIndex(Reader.readULEB128(), Index))
+        return nullptr;
+      if (Index)
+        Ty->setValue(*getGlobalStringPool().getRef(Index));
+      if (auto *Import = dyn_cast<TypeImport>(Ty))
+        Import->setInheritanceAccess(
+            static_cast<AccessSpecifier>(Reader.readByte()));
+    } else if (auto *Sym = dyn_cast<Symbol>(Obj.get())) {
+      setFlags(*Sym, SymbolFlags, Reader.readULEB128());
+      if (Sym->getIsMember())
+        Sym->setAccessSpecifier(
+            static_cast<AccessSpecifier>(Reader.readByte()));
+      Sym->setLocation(Reader.readULEB128());
+    }
+    if (Reader.failed())
+      return nullptr;
+    Created.emplace_back(Obj.get(), Links);
+    return Obj.release();
+  }
+
+  bool decodeScope(Scope &Scp, const ObjectLinks &Links) {
+    setFlags(Scp, ScopeFlags, Reader.readULEB128());
+    if (auto *Func = dyn_cast<ScopeFunction>(&Scp))
+      setFlags(*Func, FunctionFlags, Reader.readULEB128());
+    else if (auto *Enum = dyn_cast<ScopeEnumeration>(&Scp))
+      setFlags(*Enum, EnumerationFlags, Reader.readULEB128());
+
+    for (size_t I = 0, Count = Reader.readCount(); I < Count; ++I) {
+      Dwarf_Addr LowPC = Reader.readULEB128();
+      Scp.addRange(LowPC, Reader.readULEB128());
+    }
+    // Lines are created before the scope is linked, and children after.
+    for (size_t I = 0, Count = Reader.readCount(); I < Count; ++I) {
+      Object *Ln = decodeObject();
+      if (!Ln || !isa<Line>(*Ln)) {
+        delete Ln;
+        return false;
+      }
+      Scp.addChild(Ln);
+    }
+    if (Reader.failed())
+      return false;
+    Created.emplace_back(&Scp, Links);
+    for (size_t I = 0, Count = Reader.readCount(); I < Count; ++I) {
+      Object *Child = decodeObject();
+      if (!Child || isa<Line>(*Child)) {
+        delete Child;
+        return false;
+      }
+      Scp.addChild(Child);
+    }
+    return !Reader.failed();
+  }
+
+  // Return true if the objects are in DIE order, as they were read, and each
+  // link to another object of the unit is one the DWARF could have.
+  bool validateLinks() const {
+    for (size_t I = 1; I < Created.size(); ++I)
+      if (Created[I - 1].first->getDieOffset() >=
+          Created[I].first->getDieOffset())
+        return false;
+    auto IsValid = [this](const Object &Obj, Dwarf_Off Offset, bool IsType) {
+      auto IT = std::lower_bound(
+          Created.begin(), Created.end(), Offset,
+          [](const CreatedObjectList::value_type &Item, Dwarf_Off Off) {
+            return Item.first->getDieOffset() < Off;
+          });
+      return IT == Created.end() || IT->first->getDieOffset() != Offset ||
+             isValidLinkTarget(Obj, *IT->first, IsType);
+    };
+    for (const auto &ObjLinks : Created) {
+      const ObjectLinks &Links = ObjLinks.second;
+      if ((Links.HasType &&
+           !IsValid(*ObjLinks.first, Links.TypeOffset, true)) ||
+          (Links.HasReference &&
+           !IsValid(*ObjLinks.first, Links.ReferenceOffset, false)))
+        return false;
+    }
+    return true;
+  }
+
+  bool decodeLink(Dwarf_Off &Offset) {
+    uint64_t Unit = Reader.readULEB128();
+    Dwarf_Off UnitRelativeOffset = Reader.readULEB128();
+    if (Unit >= UnitOffsets.size() ||
+        UnitOffsets[static_cast<size_t>(Unit)] ==
+            IncrementalState::InvalidUnitOffset)
+      return false;
+    Offset = UnitOffsets[static_cast<size_t>(Unit)] + UnitRelativeOffset;
+    return !Reader.failed();
+  }
+
+  bool getPoolIndex(uint64_t ID, StringPoolIndex &Index) {
+    if (ID >= State.Strings.size() && ID != 0)
+      return false;
+    if (ID == 0) {
+      Index = 0;
+      return true;
+    }
+    State.PoolIndices.resize(State.Strings.size());
+    StringPoolIndex &PoolIndex = State.PoolIndices[static_cast<size_t>(ID)];
+    if (!PoolIndex)
+      PoolIndex = getGlobalStringPool().getIndex(
+          State.Strings[static_cast<size_t>(ID)]);
+    Index = PoolIndex;
+    return true;
+  }
+
+  IncrementalState &State;
+  ByteReader Reader;
+  const std::vector<Dwarf_Off> &UnitOffsets;
+  Dwarf_Off UnitOffset;
+  CreatedObjectList &Created;
+};
+
+} // end namespace ElfDwarfReader
+
+const Dwarf_Off IncrementalState::InvalidUnitOffset;
+
+bool IncrementalState::encodeUnit(
+    const Object *UnitObject,
+    const std::function<ObjectLinks(const Object &)> &GetLinks,
+    const std::vector<Dwarf_Off> &UnitOffsets, CompileUnitState &Unit) {
+  Unit.Objects.clear();
+  if (!UnitObject)
+    return true;
+  // The unit object's DIE follows the header of the unit holding it.
+  auto IT = std::upper_bound(UnitOffsets.begin(), UnitOffsets.end(),
+                             UnitObject->getDieOffset());
+  if (IT == UnitOffsets.begin())
+    return false;
+  ObjectEncoder Encoder(*this, GetLinks, UnitOffsets, *std::prev(IT),
+                        Unit.Objects);
+  return Encoder.encode(*UnitObject);
+}
+
+bool IncrementalState::decodeUnit(const CompileUnitState &Unit,
+                                  Dwarf_Off HeaderOffset,
+                                  const std::vector<Dwarf_Off> &UnitOffsets,
+                                  std::unique_ptr<Object> &UnitObject,
+                                  CreatedObjectList &Created) {
+  UnitObject.reset();
+  Created.clear();
+  if (Unit.Objects.empty())
+    return true;
+  ObjectDecoder Decoder(*this, Unit.Objects, UnitOffsets, HeaderOffset,
+                        Created);
+  UnitObject = Decoder.decode();
+  if (!UnitObject)
+    Created.clear();
+  return UnitObject != nullptr;
+}
+
+bool IncrementalState::save(const std::string &FileName) const {
+  // The magic, the version and the checksum of the rest.
+  std::string Data(StateMagic, sizeof(StateMagic));
+  ByteWriter Writer(Data);
+  Writer.writeString(StateVersion);
+  size_t ChecksumPos = Data.size();
+  Writer.writeFixed64(0);
+  Writer.writeULEB128(Strings.size());
+  for (const std::string &Str : Strings)
+    Writer.writeString(Str);
+  Writer.writeULEB128(Units.size());
+  for (const CompileUnitState &Unit : Units) {
+    Writer.writeFixed64(Unit.Hash);
+    Writer.writeULEB128(Unit.ReferencedUnits.size());
+    for (uint32_t Index : Unit.ReferencedUnits)
+      Writer.writeULEB128(Index);
+    Writer.writeByte(Unit.Reusable);
+    Writer.writeULEB128(Unit.UnknownTags.size());
+    for (Dwarf_Half Tag : Unit.UnknownTags)
+      Writer.writeULEB128(Tag);
+    Writer.writeULEB128(Unit.UnknownAttrForms.size());
+    for (const auto &AttrForm : Unit.UnknownAttrForms) {
+      Writer.writeULEB128(AttrForm.first);
+      Writer.writeULEB128(AttrForm.second);
+    }
+    Writer.writeString(Unit.Objects);
+  }
+  uint64_t Checksum = getChecksum(Data, ChecksumPos + 8);
+  for (size_t I = 0; I < 8; ++I, Checksum >>= 8)
+    Data[ChecksumPos + I] = static_cast<char>(Checksum & 0xff);
+
+  std::ofstream File(FileName, std::ios::binary | std::ios::trunc);
+  File.write(Data.data(), static_cast<std::streamsize>(Data.size()));
+  return static_cast<bool>(File);
+}
+
+bool IncrementalState::load(const std::string &FileName) {
+  Units.clear();
+  Strings.clear();
+  StringIDs.clear();
+  PoolIndices.clear();
+
+  std::ifstream File(FileName, std::ios::binary);
+  if (!File)
+    return false;
+  std::string Data((std::istreambuf_iterator<char>(File)),
+                   std::istreambuf_iterator<char>());
+  if (Data.compare(0, sizeof(StateMagic),
+                   std::string(StateMagic, sizeof(StateMagic))) != 0)
+    return false;
+  Data.erase(0, sizeof(StateMagic));
+
+  ByteReader Reader(Data);
+  if (Reader.readString() != StateVersion)
+    return false;
+  uint64_t Checksum = Reader.readFixed64();
+  if (Reader.failed() || Checksum != getChecksum(Data, Reader.getPosition()))
+    return false;
+  Strings.resize(Reader.readCount());
+  for (std::string &Str : Strings)
+    Str = Reader.readString();
+  Units.resize(Reader.readCount());
+  for (CompileUnitState &Unit : Units) {
+    Unit.Hash = Reader.readFixed64();
+    Unit.ReferencedUnits.resize(Reader.readCount());
+    for (uint32_t &Index : Unit.ReferencedUnits)
+      Index = static_cast<uint32_t>(Reader.readULEB128());
+    Unit.Reusable = Reader.readByte() != 0;
+    Unit.UnknownTags.resize(Reader.readCount());
+    for (Dwarf_Half &Tag : Unit.UnknownTags)
+      Tag = static_cast<Dwarf_Half>(Reader.readULEB128());
+    Unit.UnknownAttrForms.resize(Reader.readCount());
+    for (auto &AttrForm : Unit.UnknownAttrForms) {
+      AttrForm.first = static_cast<Dwarf_Half>(Reader.readULEB128());
+      AttrForm.second = static_cast<Dwarf_Half>(Reader.readULEB128());
+    }
+    Unit.Objects = Reader.readString();
+    if (Reader.failed())
+      break;
+  }
+  if (Reader.failed() || !Reader.atEnd()) {
+    Units.clear();
+    Strings.clear();
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,137 @@
+//===-- ElfDwarfReader/IncrementalState.h -----------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the state that a DwarfReader saves after reading a file,
+/// so that a later read can reuse the objects of unchanged compile units.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef INCREMENTAL_STATE_H
+#define INCREMENTAL_STATE_H
+
+#include "Object.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ElfDwarfReader {
+
+/// \brief The offsets of the DIEs that an object's type and reference are set
+/// from (DW_AT_type or DW_AT_import, and DW_AT_specification,
+/// DW_AT_abstract_origin or DW_AT_extension).
+///
+/// A link made with DW_FORM_ref_sig8 holds the signature of the type unit
+/// instead of an offset. Files with type units aren't read incrementally, so
+/// those links are never saved.
+struct ObjectLinks {
+  bool HasType = false;
+  bool HasReference = false;
+  bool TypeIsSignature = false;
+  bool ReferenceIsSignature = false;
+  Dwarf_Off TypeOffset = 0;
+  Dwarf_Off ReferenceOffset = 0;
+};
+
+/// \brief The saved objects of one compile unit.
+struct CompileUnitState {
+  /// \brief Fingerprint of the unit, see CompileUnitFingerprint.
+  uint64_t Hash = 0;
+  std::vector<uint32_t> ReferencedUnits;
+  /// \brief False if the objects were not saved, so the unit can't be reused.
+  bool Reusable = false;
+  /// \brief Unknown DWARF tags and attribute/form pairs found in the unit,
+  /// whose warnings are repeated when the unit is reused.
+  std::vector<Dwarf_Half> UnknownTags;
+  std::vector<std::pair<Dwarf_Half, Dwarf_Half>> UnknownAttrForms;
+  /// \brief The encoded objects, empty if the unit created no objects.
+  std::string Objects;
+};
+
+/// \brief Objects created from saved state, with their links, in the order
+/// that they were created when read from the DWARF.
+using CreatedObjectList =
+    std::vector<std::pair<LibScopeView::Object *, ObjectLinks>>;
+
+/// \brief The state saved by a read of a file, for reuse by a later read.
+///
+/// The objects of each compile unit are saved as they are before
+/// LibScopeView::Reader's post creation actions. Offsets are saved relative to
+/// a unit, so that a unit can be reused after it has moved in .debug_info.
+class IncrementalState {
+public:
+  /// \brief Load the state from a file, returning false if the file is
+  /// missing, invalid, fails its checksum or was saved by another version.
+  bool load(const std::string &FileName);
+  /// \brief Save the state to a file, returning false on failure.
+  bool save(const std::string &FileName) const;
+
+  /// \brief Encode the objects of a compile unit into Unit.Objects.
+  ///
+  /// UnitObject is the object created from the unit DIE, or null if there is
+  /// none. UnitOffsets are the header offsets of every unit in the file.
+  /// Returns false if an object links to a DIE outside of every unit.
+  bool encodeUnit(
+      const LibScopeView::Object *UnitObject,
+      const std::function<ObjectLinks(const LibScopeView::Object &)> &GetLinks,
+      const std::vector<Dwarf_Off> &UnitOffsets, CompileUnitState &Unit);
+
+  /// \brief Recreate the objects of a saved unit.
+  ///
+  /// The unit's offsets are moved to a unit header at HeaderOffset, and
+  /// UnitOffsets gives the current header offsets of the saved units (or
+  /// InvalidUnitOffset) for its links. Sets UnitObject to the recreated unit
+  /// object (null if the unit had none) and returns false if the saved data
+  /// is invalid, including an object whose kind doesn't match its tag or a
+  /// link to an object of the unit that the DWARF couldn't have made.
+  bool decodeUnit(const CompileUnitState &Unit, Dwarf_Off HeaderOffset,
+                  const std::vector<Dwarf_Off> &UnitOffsets,
+                  std::unique_ptr<LibScopeView::Object> &UnitObject,
+                  CreatedObjectList &Created);
+
+  /// \brief Marks a saved unit that can't be linked to in decodeUnit's
+  /// UnitOffsets.
+  static const Dwarf_Off InvalidUnitOffset = ~Dwarf_Off(0);
+
+  std::vector<CompileUnitState> Units;
+
+private:
+  friend class ObjectDecoder;
+  friend class ObjectEncoder;
+
+  // Strings shared by all units, referenced by ID. ID 0 is the null string.
+  std::vector<std::string> Strings;
+  // String IDs for StringPool indices, used when encoding.
+  std::unordered_map<LibScopeView::StringPoolIndex, uint64_t> StringIDs;
+  // StringPool indices for string IDs, filled in when first decoded.
+  std::vector<LibScopeView::StringPoolIndex> PoolIndices;
+};
+
+} // end namespace ElfDwarfReader
+
+#endif // INCREMENTAL_STATE_H
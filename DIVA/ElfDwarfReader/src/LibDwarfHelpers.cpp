@@ -31,6 +31,16 @@
 #include "LibDwarfHelpers.h"
 
 #include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+// The libelf header isn't distributed with the prebuilt libraries, so declare
+// the functions used to read an ELF image from memory.
+extern "C" {
+unsigned elf_version(unsigned Version);
+dwarf_elf_handle elf_memory(char *Image, size_t Size);
+int elf_end(dwarf_elf_handle Elf);
+}
 
 using namespace ElfDwarfReader;
 
@@ -38,6 +48,19 @@ namespace {
 
 const bool IsInfo = true;
 
+// EV_CURRENT from libelf.h.
+const unsigned ElfCurrentVersion = 1;
+
+// The 8 byte signature of a type unit as an integer, in the byte order of the
+// host. It is only used to match signatures read from the same file.
+uint64_t getSignatureValue(const Dwarf_Sig8 &Signature) {
+  uint64_t Value;
+  static_assert(sizeof(Value) == sizeof(Signature.signature),
+                "A type signature is 8 bytes");
+  std::memcpy(&Value, Signature.signature, sizeof(Value));
+  return Value;
+}
+
 [[noreturn]] void dwarfErrorHandler(Dwarf_Error Error, Dwarf_Ptr PtrToDbg) {
   Dwarf_Debug Dbg = *static_cast<Dwarf_Debug *>(PtrToDbg);
   throw LibDwarfError(Error, Dbg);
@@ -89,7 +112,7 @@ std::string ElfDwarfReader::getDwarfFormAsString(Dwarf_Half Form) {
 
 // DwarfDebugData methods.
 
-DwarfDebugData::DwarfDebugData(int FileDescriptor) : Dbg(nullptr) {
+DwarfDebugData::DwarfDebugData(int FileDescriptor) : Dbg(nullptr), Elf(nullptr) {
   // Errors in dwarf_init occur before the handler is setup, so use the error
   // pointer interface here, and then throw the exception 'manually'.
   Dwarf_Error Err;
@@ -106,14 +129,42 @@ DwarfDebugData::DwarfDebugData(int FileDescriptor) : Dbg(nullptr) {
   }
 }
 
-DwarfDebugData::DwarfDebugData(DwarfDebugData &&Other) : Dbg(nullptr) {
+DwarfDebugData::DwarfDebugData(char *Image, size_t Size)
+    : Dbg(nullptr), Elf(nullptr) {
+  // libelf must be told the version of the caller before any other call.
+  static std::once_flag ElfVersionFlag;
+  std::call_once(ElfVersionFlag, [] { elf_version(ElfCurrentVersion); });
+  Elf = elf_memory(Image, Size);
+  if (!Elf)
+    return;
+
+  Dwarf_Error Err;
+  int ret = dwarf_elf_init(Elf, DW_DLC_READ, dwarfErrorHandler,
+                           /*errarg*/ &Dbg, &Dbg, &Err);
+  if (ret == DW_DLV_NO_ENTRY) {
+    Dbg = nullptr;
+    return;
+  }
+  if (ret != DW_DLV_OK) {
+    LibDwarfError LibErr(Err, Dbg);
+    freeDbg();
+    throw LibErr;
+  }
+}
+
+DwarfDebugData::DwarfDebugData(DwarfDebugData &&Other)
+    : Dbg(nullptr), Elf(nullptr) {
   std::swap(Dbg, Other.Dbg);
+  std::swap(Elf, Other.Elf);
+  std::swap(AddressTable, Other.AddressTable);
 }
 
 DwarfDebugData &DwarfDebugData::operator=(DwarfDebugData &&Other) {
   if (Dbg != Other.Dbg) {
     freeDbg();
     std::swap(Dbg, Other.Dbg);
+    std::swap(Elf, Other.Elf);
+    std::swap(AddressTable, Other.AddressTable);
   }
   return *this;
 }
@@ -124,9 +175,21 @@ void DwarfDebugData::freeDbg() {
     dwarf_finish(Dbg, &Err);
     Dbg = nullptr;
   }
+  if (Elf) {
+    elf_end(Elf);
+    Elf = nullptr;
+  }
 }
 
 std::vector<DwarfCompileUnit> DwarfDebugData::getCompileUnits() const {
+  return getUnits(IsInfo);
+}
+
+std::vector<DwarfCompileUnit> DwarfDebugData::getTypeUnits() const {
+  return getUnits(!IsInfo);
+}
+
+std::vector<DwarfCompileUnit> DwarfDebugData::getUnits(bool InInfo) const {
   std::vector<DwarfCompileUnit> Result;
   if (empty())
     return Result;
@@ -134,24 +197,32 @@ std::vector<DwarfCompileUnit> DwarfDebugData::getCompileUnits() const {
   Dwarf_Unsigned CurrentHeader = 0U;
   for (;;) {
     Dwarf_Unsigned NextHeader;
+    Dwarf_Half Version = 0;
+    Dwarf_Sig8 Signature;
+    Dwarf_Unsigned TypeOffset = 0;
     int ret = dwarf_next_cu_header_d(
-        Dbg, IsInfo, /*cu_header_length*/ nullptr, /*version_stamp*/ nullptr,
+        Dbg, InInfo, /*cu_header_length*/ nullptr, &Version,
         /*abbrev_offset*/ nullptr, /*address_size*/ nullptr,
-        /*offset_size*/ nullptr, /*extension_size*/ nullptr,
-        /*signature*/ nullptr, /*typeoffse*/ nullptr, &NextHeader,
-        /*header_cu_type*/ nullptr, /*error*/ nullptr);
+        /*offset_size*/ nullptr, /*extension_size*/ nullptr, &Signature,
+        &TypeOffset, &NextHeader, /*header_cu_type*/ nullptr,
+        /*error*/ nullptr);
     if (ret != DW_DLV_OK)
       break;
 
     // Each CU header should have a CU sibling.
     Dwarf_Die RawCUDie;
-    ret = dwarf_siblingof_b(Dbg, /*die*/ nullptr, IsInfo, &RawCUDie, nullptr);
+    ret = dwarf_siblingof_b(Dbg, /*die*/ nullptr, InInfo, &RawCUDie, nullptr);
     if (ret != DW_DLV_OK)
       break;
 
     Result.emplace_back(DwarfDie(*this, RawCUDie));
     Result.back().HeaderOffset = CurrentHeader;
     Result.back().NextHeaderOffset = NextHeader;
+    Result.back().Version = Version;
+    if (!InInfo) {
+      Result.back().Signature = getSignatureValue(Signature);
+      Result.back().TypeOffset = CurrentHeader + TypeOffset;
+    }
 
     CurrentHeader = NextHeader;
   }
@@ -159,12 +230,72 @@ std::vector<DwarfCompileUnit> DwarfDebugData::getCompileUnits() const {
   return Result;
 }
 
+std::vector<DwarfArange> DwarfDebugData::getAranges() const {
+  std::vector<DwarfArange> Result;
+  if (empty())
+    return Result;
+
+  Dwarf_Arange *Aranges = nullptr;
+  Dwarf_Signed ArangeCount = 0;
+  if (dwarf_get_aranges(Dbg, &Aranges, &ArangeCount, nullptr) != DW_DLV_OK)
+    return Result;
+
+  Result.reserve(static_cast<size_t>(ArangeCount));
+  for (Dwarf_Signed I = 0; I < ArangeCount; ++I) {
+    DwarfArange Entry;
+    Dwarf_Off CUDieOffset;
+    if (dwarf_get_arange_info_b(Aranges[I], /*segment*/ nullptr,
+                                /*segment_entry_size*/ nullptr, &Entry.Start,
+                                &Entry.Length, &CUDieOffset,
+                                nullptr) == DW_DLV_OK &&
+        dwarf_get_arange_cu_header_offset(Aranges[I], &Entry.CUHeaderOffset,
+                                          nullptr) == DW_DLV_OK)
+      Result.push_back(Entry);
+    dwarf_dealloc(Dbg, Aranges[I], DW_DLA_ARANGE);
+  }
+  dwarf_dealloc(Dbg, Aranges, DW_DLA_LIST);
+
+  return Result;
+}
+
+bool DwarfDebugData::findPackageUnit(uint64_t DwoId,
+                                     Dwarf_Off &InfoOffset) const {
+  Dwarf_Sig8 Key;
+  std::memcpy(Key.signature, &DwoId, sizeof(DwoId));
+  Dwarf_Debug_Fission_Per_CU PerCU;
+  std::memset(&PerCU, 0, sizeof(PerCU));
+  Dwarf_Error Err;
+  if (dwarf_get_debugfission_for_key(Dbg, &Key, "cu", &PerCU, &Err) !=
+      DW_DLV_OK)
+    return false;
+  InfoOffset = PerCU.pcu_offset[DW_SECT_INFO];
+  return true;
+}
+
 std::string DwarfDebugData::copyAndFreeDwarfString(char *DwarfStr) const {
   std::string Result(DwarfStr);
   dwarf_dealloc(Dbg, DwarfStr, DW_DLA_STRING);
   return Result;
 }
 
+// DwarfAddressTable methods.
+
+bool DwarfAddressTable::getAddress(Dwarf_Off UnitOffset, Dwarf_Unsigned Index,
+                                   Dwarf_Addr &Address) const {
+  auto IT = Bases.find(UnitOffset);
+  if (!DebugAddr || IT == Bases.end())
+    return false;
+  Dwarf_Half AddressSize = IT->second.first;
+  Dwarf_Unsigned Offset = IT->second.second + Index * AddressSize;
+  if (Offset > DebugAddr->size() || DebugAddr->size() - Offset < AddressSize)
+    return false;
+  Address = 0;
+  for (Dwarf_Half I = 0; I < AddressSize; ++I)
+    Address = (Address << 8) |
+              (*DebugAddr)[Offset + (BigEndian ? I : AddressSize - 1 - I)];
+  return true;
+}
+
 // DwarfDie methods.
 
 DwarfDie::DwarfDie(DwarfDie &&Other)
@@ -216,6 +347,29 @@ std::string DwarfDie::getTagName() const {
 
 DwarfLineTable DwarfDie::getLineTable() const { return DwarfLineTable(*this); }
 
+std::vector<DwarfAddressRange>
+DwarfDie::getRanges(Dwarf_Off RangesOffset, Dwarf_Addr BaseAddress) const {
+  std::vector<DwarfAddressRange> Result;
+  Dwarf_Ranges *Ranges = nullptr;
+  Dwarf_Signed RangeCount = 0;
+  if (dwarf_get_ranges_a(*DebugData, RangesOffset, Die, &Ranges, &RangeCount,
+                         /*bytecount*/ nullptr, nullptr) != DW_DLV_OK)
+    return Result;
+
+  for (Dwarf_Signed I = 0; I < RangeCount; ++I) {
+    const Dwarf_Ranges &Entry = Ranges[I];
+    if (Entry.dwr_type == DW_RANGES_ADDRESS_SELECTION)
+      BaseAddress = Entry.dwr_addr2;
+    else if (Entry.dwr_type == DW_RANGES_ENTRY &&
+             Entry.dwr_addr1 < Entry.dwr_addr2)
+      Result.push_back(
+          {BaseAddress + Entry.dwr_addr1, BaseAddress + Entry.dwr_addr2});
+  }
+  dwarf_ranges_dealloc(*DebugData, Ranges, RangeCount);
+
+  return Result;
+}
+
 void DwarfDie::freeDie() {
   if (Die) {
     dwarf_dealloc(*DebugData, Die, DW_DLA_DIE);
@@ -245,17 +399,34 @@ DwarfAttrValue DwarfDie::getAttr(Dwarf_Half Attr) const {
   case DW_FORM_ref4:
   case DW_FORM_ref8:
   case DW_FORM_ref_udata:
-  case DW_FORM_ref_sig8:
   case DW_FORM_sec_offset: {
     Dwarf_Off Reference;
     dwarf_global_formref(Attribute, &Reference, nullptr);
     return DwarfAttrValue(Reference, DwarfAttrValueKind::Reference, Form);
   }
+  case DW_FORM_ref_sig8: {
+    Dwarf_Sig8 Signature;
+    dwarf_formsig8(Attribute, &Signature, nullptr);
+    return DwarfAttrValue(getSignatureValue(Signature),
+                          DwarfAttrValueKind::Signature, Form);
+  }
   case DW_FORM_addr:
   case DW_FORM_addrx:
   case DW_FORM_GNU_addr_index: {
     Dwarf_Addr Address;
-    dwarf_formaddr(Attribute, &Address, nullptr);
+    const DwarfAddressTable *Table = DebugData.getAddressTable();
+    if (Form == DW_FORM_addr || !Table) {
+      dwarf_formaddr(Attribute, &Address, nullptr);
+    } else {
+      // The index of a split unit's address is looked up in its skeleton's
+      // part of the file's .debug_addr.
+      Dwarf_Unsigned Index;
+      Dwarf_Off UnitOffset;
+      dwarf_get_debug_addr_index(Attribute, &Index, nullptr);
+      dwarf_CU_dieoffset_given_die(Die, &UnitOffset, nullptr);
+      if (!Table->getAddress(UnitOffset, Index, Address))
+        return DwarfAttrValue(); // Empty.
+    }
     return DwarfAttrValue(Address, DwarfAttrValueKind::Address, Form);
   }
   case DW_FORM_flag:
@@ -328,7 +499,9 @@ DwarfDieChildIterator &DwarfDieChildIterator::operator++() {
   assert(Child && "Incremented end DwarfDieChildIterator");
   if (Child) {
     Dwarf_Die RawChildDie;
-    int ret = dwarf_siblingof_b(Child->DebugData.get(), **Child, IsInfo,
+    // The children of a type unit are in .debug_types, not .debug_info.
+    int ret = dwarf_siblingof_b(Child->DebugData.get(), **Child,
+                                dwarf_get_die_infotypes_flag(**Child),
                                 &RawChildDie, nullptr);
     if (ret == DW_DLV_OK)
       Child = std::make_shared<DwarfDie>(Child->DebugData, RawChildDie);
@@ -352,6 +525,9 @@ DwarfAttrValue::DwarfAttrValue(const DwarfAttrValue &Other) {
   case DwarfAttrValueKind::Reference:
     Value.Reference = Other.Value.Reference;
     break;
+  case DwarfAttrValueKind::Signature:
+    Value.Signature = Other.Value.Signature;
+    break;
   case DwarfAttrValueKind::Address:
     Value.Address = Other.Value.Address;
     break;
@@ -386,6 +562,9 @@ DwarfAttrValue::DwarfAttrValue(DwarfAttrValue &&Other) {
   case DwarfAttrValueKind::Reference:
     Value.Reference = Other.Value.Reference;
     break;
+  case DwarfAttrValueKind::Signature:
+    Value.Signature = Other.Value.Signature;
+    break;
   case DwarfAttrValueKind::Address:
     Value.Address = Other.Value.Address;
     break;
@@ -422,6 +601,9 @@ DwarfAttrValue &DwarfAttrValue::operator=(const DwarfAttrValue &Other) {
   case DwarfAttrValueKind::Reference:
     Value.Reference = Other.Value.Reference;
     break;
+  case DwarfAttrValueKind::Signature:
+    Value.Signature = Other.Value.Signature;
+    break;
   case DwarfAttrValueKind::Address:
     Value.Address = Other.Value.Address;
     break;
@@ -459,6 +641,9 @@ DwarfAttrValue &DwarfAttrValue::operator=(DwarfAttrValue &&Other) {
   case DwarfAttrValueKind::Reference:
     Value.Reference = Other.Value.Reference;
     break;
+  case DwarfAttrValueKind::Signature:
+    Value.Signature = Other.Value.Signature;
+    break;
   case DwarfAttrValueKind::Address:
     Value.Address = Other.Value.Address;
     break;
@@ -489,6 +674,11 @@ Dwarf_Off DwarfAttrValue::getReference() const {
   return Value.Reference;
 }
 
+uint64_t DwarfAttrValue::getSignature() const {
+  assert(Kind == DwarfAttrValueKind::Signature);
+  return Value.Signature;
+}
+
 Dwarf_Addr DwarfAttrValue::getAddress() const {
   assert(Kind == DwarfAttrValueKind::Address);
   return Value.Address;
@@ -551,6 +741,7 @@ DwarfAttrValue::DwarfAttrValue(std::vector<uint8_t> &&Val,
   case DwarfAttrValueKind::Boolean:
   case DwarfAttrValueKind::Empty:
   case DwarfAttrValueKind::Reference:
+  case DwarfAttrValueKind::Signature:
   case DwarfAttrValueKind::Address:
   case DwarfAttrValueKind::Unsigned:
   case DwarfAttrValueKind::Signed:
@@ -571,6 +762,9 @@ DwarfAttrValue::DwarfAttrValue(Dwarf_Unsigned Val, DwarfAttrValueKind ValKind,
   case DwarfAttrValueKind::Reference:
     Value.Reference = Val;
     break;
+  case DwarfAttrValueKind::Signature:
+    Value.Signature = Val;
+    break;
   case DwarfAttrValueKind::Address:
     Value.Address = Val;
     break;
@@ -593,6 +787,7 @@ void DwarfAttrValue::destroyValue() {
   case DwarfAttrValueKind::Empty:
   case DwarfAttrValueKind::UnknownForm:
   case DwarfAttrValueKind::Reference:
+  case DwarfAttrValueKind::Signature:
   case DwarfAttrValueKind::Address:
   case DwarfAttrValueKind::Boolean:
   case DwarfAttrValueKind::Unsigned:
@@ -613,66 +808,95 @@ void DwarfAttrValue::destroyValue() {
 
 // DwarfLineTable methods.
 
-DwarfLineTable::DwarfLineTable(const DwarfDie &CU)
-    : Context(nullptr), Lines(nullptr), LineCount(0U) {
+DwarfLineTable::DwarfLineTable(const DwarfDie &CU) {
   assert(CU.getTag() == DW_TAG_compile_unit &&
          "getLineTable is only valid on compile units");
 
   Dwarf_Unsigned Version;
   Dwarf_Small TableCount;
+  Dwarf_Line_Context Context = nullptr;
   auto Ret = dwarf_srclines_b(*CU, &Version, &TableCount, &Context, nullptr);
 
   assert(TableCount <= 1 && "Multiline table is not supported");
   if (Ret != DW_DLV_OK || TableCount != 1) {
-    freeLines();
+    if (Context)
+      dwarf_srclines_dealloc_b(Context);
     return;
   }
 
-  Dwarf_Signed SLineCount;
-  Ret = dwarf_srclines_from_linecontext(Context, &Lines, &SLineCount, nullptr);
-  if (Ret != DW_DLV_OK) {
-    freeLines();
-    return;
+  // Copy the rows out so that the line context can be freed straight away.
+  Dwarf_Line *Lines = nullptr;
+  Dwarf_Signed LineCount = 0;
+  Ret = dwarf_srclines_from_linecontext(Context, &Lines, &LineCount, nullptr);
+  if (Ret == DW_DLV_OK && LineCount > 0) {
+    reserve(static_cast<size_t>(LineCount));
+    for (Dwarf_Signed I = 0; I < LineCount; ++I) {
+      Dwarf_Line Line = Lines[I];
+      Dwarf_Unsigned LineNo = 0, SrcFileID = 0, ISA = 0, Discriminator = 0;
+      Dwarf_Addr LineAddr = 0;
+      Dwarf_Bool IsBeginStatement = false, IsEndSequence = false,
+                 IsBeginBlock = false, IsPrologEnd = false,
+                 IsEpilogueBegin = false;
+      dwarf_lineno(Line, &LineNo, nullptr);
+      dwarf_line_srcfileno(Line, &SrcFileID, nullptr);
+      dwarf_lineaddr(Line, &LineAddr, nullptr);
+      dwarf_linebeginstatement(Line, &IsBeginStatement, nullptr);
+      dwarf_lineendsequence(Line, &IsEndSequence, nullptr);
+      dwarf_lineblock(Line, &IsBeginBlock, nullptr);
+      dwarf_prologue_end_etc(Line, &IsPrologEnd, &IsEpilogueBegin, &ISA,
+                             &Discriminator, nullptr);
+
+      uint8_t Flags = (IsBeginStatement ? BeginStatement : 0) |
+                      (IsEndSequence ? EndSequence : 0) |
+                      (IsBeginBlock ? BeginBlock : 0) |
+                      (IsPrologEnd ? PrologEnd : 0) |
+                      (IsEpilogueBegin ? EpilogueBegin : 0);
+      addRow(LineAddr, LineNo, SrcFileID, Flags, ISA, Discriminator);
+    }
   }
-
-  LineCount = SLineCount < 0 ? 0U : static_cast<size_t>(SLineCount);
+  dwarf_srclines_dealloc_b(Context);
 }
 
-DwarfLineTable::DwarfLineTable(DwarfLineTable &&Other)
-    : Context(nullptr), Lines(nullptr), LineCount(0U) {
-  swap(*this, Other);
+void DwarfLineTable::clear() {
+  Addresses.clear();
+  LineNumbers.clear();
+  SrcFileIDs.clear();
+  RowFlagValues.clear();
+  ISAs.clear();
+  Discriminators.clear();
 }
 
-DwarfLineTable &DwarfLineTable::operator=(DwarfLineTable &&Other) {
-  if (this != &Other) {
-    freeLines();
-    swap(*this, Other);
-  }
-  return *this;
+void DwarfLineTable::reserve(size_t Rows) {
+  Addresses.reserve(Rows);
+  LineNumbers.reserve(Rows);
+  SrcFileIDs.reserve(Rows);
+  RowFlagValues.reserve(Rows);
+  ISAs.reserve(Rows);
+  Discriminators.reserve(Rows);
 }
 
 DwarfLineEntry DwarfLineTable::getLine(size_t LineIndex) const {
   assert(LineIndex < size() && "Index out of range");
-  Dwarf_Line Line = Lines[LineIndex];
+  uint8_t Flags = RowFlagValues[LineIndex];
 
   DwarfLineEntry Result;
-  dwarf_lineno(Line, &Result.LineNo, nullptr);
-  dwarf_line_srcfileno(Line, &Result.SrcFileID, nullptr);
-  dwarf_lineaddr(Line, &Result.LineAddr, nullptr);
-
-  dwarf_linebeginstatement(Line, &Result.IsBeginStatement, nullptr);
-  dwarf_lineendsequence(Line, &Result.IsEndSequence, nullptr);
-  dwarf_lineblock(Line, &Result.IsBeginBlock, nullptr);
-  dwarf_prologue_end_etc(Line, &Result.IsPrologEnd, &Result.IsEpilogueBegin,
-                         &Result.ISA, &Result.Discriminator, nullptr);
-
+  Result.LineNo = LineNumbers[LineIndex];
+  Result.SrcFileID = SrcFileIDs[LineIndex];
+  Result.LineAddr = Addresses[LineIndex];
+  Result.IsBeginStatement = (Flags & BeginStatement) != 0;
+  Result.IsEndSequence = (Flags & EndSequence) != 0;
+  Result.IsBeginBlock = (Flags & BeginBlock) != 0;
+  Result.IsPrologEnd = (Flags & PrologEnd) != 0;
+  Result.IsEpilogueBegin = (Flags & EpilogueBegin) != 0;
+  Result.ISA = ISAs[LineIndex];
+  Result.Discriminator = Discriminators[LineIndex];
   return Result;
 }
 
-void DwarfLineTable::freeLines() {
-  if (Context)
-    dwarf_srclines_dealloc_b(Context);
-  Context = nullptr;
-  Lines = nullptr;
-  LineCount = 0U;
+uint64_t DwarfLineTable::getAllocatedBytes() const {
+  return Addresses.capacity() * sizeof(Dwarf_Addr) +
+         (LineNumbers.capacity() + SrcFileIDs.capacity() + ISAs.capacity() +
+          Discriminators.capacity()) *
+             sizeof(Dwarf_Unsigned) +
+         RowFlagValues.capacity();
 }
@@ -49,6 +49,8 @@
 #include <exception>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace ElfDwarfReader {
@@ -62,6 +64,9 @@ class DwarfDie;
 class DwarfDieChildIterator;
 class DwarfAttrValue;
 class DwarfLineTable;
+struct DwarfAddressRange;
+struct DwarfArange;
+struct DwarfAddressTable;
 
 /// \brief Exception wrapping a LibDwarf error code.
 class LibDwarfError : public std::exception {
@@ -81,8 +86,12 @@ private:
 /// \brief Wrapper around a Dwarf_Debug with resource management.
 class DwarfDebugData {
 public:
-  DwarfDebugData() : Dbg(nullptr) {}
+  DwarfDebugData() : Dbg(nullptr), Elf(nullptr) {}
   explicit DwarfDebugData(int FileDescriptor);
+  /// \brief Read the debug data of the ELF object in memory at Image, for
+  /// example a member of a static archive. libelf may modify the image, so it
+  /// must be writable, and it must outlive this object.
+  DwarfDebugData(char *Image, size_t Size);
   explicit DwarfDebugData(DwarfDebugData &&Other);
   ~DwarfDebugData() { freeDbg(); }
 
@@ -102,15 +111,38 @@ public:
   /// \brief Get all the compile units in the debug data.
   std::vector<DwarfCompileUnit> getCompileUnits() const;
 
+  /// \brief Get all the type units in .debug_types, with their signatures.
+  std::vector<DwarfCompileUnit> getTypeUnits() const;
+
+  /// \brief Get the entries of .debug_aranges, or none if there is no
+  /// .debug_aranges section.
+  std::vector<DwarfArange> getAranges() const;
+
+  /// \brief Read the addresses of the split units of this .dwo file or .dwp
+  /// package from Table, which must outlive this object.
+  void setAddressTable(const DwarfAddressTable *Table) { AddressTable = Table; }
+  /// \brief The table set by setAddressTable, or null if there isn't one.
+  const DwarfAddressTable *getAddressTable() const { return AddressTable; }
+
+  /// \brief Find the offset in .debug_info.dwo of the compile unit with
+  /// DwoId in this .dwp package, returning false if there isn't one.
+  bool findPackageUnit(uint64_t DwoId, Dwarf_Off &InfoOffset) const;
+
   /// \brief Return a copy of a libdwarf c string and then free the libdwarf
   /// memory.
   std::string copyAndFreeDwarfString(char *DwarfStr) const;
 
 private:
+  // Get the units in .debug_info if InInfo is true, else .debug_types.
+  std::vector<DwarfCompileUnit> getUnits(bool InInfo) const;
+
   // Free Dbg and set it to nullptr.
   void freeDbg();
 
   Dwarf_Debug Dbg;
+  // The libelf object of an image in memory, which libdwarf doesn't free.
+  dwarf_elf_handle Elf;
+  const DwarfAddressTable *AddressTable = nullptr;
 };
 
 /// \brief Wrapper around a Dwarf_Die with resource management.
@@ -148,6 +180,11 @@ public:
   /// \brief get the line table. Only valid for compile units.
   DwarfLineTable getLineTable() const;
 
+  /// \brief Get the address ranges of the DW_AT_ranges list at RangesOffset
+  /// in .debug_ranges. BaseAddress is the base address of the DIE's CU.
+  std::vector<DwarfAddressRange> getRanges(Dwarf_Off RangesOffset,
+                                           Dwarf_Addr BaseAddress) const;
+
 private:
   // Free Die and set it to nullptr.
   void freeDie();
@@ -157,13 +194,55 @@ private:
 };
 
 /// \brief Container for the CU Die and its metadata.
+///
+/// For a type unit the offsets are in .debug_types, and Signature and
+/// TypeOffset give the signature that references the unit's type with
+/// DW_FORM_ref_sig8 and the offset of the type's DIE. Version is the DWARF
+/// version of the unit's header.
 struct DwarfCompileUnit {
   DwarfCompileUnit(DwarfDie &&CompileUnitDie)
-      : CUDie(std::move(CompileUnitDie)), HeaderOffset(0), NextHeaderOffset(0) {
-  }
+      : CUDie(std::move(CompileUnitDie)), HeaderOffset(0), NextHeaderOffset(0),
+        Version(0), Signature(0), TypeOffset(0) {}
   DwarfDie CUDie;
   Dwarf_Off HeaderOffset;
   Dwarf_Off NextHeaderOffset;
+  Dwarf_Half Version;
+  uint64_t Signature;
+  Dwarf_Off TypeOffset;
+};
+
+/// \brief A range [LowPC, HighPC) of code addresses.
+struct DwarfAddressRange {
+  Dwarf_Addr LowPC;
+  Dwarf_Addr HighPC;
+};
+
+/// \brief An entry of .debug_aranges, the range [Start, Start + Length) of
+/// code addresses in the CU whose header is at CUHeaderOffset.
+struct DwarfArange {
+  Dwarf_Addr Start;
+  Dwarf_Unsigned Length;
+  Dwarf_Off CUHeaderOffset;
+};
+
+/// \brief The .debug_addr section of a file with skeleton units, for reading
+/// the addresses of the split units of a .dwo file or .dwp package.
+///
+/// The split units give each address as an index into .debug_addr, from the
+/// DW_AT_GNU_addr_base of their skeleton. This version of libdwarf can only
+/// find the skeleton of the units of a .dwp package, so the addresses of all
+/// split units are looked up here.
+struct DwarfAddressTable {
+  const std::vector<uint8_t> *DebugAddr = nullptr;
+  bool BigEndian = false;
+  /// \brief The address size and the offset of the first address in
+  /// DebugAddr of each split unit, by the offset of its unit DIE.
+  std::unordered_map<Dwarf_Off, std::pair<Dwarf_Half, Dwarf_Unsigned>> Bases;
+
+  /// \brief Get the address at Index of the split unit whose DIE is at
+  /// UnitOffset, returning false if there isn't one.
+  bool getAddress(Dwarf_Off UnitOffset, Dwarf_Unsigned Index,
+                  Dwarf_Addr &Address) const;
 };
 
 /// \brief Access all a DIE's children in sequence.
@@ -207,6 +286,7 @@ enum class DwarfAttrValueKind {
   Empty,
   UnknownForm,
   Reference,
+  Signature,
   Address,
   Boolean,
   Unsigned,
@@ -239,6 +319,8 @@ public:
   }
 
   Dwarf_Off getReference() const;
+  /// \brief The type signature of a DW_FORM_ref_sig8 reference.
+  uint64_t getSignature() const;
   Dwarf_Addr getAddress() const;
   Dwarf_Bool getBool() const;
   Dwarf_Unsigned getUnsigned() const;
@@ -255,7 +337,7 @@ private:
   explicit DwarfAttrValue(Dwarf_Signed Val, Dwarf_Half Form);
   explicit DwarfAttrValue(std::string &&Val, Dwarf_Half Form);
 
-  // Reference, Address and Unsigned have the same underlying type.
+  // Reference, Signature, Address and Unsigned have the same underlying type.
   explicit DwarfAttrValue(Dwarf_Unsigned Val, DwarfAttrValueKind ValKind,
                           Dwarf_Half Form);
 
@@ -267,6 +349,7 @@ private:
 
   union ValueUnion {
     Dwarf_Off Reference;
+    uint64_t Signature;
     Dwarf_Addr Address;
     Dwarf_Bool Boolean;
     Dwarf_Unsigned Unsigned;
@@ -298,39 +381,63 @@ struct DwarfLineEntry {
   Dwarf_Unsigned Discriminator;
 };
 
-/// Wrapper around a line table with memory management.
+/// \brief The rows of a line table, held in one flat array per column.
 class DwarfLineTable {
 public:
-  explicit DwarfLineTable(const DwarfDie &CU);
-  DwarfLineTable(DwarfLineTable &&Other);
-  ~DwarfLineTable() { freeLines(); }
-
-  DwarfLineTable(const DwarfLineTable &) = delete;
-  DwarfLineTable &operator=(const DwarfLineTable &) = delete;
+  /// \brief Flags of a row.
+  enum RowFlags : uint8_t {
+    BeginStatement = 1 << 0,
+    EndSequence = 1 << 1,
+    BeginBlock = 1 << 2,
+    PrologEnd = 1 << 3,
+    EpilogueBegin = 1 << 4,
+  };
 
-  DwarfLineTable &operator=(DwarfLineTable &&Other);
+  DwarfLineTable() = default;
+  /// \brief Read the line table of a compile unit through libdwarf.
+  explicit DwarfLineTable(const DwarfDie &CU);
 
-  friend void swap(DwarfLineTable &A, DwarfLineTable &B) {
-    std::swap(A.Context, B.Context);
-    std::swap(A.Lines, B.Lines);
-    std::swap(A.LineCount, B.LineCount);
+  bool empty() const { return Addresses.empty(); }
+  size_t size() const { return Addresses.size(); }
+
+  void clear();
+  void reserve(size_t Rows);
+  void addRow(Dwarf_Addr Address, Dwarf_Unsigned LineNo,
+              Dwarf_Unsigned SrcFileID, uint8_t Flags, Dwarf_Unsigned ISA,
+              Dwarf_Unsigned Discriminator) {
+    Addresses.push_back(Address);
+    LineNumbers.push_back(LineNo);
+    SrcFileIDs.push_back(SrcFileID);
+    RowFlagValues.push_back(Flags);
+    ISAs.push_back(ISA);
+    Discriminators.push_back(Discriminator);
   }
 
-  bool empty() const { return LineCount == 0; }
-  size_t size() const { return LineCount; }
+  Dwarf_Addr getAddress(size_t Row) const { return Addresses[Row]; }
+  Dwarf_Unsigned getLineNo(size_t Row) const { return LineNumbers[Row]; }
+  Dwarf_Unsigned getSrcFileID(size_t Row) const { return SrcFileIDs[Row]; }
+  uint8_t getFlags(size_t Row) const { return RowFlagValues[Row]; }
+  Dwarf_Unsigned getISA(size_t Row) const { return ISAs[Row]; }
+  Dwarf_Unsigned getDiscriminator(size_t Row) const {
+    return Discriminators[Row];
+  }
 
+  /// \brief Get all the columns of one row.
   DwarfLineEntry getLine(size_t LineIndex) const;
   DwarfLineEntry operator[](size_t LineIndex) const {
     return getLine(LineIndex);
   }
 
-private:
-  // Free lines and reset values to null/zero.
-  void freeLines();
+  /// \brief Heap bytes held by the table.
+  uint64_t getAllocatedBytes() const;
 
-  Dwarf_Line_Context Context;
-  Dwarf_Line *Lines;
-  size_t LineCount;
+private:
+  std::vector<Dwarf_Addr> Addresses;
+  std::vector<Dwarf_Unsigned> LineNumbers;
+  std::vector<Dwarf_Unsigned> SrcFileIDs;
+  std::vector<uint8_t> RowFlagValues;
+  std::vector<Dwarf_Unsigned> ISAs;
+  std::vector<Dwarf_Unsigned> Discriminators;
 };
 
 } // end namespace ElfDwarfReader
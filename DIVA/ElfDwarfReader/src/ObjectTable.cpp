@@ -0,0 +1,98 @@
+//===-- ElfDwarfReader/ObjectTable.cpp --------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implementation of the ObjectTable class.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ObjectTable.h"
+#include "MemoryProfile.h"
+
+#include <bitset>
+#include <cassert>
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+unsigned countBits(uint64_t Word) {
+  return static_cast<unsigned>(std::bitset<64>(Word).count());
+}
+
+} // end anonymous namespace
+
+void ObjectTable::insert(uint64_t Offset, LibScopeView::Object *Obj) {
+  assert(Obj && "Null objects can't be found");
+  uint64_t PageIndex = Offset >> PageBits;
+  assert(PageIndex < SIZE_MAX && "Offset is too large for the table");
+  if (PageIndex >= Pages.size())
+    Pages.resize(static_cast<size_t>(PageIndex) + 1);
+  std::unique_ptr<Page> &P = Pages[static_cast<size_t>(PageIndex)];
+  if (!P) {
+    P = std::make_unique<Page>();
+    ++PageCount;
+  }
+
+  size_t Word = static_cast<size_t>((Offset & (PageSize - 1)) / 64);
+  uint64_t Bit = uint64_t(1) << (Offset % 64);
+  assert(!(P->Bits[Word] & Bit) && "Offset already has an object");
+  size_t Rank = P->Ranks[Word] + countBits(P->Bits[Word] & (Bit - 1));
+  P->Objects.insert(P->Objects.begin() + Rank, Obj);
+  P->Bits[Word] |= Bit;
+  for (size_t I = Word + 1; I < WordsPerPage; ++I)
+    ++P->Ranks[I];
+  ++Count;
+}
+
+LibScopeView::Object *ObjectTable::find(uint64_t Offset) const {
+  uint64_t PageIndex = Offset >> PageBits;
+  if (PageIndex >= Pages.size())
+    return nullptr;
+  const Page *P = Pages[static_cast<size_t>(PageIndex)].get();
+  if (!P)
+    return nullptr;
+
+  size_t Word = static_cast<size_t>((Offset & (PageSize - 1)) / 64);
+  uint64_t Bit = uint64_t(1) << (Offset % 64);
+  if (!(P->Bits[Word] & Bit))
+    return nullptr;
+  return P->Objects[P->Ranks[Word] + countBits(P->Bits[Word] & (Bit - 1))];
+}
+
+void ObjectTable::clear() {
+  Pages.clear();
+  Pages.shrink_to_fit();
+  PageCount = 0;
+  Count = 0;
+}
+
+uint64_t ObjectTable::getAllocatedBytes() const {
+  uint64_t Bytes = LibScopeView::getHeapBytes(Pages) +
+                   PageCount * LibScopeView::getAllocationBytes(sizeof(Page));
+  for (const std::unique_ptr<Page> &P : Pages)
+    if (P)
+      Bytes += LibScopeView::getHeapBytes(P->Objects);
+  return Bytes;
+}
@@ -0,0 +1,106 @@
+//===-- ElfDwarfReader/ObjectTable.h ----------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the table of the objects created from the DIEs of a file,
+/// indexed by their DWARF offsets.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef OBJECT_TABLE_H
+#define OBJECT_TABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace LibScopeView {
+class Object;
+} // end namespace LibScopeView
+
+namespace ElfDwarfReader {
+
+/// \brief A map from the DWARF offsets of DIEs to the objects created from
+/// them.
+///
+/// DIE offsets are dense and increasing within .debug_info, so the table is
+/// indexed directly by offset. The offsets are split into fixed size pages,
+/// each holding a bit for every offset in the page and the objects of the set
+/// bits in offset order. An object is found from the count of the set bits
+/// before its offset, so the table costs a fraction of a byte for each offset
+/// and a pointer for each object, with no hashing or node allocation.
+class ObjectTable {
+public:
+  ObjectTable() = default;
+  ObjectTable(const ObjectTable &) = delete;
+  ObjectTable &operator=(const ObjectTable &) = delete;
+
+  /// \brief Record Obj as the object at Offset, which must not have one.
+  ///
+  /// Objects are cheapest to insert in increasing offset order.
+  void insert(uint64_t Offset, LibScopeView::Object *Obj);
+
+  /// \brief The object at Offset, or null if there isn't one.
+  LibScopeView::Object *find(uint64_t Offset) const;
+
+  /// \brief Number of objects in the table.
+  size_t size() const { return Count; }
+
+  /// \brief Remove every object, freeing the pages.
+  void clear();
+
+  /// \brief Exchange the objects of this table with those of Other.
+  void swap(ObjectTable &Other) {
+    Pages.swap(Other.Pages);
+    std::swap(PageCount, Other.PageCount);
+    std::swap(Count, Other.Count);
+  }
+
+  /// \brief Heap bytes held by the table.
+  uint64_t getAllocatedBytes() const;
+
+private:
+  static const unsigned PageBits = 12;
+  static const uint64_t PageSize = uint64_t(1) << PageBits;
+  static const size_t WordsPerPage = PageSize / 64;
+
+  struct Page {
+    // A bit for each offset in the page with an object.
+    uint64_t Bits[WordsPerPage] = {};
+    // The number of bits set in the words before each word.
+    uint16_t Ranks[WordsPerPage] = {};
+    // The objects of the set bits, in offset order.
+    std::vector<LibScopeView::Object *> Objects;
+  };
+
+  // Pages indexed by offset / PageSize, null where no offset has an object.
+  std::vector<std::unique_ptr<Page>> Pages;
+  size_t PageCount = 0;
+  size_t Count = 0;
+};
+
+} // end namespace ElfDwarfReader
+
+#endif // OBJECT_TABLE_H
@@ -0,0 +1,240 @@
+//===-- ElfDwarfReader/SplitDwarf.cpp ---------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implementation of the loading of the split DWARF of
+/// the skeleton compile units of a file built with -gsplit-dwarf.
+///
+//===----------------------------------------------------------------------===//
+
+#include "SplitDwarf.h"
+#include "DebugSections.h"
+#include "Error.h"
+#include "Trace.h"
+#include "Utilities.h"
+
+#include <algorithm>
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+bool isAbsolutePath(const std::string &UnifiedPath) {
+  return (!UnifiedPath.empty() && UnifiedPath[0] == '/') ||
+         (UnifiedPath.size() > 1 && UnifiedPath[1] == ':');
+}
+
+// Get a string attribute of a skeleton, or an empty string if it doesn't
+// have one.
+std::string getStringAttr(const DwarfDie &Die, Dwarf_Half Attr) {
+  DwarfAttrValue Value = Die.getAttr(Attr);
+  if (Value.getKind() != DwarfAttrValueKind::String)
+    return std::string();
+  return Value.getString();
+}
+
+} // end anonymous namespace
+
+SplitDwarf::SplitDwarf(const std::string &FileName,
+                       const std::vector<DwarfCompileUnit> &CompileUnits,
+                       unsigned ThreadCount) {
+  std::string FileDir = LibScopeView::getDirectoryName(
+      LibScopeView::unifyFilePath(FileName));
+  for (size_t I = 0; I < CompileUnits.size(); ++I) {
+    const DwarfDie &Die = CompileUnits[I].CUDie;
+    std::string DwoName = getStringAttr(Die, DW_AT_GNU_dwo_name);
+    if (DwoName.empty())
+      DwoName = getStringAttr(Die, DW_AT_dwo_name);
+    if (DwoName.empty())
+      continue;
+
+    Skeleton Skel = {I, NoIndex, NoIndex, std::string(), 0, false};
+    DwarfAttrValue DwoId = Die.getAttr(DW_AT_GNU_dwo_id);
+    if (DwoId.getKind() == DwarfAttrValueKind::Unsigned) {
+      Skel.DwoId = DwoId.getUnsigned();
+      Skel.HasDwoId = true;
+    }
+
+    // A relative name is relative to the directory it was compiled in, but
+    // the .dwo files are often moved with the file.
+    DwoName = LibScopeView::unifyFilePath(DwoName);
+    if (isAbsolutePath(DwoName)) {
+      Skel.DwoPath = DwoName;
+    } else {
+      std::string CompDir = getStringAttr(Die, DW_AT_comp_dir);
+      std::string CompPath =
+          LibScopeView::unifyFilePath(CompDir + '/' + DwoName);
+      if (!CompDir.empty() && LibScopeView::doesFileExist(CompPath))
+        Skel.DwoPath = CompPath;
+      else
+        Skel.DwoPath = FileDir.empty() ? DwoName : FileDir + '/' + DwoName;
+    }
+    Skeletons.push_back(std::move(Skel));
+  }
+  if (Skeletons.empty())
+    return;
+
+  std::string PackagePath = FileName + ".dwp";
+  if (LibScopeView::doesFileExist(PackagePath))
+    loadPackage(PackagePath);
+  else
+    loadDwoFiles(ThreadCount);
+  readAddressTable(FileName, CompileUnits);
+}
+
+SplitDwarf::SplitUnit SplitDwarf::getSplitUnit(size_t I) const {
+  SplitUnit Result = {nullptr, nullptr};
+  auto IT = std::lower_bound(
+      Skeletons.begin(), Skeletons.end(), I,
+      [](const Skeleton &Skel, size_t Index) { return Skel.UnitIndex < Index; });
+  if (IT == Skeletons.end() || IT->UnitIndex != I ||
+      IT->SplitIndex == NoIndex)
+    return Result;
+  const SplitFile &File = *Files[IT->FileIndex];
+  Result.DebugData = File.DebugData.get();
+  Result.Unit = &File.CompileUnits[IT->SplitIndex];
+  return Result;
+}
+
+void SplitDwarf::loadPackage(const std::string &PackagePath) {
+  LibScopeView::TraceSpan Span("ReadDwarfPackage");
+  auto Package = std::make_unique<SplitFile>();
+  Package->Path = PackagePath;
+  try {
+    Package->FD = LibScopeView::FileDescriptor(PackagePath);
+    Package->DebugData = std::make_unique<DwarfDebugData>(Package->FD.get());
+    Package->CompileUnits = Package->DebugData->getCompileUnits();
+    Package->TypeUnits = Package->DebugData->getTypeUnits();
+  } catch (LibDwarfError &) {
+    LibScopeError::warning("Unable to read the split DWARF package '" +
+                           PackagePath + "'.");
+    return;
+  }
+
+  // The package's index gives the offset of each split unit by its id.
+  size_t Missing = 0;
+  for (Skeleton &Skel : Skeletons) {
+    Dwarf_Off InfoOffset;
+    if (!Skel.HasDwoId ||
+        !Package->DebugData->findPackageUnit(Skel.DwoId, InfoOffset)) {
+      ++Missing;
+      continue;
+    }
+    auto IT = std::find_if(Package->CompileUnits.begin(),
+                           Package->CompileUnits.end(),
+                           [&](const DwarfCompileUnit &CU) {
+                             return CU.HeaderOffset == InfoOffset;
+                           });
+    if (IT == Package->CompileUnits.end()) {
+      ++Missing;
+      continue;
+    }
+    Skel.FileIndex = 0;
+    Skel.SplitIndex = static_cast<size_t>(IT - Package->CompileUnits.begin());
+  }
+  if (Missing)
+    LibScopeError::warning(std::to_string(Missing) +
+                           " split compile units are missing from '" +
+                           PackagePath + "'.");
+  Files.push_back(std::move(Package));
+}
+
+void SplitDwarf::loadDwoFiles(unsigned ThreadCount) {
+  LibScopeView::TraceSpan Span("ReadDwoFiles");
+  // Each .dwo file is opened, and its unit headers read, on a thread of its
+  // own. libdwarf shares no state between different Dwarf_Debugs.
+  Files.resize(Skeletons.size());
+  LibScopeView::runInParallel(Skeletons.size(), ThreadCount, [&](size_t I) {
+    const std::string &Path = Skeletons[I].DwoPath;
+    if (!LibScopeView::doesFileExist(Path))
+      return;
+    auto File = std::make_unique<SplitFile>();
+    File->Path = Path;
+    try {
+      File->FD = LibScopeView::FileDescriptor(Path);
+      File->DebugData = std::make_unique<DwarfDebugData>(File->FD.get());
+      File->CompileUnits = File->DebugData->getCompileUnits();
+      File->TypeUnits = File->DebugData->getTypeUnits();
+    } catch (LibDwarfError &) {
+      File->DebugData.reset();
+    }
+    Files[I] = std::move(File);
+  });
+
+  for (size_t I = 0; I < Skeletons.size(); ++I) {
+    Skeleton &Skel = Skeletons[I];
+    const SplitFile *File = Files[I].get();
+    if (!File) {
+      LibScopeError::warning("Unable to find the split DWARF file '" +
+                             Skel.DwoPath + "'.");
+      continue;
+    }
+    if (!File->DebugData || File->CompileUnits.empty()) {
+      LibScopeError::warning("Unable to read the split DWARF file '" +
+                             Skel.DwoPath + "'.");
+      continue;
+    }
+    Skel.FileIndex = I;
+    Skel.SplitIndex = 0;
+  }
+}
+
+void SplitDwarf::readAddressTable(
+    const std::string &FileName,
+    const std::vector<DwarfCompileUnit> &CompileUnits) {
+  // The addresses of a relocatable file aren't final until they have been
+  // relocated, which only libdwarf does, so the split units of a relocatable
+  // file have no addresses.
+  DebugSections Sections;
+  bool HaveAddresses =
+      readDebugSections(FileName, DebugSections::AddrSection, Sections) &&
+      !(Sections.RelocatedSections & DebugSections::AddrSection);
+  DebugAddr = std::move(Sections.Addr);
+  for (const auto &File : Files) {
+    if (!File || !File->DebugData)
+      continue;
+    if (HaveAddresses)
+      File->AddressTable.DebugAddr = &DebugAddr;
+    File->AddressTable.BigEndian = Sections.BigEndian;
+    File->DebugData->setAddressTable(&File->AddressTable);
+  }
+
+  for (const Skeleton &Skel : Skeletons) {
+    if (Skel.SplitIndex == NoIndex)
+      continue;
+    const DwarfDie &Die = CompileUnits[Skel.UnitIndex].CUDie;
+    DwarfAttrValue AddrBase = Die.getAttr(DW_AT_GNU_addr_base);
+    if (AddrBase.empty())
+      AddrBase = Die.getAttr(DW_AT_addr_base);
+    Dwarf_Half AddressSize = 0;
+    dwarf_get_die_address_size(*Die, &AddressSize, nullptr);
+    SplitFile &File = *Files[Skel.FileIndex];
+    const DwarfCompileUnit &SplitCU = File.CompileUnits[Skel.SplitIndex];
+    File.AddressTable.Bases[SplitCU.CUDie.getGlobalOffset()] = std::make_pair(
+        AddressSize,
+        AddrBase.getKind() == DwarfAttrValueKind::Reference
+            ? AddrBase.getReference()
+            : 0);
+  }
+}
@@ -0,0 +1,128 @@
+//===-- ElfDwarfReader/SplitDwarf.h -----------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file declares the loading of the split DWARF of the skeleton compile
+/// units of a file built with -gsplit-dwarf.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SPLIT_DWARF_H
+#define SPLIT_DWARF_H
+
+#include "FileUtilities.h"
+#include "LibDwarfHelpers.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ElfDwarfReader {
+
+/// \brief The split DWARF of the skeleton compile units of a file built with
+/// -gsplit-dwarf.
+///
+/// A skeleton unit holds little more than the code ranges and line table of
+/// its unit, and names the .dwo file that holds the rest of the unit's DIEs
+/// with DW_AT_GNU_dwo_name (DW_AT_dwo_name in DWARF 5). If there is a .dwp
+/// package next to the file (named FileName.dwp) each split unit is found
+/// through the package's index by the skeleton's DW_AT_GNU_dwo_id. Otherwise
+/// each .dwo file is looked for at its name, relative to the skeleton's
+/// DW_AT_comp_dir and then to the directory of the file. The split units
+/// give their addresses as indices into the file's .debug_addr, which is read
+/// for them.
+class SplitDwarf {
+public:
+  /// \brief A .dwo file or .dwp package, with its compile and type units.
+  struct SplitFile {
+    std::string Path;
+    LibScopeView::FileDescriptor FD;
+    DwarfAddressTable AddressTable;
+    std::unique_ptr<DwarfDebugData> DebugData;
+    std::vector<DwarfCompileUnit> CompileUnits;
+    std::vector<DwarfCompileUnit> TypeUnits;
+  };
+
+  /// \brief The split unit of a skeleton and the debug data to read it with.
+  struct SplitUnit {
+    const DwarfDebugData *DebugData;
+    const DwarfCompileUnit *Unit;
+  };
+
+  /// \brief Find and open the split units of the skeletons in CompileUnits,
+  /// read from FileName. The .dwo files are opened and their
+  /// unit headers read on up to ThreadCount threads (0 for one per hardware
+  /// thread). Warns about the split units that can't be found or read.
+  SplitDwarf(const std::string &FileName,
+             const std::vector<DwarfCompileUnit> &CompileUnits,
+             unsigned ThreadCount = 0);
+
+  SplitDwarf(const SplitDwarf &) = delete;
+  SplitDwarf &operator=(const SplitDwarf &) = delete;
+
+  /// \brief Return true if none of the compile units is a skeleton.
+  bool empty() const { return Skeletons.empty(); }
+
+  /// \brief The split unit of CompileUnits[I], with a null Unit if it isn't
+  /// a skeleton or its split unit couldn't be read.
+  SplitUnit getSplitUnit(size_t I) const;
+
+  /// \brief The .dwo files or .dwp package that were read.
+  const std::vector<std::unique_ptr<SplitFile>> &getFiles() const {
+    return Files;
+  }
+
+private:
+  // A skeleton unit, its split unit as indices into Files and the file's
+  // CompileUnits, the path of its .dwo file and its DW_AT_GNU_dwo_id.
+  struct Skeleton {
+    size_t UnitIndex;
+    size_t FileIndex;
+    size_t SplitIndex;
+    std::string DwoPath;
+    uint64_t DwoId;
+    bool HasDwoId;
+  };
+
+  // Find the split units in the .dwp package at PackagePath.
+  void loadPackage(const std::string &PackagePath);
+
+  // Find the split units in the .dwo file of each skeleton.
+  void loadDwoFiles(unsigned ThreadCount);
+
+  // Read the .debug_addr of FileName, and where the addresses of each split
+  // unit start in it.
+  void readAddressTable(const std::string &FileName,
+                        const std::vector<DwarfCompileUnit> &CompileUnits);
+
+  static const size_t NoIndex = static_cast<size_t>(-1);
+
+  std::vector<Skeleton> Skeletons;
+  std::vector<uint8_t> DebugAddr;
+  std::vector<std::unique_ptr<SplitFile>> Files;
+};
+
+} // end namespace ElfDwarfReader
+
+#endif // SPLIT_DWARF_H
@@ -0,0 +1,312 @@
+//===-- LibDiva/LibDiva.cpp -------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implementation of the C interface to DIVA.
+///
+//===----------------------------------------------------------------------===//
+
+#include "LibDiva.h"
+#include "DivaOptions.h"
+#include "DivaOutput.h"
+#include "Error.h"
+#include "Line.h"
+#include "Scope.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace LibScopeView;
+
+struct diva_tree {
+  std::string Path;
+  std::unique_ptr<ScopeRoot> Root;
+  // The settings that the tree was read with, which a render must match.
+  PrintSettings Settings;
+  std::string Warnings;
+};
+
+namespace {
+
+thread_local std::string LastError;
+// The warnings and errors given on this thread during a call, or null outside
+// of one.
+thread_local std::string *CallErrors = nullptr;
+
+bool captureError(const std::string &Text) {
+  if (!CallErrors)
+    return false;
+  *CallErrors += Text;
+  return true;
+}
+
+/// \brief Captures the warnings and errors of a call on this thread and makes
+/// its fatal errors throw, for the lifetime of the object.
+class CallScope {
+public:
+  CallScope() : PreviousThrowOnExit(LibScopeError::getThreadThrowOnExit()) {
+    static std::once_flag InstallHandler;
+    std::call_once(InstallHandler,
+                   []() { LibScopeError::setErrorHandler(captureError); });
+    LibScopeError::setThreadThrowOnExit(true);
+    CallErrors = &Errors;
+  }
+  ~CallScope() {
+    CallErrors = nullptr;
+    LibScopeError::setThreadThrowOnExit(PreviousThrowOnExit);
+  }
+
+  CallScope(const CallScope &) = delete;
+  CallScope &operator=(const CallScope &) = delete;
+
+  std::string Errors;
+
+private:
+  bool PreviousThrowOnExit;
+};
+
+// Remove the leading and trailing blank lines and spaces of Text.
+std::string stripBlankLines(const std::string &Text) {
+  size_t Start = Text.find_first_not_of(" \n");
+  if (Start == std::string::npos)
+    return std::string();
+  return Text.substr(Start, Text.find_last_not_of(" \n") - Start + 1);
+}
+
+diva_status fail(diva_status Status, const std::string &Error) {
+  LastError = stripBlankLines(Error);
+  return Status;
+}
+
+// Set the error of a call that exited, from the fatal error that it threw or
+// else the messages that it printed.
+diva_status failOnExit(const LibScopeError::ExitException &Exit,
+                       const CallScope &Call,
+                       const std::ostringstream &Messages) {
+  if (!Exit.getMessage().empty())
+    return fail(DIVA_ERROR, Exit.getMessage());
+  std::string Error = stripBlankLines(Call.Errors + Messages.str());
+  if (Error.empty())
+    Error = "diva exited with status " + std::to_string(Exit.getStatus());
+  return fail(DIVA_ERROR, Error);
+}
+
+// Parse Options with InputFile added as the input file, printing any help or
+// errors to Messages. Returns null if Options name another input file.
+std::unique_ptr<DivaOptions> parseOptions(const std::string &InputFile,
+                                          const char *const *Options,
+                                          size_t OptionCount,
+                                          std::ostream &Messages) {
+  std::vector<std::string> Args;
+  for (size_t I = 0; I < OptionCount; ++I)
+    Args.emplace_back(Options[I]);
+  Args.push_back(InputFile);
+  auto Parsed =
+      std::make_unique<DivaOptions>(Args, /*HelpOut*/ Messages,
+                                    /*VersionOut*/ Messages,
+                                    /*ErrOut*/ Messages);
+  if (Parsed->InputFiles.size() != 1)
+    return nullptr;
+  return Parsed;
+}
+
+const Object *toObject(const diva_object *Obj) {
+  return reinterpret_cast<const Object *>(Obj);
+}
+
+const diva_object *toHandle(const Object *Obj) {
+  return reinterpret_cast<const diva_object *>(Obj);
+}
+
+} // namespace
+
+int diva_api_version(void) { return DIVA_API_VERSION; }
+
+const char *diva_version(void) { return RC_VERSION_STR; }
+
+const char *diva_last_error(void) { return LastError.c_str(); }
+
+diva_status diva_open(const char *Path, const char *const *Options,
+                      size_t OptionCount, diva_tree **Tree) {
+  if (!Path || !Tree || (OptionCount && !Options))
+    return fail(DIVA_INVALID_ARGUMENT, "A required argument is null.");
+  *Tree = nullptr;
+
+  CallScope Call;
+  std::ostringstream Messages;
+  try {
+    std::unique_ptr<DivaOptions> Parsed =
+        parseOptions(Path, Options, OptionCount, Messages);
+    if (!Parsed)
+      return fail(DIVA_INVALID_ARGUMENT, "The options name an input file.");
+
+    auto NewTree = std::make_unique<diva_tree>();
+    NewTree->Path = Path;
+    NewTree->Settings = Parsed->PrintingSettings;
+    NewTree->Root =
+        readInputFile(NewTree->Path, NewTree->Settings, {},
+                      Parsed->getIncrementalStateFile(NewTree->Path), {},
+                      Parsed->CompileUnitPatterns);
+    // Work out the names now so that the tree is only read after this.
+    materializeNames(*NewTree->Root);
+    NewTree->Warnings = stripBlankLines(Call.Errors);
+    *Tree = NewTree.release();
+  } catch (LibScopeError::ExitException &Exit) {
+    return failOnExit(Exit, Call, Messages);
+  } catch (std::exception &Error) {
+    return fail(DIVA_ERROR, Error.what());
+  }
+  return DIVA_OK;
+}
+
+void diva_close(diva_tree *Tree) { delete Tree; }
+
+const char *diva_tree_warnings(const diva_tree *Tree) {
+  return Tree ? Tree->Warnings.c_str() : "";
+}
+
+const diva_object *diva_tree_root(const diva_tree *Tree) {
+  return Tree ? toHandle(Tree->Root.get()) : nullptr;
+}
+
+size_t diva_cu_count(const diva_tree *Tree) {
+  return Tree ? Tree->Root->getChildren().size() : 0;
+}
+
+const diva_object *diva_cu(const diva_tree *Tree, size_t Index) {
+  if (!Tree || Index >= Tree->Root->getChildren().size())
+    return nullptr;
+  return toHandle(Tree->Root->getChildren()[Index]);
+}
+
+size_t diva_child_count(const diva_object *Object) {
+  const auto *Scp = Object ? dyn_cast<Scope>(toObject(Object)) : nullptr;
+  return Scp ? Scp->getChildren().size() + Scp->getLines().size() : 0;
+}
+
+const diva_object *diva_child(const diva_object *Object, size_t Index) {
+  const auto *Scp = Object ? dyn_cast<Scope>(toObject(Object)) : nullptr;
+  if (!Scp)
+    return nullptr;
+  const std::vector<LibScopeView::Object *> &Children = Scp->getChildren();
+  if (Index < Children.size())
+    return toHandle(Children[Index]);
+  Index -= Children.size();
+  if (Index < Scp->getLines().size())
+    return toHandle(Scp->getLines()[Index]);
+  return nullptr;
+}
+
+const diva_object *diva_parent(const diva_object *Object) {
+  return Object ? toHandle(toObject(Object)->getParent()) : nullptr;
+}
+
+const char *diva_object_kind(const diva_object *Object) {
+  return Object ? toObject(Object)->getKindAsString() : "";
+}
+
+const char *diva_object_name(const diva_object *Object) {
+  return Object ? toObject(Object)->getName().c_str() : "";
+}
+
+const char *diva_object_qualified_name(const diva_object *Object) {
+  return Object ? toObject(Object)->getQualifiedName().c_str() : "";
+}
+
+const diva_object *diva_object_type(const diva_object *Object) {
+  return Object ? toHandle(toObject(Object)->getType()) : nullptr;
+}
+
+const char *diva_object_type_name(const diva_object *Object) {
+  if (!Object)
+    return "";
+  const LibScopeView::Object *Type = toObject(Object)->getType();
+  return Type ? Type->getName().c_str() : "";
+}
+
+const char *diva_object_file(const diva_object *Object) {
+  return Object ? toObject(Object)->getFilePath().c_str() : "";
+}
+
+uint64_t diva_object_line(const diva_object *Object) {
+  return Object ? toObject(Object)->getLineNumber() : 0;
+}
+
+uint64_t diva_object_dwarf_offset(const diva_object *Object) {
+  return Object ? toObject(Object)->getDieOffset() : 0;
+}
+
+uint16_t diva_object_dwarf_tag(const diva_object *Object) {
+  return Object ? toObject(Object)->getDieTag() : 0;
+}
+
+diva_status diva_render(const diva_tree *Tree, const char *const *Options,
+                        size_t OptionCount, char **Output,
+                        size_t *OutputSize) {
+  if (!Tree || !Output || (OptionCount && !Options))
+    return fail(DIVA_INVALID_ARGUMENT, "A required argument is null.");
+  *Output = nullptr;
+  if (OutputSize)
+    *OutputSize = 0;
+
+  CallScope Call;
+  std::ostringstream Messages;
+  std::ostringstream Out;
+  try {
+    std::unique_ptr<DivaOptions> Parsed =
+        parseOptions(Tree->Path, Options, OptionCount, Messages);
+    if (!Parsed)
+      return fail(DIVA_INVALID_ARGUMENT, "The options name an input file.");
+    // Sorting or formulating the names again would change the tree under
+    // the other threads using it.
+    if (Parsed->PrintingSettings.SortKey != Tree->Settings.SortKey ||
+        Parsed->PrintingSettings.ShowVoid != Tree->Settings.ShowVoid)
+      return fail(DIVA_INVALID_ARGUMENT,
+                  "The sort order and void types must be the same as when "
+                  "the tree was opened.");
+
+    printScopeView(*Tree->Root, Tree->Path, *Parsed, Out);
+  } catch (LibScopeError::ExitException &Exit) {
+    return failOnExit(Exit, Call, Messages);
+  } catch (std::exception &Error) {
+    return fail(DIVA_ERROR, Error.what());
+  }
+
+  const std::string Text = Out.str();
+  char *Buffer = static_cast<char *>(std::malloc(Text.size() + 1));
+  if (!Buffer)
+    return fail(DIVA_ERROR, "Out of memory.");
+  std::memcpy(Buffer, Text.c_str(), Text.size() + 1);
+  *Output = Buffer;
+  if (OutputSize)
+    *OutputSize = Text.size();
+  return DIVA_OK;
+}
+
+void diva_free(char *Buffer) { std::free(Buffer); }
@@ -0,0 +1,160 @@
+//===-- LibDiva/LibDiva.h -----------------------------------------*- C -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the C interface to DIVA, which reads the debug
+/// information of an ELF object into a tree that can be walked, queried and
+/// printed in-process.
+///
+/// A tree is not changed once it is open, so its handle, and the handles of
+/// its objects, can be used from several threads at once. Each thread has its
+/// own last error.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LIBDIVA_H
+#define LIBDIVA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(LIBDIVA_STATIC)
+#define DIVA_API
+#elif defined(_WIN32)
+#ifdef LIBDIVA_EXPORTS
+#define DIVA_API __declspec(dllexport)
+#else
+#define DIVA_API __declspec(dllimport)
+#endif
+#else
+#define DIVA_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// \brief The version of this interface. Functions are only added to it, so
+/// a program built against an older version still works.
+#define DIVA_API_VERSION 1
+
+/// \brief The result of a call that can fail. The reason for the failure is
+/// then returned by diva_last_error.
+typedef enum diva_status {
+  DIVA_OK = 0,
+  DIVA_ERROR = 1,
+  DIVA_INVALID_ARGUMENT = 2
+} diva_status;
+
+/// \brief The debug information read from an input file.
+typedef struct diva_tree diva_tree;
+
+/// \brief An object (scope, type, symbol or line) in a tree, which is valid
+/// until the tree is closed.
+typedef struct diva_object diva_object;
+
+/// \brief The version of the library, checked against DIVA_API_VERSION.
+DIVA_API int diva_api_version(void);
+
+/// \brief The version of DIVA, as printed by "diva --version".
+DIVA_API const char *diva_version(void);
+
+/// \brief The error of the last call on this thread that failed, which is
+/// valid until the next call that fails on this thread.
+DIVA_API const char *diva_last_error(void);
+
+/// \brief Read the ELF object at Path into a tree.
+///
+/// Options are diva command line options (without input files), of which the
+/// sort order (--sort), the void types (--show-void) and the compile units
+/// read (--cu) change the tree.
+/// They may be null if OptionCount is 0.
+DIVA_API diva_status diva_open(const char *Path, const char *const *Options,
+                               size_t OptionCount, diva_tree **Tree);
+
+/// \brief Release a tree, and the handles of its objects.
+DIVA_API void diva_close(diva_tree *Tree);
+
+/// \brief The warnings given while reading the tree, or an empty string.
+DIVA_API const char *diva_tree_warnings(const diva_tree *Tree);
+
+/// \brief The root of the tree, whose children are the compile units.
+DIVA_API const diva_object *diva_tree_root(const diva_tree *Tree);
+
+/// \brief The compile units of the tree.
+DIVA_API size_t diva_cu_count(const diva_tree *Tree);
+DIVA_API const diva_object *diva_cu(const diva_tree *Tree, size_t Index);
+
+/// \brief The children of an object, in the order that they are printed
+/// (lines last), or none if it is not a scope.
+DIVA_API size_t diva_child_count(const diva_object *Object);
+DIVA_API const diva_object *diva_child(const diva_object *Object,
+                                       size_t Index);
+
+/// \brief The scope containing an object, or null for the root.
+DIVA_API const diva_object *diva_parent(const diva_object *Object);
+
+/// \brief The kind of an object, such as "Function" or "Line".
+DIVA_API const char *diva_object_kind(const diva_object *Object);
+
+/// \brief The name of an object, and its name with the enclosing namespaces
+/// and classes.
+DIVA_API const char *diva_object_name(const diva_object *Object);
+DIVA_API const char *diva_object_qualified_name(const diva_object *Object);
+
+/// \brief The type of an object, or null if it has none.
+DIVA_API const diva_object *diva_object_type(const diva_object *Object);
+
+/// \brief The name of the type of an object, or an empty string if it has
+/// none.
+DIVA_API const char *diva_object_type_name(const diva_object *Object);
+
+/// \brief The source file and line of an object, or 0 if it has none.
+DIVA_API const char *diva_object_file(const diva_object *Object);
+DIVA_API uint64_t diva_object_line(const diva_object *Object);
+
+/// \brief The offset and tag of the DWARF DIE an object was read from.
+DIVA_API uint64_t diva_object_dwarf_offset(const diva_object *Object);
+DIVA_API uint16_t diva_object_dwarf_tag(const diva_object *Object);
+
+/// \brief Print a tree as diva would with Options (without input files),
+/// such as "--filter=foo" or "--output=yaml", into a buffer.
+///
+/// The buffer is null terminated and must be released with diva_free. The
+/// options must not change the sort order or the void types from those the
+/// tree was opened with. Split output is written to files as usual and
+/// leaves the buffer empty.
+DIVA_API diva_status diva_render(const diva_tree *Tree,
+                                 const char *const *Options,
+                                 size_t OptionCount, char **Output,
+                                 size_t *OutputSize);
+
+/// \brief Release a buffer returned by diva_render.
+DIVA_API void diva_free(char *Buffer);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBDIVA_H
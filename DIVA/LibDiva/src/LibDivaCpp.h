@@ -0,0 +1,145 @@
+//===-- LibDiva/LibDivaCpp.h ------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains a C++ interface to DIVA, which wraps the handles of the
+/// C interface in LibDiva.h.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LIBDIVACPP_H
+#define LIBDIVACPP_H
+
+#include "LibDiva.h"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace LibDiva {
+
+/// \brief Thrown when a call to the C interface fails, with its error.
+class Error : public std::runtime_error {
+public:
+  Error(diva_status ErrorStatus, const char *Message)
+      : std::runtime_error(Message), Status(ErrorStatus) {}
+  diva_status getStatus() const { return Status; }
+
+private:
+  diva_status Status;
+};
+
+namespace detail {
+
+inline void check(diva_status Status) {
+  if (Status != DIVA_OK)
+    throw Error(Status, diva_last_error());
+}
+
+inline std::vector<const char *>
+getArgs(const std::vector<std::string> &Options) {
+  std::vector<const char *> Args;
+  for (const std::string &Option : Options)
+    Args.push_back(Option.c_str());
+  return Args;
+}
+
+} // namespace detail
+
+/// \brief An object in a Tree, which is valid until the Tree is destroyed.
+class ObjectRef {
+public:
+  explicit ObjectRef(const diva_object *ObjectHandle = nullptr)
+      : Handle(ObjectHandle) {}
+
+  explicit operator bool() const { return Handle != nullptr; }
+  const diva_object *getHandle() const { return Handle; }
+
+  std::string getKind() const { return diva_object_kind(Handle); }
+  std::string getName() const { return diva_object_name(Handle); }
+  std::string getQualifiedName() const {
+    return diva_object_qualified_name(Handle);
+  }
+  ObjectRef getType() const { return ObjectRef(diva_object_type(Handle)); }
+  std::string getTypeName() const { return diva_object_type_name(Handle); }
+  std::string getFilePath() const { return diva_object_file(Handle); }
+  uint64_t getLineNumber() const { return diva_object_line(Handle); }
+  uint64_t getDieOffset() const { return diva_object_dwarf_offset(Handle); }
+  uint16_t getDieTag() const { return diva_object_dwarf_tag(Handle); }
+
+  ObjectRef getParent() const { return ObjectRef(diva_parent(Handle)); }
+  size_t getChildCount() const { return diva_child_count(Handle); }
+  ObjectRef getChild(size_t Index) const {
+    return ObjectRef(diva_child(Handle, Index));
+  }
+
+private:
+  const diva_object *Handle;
+};
+
+/// \brief The debug information read from an input file (see diva_open).
+class Tree {
+public:
+  explicit Tree(const std::string &Path,
+                const std::vector<std::string> &Options = {}) {
+    std::vector<const char *> Args = detail::getArgs(Options);
+    diva_tree *NewHandle = nullptr;
+    detail::check(
+        diva_open(Path.c_str(), Args.data(), Args.size(), &NewHandle));
+    Handle.reset(NewHandle);
+  }
+
+  const diva_tree *getHandle() const { return Handle.get(); }
+
+  std::string getWarnings() const { return diva_tree_warnings(getHandle()); }
+  ObjectRef getRoot() const { return ObjectRef(diva_tree_root(getHandle())); }
+  size_t getCompileUnitCount() const { return diva_cu_count(getHandle()); }
+  ObjectRef getCompileUnit(size_t Index) const {
+    return ObjectRef(diva_cu(getHandle(), Index));
+  }
+
+  /// \brief Print the tree with Options (see diva_render).
+  std::string render(const std::vector<std::string> &Options) const {
+    std::vector<const char *> Args = detail::getArgs(Options);
+    char *Output = nullptr;
+    size_t OutputSize = 0;
+    detail::check(diva_render(getHandle(), Args.data(), Args.size(), &Output,
+                              &OutputSize));
+    std::string Text(Output, OutputSize);
+    diva_free(Output);
+    return Text;
+  }
+
+private:
+  struct Closer {
+    void operator()(diva_tree *Tree) const { diva_close(Tree); }
+  };
+  std::unique_ptr<diva_tree, Closer> Handle;
+};
+
+} // namespace LibDiva
+
+#endif // LIBDIVACPP_H
@@ -0,0 +1,175 @@
+//===-- LibScopeView/AddressIndex.cpp ---------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// An index from code addresses to scopes and line table rows.
+///
+//===----------------------------------------------------------------------===//
+
+#include "AddressIndex.h"
+#include "Line.h"
+#include "Scope.h"
+#include "ScopeVisitor.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace LibScopeView;
+
+namespace LibScopeView {
+
+/// \brief Visits a tree collecting the address ranges of each scope and the
+/// address of each line.
+class AddressIndexBuilder : public ConstScopeVisitor {
+public:
+  struct ScopeRange {
+    Dwarf_Addr LowPC;
+    Dwarf_Addr HighPC;
+    unsigned Depth;
+    const Scope *Scp;
+  };
+  std::vector<ScopeRange> Ranges;
+
+  struct LineRow {
+    Dwarf_Addr Address;
+    // Nullptr for the end of a sequence.
+    const Line *Ln;
+  };
+  std::vector<LineRow> Rows;
+
+  /// \brief Flatten the nested ranges into Index.ScopeStarts.
+  void addScopeStarts(AddressIndex &Index);
+
+  /// \brief Sort the rows into Index.LineStarts.
+  void addLineStarts(AddressIndex &Index);
+
+private:
+  void visitImpl(const Object *Obj) override {
+    if (auto Ln = dyn_cast<Line>(Obj)) {
+      Rows.push_back({Ln->getAddress(),
+                      Ln->getIsLineEndSequence() ? nullptr : Ln});
+      return;
+    }
+    if (auto Scp = dyn_cast<Scope>(Obj))
+      for (const AddressRange &Range : Scp->getRanges())
+        Ranges.push_back({Range.LowPC, Range.HighPC, Depth, Scp});
+    ++Depth;
+    visitChildren(Obj);
+    --Depth;
+  }
+
+  unsigned Depth = 0;
+};
+
+} // namespace LibScopeView
+
+namespace {
+
+// Add a boundary, replacing one at the same address and skipping one that
+// doesn't change what is covered.
+template <typename T>
+void addStart(std::vector<T> &Starts, Dwarf_Addr Address,
+              decltype(T::Covering) Covering) {
+  if (!Starts.empty() && Starts.back().Address == Address)
+    Starts.back().Covering = Covering;
+  else if (Starts.empty() ? Covering != nullptr
+                          : Starts.back().Covering != Covering)
+    Starts.push_back({Address, Covering});
+}
+
+} // namespace
+
+void AddressIndexBuilder::addScopeStarts(AddressIndex &Index) {
+  // Outer ranges sort before the ranges they contain.
+  std::sort(Ranges.begin(), Ranges.end(),
+            [](const ScopeRange &A, const ScopeRange &B) {
+              if (A.LowPC != B.LowPC)
+                return A.LowPC < B.LowPC;
+              if (A.HighPC != B.HighPC)
+                return A.HighPC > B.HighPC;
+              return A.Depth < B.Depth;
+            });
+
+  // The ranges containing the current address, innermost last.
+  std::vector<ScopeRange> Open;
+  auto CloseUntil = [&](Dwarf_Addr Address) {
+    while (!Open.empty() && Open.back().HighPC <= Address) {
+      Dwarf_Addr End = Open.back().HighPC;
+      Open.pop_back();
+      addStart(Index.ScopeStarts, End,
+               Open.empty() ? nullptr : Open.back().Scp);
+    }
+  };
+  for (ScopeRange Range : Ranges) {
+    CloseUntil(Range.LowPC);
+    // Ranges that overlap without nesting (only in invalid DWARF or
+    // unrelocated objects) are cut short at the end of the enclosing range.
+    if (!Open.empty())
+      Range.HighPC = std::min(Range.HighPC, Open.back().HighPC);
+    if (Range.LowPC >= Range.HighPC)
+      continue;
+    addStart(Index.ScopeStarts, Range.LowPC, Range.Scp);
+    Open.push_back(Range);
+  }
+  CloseUntil(std::numeric_limits<Dwarf_Addr>::max());
+}
+
+void AddressIndexBuilder::addLineStarts(AddressIndex &Index) {
+  // The end of a sequence sorts before a row starting at the same address.
+  // Otherwise the table order is kept, so the last row at an address wins.
+  std::stable_sort(Rows.begin(), Rows.end(),
+                   [](const LineRow &A, const LineRow &B) {
+                     if (A.Address != B.Address)
+                       return A.Address < B.Address;
+                     return A.Ln == nullptr && B.Ln != nullptr;
+                   });
+  for (const LineRow &Row : Rows)
+    addStart(Index.LineStarts, Row.Address, Row.Ln);
+}
+
+AddressIndex::AddressIndex(const Object &Root) {
+  TraceSpan Span("BuildAddressIndex");
+  AddressIndexBuilder Builder;
+  Builder.visit(&Root);
+  Builder.addScopeStarts(*this);
+  Builder.addLineStarts(*this);
+}
+
+template <typename T>
+const T *AddressIndex::find(const std::vector<Start<T>> &Starts,
+                            Dwarf_Addr Address) {
+  auto IT = std::upper_bound(
+      Starts.begin(), Starts.end(), Address,
+      [](Dwarf_Addr Addr, const Start<T> &S) { return Addr < S.Address; });
+  return IT == Starts.begin() ? nullptr : std::prev(IT)->Covering;
+}
+
+const Scope *AddressIndex::findScope(Dwarf_Addr Address) const {
+  return find(ScopeStarts, Address);
+}
+
+const Line *AddressIndex::findLine(Dwarf_Addr Address) const {
+  return find(LineStarts, Address);
+}
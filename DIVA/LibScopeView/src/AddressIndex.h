@@ -0,0 +1,96 @@
+//===-- LibScopeView/AddressIndex.h -----------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// An index from code addresses to the scopes and line table rows that cover
+/// them, for answering many address queries without visiting the whole tree.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ADDRESSINDEX_H
+#define ADDRESSINDEX_H
+
+#include "libdwarf.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LibScopeView {
+
+class Line;
+class Object;
+class Scope;
+
+/// \brief Maps code addresses to the innermost scope (compile unit, function,
+/// inlined function or block) and the line table row that cover them.
+///
+/// The address ranges of the scopes nest, so they are flattened into a sorted
+/// list of boundaries where the innermost covering scope changes; the scopes
+/// that contain it are its parents. The line table rows are kept sorted the
+/// same way, each row covering the addresses up to the next row. Building the
+/// index visits the whole tree once, after which a query is a binary search.
+class AddressIndex {
+public:
+  /// \brief Index the scopes and lines in the tree under Root.
+  explicit AddressIndex(const Object &Root);
+
+  AddressIndex(const AddressIndex &) = delete;
+  AddressIndex &operator=(const AddressIndex &) = delete;
+
+  /// \brief The innermost scope whose ranges contain Address, or nullptr.
+  const Scope *findScope(Dwarf_Addr Address) const;
+
+  /// \brief The line table row that covers Address, or nullptr.
+  const Line *findLine(Dwarf_Addr Address) const;
+
+  /// \brief Number of boundaries between the scopes' address ranges.
+  size_t getScopeBoundaryCount() const { return ScopeStarts.size(); }
+
+  /// \brief Number of boundaries between the line table rows.
+  size_t getLineBoundaryCount() const { return LineStarts.size(); }
+
+private:
+  friend class AddressIndexBuilder;
+
+  /// \brief Covering (or nullptr) covers from Address to the next Start.
+  template <typename T> struct Start {
+    Dwarf_Addr Address;
+    const T *Covering;
+  };
+
+  // Find the Start at or before Address.
+  template <typename T>
+  static const T *find(const std::vector<Start<T>> &Starts,
+                       Dwarf_Addr Address);
+
+  // Boundaries of the innermost scopes, sorted by address.
+  std::vector<Start<Scope>> ScopeStarts;
+  // Boundaries of the line table rows, sorted by address.
+  std::vector<Start<Line>> LineStarts;
+};
+
+} // namespace LibScopeView
+
+#endif // ADDRESSINDEX_H
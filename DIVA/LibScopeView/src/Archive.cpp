@@ -0,0 +1,151 @@
+//===-- LibScopeView/Archive.cpp --------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the parsing of the member table of a static archive.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Archive.h"
+
+#include <cstring>
+
+using namespace LibScopeView;
+
+namespace {
+
+const char ArchiveMagic[] = "!<arch>\n";
+const size_t ArchiveMagicSize = sizeof(ArchiveMagic) - 1;
+
+// The fixed size header before each member.
+const size_t HeaderSize = 60;
+const size_t NameFieldSize = 16;
+const size_t SizeFieldOffset = 48;
+const size_t SizeFieldSize = 10;
+const size_t TerminatorOffset = 58;
+
+/// \brief Parse a space padded decimal field, returning false if it isn't a
+/// number.
+bool parseDecimal(const char *Field, size_t FieldSize, uint64_t &Value) {
+  Value = 0;
+  size_t I = 0;
+  for (; I < FieldSize && Field[I] >= '0' && Field[I] <= '9'; ++I)
+    Value = Value * 10 + static_cast<uint64_t>(Field[I] - '0');
+  if (I == 0)
+    return false;
+  for (; I < FieldSize; ++I)
+    if (Field[I] != ' ')
+      return false;
+  return true;
+}
+
+/// \brief Remove the trailing spaces of a header field.
+std::string trimField(const char *Field, size_t FieldSize) {
+  std::string Str(Field, FieldSize);
+  Str.erase(Str.find_last_not_of(' ') + 1);
+  return Str;
+}
+
+} // end anonymous namespace
+
+bool LibScopeView::getArchiveMembers(const char *Data, size_t Size,
+                                     std::vector<ArchiveMember> &Members) {
+  if (Size < ArchiveMagicSize ||
+      memcmp(Data, ArchiveMagic, ArchiveMagicSize) != 0)
+    return false;
+
+  // The GNU table of names that don't fit in the header.
+  const char *LongNames = nullptr;
+  uint64_t LongNamesSize = 0;
+
+  uint64_t Pos = ArchiveMagicSize;
+  while (Pos < Size) {
+    if (Size - Pos < HeaderSize)
+      return false;
+    const char *Header = Data + Pos;
+    uint64_t MemberSize;
+    if (memcmp(Header + TerminatorOffset, "`\n", 2) != 0 ||
+        !parseDecimal(Header + SizeFieldOffset, SizeFieldSize, MemberSize))
+      return false;
+    Pos += HeaderSize;
+    if (MemberSize > Size - Pos)
+      return false;
+
+    ArchiveMember Member;
+    Member.Offset = Pos;
+    Member.Size = MemberSize;
+    std::string Name(trimField(Header, NameFieldSize));
+
+    // Each member starts on an even offset.
+    Pos += MemberSize + (MemberSize & 1);
+
+    if (Name == "/" || Name == "/SYM64/") {
+      // GNU symbol table.
+      continue;
+    }
+    if (Name == "//") {
+      LongNames = Data + Member.Offset;
+      LongNamesSize = MemberSize;
+      continue;
+    }
+    if (Name.compare(0, 3, "#1/") == 0) {
+      // BSD long name, stored at the start of the member.
+      uint64_t NameSize;
+      if (!parseDecimal(Name.c_str() + 3, Name.size() - 3, NameSize) ||
+          NameSize > MemberSize)
+        return false;
+      const char *NameStart = Data + Member.Offset;
+      Name.assign(NameStart, strnlen(NameStart, NameSize));
+      Member.Offset += NameSize;
+      Member.Size -= NameSize;
+      if (Name.compare(0, 9, "__.SYMDEF") == 0)
+        continue;
+    } else if (Name.size() > 1 && Name[0] == '/') {
+      // GNU long name, an offset into the table of names, each of which ends
+      // with "/\n".
+      uint64_t NameOffset;
+      if (!LongNames ||
+          !parseDecimal(Name.c_str() + 1, Name.size() - 1, NameOffset) ||
+          NameOffset >= LongNamesSize)
+        return false;
+      const char *NameStart = LongNames + NameOffset;
+      const char *NameEnd = static_cast<const char *>(
+          memchr(NameStart, '\n', LongNamesSize - NameOffset));
+      if (!NameEnd)
+        return false;
+      Name.assign(NameStart, NameEnd);
+      if (!Name.empty() && Name.back() == '/')
+        Name.pop_back();
+    } else if (Name.compare(0, 9, "__.SYMDEF") == 0) {
+      // BSD symbol table.
+      continue;
+    } else if (!Name.empty() && Name.back() == '/') {
+      // GNU short names end with a '/' so that they can contain spaces.
+      Name.pop_back();
+    }
+    Member.Name = std::move(Name);
+    Members.push_back(std::move(Member));
+  }
+  return true;
+}
@@ -0,0 +1,56 @@
+//===-- LibScopeView/Archive.h ----------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the parsing of the member table of a static archive.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace LibScopeView {
+
+/// \brief A file stored in a static archive.
+struct ArchiveMember {
+  std::string Name;
+  /// \brief Offset of the member's contents from the start of the archive.
+  uint64_t Offset = 0;
+  uint64_t Size = 0;
+};
+
+/// \brief Get the members of the static archive in Data, in the order they
+/// are stored. Both GNU and BSD long names are supported and the symbol and
+/// long name tables are skipped. Returns false if the archive is malformed.
+bool getArchiveMembers(const char *Data, size_t Size,
+                       std::vector<ArchiveMember> &Members);
+
+} // namespace LibScopeView
+
+#endif // ARCHIVE_H
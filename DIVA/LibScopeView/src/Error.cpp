@@ -30,7 +30,9 @@
 #include "Error.h"
 
 #include <assert.h>
+#include <atomic>
 #include <sstream>
+#include <vector>
 
 using namespace LibScopeError;
 
@@ -57,6 +59,9 @@ const ErrorEntry ErrorTable[] = {
     // Reading.
     {"ERR_READ_FAILED", "Failed to read '%s'."},
 
+    // Writing.
+    {"ERR_WRITE_FAILED", "Failed to write '%s' (%s)."},
+
     // ElfDwarfReader.
     {"ERR_INVALID_DWARF", "Failed to read DWARF from '%s'."},
 
@@ -74,6 +79,10 @@ const ErrorEntry ErrorTable[] = {
     {"ERR_FILE_NOT_FOUND", "Unable to open file '%s'."},
     {"ERR_INVALID_FILE",
      "Invalid input file '%s', please provide a file in a supported format."},
+
+    // Server Error.
+    {"ERR_SERVE_FAILED", "Unable to serve on '%s' (%s)."},
+    {"ERR_CONNECT_FAILED", "Unable to connect to the diva server on '%s' (%s)."},
 };
 static_assert(sizeof(ErrorTable) / sizeof(ErrorEntry) ==
                   static_cast<size_t>(ErrorCode::ERR_LAST_CODE),
@@ -84,12 +93,51 @@ const ErrorEntry &getEntry(const ErrorCode Code) {
   return ErrorTable[static_cast<size_t>(Code)];
 }
 
+std::atomic<bool> ThrowOnExit(false);
+thread_local bool ThreadThrowOnExit = false;
+std::ostream *ErrorOutput = nullptr;
+std::atomic<ErrorHandler> Handler(nullptr);
+
+void writeError(const std::string &Text) {
+  if (ErrorOutput) {
+    *ErrorOutput << Text;
+    ErrorOutput->flush();
+    return;
+  }
+  ErrorHandler CurrentHandler = Handler;
+  if (CurrentHandler && CurrentHandler(Text))
+    return;
+  fputs(Text.c_str(), stderr);
+  // Printing to stderr includes a flush on Linux but not Windows
+  fflush(stderr);
+}
+
 } // namespace
 
+void LibScopeError::setThrowOnExit(bool Throw) { ThrowOnExit = Throw; }
+
+bool LibScopeError::getThrowOnExit() { return ThrowOnExit; }
+
+void LibScopeError::setThreadThrowOnExit(bool Throw) {
+  ThreadThrowOnExit = Throw;
+}
+
+bool LibScopeError::getThreadThrowOnExit() { return ThreadThrowOnExit; }
+
+void LibScopeError::exitProcess(int Status, const std::string &Message) {
+  if (ThrowOnExit || ThreadThrowOnExit)
+    throw ExitException(Status, Message);
+  exit(Status);
+}
+
+void LibScopeError::setErrorOutput(std::ostream *Out) { ErrorOutput = Out; }
+
+void LibScopeError::setErrorHandler(ErrorHandler NewHandler) {
+  Handler = NewHandler;
+}
+
 void LibScopeError::warning(const std::string &Msg) {
-  fprintf(stderr, "\nWarning: %s\n", Msg.c_str());
-  // Printing to stderr includes a flush on Linux but not Windows
-  fflush(stderr);
+  writeError("\nWarning: " + Msg + "\n");
 }
 
 #ifdef __clang__
@@ -102,25 +150,27 @@ void LibScopeError::warning(const std::string &Msg) {
 #pragma GCC diagnostic ignored "-Wformat-security"
 #endif
 
-void LibScopeError::fatalError(const ErrorCode Code) {
-  fprintf(stderr, "\n%s: ", getEntry(Code).Name);
-  fprintf(stderr, getEntry(Code).Format);
-  fprintf(stderr, "\n");
-  exit(1);
+namespace {
+template <typename... Args>
+[[noreturn]] void reportFatalError(const ErrorCode Code, Args... Details) {
+  const ErrorEntry &Entry = getEntry(Code);
+  int Size = snprintf(nullptr, 0, Entry.Format, Details...);
+  std::vector<char> Message(static_cast<size_t>(Size > 0 ? Size : 0) + 1);
+  snprintf(Message.data(), Message.size(), Entry.Format, Details...);
+  std::string Text = std::string(Entry.Name) + ": " + Message.data();
+  writeError("\n" + Text + "\n");
+  exitProcess(1, Text);
 }
+} // namespace
+
+void LibScopeError::fatalError(const ErrorCode Code) { reportFatalError(Code); }
 void LibScopeError::fatalError(const ErrorCode Code,
                                const std::string &Detail1) {
-  fprintf(stderr, "\n%s: ", getEntry(Code).Name);
-  fprintf(stderr, getEntry(Code).Format, Detail1.c_str());
-  fprintf(stderr, "\n");
-  exit(1);
+  reportFatalError(Code, Detail1.c_str());
 }
 void LibScopeError::fatalError(const ErrorCode Code, const std::string &Detail1,
                                const std::string &Detail2) {
-  fprintf(stderr, "\n%s: ", getEntry(Code).Name);
-  fprintf(stderr, getEntry(Code).Format, Detail1.c_str(), Detail2.c_str());
-  fprintf(stderr, "\n");
-  exit(1);
+  reportFatalError(Code, Detail1.c_str(), Detail2.c_str());
 }
 
 #ifdef __clang__
@@ -27,6 +27,8 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#include <exception>
+#include <ostream>
 #include <string>
 
 #ifndef ERROR_H
@@ -47,6 +49,9 @@ enum class ErrorCode {
   // Reading.
   ERR_READ_FAILED,
 
+  // Writing.
+  ERR_WRITE_FAILED,
+
   // ElfDwarfReader.
   ERR_INVALID_DWARF,
 
@@ -63,14 +68,61 @@ enum class ErrorCode {
   ERR_FILE_NOT_FOUND,
   ERR_INVALID_FILE,
 
+  // Server Error.
+  ERR_SERVE_FAILED,
+  ERR_CONNECT_FAILED,
+
   // Last Error.
   ERR_LAST_CODE
 };
 
+/// \brief Thrown by exitProcess in place of exiting while exceptions are
+/// enabled with setThrowOnExit.
+class ExitException : public std::exception {
+public:
+  explicit ExitException(int ExitStatus,
+                         const std::string &ExitMessage = std::string())
+      : Status(ExitStatus), Message(ExitMessage) {}
+  int getStatus() const { return Status; }
+  /// \brief The fatal error that caused the exit, or empty.
+  const std::string &getMessage() const { return Message; }
+  const char *what() const noexcept override { return "diva exit"; }
+
+private:
+  int Status;
+  std::string Message;
+};
+
+/// \brief Make exitProcess (and so fatalError) throw an ExitException rather
+/// than exit. Used by the diva server so that a bad request does not stop it.
+void setThrowOnExit(bool Throw);
+bool getThrowOnExit();
+
+/// \brief As setThrowOnExit, but only for exits on the calling thread.
+void setThreadThrowOnExit(bool Throw);
+bool getThreadThrowOnExit();
+
+/// \brief Exit with Status, or throw an ExitException holding Message (see
+/// setThrowOnExit).
+[[noreturn]] void exitProcess(int Status,
+                              const std::string &Message = std::string());
+
+/// \brief Write warnings and fatal errors to Out instead of stderr (nullptr
+/// restores stderr).
+void setErrorOutput(std::ostream *Out);
+
+/// \brief A function given each warning and fatal error that isn't written to
+/// the error output, which returns false if it should still go to stderr.
+using ErrorHandler = bool (*)(const std::string &Text);
+
+/// \brief Pass warnings and fatal errors to Handler before writing them to
+/// stderr (nullptr removes it).
+void setErrorHandler(ErrorHandler Handler);
+
 /// \brief Display a warning message.
 void warning(const std::string &Msg);
 
-/// \brief Display a fatal error and exit.
+/// \brief Display a fatal error and exit (see exitProcess).
 [[noreturn]] void fatalError(const ErrorCode Code);
 [[noreturn]] void fatalError(const ErrorCode Code, const std::string &Detail1);
 [[noreturn]] void fatalError(const ErrorCode Code, const std::string &Detail1,
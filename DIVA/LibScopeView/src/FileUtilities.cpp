@@ -36,6 +36,7 @@
 #include <array>
 #include <assert.h>
 #include <cctype>
+#include <cstdio>
 #include <fcntl.h>
 #include <fstream>
 #include <iterator>
@@ -47,9 +48,11 @@
 #include <Windows.h>
 #include <io.h>
 #elif defined(PLATFORM_LINUX)
+#include <dirent.h>
 #include <errno.h>
 #include <limits.h>
 #include <stdlib.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -276,6 +279,150 @@ bool LibScopeView::doesFileExist(const std::string &FileLocation) {
   return IFS.good();
 }
 
+bool LibScopeView::listFilesRecursively(const std::string &UnifiedPath,
+                                        std::vector<std::string> &Files) {
+  std::string Dir(UnifiedPath);
+  if (!Dir.empty() && Dir.back() == '/')
+    Dir.pop_back();
+
+  std::vector<std::string> Names;
+  std::vector<std::string> Subdirectories;
+#ifdef PLATFORM_WIN
+  WIN32_FIND_DATAA Data;
+  HANDLE Find = FindFirstFileA(nativeFilePath(Dir + "/*").c_str(), &Data);
+  if (Find == INVALID_HANDLE_VALUE)
+    return false;
+  do {
+    std::string Name(unifyFilePath(Data.cFileName));
+    if (Name == "." || Name == "..")
+      continue;
+    if (!(Data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+      Names.push_back(Name);
+    else if (!(Data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+      Subdirectories.push_back(Name);
+  } while (FindNextFileA(Find, &Data));
+  FindClose(Find);
+#else
+  DIR *Stream = opendir(Dir.c_str());
+  if (!Stream)
+    return false;
+  while (dirent *Entry = readdir(Stream)) {
+    std::string Name(Entry->d_name);
+    if (Name == "." || Name == "..")
+      continue;
+    struct stat SB;
+    if (lstat((Dir + "/" + Name).c_str(), &SB) != 0)
+      continue;
+    if (S_ISDIR(SB.st_mode)) {
+      Subdirectories.push_back(Name);
+      continue;
+    }
+    // Follow links to files, but not to directories.
+    if (S_ISLNK(SB.st_mode) && stat((Dir + "/" + Name).c_str(), &SB) != 0)
+      continue;
+    if (S_ISREG(SB.st_mode))
+      Names.push_back(Name);
+  }
+  closedir(Stream);
+#endif
+
+  // Files and directories are listed together in sorted order.
+  std::vector<std::pair<std::string, bool>> Entries;
+  for (const std::string &Name : Names)
+    Entries.emplace_back(Name, false);
+  for (const std::string &Name : Subdirectories)
+    Entries.emplace_back(Name, true);
+  std::sort(Entries.begin(), Entries.end());
+  for (const auto &Entry : Entries) {
+    std::string Path(Dir + "/" + Entry.first);
+    if (Entry.second)
+      listFilesRecursively(Path, Files);
+    else
+      Files.push_back(Path);
+  }
+  return true;
+}
+
+bool LibScopeView::matchGlob(const std::string &Pattern,
+                             const std::string &Text) {
+  // Match one character at PatternPos against C, returning the position after
+  // the pattern character or set, or npos if it doesn't match.
+  auto MatchOne = [&Pattern](size_t PatternPos, char C) {
+    if (Pattern[PatternPos] == '?')
+      return PatternPos + 1;
+    if (Pattern[PatternPos] == '[') {
+      size_t End = Pattern.find(']', PatternPos + 2);
+      if (End != std::string::npos) {
+        size_t Pos = PatternPos + 1;
+        bool Negated = Pattern[Pos] == '!';
+        if (Negated)
+          ++Pos;
+        bool InSet = false;
+        for (; Pos < End; ++Pos) {
+          if (Pos + 2 < End && Pattern[Pos + 1] == '-') {
+            InSet |= C >= Pattern[Pos] && C <= Pattern[Pos + 2];
+            Pos += 2;
+          } else {
+            InSet |= C == Pattern[Pos];
+          }
+        }
+        return InSet != Negated ? End + 1 : std::string::npos;
+      }
+    }
+    return Pattern[PatternPos] == C ? PatternPos + 1 : std::string::npos;
+  };
+
+  // On a mismatch, let the last '*' match one more character and try again.
+  size_t PatternPos = 0, TextPos = 0;
+  size_t StarPos = std::string::npos, StarTextPos = 0;
+  while (TextPos < Text.size()) {
+    if (PatternPos < Pattern.size() && Pattern[PatternPos] == '*') {
+      StarPos = PatternPos++;
+      StarTextPos = TextPos;
+      continue;
+    }
+    size_t Next = PatternPos < Pattern.size()
+                      ? MatchOne(PatternPos, Text[TextPos])
+                      : std::string::npos;
+    if (Next != std::string::npos) {
+      PatternPos = Next;
+      ++TextPos;
+    } else if (StarPos != std::string::npos) {
+      PatternPos = StarPos + 1;
+      TextPos = ++StarTextPos;
+    } else {
+      return false;
+    }
+  }
+  while (PatternPos < Pattern.size() && Pattern[PatternPos] == '*')
+    ++PatternPos;
+  return PatternPos == Pattern.size();
+}
+
+bool LibScopeView::getFileStatus(const std::string &FileLocation,
+                                 FileStatus &Status) {
+#ifdef PLATFORM_WIN
+  WIN32_FILE_ATTRIBUTE_DATA Data;
+  if (!GetFileAttributesExA(nativeFilePath(FileLocation).c_str(),
+                            GetFileExInfoStandard, &Data))
+    return false;
+  Status.Size = (static_cast<uint64_t>(Data.nFileSizeHigh) << 32) |
+                Data.nFileSizeLow;
+  Status.ModificationTime =
+      (static_cast<uint64_t>(Data.ftLastWriteTime.dwHighDateTime) << 32) |
+      Data.ftLastWriteTime.dwLowDateTime;
+#else
+  struct stat SB;
+  if (stat(FileLocation.c_str(), &SB) != 0)
+    return false;
+  Status.Size = static_cast<uint64_t>(SB.st_size);
+  Status.ModificationTime =
+      static_cast<uint64_t>(SB.st_mtim.tv_sec) * 1000000000 +
+      static_cast<uint64_t>(SB.st_mtim.tv_nsec);
+#endif
+  return true;
+}
+
 bool LibScopeView::isFileFormatElf(const std::string &FileLocation) {
   static const std::array<char, 4> ElfMagic = {{0x7f, 0x45, 0x4c, 0x46}};
 
@@ -286,6 +433,23 @@ bool LibScopeView::isFileFormatElf(const std::string &FileLocation) {
   return std::equal(Bytes.begin(), Bytes.end(), ElfMagic.begin());
 }
 
+bool LibScopeView::isFileFormatArchive(const std::string &FileLocation) {
+  static const std::string ArchiveMagic("!<arch>\n");
+
+  std::vector<char> Bytes;
+  if (!getBytesFromFile(Bytes, FileLocation, ArchiveMagic.size()))
+    return false;
+
+  return Bytes.size() == ArchiveMagic.size() &&
+         std::equal(Bytes.begin(), Bytes.end(), ArchiveMagic.begin());
+}
+
+void LibScopeView::setStdoutBinaryMode() {
+#ifdef PLATFORM_WIN
+  _setmode(_fileno(stdout), _O_BINARY);
+#endif
+}
+
 FileDescriptor::FileDescriptor(const std::string &UnifiedPath) {
 #ifdef PLATFORM_WIN
   _sopen_s(&FD, nativeFilePath(UnifiedPath).c_str(), _O_BINARY | _O_RDONLY,
@@ -317,3 +481,34 @@ FileDescriptor &FileDescriptor::operator=(FileDescriptor &&Other) {
   swap(*this, Tmp);
   return *this;
 }
+
+MappedFile::MappedFile(const std::string &UnifiedPath) {
+  FileStatus Status;
+  if (!getFileStatus(UnifiedPath, Status))
+    fatalError(LibScopeError::ErrorCode::ERR_FILEIO_OPEN_FAILURE, UnifiedPath);
+  Size = static_cast<size_t>(Status.Size);
+  if (Size == 0)
+    return;
+
+#ifdef PLATFORM_LINUX
+  FileDescriptor FD(UnifiedPath);
+  void *Mapping =
+      mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE, FD.get(), 0);
+  if (Mapping != MAP_FAILED) {
+    Data = static_cast<char *>(Mapping);
+    IsMapped = true;
+    return;
+  }
+#endif
+
+  if (!getBytesFromFile(Buffer, UnifiedPath, Size) || Buffer.size() != Size)
+    fatalError(LibScopeError::ErrorCode::ERR_READ_FAILED, UnifiedPath);
+  Data = Buffer.data();
+}
+
+MappedFile::~MappedFile() {
+#ifdef PLATFORM_LINUX
+  if (IsMapped)
+    munmap(Data, Size);
+#endif
+}
@@ -31,7 +31,9 @@
 #ifndef FILE_UTILITIES_H
 #define FILE_UTILITIES_H
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace LibScopeView {
 
@@ -69,12 +71,40 @@ bool makeDir(const std::string &UnifiedPath);
 /// Returns true if all the directories were created or already existed.
 bool recursiveMakeDir(const std::string &UnifiedPath);
 
+/// \brief Get the paths of the regular files in a directory and all of its
+/// subdirectories, in sorted order. Symbolic links to directories are not
+/// followed. Returns false if the directory can't be read.
+bool listFilesRecursively(const std::string &UnifiedPath,
+                          std::vector<std::string> &Files);
+
+/// \brief Return true if Text matches Pattern, where '*' matches any
+/// characters, '?' matches one character and "[...]" matches one of a set of
+/// characters (or "[!...]" one not in the set).
+bool matchGlob(const std::string &Pattern, const std::string &Text);
+
 /// \brief Return true if the file exists.
 bool doesFileExist(const std::string &FileLocation);
 
+/// \brief The size and last modification time of a file.
+struct FileStatus {
+  uint64_t Size = 0;
+  /// \brief Platform specific time stamp, only useful for comparisons.
+  uint64_t ModificationTime = 0;
+};
+
+/// \brief Get the status of a file, returning false if it does not exist.
+bool getFileStatus(const std::string &FileLocation, FileStatus &Status);
+
 /// \brief Return true if the file is an elf.
 bool isFileFormatElf(const std::string &FileLocation);
 
+/// \brief Return true if the file is a static archive (not a thin archive).
+bool isFileFormatArchive(const std::string &FileLocation);
+
+/// \brief Stop the newlines written to stdout being translated, so that binary
+/// data can be written to it.
+void setStdoutBinaryMode();
+
 /// \brief RAII warpper around an int file descriptor.
 class FileDescriptor {
 public:
@@ -99,6 +129,27 @@ private:
   int FD;
 };
 
+/// \brief A private copy-on-write view of a whole file, so that the contents
+/// can be modified in memory without changing the file.
+class MappedFile {
+public:
+  MappedFile(const std::string &UnifiedPath);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &Other) = delete;
+  MappedFile &operator=(const MappedFile &Other) = delete;
+
+  char *data() const { return Data; }
+  size_t size() const { return Size; }
+
+private:
+  char *Data = nullptr;
+  size_t Size = 0;
+  bool IsMapped = false;
+  // The contents of the file, where it can't be mapped.
+  std::vector<char> Buffer;
+};
+
 } // namespace LibScopeView
 
 #endif // FILE_UTILITIES_H
@@ -0,0 +1,140 @@
+//===-- LibScopeView/GzipStream.cpp -----------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implementation of GzipOutputStream.
+///
+//===----------------------------------------------------------------------===//
+
+#include "GzipStream.h"
+#include "Error.h"
+
+#include "zlib.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace LibScopeView;
+
+namespace {
+
+// Compress Size bytes of Data as a complete gzip member, returning an empty
+// string if zlib fails.
+std::string compressBlock(const char *Data, size_t Size) {
+  z_stream Stream = {};
+  // A window size of 15 plus 16 selects the gzip format.
+  if (deflateInit2(&Stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+    return std::string();
+
+  std::string Compressed(deflateBound(&Stream, static_cast<uLong>(Size)), '\0');
+  Stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(Data));
+  Stream.avail_in = static_cast<uInt>(Size);
+  Stream.next_out = reinterpret_cast<Bytef *>(&Compressed[0]);
+  Stream.avail_out = static_cast<uInt>(Compressed.size());
+  int Result = deflate(&Stream, Z_FINISH);
+  Compressed.resize(Stream.total_out);
+  deflateEnd(&Stream);
+  if (Result != Z_STREAM_END)
+    return std::string();
+  return Compressed;
+}
+
+} // namespace
+
+GzipStreamBuf::GzipStreamBuf(std::ostream &Output, size_t BlockSize,
+                             unsigned ThreadCount)
+    : Output(Output), ThreadCount(ThreadCount), Block(BlockSize) {
+  setp(Block.data(), Block.data() + Block.size());
+}
+
+GzipStreamBuf::~GzipStreamBuf() { finish(); }
+
+void GzipStreamBuf::finish() {
+  if (Finished)
+    return;
+  if (pptr() != pbase())
+    submitBlock();
+  while (!Pending.empty())
+    writeOldestBlock();
+  Output.flush();
+  Finished = true;
+  // Make any further writes fail.
+  setp(nullptr, nullptr);
+}
+
+GzipStreamBuf::int_type GzipStreamBuf::overflow(int_type C) {
+  if (Finished)
+    return traits_type::eof();
+  submitBlock();
+  if (!traits_type::eq_int_type(C, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(C);
+    pbump(1);
+  }
+  return traits_type::not_eof(C);
+}
+
+void GzipStreamBuf::submitBlock() {
+  size_t Size = static_cast<size_t>(pptr() - pbase());
+  if (ThreadCount <= 1) {
+    writeCompressed(compressBlock(Block.data(), Size));
+  } else {
+    // Hand the block to a thread and carry on with a new one, keeping at most
+    // one block per thread in flight.
+    if (Pending.size() >= ThreadCount)
+      writeOldestBlock();
+    std::vector<char> Data(Block.size());
+    Data.swap(Block);
+    Pending.push_back(std::async(
+        std::launch::async,
+        [](std::vector<char> Data, size_t Size) {
+          return compressBlock(Data.data(), Size);
+        },
+        std::move(Data), Size));
+  }
+  setp(Block.data(), Block.data() + Block.size());
+}
+
+void GzipStreamBuf::writeOldestBlock() {
+  std::string Compressed(Pending.front().get());
+  Pending.pop_front();
+  writeCompressed(Compressed);
+}
+
+void GzipStreamBuf::writeCompressed(const std::string &Compressed) {
+  if (Compressed.empty())
+    fatalError(LibScopeError::ErrorCode::ERR_WRITE_FAILED, "compressed output",
+               "zlib failed");
+  Output.write(Compressed.data(),
+               static_cast<std::streamsize>(Compressed.size()));
+}
+
+GzipOutputStream::GzipOutputStream(std::ostream &Output, size_t BlockSize,
+                                   unsigned ThreadCount)
+    : std::ostream(nullptr),
+      Buf(Output, BlockSize,
+          ThreadCount ? ThreadCount
+                      : std::max(1U, std::thread::hardware_concurrency())) {
+  rdbuf(&Buf);
+}
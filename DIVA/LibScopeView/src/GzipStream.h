@@ -0,0 +1,105 @@
+//===-- LibScopeView/GzipStream.h -------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of GzipOutputStream, an output stream
+/// that compresses what is written to it with gzip.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SCOPEVIEW_GZIPSTREAM_H
+#define SCOPEVIEW_GZIPSTREAM_H
+
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace LibScopeView {
+
+/// \brief A stream buffer that compresses its contents with gzip and writes
+/// them to another stream.
+///
+/// The contents are split into blocks that are compressed independently, on
+/// up to ThreadCount threads, and written as concatenated gzip members (as
+/// pigz does), which any gzip reader decompresses as one stream. Flushing
+/// doesn't end a member, so nothing is written until a block is full or
+/// finish() is called.
+class GzipStreamBuf : public std::streambuf {
+public:
+  GzipStreamBuf(std::ostream &Output, size_t BlockSize, unsigned ThreadCount);
+  ~GzipStreamBuf() override;
+
+  GzipStreamBuf(const GzipStreamBuf &) = delete;
+  GzipStreamBuf &operator=(const GzipStreamBuf &) = delete;
+
+  /// \brief Compress and write everything written so far, ending the output.
+  /// Nothing is written if nothing was written to the stream.
+  void finish();
+
+protected:
+  int_type overflow(int_type C) override;
+
+private:
+  // Start compressing the current block.
+  void submitBlock();
+  // Write the oldest compressed block to Output.
+  void writeOldestBlock();
+  void writeCompressed(const std::string &Compressed);
+
+  std::ostream &Output;
+  unsigned ThreadCount;
+  std::vector<char> Block;
+  // The blocks being compressed, in output order.
+  std::deque<std::future<std::string>> Pending;
+  bool Finished = false;
+};
+
+/// \brief An output stream that compresses what is written to it with gzip,
+/// writing the compressed data to another stream. See GzipStreamBuf.
+class GzipOutputStream : public std::ostream {
+public:
+  static const size_t DefaultBlockSize = 1024 * 1024;
+
+  /// \brief Compress to Output. ThreadCount is the number of blocks that can
+  /// be compressed at once, or 0 for the number of hardware threads.
+  explicit GzipOutputStream(std::ostream &Output,
+                            size_t BlockSize = DefaultBlockSize,
+                            unsigned ThreadCount = 0);
+
+  /// \brief Finish the output if close() wasn't called.
+  ~GzipOutputStream() override = default;
+
+  /// \brief Compress and write everything written so far, ending the output.
+  void close() { Buf.finish(); }
+
+private:
+  GzipStreamBuf Buf;
+};
+
+} // namespace LibScopeView
+
+#endif // SCOPEVIEW_GZIPSTREAM_H
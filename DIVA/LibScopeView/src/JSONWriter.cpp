@@ -0,0 +1,160 @@
+//===-- LibScopeView/JSONWriter.cpp -----------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the definitions of JSONWriter's methods.
+///
+//===----------------------------------------------------------------------===//
+
+#include "JSONWriter.h"
+
+using namespace LibScopeView;
+
+namespace {
+
+// Write Str escaped for the inside of a JSON string, copying the runs of
+// characters that need no escaping as they are.
+void writeEscaped(std::ostream &OS, const char *Str, size_t Length) {
+  static const char HexDigits[] = "0123456789abcdef";
+  size_t RunStart = 0;
+  for (size_t I = 0; I < Length; ++I) {
+    unsigned char C = static_cast<unsigned char>(Str[I]);
+    if (C >= 0x20 && C != '"' && C != '\\')
+      continue;
+    OS.write(Str + RunStart, static_cast<std::streamsize>(I - RunStart));
+    RunStart = I + 1;
+    switch (C) {
+    case '"':
+      OS.write("\\\"", 2);
+      break;
+    case '\\':
+      OS.write("\\\\", 2);
+      break;
+    case '\n':
+      OS.write("\\n", 2);
+      break;
+    case '\r':
+      OS.write("\\r", 2);
+      break;
+    case '\t':
+      OS.write("\\t", 2);
+      break;
+    default:
+      char Escape[] = {'\\', 'u', '0', '0', HexDigits[C >> 4],
+                       HexDigits[C & 0xf]};
+      OS.write(Escape, sizeof(Escape));
+    }
+  }
+  OS.write(Str + RunStart, static_cast<std::streamsize>(Length - RunStart));
+}
+
+} // namespace
+
+void JSONWriter::beginObject() {
+  writeSeparator();
+  OS->put('{');
+  NeedsComma = false;
+}
+
+void JSONWriter::endObject() {
+  OS->put('}');
+  NeedsComma = true;
+}
+
+void JSONWriter::beginArray() {
+  writeSeparator();
+  OS->put('[');
+  NeedsComma = false;
+}
+
+void JSONWriter::endArray() {
+  OS->put(']');
+  NeedsComma = true;
+}
+
+void JSONWriter::key(const char *Key) {
+  writeSeparator();
+  *OS << '"' << Key << "\":";
+  AfterKey = true;
+}
+
+void JSONWriter::string(const char *Str, size_t Length) {
+  beginString();
+  appendString(Str, Length);
+  endString();
+}
+
+void JSONWriter::boolean(bool Value) {
+  writeSeparator();
+  if (Value)
+    OS->write("true", 4);
+  else
+    OS->write("false", 5);
+  NeedsComma = true;
+}
+
+void JSONWriter::number(uint64_t Value) {
+  writeSeparator();
+  *OS << Value;
+  NeedsComma = true;
+}
+
+void JSONWriter::signedNumber(int64_t Value) {
+  writeSeparator();
+  *OS << Value;
+  NeedsComma = true;
+}
+
+void JSONWriter::null() {
+  writeSeparator();
+  OS->write("null", 4);
+  NeedsComma = true;
+}
+
+void JSONWriter::beginString() {
+  writeSeparator();
+  OS->put('"');
+}
+
+void JSONWriter::appendString(const char *Str, size_t Length) {
+  writeEscaped(*OS, Str, Length);
+}
+
+void JSONWriter::endString() {
+  OS->put('"');
+  NeedsComma = true;
+}
+
+void JSONWriter::writeSeparator() {
+  if (AfterKey)
+    AfterKey = false;
+  else if (NeedsComma)
+    OS->put(',');
+}
+
+void LibScopeView::writeJSONString(std::ostream &OS, const std::string &Str) {
+  OS.put('"');
+  writeEscaped(OS, Str.data(), Str.size());
+  OS.put('"');
+}
@@ -0,0 +1,124 @@
+//===-- LibScopeView/JSONWriter.h -------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of JSONWriter, which streams JSON to an
+/// output stream.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SCOPEVIEW_JSONWRITER_H
+#define SCOPEVIEW_JSONWRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace LibScopeView {
+
+/// \brief Writes JSON values to a stream as they are given, without building
+/// a document or allocating.
+///
+/// The writer only tracks whether the next value needs a separator, so the
+/// caller is responsible for balancing the objects and arrays and for giving
+/// each member of an object a key.
+///
+/// \code
+///   JSONWriter JSON(std::cout);
+///   JSON.beginObject();
+///   JSON.key("name");
+///   JSON.string("main");
+///   JSON.key("lines");
+///   JSON.beginArray();
+///   JSON.number(1);
+///   JSON.number(2);
+///   JSON.endArray();
+///   JSON.endObject(); // {"name":"main","lines":[1,2]}
+/// \endcode
+class JSONWriter {
+public:
+  explicit JSONWriter(std::ostream &Output) : OS(&Output) {}
+  /// \brief Create a writer that must be reset before it is written to.
+  JSONWriter() : OS(nullptr) {}
+
+  /// \brief Start a new document on Output.
+  void reset(std::ostream &Output) {
+    OS = &Output;
+    NeedsComma = false;
+    AfterKey = false;
+  }
+
+  /// \brief End the line, starting a new document on the next one, as for
+  /// JSON lines (NDJSON) output.
+  void newline() {
+    OS->put('\n');
+    NeedsComma = false;
+    AfterKey = false;
+  }
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+
+  /// \brief Write the key of the next member of an object. Key is written as
+  /// is, so it must not need escaping.
+  void key(const char *Key);
+
+  void string(const std::string &Str) { string(Str.data(), Str.size()); }
+  void string(const char *Str) { string(Str, strlen(Str)); }
+  void string(const char *Str, size_t Length);
+  void boolean(bool Value);
+  void number(uint64_t Value);
+  void signedNumber(int64_t Value);
+  void null();
+
+  /// \brief Write a string value made of several parts, without first
+  /// concatenating them.
+  void beginString();
+  void appendString(const std::string &Str) {
+    appendString(Str.data(), Str.size());
+  }
+  void appendString(const char *Str) { appendString(Str, strlen(Str)); }
+  void appendString(const char *Str, size_t Length);
+  void endString();
+
+private:
+  // Write the comma before a value, unless it is the first value in its
+  // object or array or follows a key.
+  void writeSeparator();
+
+  std::ostream *OS;
+  bool NeedsComma = false;
+  bool AfterKey = false;
+};
+
+/// \brief Write Str to OS as a quoted JSON string.
+void writeJSONString(std::ostream &OS, const std::string &Str);
+
+} // end namespace LibScopeView
+
+#endif // SCOPEVIEW_JSONWRITER_H
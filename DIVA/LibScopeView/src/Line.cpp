@@ -28,6 +28,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Line.h"
+#include "JSONWriter.h"
 #include "PrintSettings.h"
 #include "Utilities.h"
 
@@ -83,3 +84,22 @@ std::string Line::getAsYAML() const {
   YAML << getCommonYAML() << "\nattributes:" << Attrs.str();
   return YAML.str();
 }
+
+void Line::writeJSON(JSONWriter &JSON) const {
+  writeCommonJSON(JSON);
+  JSON.key("attributes");
+  JSON.beginObject();
+  JSON.key("Discriminator");
+  JSON.number(getDiscriminator());
+  JSON.key("NewStatement");
+  JSON.boolean(getIsNewStatement());
+  JSON.key("PrologueEnd");
+  JSON.boolean(getIsPrologueEnd());
+  JSON.key("EndSequence");
+  JSON.boolean(getIsLineEndSequence());
+  JSON.key("BasicBlock");
+  JSON.boolean(getIsNewBasicBlock());
+  JSON.key("EpilogueBegin");
+  JSON.boolean(getIsEpilogueBegin());
+  JSON.endObject();
+}
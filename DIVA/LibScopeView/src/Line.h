@@ -32,6 +32,8 @@
 
 #include "Object.h"
 
+#include <bitset>
+
 namespace LibScopeView {
 
 /// \brief  Class to represent a single line info entry.
@@ -102,6 +104,8 @@ public:
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 };
 
 } // namespace LibScopeView
@@ -0,0 +1,200 @@
+//===-- LibScopeView/MemoryProfile.cpp --------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the MemoryProfile and MemoryOwner classes.
+///
+//===----------------------------------------------------------------------===//
+
+#include "MemoryProfile.h"
+#include "Object.h"
+#include "StringPool.h"
+#include "Utilities.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+
+using namespace LibScopeView;
+
+namespace {
+
+std::atomic<MemoryProfile *> GlobalActiveProfile(nullptr);
+
+// Name of the heap bytes that no owner accounts for.
+const char *const OtherOwner = "Other";
+
+uint64_t toKB(uint64_t Bytes) { return (Bytes + 512) / 1024; }
+
+} // namespace
+
+uint64_t MemoryProfile::measureOwners(MemoryOwnerBytes &OwnerBytes,
+                                      uint64_t HeapBytes) {
+  OwnerBytes["StringPool"] += getGlobalStringPool().getAllocatedBytes();
+  std::lock_guard<std::mutex> Lock(OwnersMutex);
+  for (const MemoryOwner *Owner : Owners)
+    Owner->measure(OwnerBytes);
+
+  uint64_t Attributed = 0;
+  for (const auto &Owner : OwnerBytes)
+    Attributed += Owner.second;
+  uint64_t Unattributed = HeapBytes > Attributed ? HeapBytes - Attributed : 0;
+  for (const UnattributedMemoryOwner *Owner : UnattributedOwners)
+    Owner->claim(Unattributed, OwnerBytes);
+  return Unattributed;
+}
+
+void MemoryProfile::sample(const char *Phase) {
+  MemorySample Sample{Phase, MemoryOwnerBytes(), getHeapMemoryUsage(),
+                      getCurrentMemoryUsage(), getPeakMemoryUsage()};
+  uint64_t Unattributed = measureOwners(Sample.OwnerBytes, Sample.HeapBytes);
+  if (Sample.HeapBytes)
+    Sample.OwnerBytes[OtherOwner] = Unattributed;
+  Samples.push_back(std::move(Sample));
+}
+
+MemoryOwnerBytes MemoryProfile::getPeakBytes() const {
+  MemoryOwnerBytes Peaks;
+  for (const MemorySample &Sample : Samples)
+    for (const auto &Owner : Sample.OwnerBytes) {
+      uint64_t &Peak = Peaks[Owner.first];
+      Peak = std::max(Peak, Owner.second);
+    }
+  return Peaks;
+}
+
+void MemoryProfile::print(std::ostream &OS) const {
+  // One column for each owner, with the unattributed heap after the owners.
+  MemoryOwnerBytes Peaks(getPeakBytes());
+  std::vector<std::string> Columns;
+  for (const auto &Owner : Peaks)
+    if (Owner.first != OtherOwner)
+      Columns.push_back(Owner.first);
+  if (Peaks.count(OtherOwner))
+    Columns.push_back(OtherOwner);
+
+  const int PhaseWidth = 20;
+  auto getWidth = [](const std::string &Name) {
+    return std::max<int>(10, static_cast<int>(Name.size()));
+  };
+
+  OS << "\nMemory Breakdown (KB):\n" << std::left << std::setw(PhaseWidth)
+     << "Phase" << std::right;
+  for (const std::string &Column : Columns)
+    OS << " | " << std::setw(getWidth(Column)) << Column;
+  OS << " | " << std::setw(10) << "Heap" << " | " << std::setw(10) << "RSS"
+     << " | " << std::setw(10) << "Peak RSS" << '\n';
+
+  auto printRow = [&](const std::string &Phase,
+                      const MemoryOwnerBytes &OwnerBytes, uint64_t Heap,
+                      uint64_t Resident, uint64_t PeakResident) {
+    OS << std::left << std::setw(PhaseWidth) << Phase << std::right;
+    for (const std::string &Column : Columns) {
+      auto It = OwnerBytes.find(Column);
+      OS << " | " << std::setw(getWidth(Column));
+      if (It == OwnerBytes.end())
+        OS << '-';
+      else
+        OS << toKB(It->second);
+    }
+    OS << " | " << std::setw(10) << toKB(Heap) << " | " << std::setw(10)
+       << toKB(Resident) << " | " << std::setw(10) << toKB(PeakResident)
+       << '\n';
+  };
+
+  uint64_t PeakHeap = 0;
+  uint64_t PeakResident = 0;
+  uint64_t PeakResidentSoFar = 0;
+  for (const MemorySample &Sample : Samples) {
+    printRow(Sample.Phase, Sample.OwnerBytes, Sample.HeapBytes,
+             Sample.ResidentBytes, Sample.PeakResidentBytes);
+    PeakHeap = std::max(PeakHeap, Sample.HeapBytes);
+    PeakResident = std::max(PeakResident, Sample.ResidentBytes);
+    PeakResidentSoFar = std::max(PeakResidentSoFar, Sample.PeakResidentBytes);
+  }
+  printRow("Peak", Peaks, PeakHeap, PeakResident, PeakResidentSoFar);
+}
+
+void LibScopeView::setActiveMemoryProfile(MemoryProfile *ActiveProfile) {
+  GlobalActiveProfile = ActiveProfile;
+}
+
+MemoryProfile *LibScopeView::getActiveMemoryProfile() {
+  return GlobalActiveProfile;
+}
+
+void LibScopeView::sampleMemory(const char *Phase) {
+  if (MemoryProfile *Profile = getActiveMemoryProfile())
+    Profile->sample(Phase);
+}
+
+MemoryOwner::MemoryOwner(MeasureFn OwnerMeasure)
+    : Profile(getActiveMemoryProfile()) {
+  if (!Profile)
+    return;
+  Measure = std::move(OwnerMeasure);
+  std::lock_guard<std::mutex> Lock(Profile->OwnersMutex);
+  Profile->Owners.push_back(this);
+}
+
+MemoryOwner::~MemoryOwner() {
+  if (!Profile)
+    return;
+  std::lock_guard<std::mutex> Lock(Profile->OwnersMutex);
+  auto &Owners = Profile->Owners;
+  Owners.erase(std::remove(Owners.begin(), Owners.end(), this), Owners.end());
+}
+
+void LibScopeView::addObjectTreeBytes(const Object &Root,
+                                      MemoryOwnerBytes &OwnerBytes) {
+  ObjectTreeMemory Memory(getObjectTreeMemory(Root));
+  OwnerBytes["Objects"] += Memory.ObjectBytes;
+  OwnerBytes["ObjectVectors"] += Memory.VectorBytes;
+}
+
+UnattributedMemoryOwner::UnattributedMemoryOwner(const char *OwnerName)
+    : Profile(getActiveMemoryProfile()), Name(OwnerName), BaselineBytes(0) {
+  if (!Profile)
+    return;
+  MemoryOwnerBytes OwnerBytes;
+  BaselineBytes = Profile->measureOwners(OwnerBytes, getHeapMemoryUsage());
+  std::lock_guard<std::mutex> Lock(Profile->OwnersMutex);
+  Profile->UnattributedOwners.push_back(this);
+}
+
+UnattributedMemoryOwner::~UnattributedMemoryOwner() {
+  if (!Profile)
+    return;
+  std::lock_guard<std::mutex> Lock(Profile->OwnersMutex);
+  auto &Owners = Profile->UnattributedOwners;
+  Owners.erase(std::remove(Owners.begin(), Owners.end(), this), Owners.end());
+}
+
+void UnattributedMemoryOwner::claim(uint64_t &Unattributed,
+                                    MemoryOwnerBytes &OwnerBytes) const {
+  uint64_t Claimed =
+      Unattributed > BaselineBytes ? Unattributed - BaselineBytes : 0;
+  OwnerBytes[Name] += Claimed;
+  Unattributed -= Claimed;
+}
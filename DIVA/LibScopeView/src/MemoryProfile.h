@@ -0,0 +1,224 @@
+//===-- LibScopeView/MemoryProfile.h ----------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Heap accounting for the structures that own most of DIVA's memory, sampled
+/// at the boundaries of the reading and printing phases.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef MEMORYPROFILE_H
+#define MEMORYPROFILE_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace LibScopeView {
+
+class Object;
+
+/// \brief Bytes held by each named owner (e.g. "StringPool").
+using MemoryOwnerBytes = std::map<std::string, uint64_t>;
+
+/// \brief The memory in use at the end of a phase.
+struct MemorySample {
+  /// \brief Name of the phase that just ended (e.g. "ReadDIEs").
+  const char *Phase;
+  /// \brief Bytes held by each owner that was registered at the time.
+  MemoryOwnerBytes OwnerBytes;
+  /// \brief Heap bytes in use by the whole process (0 if not known).
+  uint64_t HeapBytes;
+  /// \brief Memory used by the process.
+  uint64_t ResidentBytes;
+  /// \brief Peak memory used by the process so far.
+  uint64_t PeakResidentBytes;
+};
+
+class MemoryOwner;
+class UnattributedMemoryOwner;
+
+/// \brief Collects samples of the memory held by the registered owners.
+///
+/// The global string pool is always measured, other owners register
+/// themselves with a MemoryOwner for as long as they hold memory. Heap bytes
+/// that no owner accounts for (mostly libdwarf while a file is being read)
+/// are reported as "Other".
+///
+/// Typical usage:
+/// \code
+///   MemoryProfile Profile;
+///   setActiveMemoryProfile(&Profile);
+///   {
+///     MemoryOwner Owner([&](MemoryOwnerBytes &Bytes) {
+///       Bytes["Cache"] += Cache.capacity() * sizeof(Entry);
+///     });
+///     // ...
+///     sampleMemory("Phase");
+///   }
+///   setActiveMemoryProfile(nullptr);
+///   Profile.print(std::cout);
+/// \endcode
+class MemoryProfile {
+public:
+  MemoryProfile() = default;
+
+  MemoryProfile(const MemoryProfile &) = delete;
+  MemoryProfile &operator=(const MemoryProfile &) = delete;
+
+  /// \brief Measure every registered owner and the process at the end of
+  /// Phase.
+  void sample(const char *Phase);
+
+  /// \brief All the samples, in the order they were taken.
+  const std::vector<MemorySample> &getSamples() const { return Samples; }
+
+  /// \brief The largest number of bytes sampled for each owner.
+  MemoryOwnerBytes getPeakBytes() const;
+
+  /// \brief Print a table of the samples in KB, with a final row of peaks.
+  void print(std::ostream &OS) const;
+
+private:
+  friend class MemoryOwner;
+  friend class UnattributedMemoryOwner;
+
+  // Measure the registered owners, returning the heap bytes not accounted for.
+  uint64_t measureOwners(MemoryOwnerBytes &OwnerBytes, uint64_t HeapBytes);
+
+  std::mutex OwnersMutex;
+  std::vector<const MemoryOwner *> Owners;
+  std::vector<const UnattributedMemoryOwner *> UnattributedOwners;
+  std::vector<MemorySample> Samples;
+};
+
+/// \brief Claims the growth of the heap that no other owner accounts for,
+/// from when it is created until it is destroyed, for code whose allocations
+/// can't be measured directly (e.g. libdwarf).
+///
+/// When no MemoryProfile is active an UnattributedMemoryOwner does nothing.
+class UnattributedMemoryOwner {
+public:
+  explicit UnattributedMemoryOwner(const char *OwnerName);
+  ~UnattributedMemoryOwner();
+
+  UnattributedMemoryOwner(const UnattributedMemoryOwner &) = delete;
+  UnattributedMemoryOwner &
+  operator=(const UnattributedMemoryOwner &) = delete;
+
+  /// \brief Move the bytes claimed by this owner from Unattributed to
+  /// OwnerBytes.
+  void claim(uint64_t &Unattributed, MemoryOwnerBytes &OwnerBytes) const;
+
+private:
+  MemoryProfile *Profile;
+  const char *Name;
+  // Unattributed heap bytes when the owner was created.
+  uint64_t BaselineBytes;
+};
+
+/// \brief Set the MemoryProfile that samples are added to (nullptr disables
+/// memory profiling).
+void setActiveMemoryProfile(MemoryProfile *ActiveProfile);
+
+/// \brief Get the active MemoryProfile, or nullptr if disabled.
+MemoryProfile *getActiveMemoryProfile();
+
+/// \brief Sample the active MemoryProfile, if there is one, at the end of
+/// Phase.
+void sampleMemory(const char *Phase);
+
+/// \brief Registers a measure of the memory held by some structure with the
+/// active MemoryProfile for the lifetime of the MemoryOwner.
+///
+/// When no MemoryProfile is active a MemoryOwner does nothing.
+class MemoryOwner {
+public:
+  using MeasureFn = std::function<void(MemoryOwnerBytes &)>;
+
+  explicit MemoryOwner(MeasureFn Measure);
+  ~MemoryOwner();
+
+  MemoryOwner(const MemoryOwner &) = delete;
+  MemoryOwner &operator=(const MemoryOwner &) = delete;
+
+  /// \brief Add the bytes currently held to OwnerBytes.
+  void measure(MemoryOwnerBytes &OwnerBytes) const { Measure(OwnerBytes); }
+
+private:
+  MemoryProfile *Profile;
+  MeasureFn Measure;
+};
+
+/// \brief Add the bytes held by Root and the Objects under it to OwnerBytes
+/// (as "Objects" and "ObjectVectors").
+void addObjectTreeBytes(const Object &Root, MemoryOwnerBytes &OwnerBytes);
+
+/// \brief Heap bytes taken by an allocation of Size bytes, including the
+/// allocator's header and alignment. This matches glibc's malloc and is a
+/// close estimate for other allocators.
+inline uint64_t getAllocationBytes(uint64_t Size) {
+  const uint64_t HeaderBytes = sizeof(size_t);
+  const uint64_t Alignment = 2 * sizeof(size_t);
+  const uint64_t MinimumBytes = 4 * sizeof(size_t);
+  if (Size == 0)
+    return 0;
+  uint64_t Bytes = (Size + HeaderBytes + Alignment - 1) & ~(Alignment - 1);
+  return Bytes < MinimumBytes ? MinimumBytes : Bytes;
+}
+
+/// \brief Heap bytes used by the characters of Str (0 if they are stored in
+/// the string itself).
+inline uint64_t getHeapBytes(const std::string &Str) {
+  static const size_t InlineCapacity = std::string().capacity();
+  if (Str.capacity() <= InlineCapacity)
+    return 0;
+  return getAllocationBytes(Str.capacity() + 1);
+}
+
+/// \brief Heap bytes used by the buffer of a vector.
+template <typename T> uint64_t getHeapBytes(const std::vector<T> &Vec) {
+  return getAllocationBytes(Vec.capacity() * sizeof(T));
+}
+
+/// \brief Heap bytes used by the buckets and nodes of an unordered map or
+/// set, not counting any memory owned by the elements.
+///
+/// Each node holds a value and a link to the next node, and HashBytes more
+/// if the hash of the key is stored (as it is for strings).
+template <typename HashMap>
+uint64_t getHashTableBytes(const HashMap &Map, size_t HashBytes = 0) {
+  return getAllocationBytes(Map.bucket_count() * sizeof(void *)) +
+         Map.size() *
+             getAllocationBytes(sizeof(typename HashMap::value_type) +
+                                sizeof(void *) + HashBytes);
+}
+
+} // namespace LibScopeView
+
+#endif // MEMORYPROFILE_H
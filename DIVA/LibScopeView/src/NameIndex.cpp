@@ -0,0 +1,170 @@
+//===-- LibScopeView/NameIndex.cpp ------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// An index from names to the objects in a Scope tree.
+///
+//===----------------------------------------------------------------------===//
+
+#include "NameIndex.h"
+#include "Object.h"
+#include "Scope.h"
+#include "ScopeVisitor.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace LibScopeView;
+
+namespace LibScopeView {
+
+/// \brief Visits a tree collecting the names of each object.
+class NameIndexBuilder : public ConstScopeVisitor {
+public:
+  explicit NameIndexBuilder(NameIndex &TheIndex) : Index(TheIndex) {}
+
+  // Each name with the position in Objects of an object that has it, in tree
+  // order.
+  std::vector<std::pair<StringPoolIndex, uint32_t>> NamedIDs;
+
+private:
+  void visitImpl(const Object *Obj) override {
+    StringPoolIndex Name = Obj->getNameIndex();
+    if (Name) {
+      uint32_t ID = static_cast<uint32_t>(Index.Objects.size());
+      Index.Objects.push_back(Obj);
+      NamedIDs.emplace_back(Name, ID);
+      const std::string &Qualifier = Obj->getQualifiedName();
+      if (!Qualifier.empty())
+        NamedIDs.emplace_back(
+            getGlobalStringPool().getIndex(Qualifier + Obj->getName()), ID);
+    }
+    visitChildren(Obj);
+  }
+
+  NameIndex &Index;
+};
+
+} // namespace LibScopeView
+
+const uint32_t NameIndex::NoName;
+
+NameIndex::NameIndex(const Object &Root) {
+  TraceSpan Span("BuildNameIndex");
+  NameIndexBuilder Builder(*this);
+  Builder.visit(&Root);
+
+  // Find the distinct names and how many objects have each.
+  const StringPool &Pool = getGlobalStringPool();
+  NamePositions.assign(Pool.size() + 1, NoName);
+  std::vector<uint32_t> Counts(Pool.size() + 1, 0);
+  for (const auto &NamedID : Builder.NamedIDs)
+    if (Counts[NamedID.first]++ == 0)
+      Names.push_back({NamedID.first, 0, 0});
+
+  std::sort(Names.begin(), Names.end(),
+            [&Pool](const NameEntry &LHS, const NameEntry &RHS) {
+              return *Pool.getRef(LHS.Name) < *Pool.getRef(RHS.Name);
+            });
+
+  // Give each name its range of MatchIDs and fill them in tree order.
+  uint32_t FirstMatch = 0;
+  for (size_t Pos = 0; Pos < Names.size(); ++Pos) {
+    NameEntry &Entry = Names[Pos];
+    NamePositions[Entry.Name] = static_cast<uint32_t>(Pos);
+    Entry.FirstMatch = FirstMatch;
+    FirstMatch += Counts[Entry.Name];
+  }
+  MatchIDs.resize(FirstMatch);
+  for (const auto &NamedID : Builder.NamedIDs) {
+    NameEntry &Entry = Names[NamePositions[NamedID.first]];
+    MatchIDs[Entry.FirstMatch + Entry.MatchCount++] = NamedID.second;
+  }
+}
+
+void NameIndex::addMatches(const NameEntry &Entry,
+                           std::vector<uint32_t> &IDs) const {
+  auto First = MatchIDs.begin() + Entry.FirstMatch;
+  IDs.insert(IDs.end(), First, First + Entry.MatchCount);
+}
+
+std::vector<const Object *>
+NameIndex::getObjects(std::vector<uint32_t> &IDs) const {
+  std::sort(IDs.begin(), IDs.end());
+  // An object can match by both its name and its qualified name.
+  IDs.erase(std::unique(IDs.begin(), IDs.end()), IDs.end());
+  std::vector<const Object *> Result;
+  Result.reserve(IDs.size());
+  for (uint32_t ID : IDs)
+    Result.push_back(Objects[ID]);
+  return Result;
+}
+
+std::vector<const Object *>
+NameIndex::findExact(const std::string &Name) const {
+  StringPoolIndex Index = getGlobalStringPool().findIndex(Name);
+  // Names interned after the index was built are not in it.
+  if (!Index || Index >= NamePositions.size() ||
+      NamePositions[Index] == NoName)
+    return {};
+  std::vector<uint32_t> IDs;
+  addMatches(Names[NamePositions[Index]], IDs);
+  return getObjects(IDs);
+}
+
+std::vector<const Object *>
+NameIndex::findPrefix(const std::string &Prefix) const {
+  const StringPool &Pool = getGlobalStringPool();
+  auto It = std::lower_bound(Names.begin(), Names.end(), Prefix,
+                             [&Pool](const NameEntry &Entry,
+                                     const std::string &Str) {
+                               return *Pool.getRef(Entry.Name) < Str;
+                             });
+  std::vector<uint32_t> IDs;
+  for (; It != Names.end() &&
+         Pool.getRef(It->Name)->compare(0, Prefix.size(), Prefix) == 0;
+       ++It)
+    addMatches(*It, IDs);
+  return getObjects(IDs);
+}
+
+std::vector<const Object *>
+NameIndex::findRegex(const std::regex &Pattern) const {
+  const StringPool &Pool = getGlobalStringPool();
+  std::vector<uint32_t> IDs;
+  for (const NameEntry &Entry : Names)
+    if (std::regex_match(*Pool.getRef(Entry.Name), Pattern))
+      addMatches(Entry, IDs);
+  return getObjects(IDs);
+}
+
+std::vector<const Object *> NameIndex::getAncestors(const Object &Obj) {
+  std::vector<const Object *> Ancestors;
+  for (const Object *Parent = Obj.getParent();
+       Parent && !isa<ScopeRoot>(*Parent); Parent = Parent->getParent())
+    Ancestors.push_back(Parent);
+  std::reverse(Ancestors.begin(), Ancestors.end());
+  return Ancestors;
+}
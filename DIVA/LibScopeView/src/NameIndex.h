@@ -0,0 +1,108 @@
+//===-- LibScopeView/NameIndex.h --------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// An index from names to the objects in a Scope tree, for answering many
+/// name queries without visiting the whole tree.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include "StringPool.h"
+
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace LibScopeView {
+
+class Object;
+
+/// \brief Maps the names and qualified names (e.g. "ns::Class::method") of
+/// the objects in a tree to the objects.
+///
+/// The names are interned, so the StringPool's hash table finds a name and a
+/// table indexed by StringPoolIndex finds its objects. The names are also kept
+/// sorted for prefix queries. Building the index visits the whole tree once;
+/// after that exact and prefix queries cost in proportion to the number of
+/// matches. A regex query has to test each distinct name, but not each
+/// object. Matches are returned in the order the objects are in the tree.
+class NameIndex {
+public:
+  /// \brief Index the objects in the tree under Root (including Root).
+  explicit NameIndex(const Object &Root);
+
+  NameIndex(const NameIndex &) = delete;
+  NameIndex &operator=(const NameIndex &) = delete;
+
+  /// \brief Objects whose name or qualified name is Name.
+  std::vector<const Object *> findExact(const std::string &Name) const;
+
+  /// \brief Objects whose name or qualified name starts with Prefix.
+  std::vector<const Object *> findPrefix(const std::string &Prefix) const;
+
+  /// \brief Objects whose name or qualified name matches Pattern.
+  std::vector<const Object *> findRegex(const std::regex &Pattern) const;
+
+  /// \brief Number of named objects in the index.
+  size_t getObjectCount() const { return Objects.size(); }
+
+  /// \brief Number of distinct names (and qualified names) in the index.
+  size_t getNameCount() const { return Names.size(); }
+
+  /// \brief The ancestors of Obj, outermost first, excluding the root.
+  static std::vector<const Object *> getAncestors(const Object &Obj);
+
+private:
+  friend class NameIndexBuilder;
+
+  struct NameEntry {
+    StringPoolIndex Name;
+    // The range of MatchIDs holding the objects with this name.
+    uint32_t FirstMatch;
+    uint32_t MatchCount;
+  };
+
+  // Turn positions in Objects into the objects, in tree order.
+  std::vector<const Object *> getObjects(std::vector<uint32_t> &IDs) const;
+  // Add the objects of Entry to IDs.
+  void addMatches(const NameEntry &Entry, std::vector<uint32_t> &IDs) const;
+
+  // Named objects in tree order.
+  std::vector<const Object *> Objects;
+  // Each name, sorted by the string.
+  std::vector<NameEntry> Names;
+  // Positions in Objects grouped by name, in the order of Names.
+  std::vector<uint32_t> MatchIDs;
+  // Position in Names of each StringPoolIndex (NoName if not a name).
+  std::vector<uint32_t> NamePositions;
+  static const uint32_t NoName = ~uint32_t(0);
+};
+
+} // namespace LibScopeView
+
+#endif // NAMEINDEX_H
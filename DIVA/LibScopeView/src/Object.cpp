@@ -29,7 +29,9 @@
 
 #include "Object.h"
 #include "FileUtilities.h"
+#include "JSONWriter.h"
 #include "Line.h"
+#include "MemoryProfile.h"
 #include "PrintSettings.h"
 #include "Scope.h"
 #include "ScopeVisitor.h"
@@ -38,6 +40,7 @@
 #include "Type.h"
 
 #include <assert.h>
+#include <bitset>
 #include <cstring>
 #include <iomanip>
 #include <map>
@@ -64,19 +67,36 @@ void ObjectKindCounter::visitImpl(const Object *Obj) {
   visitChildren(Obj);
 }
 
+// Mirror of the Object and Element data members before the compact layout
+// (virtual getters, std::bitset flags, 64-bit line and pointer sized string
+// references), used to report the saving made by the compact layout.
+struct LegacyElementLayout {
+  void *VTablePtr;
+  int Kind;
+  std::bitset<2> ObjectAttributesFlags;
+  uint64_t LineNumber;
+  Scope *Parent;
+  Dwarf_Off DieOffset;
+  Dwarf_Half DieTag;
+  StringPoolRef NameRef;
+  StringPoolRef QualifiedRef;
+  StringPoolRef FilePathRef;
+  Object *TheType;
+};
+
 // Name Kind and Size of an Object subclass.
 struct NameKindSize {
   std::string Name;
   Object::ObjectKind Kind;
   size_t Size;
+  size_t LegacySize;
 };
 
-} // namespace
-
-void LibScopeView::printAllocationInfo(const Object &Root, std::ostream &Out) {
-  ObjectKindCounter Counts(Root);
-
-#define ROW(CLASS, KIND) {#CLASS, Object::ObjectKind::KIND, sizeof(CLASS)}
+// Sizes of each Object subclass, in ObjectKind order.
+const std::vector<NameKindSize> &getObjectClassSizes() {
+#define ROW(CLASS, KIND)                                                       \
+  {#CLASS, Object::ObjectKind::KIND, sizeof(CLASS),                            \
+   sizeof(CLASS) - sizeof(Element) + sizeof(LegacyElementLayout)}
   static const std::vector<NameKindSize> Rows({
     ROW(Line, SV_Line),
     ROW(Scope, SV_Scope),
@@ -99,22 +119,102 @@ void LibScopeView::printAllocationInfo(const Object &Root, std::ostream &Out) {
     ROW(TypeSubrange, SV_TypeSubrange),
   });
 #undef ROW
+  return Rows;
+}
+
+// Visitor that adds up the bytes held by each Object and its vectors.
+class ObjectTreeMeasurer : private ConstScopeVisitor {
+public:
+  ObjectTreeMeasurer(const Object &Obj) : Sizes(getObjectClassSizes()) {
+    visit(&Obj);
+  }
+  ObjectTreeMemory Memory;
+
+private:
+  void visitImpl(const Object *Obj) override;
+
+  const std::vector<NameKindSize> &Sizes;
+};
+
+void ObjectTreeMeasurer::visitImpl(const Object *Obj) {
+  assert(Sizes[Obj->getKind()].Kind == Obj->getKind() &&
+         "Object class sizes are not in ObjectKind order");
+  Memory.ObjectBytes += getAllocationBytes(Sizes[Obj->getKind()].Size);
+  if (auto *Scp = dyn_cast<Scope>(Obj))
+    Memory.VectorBytes += getHeapBytes(Scp->getChildren()) +
+                          getHeapBytes(Scp->getLines()) +
+                          getHeapBytes(Scp->getRanges());
+  visitChildren(Obj);
+}
+
+// Visitor that reads the name and qualified name of each Object, or only
+// the qualified names of types and template parameters.
+class NameMaterializer : private ConstScopeVisitor {
+public:
+  NameMaterializer(const Object &Obj, bool AllQualifiedNames)
+      : AllQualified(AllQualifiedNames) {
+    visit(&Obj);
+  }
+
+private:
+  void visitImpl(const Object *Obj) override {
+    Obj->getNameIndex();
+    if (AllQualified || isa<TypeTemplateParam>(*Obj))
+      Obj->getQualifiedName();
+    else if (const Object *Ty = Obj->getType())
+      Ty->getQualifiedName();
+    visitChildren(Obj);
+  }
+
+  const bool AllQualified;
+};
+
+} // namespace
+
+ObjectTreeMemory LibScopeView::getObjectTreeMemory(const Object &Root) {
+  return ObjectTreeMeasurer(Root).Memory;
+}
+
+void LibScopeView::materializeNames(const Object &Root,
+                                    bool AllQualifiedNames) {
+  NameMaterializer Materializer(Root, AllQualifiedNames);
+}
+
+void LibScopeView::printAllocationInfo(const Object &Root, std::ostream &Out) {
+  ObjectKindCounter Counts(Root);
+  const std::vector<NameKindSize> &Rows(getObjectClassSizes());
 
   Out << "Allocation Info:\n"
-      << "Class                 | Size (Bytes) | Number Created | % of Total\n"
-      << "----------------------|--------------|----------------|-----------\n";
+      << "Class                 | Size (Bytes) | Legacy Size | Number Created "
+         "| % of Total\n"
+      << "----------------------|--------------|-------------|----------------"
+         "|-----------\n";
 
   size_t TotalSize = 0;
-  for (const NameKindSize &Row : Rows)
+  size_t TotalLegacySize = 0;
+  size_t TotalCount = 0;
+  for (const NameKindSize &Row : Rows) {
     TotalSize += Row.Size * Counts.getCount(Row.Kind);
+    TotalLegacySize += Row.LegacySize * Counts.getCount(Row.Kind);
+    TotalCount += Counts.getCount(Row.Kind);
+  }
 
   for (const NameKindSize &Row : Rows) {
     size_t RowCount = Counts.getCount(Row.Kind);
     Out << " " << std::setw(20) << Row.Name << " | " << std::setw(12)
-        << Row.Size << " | " << std::setw(14) << RowCount << " | "
-        << std::setw(10) << std::fixed << std::setprecision(2)
+        << Row.Size << " | " << std::setw(11) << Row.LegacySize << " | "
+        << std::setw(14) << RowCount << " | " << std::setw(10) << std::fixed
+        << std::setprecision(2)
         << double(Row.Size * RowCount) / double(TotalSize) * 100.0 << '\n';
   }
+
+  if (TotalCount == 0)
+    return;
+  Out << "Bytes per object: " << std::setprecision(2)
+      << double(TotalSize) / double(TotalCount) << " (legacy layout "
+      << double(TotalLegacySize) / double(TotalCount) << ")\n"
+      << "Total bytes: " << TotalSize << " (legacy layout " << TotalLegacySize
+      << ")\n";
 }
 
 //===----------------------------------------------------------------------===//
@@ -123,12 +223,10 @@ void LibScopeView::printAllocationInfo(const Object &Root, std::ostream &Out) {
 
 Object::~Object() {}
 
-Object::Object(ObjectKind K) : Kind(K) {
-  LineNumber = 0;
-  Parent = nullptr;
-  DieOffset = 0;
-  DieTag = 0;
-}
+Object::Object(ObjectKind K)
+    : Parent(nullptr), TheType(nullptr), DieOffset(0), LineNumber(0),
+      NameIndex(0), QualifiedIndex(0), FilePathIndex(0), DieTag(0), Kind(K),
+      ObjectAttributesFlags(0) {}
 
 const char *Object::getKindAsString() const {
   switch (Kind) {
@@ -246,11 +344,13 @@ const std::string &Object::getTypeQualifiedName() const {
   return getType()->getQualifiedName();
 }
 
-void Object::resolveQualifiedName(const Scope *ExplicitParent) {
+namespace {
+
+// Get the qualified name (e.g. "NS::Class::") from the parent chain,
+// excluding the Compile Unit, Functions, and the scope root.
+std::string formulateQualifiedName(const Scope *ExplicitParent) {
   std::string QualifiedName;
 
-  // Get the qualified name, excluding the Compile Unit, Functions, and the
-  // scope root.
   const Object *ObjParent = ExplicitParent;
   while (ObjParent && !isa<ScopeCompileUnit>(*ObjParent) &&
          !isa<ScopeFunction>(*ExplicitParent) && !isa<ScopeRoot>(*ObjParent)) {
@@ -262,12 +362,46 @@ void Object::resolveQualifiedName(const Scope *ExplicitParent) {
     }
     ObjParent = ObjParent->getParent();
   }
+  return QualifiedName;
+}
 
+} // namespace
+
+void Object::resolveQualifiedName(const Scope *ExplicitParent) {
+  std::string QualifiedName(formulateQualifiedName(ExplicitParent));
   if (!QualifiedName.empty()) {
-    setQualifiedName(QualifiedName.c_str());
+    setQualifiedName(QualifiedName);
+  } else if (QualifiedIndex == PendingQualifiedName) {
+    QualifiedIndex = 0;
   }
 }
 
+void Object::materializeQualifiedName() const {
+  std::string QualifiedName(formulateQualifiedName(getParent()));
+  QualifiedIndex =
+      QualifiedName.empty() ? 0 : getGlobalStringPool().getIndex(QualifiedName);
+}
+
+void Object::materializeName() const {
+  bool ShowVoid = NameIndex == PendingNameShowVoid;
+
+  // Clear the marker first, so a type that (indirectly) refers back to this
+  // object sees an empty name instead of recursing.
+  NameIndex = 0;
+
+  std::string Name;
+  if (auto *Ty = dyn_cast<Type>(this))
+    Name = Ty->getFormulatedTypeName(ShowVoid);
+  else if (auto *Func = dyn_cast<ScopeFunction>(this))
+    Name = Func->getFormulatedFunctionPointerName(ShowVoid);
+  else if (auto *Array = dyn_cast<ScopeArray>(this))
+    Name = Array->getFormulatedArrayName();
+  else
+    assert(false && "Only types, functions and arrays have deferred names");
+
+  NameIndex = getGlobalStringPool().getIndex(Name);
+}
+
 std::string Object::formatAttributeText(const std::string &AttributeText) {
   return "    - " + AttributeText;
 }
@@ -336,34 +470,104 @@ std::string Object::getCommonYAML() const {
   return YAML.str();
 }
 
-//===----------------------------------------------------------------------===//
-// Class to represent the basic data for an object.
-//===----------------------------------------------------------------------===//
+void Object::writeCommonJSON(JSONWriter &JSON) const {
+  JSON.key("object");
+  JSON.string(getKindAsString());
 
-Element::Element(ObjectKind K)
-    : Object(K), NameRef(nullptr), QualifiedRef(nullptr), FilePathRef(nullptr),
-      TheType(nullptr) {}
+  // Name.
+  const std::string &QualifiedName = getQualifiedName();
+  bool IsUnspecified =
+      isa<Symbol>(*this) && cast<Symbol>(this)->getIsUnspecifiedParameter();
+  const std::string &Name = getName();
+  JSON.key("name");
+  if (QualifiedName.empty() && Name.empty() && !IsUnspecified) {
+    JSON.null();
+  } else {
+    JSON.beginString();
+    JSON.appendString(QualifiedName);
+    if (IsUnspecified)
+      JSON.appendString("...");
+    else
+      JSON.appendString(Name);
+    JSON.endString();
+  }
+
+  // Type, where template's types are written in attributes and functions
+  // must have types.
+  JSON.key("type");
+  if (getType() && !(isa<TypeTemplateParam>(*this))) {
+    JSON.beginString();
+    JSON.appendString(getType()->getQualifiedName());
+    JSON.appendString(getType()->getName());
+    JSON.endString();
+  } else if (isa<ScopeFunction>(*this)) {
+    JSON.string("void");
+  } else {
+    JSON.null();
+  }
+
+  // Source.
+  JSON.key("line");
+  if (getLineNumber() != 0)
+    JSON.number(getLineNumber());
+  else
+    JSON.null();
+  JSON.key("file");
+  writeFileNameJSON(JSON, *this);
+
+  // Dwarf.
+  JSON.key("offset");
+  JSON.number(getDieOffset());
+  JSON.key("tag");
+  writeTagJSON(JSON, getDieTag());
+}
+
+void Object::writeFileNameJSON(JSONWriter &JSON, const Object &Obj) {
+  if (Obj.getInvalidFileName()) {
+    JSON.string("?");
+    return;
+  }
+  // The file name is the part of the unified path after the last '/'.
+  const std::string &Path = Obj.getFilePath();
+  size_t Start = Path.rfind('/');
+  Start = Start == std::string::npos ? 0 : Start + 1;
+  if (Start == Path.size())
+    JSON.null();
+  else
+    JSON.string(Path.data() + Start, Path.size() - Start);
+}
+
+void Object::writeTagJSON(JSONWriter &JSON, Dwarf_Half Tag) {
+  const char *TagName = nullptr;
+  if (Tag != 0 && dwarf_get_TAG_name(Tag, &TagName) == DW_DLV_OK)
+    JSON.string(TagName);
+  else
+    JSON.null();
+}
 
-const std::string &Element::getName() const {
-  return NameRef ? *NameRef : EmptyString;
+const std::string &Object::getPoolString(StringPoolIndex Index) {
+  StringPoolRef Ref = getGlobalStringPool().getRef(Index);
+  return Ref ? *Ref : EmptyString;
 }
 
-void Element::setName(const std::string &Name) {
-  NameRef = getGlobalStringPool().get(Name);
+void Object::setName(const std::string &Name) {
+  NameIndex = getGlobalStringPool().getIndex(
+      Kind == SV_ScopeCompileUnit || Kind == SV_ScopeRoot ? unifyFilePath(Name)
+                                                          : Name);
 }
 
-const std::string &Element::getQualifiedName() const {
-  return QualifiedRef ? *QualifiedRef : EmptyString;
+void Object::setName(StringPoolRef Name) {
+  NameIndex = Name ? getGlobalStringPool().getIndex(*Name) : 0;
 }
 
-void Element::setQualifiedName(const std::string &QualName) {
-  QualifiedRef = getGlobalStringPool().get(QualName);
+void Object::setQualifiedName(const std::string &QualName) {
+  QualifiedIndex = getGlobalStringPool().getIndex(QualName);
 }
 
-const std::string &Element::getFilePath() const {
-  return FilePathRef ? *FilePathRef : EmptyString;
+void Object::setFilePath(const std::string &FilePath) {
+  FilePathIndex = getGlobalStringPool().getIndex(FilePath);
 }
 
-void Element::setFilePath(const std::string &FilePath) {
-  FilePathRef = getGlobalStringPool().get(FilePath);
+void Object::setFilePath(StringPoolRef FilePath) {
+  FilePathIndex = FilePath ? getGlobalStringPool().getIndex(*FilePath) : 0;
 }
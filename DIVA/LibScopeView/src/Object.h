@@ -45,12 +45,12 @@
 
 #include "StringPool.h"
 
-#include <bitset>
 #include <cassert>
 #include <cstdint>
 
 namespace LibScopeView {
 
+class JSONWriter;
 class Object;
 class PrintSettings;
 class Scope;
@@ -83,6 +83,25 @@ template <class T> const T *dyn_cast(const Object *Obj) {
 /// \brief Print sizes and counts of allocated Objects.
 void printAllocationInfo(const Object &Root, std::ostream &Out);
 
+/// \brief Heap bytes held by a tree of Objects.
+struct ObjectTreeMemory {
+  /// \brief Bytes of the Objects themselves.
+  uint64_t ObjectBytes = 0;
+  /// \brief Bytes of the child and line vectors of the Scopes.
+  uint64_t VectorBytes = 0;
+};
+
+/// \brief Measure the heap bytes held by Root and the Objects under it.
+ObjectTreeMemory getObjectTreeMemory(const Object &Root);
+
+/// \brief Work out the deferred names of Root and the Objects under it, so
+/// that the tree can then be read from several threads at once.
+///
+/// Unless AllQualifiedNames, the only qualified names worked out are those
+/// that the text output reads: of the types of objects and of template
+/// parameters.
+void materializeNames(const Object &Root, bool AllQualifiedNames = true);
+
 /// \brief Enum to represent C++ access specifiers.
 enum class AccessSpecifier { Unspecified, Private, Protected, Public };
 
@@ -98,7 +117,7 @@ public:
   /// make checking classes more efficient. When modifying the list you need to
   /// be careful to check any effect you might have on the subclasses static
   /// 'classof' methods.
-  enum ObjectKind {
+  enum ObjectKind : uint8_t {
     SV_Line,
     SV_Scope,
     SV_ScopeAggregate,
@@ -136,16 +155,48 @@ public:
   Object &operator=(const Object &&) = delete;
 
 private:
+  // The hot fields are grouped and sized so that an Object fits in 56 bytes
+  // (including the vtable pointer) on 64-bit platforms. Names are stored as
+  // 32-bit indices into the global StringPool and the accessors for them are
+  // non-virtual, as every subclass shares the same storage.
+
+  // The parent of this object (nullptr if the root scope).
+  Scope *Parent;
+
+  // Type of this object.
+  Object *TheType;
+
+  // Information to link the object back to the DWARF.
+  Dwarf_Off DieOffset; // Global Offset in Debug Info.
+
+  // Line associated with this object.
+  uint32_t LineNumber;
+
+  // The name, qualified name and filename in String Pool. The name and
+  // qualified name may hold one of the Pending* markers until first use.
+  mutable StringPoolIndex NameIndex;
+  mutable StringPoolIndex QualifiedIndex;
+  StringPoolIndex FilePathIndex;
+
+  Dwarf_Half DieTag; // DWARF tag/attr for this object.
+
   const ObjectKind Kind;
 
   // Flags specifying various properties of the Object.
-  enum ObjectAttributes {
-    IsGlobalReference,
-    InvalidFilename,
-    ObjectAttributesSize
+  enum ObjectAttributes : uint8_t {
+    IsGlobalReference = 1 << 0,
+    InvalidFilename = 1 << 1,
   };
-  // Flags specifying various properties of the Object.
-  std::bitset<ObjectAttributesSize> ObjectAttributesFlags;
+  // Flags specifying various properties of the Object, packed into one word.
+  uint8_t ObjectAttributesFlags;
+
+  // Reserved StringPoolIndex values for names that are derived from other
+  // objects and are only materialized when they are first read.
+  static const StringPoolIndex PendingName = ~StringPoolIndex(0);
+  static const StringPoolIndex PendingNameShowVoid = PendingName - 1;
+  static const StringPoolIndex PendingQualifiedName = PendingName;
+
+  bool getNameIsPending() const { return NameIndex >= PendingNameShowVoid; }
 
 public:
   /// \brief Get the object kind as a string.
@@ -153,28 +204,16 @@ public:
 
   /// \brief The Object is referenced from other CUs.
   bool getIsGlobalReference() const {
-    return ObjectAttributesFlags[IsGlobalReference];
+    return ObjectAttributesFlags & IsGlobalReference;
   }
-  void setIsGlobalReference() { ObjectAttributesFlags.set(IsGlobalReference); }
+  void setIsGlobalReference() { ObjectAttributesFlags |= IsGlobalReference; }
 
   /// \brief The filename associated with the object is valid.
   bool getInvalidFileName() const {
-    return ObjectAttributesFlags[InvalidFilename];
+    return ObjectAttributesFlags & InvalidFilename;
   }
-  void setInvalidFileName() { ObjectAttributesFlags.set(InvalidFilename); }
-
-private:
-  // Line associated with this object.
-  uint64_t LineNumber;
-
-  // The parent of this object (nullptr if the root scope).
-  Scope *Parent;
+  void setInvalidFileName() { ObjectAttributesFlags |= InvalidFilename; }
 
-  // Information to link the object back to the DWARF.
-  Dwarf_Off DieOffset; // Global Offset in Debug Info.
-  Dwarf_Half DieTag;   // DWARF tag/attr for this object.
-
-public:
   /// \brief DWARF Die tag.
   Dwarf_Half getDieTag() const { return DieTag; }
   void setDieTag(Dwarf_Half DWTag) { DieTag = DWTag; }
@@ -184,28 +223,57 @@ public:
   void setDieOffset(Dwarf_Off Offset) { DieOffset = Offset; }
 
   /// \brief The Object's name.
-  virtual const std::string &getName() const = 0;
-  virtual StringPoolRef getNamePoolRef() const = 0;
-  virtual void setName(const std::string &Name) = 0;
-  virtual void setName(StringPoolRef Name) = 0;
+  const std::string &getName() const { return getPoolString(getNameIndex()); }
+  StringPoolRef getNamePoolRef() const {
+    return getGlobalStringPool().getRef(getNameIndex());
+  }
+  StringPoolIndex getNameIndex() const {
+    if (getNameIsPending())
+      materializeName();
+    return NameIndex;
+  }
+  /// \brief Set the name. The names of compile units and the root are file
+  /// paths, which are unified (see unifyFilePath).
+  void setName(const std::string &Name);
+  void setName(StringPoolRef Name);
+  void setNameIndex(StringPoolIndex Index) { NameIndex = Index; }
+
+  /// \brief Defer working out the name of an unnamed type, function pointer
+  /// or array until it is first read.
+  void deferNameFormulation(bool ShowVoid) {
+    NameIndex = ShowVoid ? PendingNameShowVoid : PendingName;
+  }
 
   /// \brief The Object's qualified name.
-  virtual const std::string &getQualifiedName() const = 0;
-  virtual void setQualifiedName(const std::string &Name) = 0;
+  const std::string &getQualifiedName() const {
+    if (QualifiedIndex == PendingQualifiedName)
+      materializeQualifiedName();
+    return getPoolString(QualifiedIndex);
+  }
+  void setQualifiedName(const std::string &Name);
 
   /// \brief The Object's file path.
-  virtual const std::string &getFilePath() const = 0;
-  virtual StringPoolRef getFilePathPoolRef() const = 0;
-  virtual void setFilePath(const std::string &FilePath) = 0;
-  virtual void setFilePath(StringPoolRef FilePath) = 0;
+  const std::string &getFilePath() const {
+    return getPoolString(FilePathIndex);
+  }
+  StringPoolRef getFilePathPoolRef() const {
+    return getGlobalStringPool().getRef(FilePathIndex);
+  }
+  StringPoolIndex getFilePathIndex() const { return FilePathIndex; }
+  void setFilePath(const std::string &FilePath);
+  void setFilePath(StringPoolRef FilePath);
+  void setFilePathIndex(StringPoolIndex Index) { FilePathIndex = Index; }
 
   /// \brief Set the qualified name to include the parent's name.
-  void resolveQualifiedName() { resolveQualifiedName(getParent()); }
+  ///
+  /// The qualified name is kept as the parent link and only concatenated
+  /// when it is first read.
+  void resolveQualifiedName() { QualifiedIndex = PendingQualifiedName; }
   void resolveQualifiedName(const Scope *ExplicitParent);
 
   /// \brief The line for the object.
-  uint64_t getLineNumber() const { return LineNumber; }
-  void setLineNumber(uint64_t LnNumber) { LineNumber = LnNumber; }
+  uint32_t getLineNumber() const { return LineNumber; }
+  void setLineNumber(uint32_t LnNumber) { LineNumber = LnNumber; }
 
   /// \brief The parent scope for this object.
   Scope *getParent() const { return Parent; }
@@ -217,8 +285,8 @@ public:
 
   const std::string &getTypeQualifiedName() const;
 
-  virtual Object *getType() const = 0;
-  virtual void setType(Object *Obj) = 0;
+  Object *getType() const { return TheType; }
+  void setType(Object *Obj) { TheType = Obj; }
 
   /// \brief Should this object be printed under children?
   virtual bool getIsPrintedAsObject() const { return true; }
@@ -226,50 +294,46 @@ public:
   virtual std::string getAsText(const PrintSettings &Settings) const = 0;
   /// \brief Returns a YAML representation of this DIVA Object.
   virtual std::string getAsYAML() const = 0;
+  /// \brief Writes the members of a JSON representation of this DIVA Object,
+  /// the same information as in its YAML, into the JSON object being written.
+  virtual void writeJSON(JSONWriter &JSON) const = 0;
 
 protected:
   /// \brief Returns a text representation of attribute information.
   static std::string formatAttributeText(const std::string &AttributeText);
   /// \brief Returns the common YAML information for this object.
   std::string getCommonYAML() const;
+  /// \brief Writes the common JSON members for this object, all but the
+  /// attributes.
+  void writeCommonJSON(JSONWriter &JSON) const;
+  /// \brief Writes the file name of Obj as a JSON value, "?" if it is invalid
+  /// or null if it has none.
+  static void writeFileNameJSON(JSONWriter &JSON, const Object &Obj);
+  /// \brief Writes the name of Tag as a JSON value, or null if Tag is 0.
+  static void writeTagJSON(JSONWriter &JSON, Dwarf_Half Tag);
+
+private:
+  // Get the pooled string for Index, or an empty string for index 0.
+  static const std::string &getPoolString(StringPoolIndex Index);
+
+  // Work out a pending name or qualified name and store it in the pool.
+  // Names are materialized in place, so a tree must not be read from several
+  // threads until its names have been materialized.
+  void materializeName() const;
+  void materializeQualifiedName() const;
 };
 
 /// \brief Class to represent the basic data for an object.
+///
+/// The storage for names, file paths and types lives in Object so that the
+/// accessors can be non-virtual, this class is kept as the common base of all
+/// the concrete object classes.
 class Element : public Object {
 public:
-  Element(ObjectKind K);
+  Element(ObjectKind K) : Object(K) {}
 
   /// Return true if Obj is an instance of Element.
   static bool classof(const Object *) { return true; }
-
-private:
-  // The name, type name, qualified name and filename in String Pool.
-  StringPoolRef NameRef;
-  StringPoolRef QualifiedRef;
-  StringPoolRef FilePathRef;
-
-  // Type of this object.
-  Object *TheType;
-
-public:
-  /// \brief The Object's name.
-  const std::string &getName() const override;
-  StringPoolRef getNamePoolRef() const override { return NameRef; }
-  void setName(const std::string &Name) override;
-  void setName(StringPoolRef Name) override { NameRef = Name; }
-
-  /// \brief The Object's qualified name.
-  const std::string &getQualifiedName() const override;
-  void setQualifiedName(const std::string &Name) override;
-
-  /// \brief The Object's file path.
-  const std::string &getFilePath() const override;
-  StringPoolRef getFilePathPoolRef() const override { return FilePathRef; }
-  void setFilePath(const std::string &FilePath) override;
-  void setFilePath(StringPoolRef FilePath) override { FilePathRef = FilePath; }
-
-  void setType(Object *Obj) override { TheType = Obj; }
-  Object *getType() const override { return TheType; }
 };
 
 } // namespace LibScopeView
@@ -63,6 +63,8 @@ public:
 
   bool SplitOutput = false;
   std::string OutputDirectory;
+  /// \brief Compress the output with gzip, adding ".gz" to split file names.
+  bool CompressOutput = false;
 
   SortingKey SortKey = SortingKey::LINE;
 
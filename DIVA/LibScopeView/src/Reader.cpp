@@ -29,24 +29,27 @@
 
 #include "Reader.h"
 #include "Line.h"
+#include "MemoryProfile.h"
 #include "ScopeVisitor.h"
+#include "StringPool.h"
 #include "Symbol.h"
+#include "Trace.h"
 #include "Type.h"
 #include "Utilities.h"
 
 #include <algorithm>
 #include <assert.h>
 #include <iostream>
-#include <sstream>
-#include <unordered_set>
+#include <map>
 
 using namespace LibScopeView;
 
 // Visitors for post-creation actions.
 namespace {
 
-// Visitor that creates all the full type names once the CU tree has been
-// created.
+// Visitor that marks the objects whose names are built from other objects
+// (unnamed types, function pointers and arrays) once the CU tree has been
+// created. The full names are only formulated when they are first read.
 class NameResolver : public ScopeVisitor {
 public:
   NameResolver(const PrintSettings &PrintingSettings)
@@ -54,87 +57,23 @@ public:
 
 private:
   void visitImpl(Object *Obj) override {
-    resolve(Obj);
+    if (needsFormulatedName(Obj))
+      Obj->deferNameFormulation(Settings.ShowVoid);
     visitChildren(Obj);
   }
 
-  void resolve(Object *Obj) {
-    if (AlreadyResolved.count(Obj))
-      return;
-    AlreadyResolved.insert(Obj);
-
-    // Resolve type names.
-    if (auto Ty = dyn_cast<Type>(Obj)) {
-      resolveTypeName(Ty);
-      return;
-    }
-
-    if (auto ObjScope = dyn_cast<Scope>(Obj)) {
-      // Resolve function pointer names.
-      if (ObjScope->getIsSubroutineType()) {
-        resolveFunctionPointerName(dyn_cast<ScopeFunction>(Obj));
-        return;
-      }
-
-      // Resolve array names.
-      if (isa<ScopeArray>(*ObjScope)) {
-        resolveArrayName(dyn_cast<ScopeArray>(Obj));
-        return;
-      }
-    }
-  }
-
-  void resolveFunctionPointerName(ScopeFunction *Func) {
-    // Make sure the return type is resolved first.
-    if (Func->getType())
-      resolve(Func->getType());
-
-    std::stringstream ResolvedName;
-    ResolvedName << Func->getTypeAsString(Settings) << " (*)(";
-
-    // Add the parameters.
-    bool First = true;
-    for (const Object *Child : Func->getChildren()) {
-      if (auto *Sym = dyn_cast<const Symbol>(Child)) {
-        if (Sym->getIsParameter()) {
-          // Make sure the parameters are resolved.
-          if (Sym->getType())
-            resolve(Sym->getType());
-          ResolvedName << (First ? "" : ",") << Sym->getTypeAsString(Settings);
-          First = false;
-        }
-      }
-    }
-
-    ResolvedName << ")";
-    Func->setName(ResolvedName.str().c_str());
-  }
-
-  void resolveTypeName(Type *Ty) {
-    // Make sure Ty's type is resolved first.
-    if (Ty->getType())
-      resolve(Ty->getType());
-    Ty->formulateTypeName(Settings);
-  }
-
-  void resolveArrayName(ScopeArray *Array) {
-    // Make sure Array's type is resolved first.
-    Object *ArrayType = Array->getType();
-    if (ArrayType)
-      resolve(ArrayType);
+  static bool needsFormulatedName(const Object *Obj) {
+    if (auto Ty = dyn_cast<Type>(Obj))
+      return !isa<TypeTemplateParam>(*Ty) && Ty->getName().empty();
 
-    std::string ResolvedName(ArrayType ? ArrayType->getName() : "?");
-    ResolvedName += " ";
-
-    for (const Object *Child : Array->getChildren())
-      if (auto *Ty = dyn_cast<const Type>(Child))
-        if (isa<TypeSubrange>(*Ty))
-          ResolvedName += Ty->getName();
-    Array->setName(ResolvedName.c_str());
+    // Function pointer and array names are always formulated.
+    if (auto ObjScope = dyn_cast<Scope>(Obj))
+      return (ObjScope->getIsSubroutineType() && isa<ScopeFunction>(*Obj)) ||
+             isa<ScopeArray>(*ObjScope);
+    return false;
   }
 
   const PrintSettings &Settings;
-  std::unordered_set<Object *> AlreadyResolved;
 };
 
 // Visitor that sets the attributes of objects to those they reference.
@@ -163,15 +102,15 @@ private:
     resolveReference(Reference);
 
     // Set common attribute values.
-    Obj->setName(Reference->getNamePoolRef());
+    Obj->setNameIndex(Reference->getNameIndex());
     Obj->setLineNumber(Reference->getLineNumber());
-    Obj->setFilePath(Reference->getFilePathPoolRef());
+    Obj->setFilePathIndex(Reference->getFilePathIndex());
     if (Reference->getInvalidFileName())
       Obj->setInvalidFileName();
 
     // Set type.
     if (Reference->getType()) {
-      cast<Element>(Obj)->setType(Reference->getType());
+      Obj->setType(Reference->getType());
     }
 
     // Cover the static function case that initScopeFromAttrs can't reach.
@@ -196,15 +135,49 @@ private:
     visitChildren(Obj);
   }
 };
+
+// Visitor that counts the objects of each kind (as named in the output).
+class ObjectCounter : public ConstScopeVisitor {
+public:
+  std::map<std::string, uint64_t> Counts;
+
+private:
+  void visitImpl(const Object *Obj) override {
+    ++Counts[Obj->getKindAsString()];
+    visitChildren(Obj);
+  }
+};
 } // namespace
 
 Reader::~Reader() {}
 
 std::unique_ptr<ScopeRoot> Reader::loadFile(const std::string &FileName,
                                             const PrintSettings &Settings) {
+  const StringPool &Pool = getGlobalStringPool();
+  size_t PoolSize = Pool.size();
+  uint64_t PoolLookups = Pool.getLookupCount();
+
   std::unique_ptr<ScopeRoot> Root = createScopes(FileName);
-  if (Root)
+  if (Root) {
+    MemoryOwner TreeOwner([&Root](MemoryOwnerBytes &OwnerBytes) {
+      addObjectTreeBytes(*Root, OwnerBytes);
+    });
     postCreationActions(Root.get(), Settings);
+  }
+
+  if (Tracer *ActiveTracer = getActiveTracer()) {
+    uint64_t Interned = Pool.size() - PoolSize;
+    ActiveTracer->addCounter("StringsInterned", Interned);
+    ActiveTracer->addCounter("StringPoolHits",
+                             Pool.getLookupCount() - PoolLookups - Interned);
+    if (Root) {
+      TraceSpan Span("CountObjects");
+      ObjectCounter Counter;
+      Counter.visit(Root.get());
+      for (const auto &Count : Counter.Counts)
+        ActiveTracer->addCounter("Objects." + Count.first, Count.second);
+    }
+  }
   return Root;
 }
 
@@ -212,9 +185,24 @@ void Reader::postCreationActions(ScopeRoot *Root,
                                  const PrintSettings &Settings) {
   assert(Root);
 
-  NameResolver(Settings).visit(Root);
-  ReferenceAttributeResolver().visit(Root);
-  GlobalResolver().visit(Root);
-
-  Root->sortScopes(Settings.SortKey);
+  {
+    TraceSpan Span("ResolveNames");
+    NameResolver(Settings).visit(Root);
+  }
+  sampleMemory("ResolveNames");
+  {
+    TraceSpan Span("ResolveReferences");
+    ReferenceAttributeResolver().visit(Root);
+  }
+  sampleMemory("ResolveReferences");
+  {
+    TraceSpan Span("ResolveGlobals");
+    GlobalResolver().visit(Root);
+  }
+  sampleMemory("ResolveGlobals");
+  {
+    TraceSpan Span("Sort");
+    Root->sortScopes(Settings.SortKey);
+  }
+  sampleMemory("Sort");
 }
@@ -30,6 +30,7 @@
 #include "Scope.h"
 #include "Error.h"
 #include "FileUtilities.h"
+#include "JSONWriter.h"
 #include "Line.h"
 #include "PrintSettings.h"
 #include "Symbol.h"
@@ -118,6 +119,19 @@ std::string Scope::getAsYAML() const {
   return "";
 }
 
+void Scope::writeJSON(JSONWriter &JSON) const {
+  writeCommonJSON(JSON);
+  JSON.key("attributes");
+  JSON.beginObject();
+  if (getIsBlock()) {
+    JSON.key("try");
+    JSON.boolean(getIsTryBlock());
+    JSON.key("catch");
+    JSON.boolean(getIsCatchBlock());
+  }
+  JSON.endObject();
+}
+
 ScopeAggregate::ScopeAggregate() : Scope(SV_ScopeAggregate) {
   Reference = nullptr;
 }
@@ -173,6 +187,32 @@ std::string ScopeAggregate::getAsYAML() const {
   return Result.str();
 }
 
+void ScopeAggregate::writeJSON(JSONWriter &JSON) const {
+  writeCommonJSON(JSON);
+  JSON.key("attributes");
+  JSON.beginObject();
+  JSON.key("is_template");
+  JSON.boolean(getIsTemplate());
+
+  // A Union can't have any inheritance attributes.
+  if (!getIsUnionType()) {
+    JSON.key("inherits_from");
+    JSON.beginArray();
+    for (const Object *Obj : getChildren()) {
+      if (auto *Ty = dyn_cast<const Type>(Obj)) {
+        if (Ty->getIsInheritance()) {
+          JSON.beginObject();
+          Ty->writeJSON(JSON);
+          JSON.endObject();
+        }
+      }
+    }
+    JSON.endArray();
+  }
+
+  JSON.endObject();
+}
+
 std::string ScopeAlias::getAsText(const PrintSettings &Settings) const {
   std::stringstream Result;
   Result << "{" << getKindAsString() << "} \"" << getName() << "\" -> "
@@ -185,6 +225,25 @@ std::string ScopeAlias::getAsYAML() const {
   return getCommonYAML() + std::string("\nattributes: {}");
 }
 
+void ScopeAlias::writeJSON(JSONWriter &JSON) const {
+  writeCommonJSON(JSON);
+  JSON.key("attributes");
+  JSON.beginObject();
+  JSON.endObject();
+}
+
+std::string ScopeArray::getFormulatedArrayName() const {
+  const Object *ArrayType = getType();
+  std::string Name(ArrayType ? ArrayType->getName() : "?");
+  Name += " ";
+
+  for (const Object *Child : getChildren())
+    if (auto *Ty = dyn_cast<const Type>(Child))
+      if (isa<TypeSubrange>(*Ty))
+        Name += Ty->getName();
+  return Name;
+}
+
 std::string ScopeArray::getAsText(const PrintSettings &Settings) const {
   std::stringstream Result;
   Result << "{" << getKindAsString() << "} "
@@ -192,10 +251,6 @@ std::string ScopeArray::getAsText(const PrintSettings &Settings) const {
   return Result.str();
 }
 
-void ScopeCompileUnit::setName(const std::string &Name) {
-  Scope::setName(unifyFilePath(Name));
-}
-
 std::string ScopeCompileUnit::getAsText(const PrintSettings &) const {
   std::string ObjectAsText;
   ObjectAsText.append("{").append(getKindAsString()).append("}");
@@ -208,6 +263,13 @@ std::string ScopeCompileUnit::getAsYAML() const {
   return getCommonYAML() + std::string("\nattributes: {}");
 }
 
+void ScopeCompileUnit::writeJSON(JSONWriter &JSON) const {
+  writeCommonJSON(JSON);
+  JSON.key("attributes");
+  JSON.beginObject();
+  JSON.endObject();
+}
+
 std::string ScopeEnumeration::getAsText(const PrintSettings &Settings) const {
   std::string ObjectAsText;
   std::string Name = getName();
@@ -256,10 +318,60 @@ std::string ScopeEnumeration::getAsYAML() const {
   return YAML.str();
 }
 
+void ScopeEnumeration::writeJSON(JSONWriter &JSON) const {
+  writeCommonJSON(JSON);
+  JSON.key("attributes");
+  JSON.beginObject();
+  JSON.key("class");
+  JSON.boolean(getIsClass());
+  JSON.key("enumerators");
+  JSON.beginArray();
+  for (auto *Child : getChildren()) {
+    if (!isa<TypeEnumerator>(*Child))
+      continue;
+    JSON.beginObject();
+    JSON.key("enumerator");
+    JSON.string(Child->getName());
+    JSON.key("value");
+    JSON.string(cast<TypeEnumerator>(Child)->getValue());
+    JSON.endObject();
+  }
+  JSON.endArray();
+  JSON.endObject();
+}
+
 ScopeFunction::ScopeFunction(ObjectKind K)
     : Scope(K), Reference(nullptr), IsStatic(false), DeclaredInline(false),
       IsDeclaration(false) {}
 
+std::string ScopeFunction::getFormulatedFunctionPointerName(bool ShowVoid) const {
+  std::string Name;
+  if (getType())
+    Name += getType()->getName();
+  else if (ShowVoid)
+    Name += "void";
+  Name += " (*)(";
+
+  // Add the parameters.
+  bool First = true;
+  for (const Object *Child : getChildren()) {
+    if (auto *Sym = dyn_cast<const Symbol>(Child)) {
+      if (Sym->getIsParameter()) {
+        if (!First)
+          Name += ",";
+        if (Sym->getType())
+          Name += Sym->getType()->getName();
+        else if (ShowVoid)
+          Name += "void";
+        First = false;
+      }
+    }
+  }
+
+  Name += ")";
+  return Name;
+}
+
 std::string ScopeFunction::getAsText(const PrintSettings &Settings) const {
   std::string Result = "{";
   Result += getKindAsString();
@@ -342,6 +454,38 @@ std::string ScopeFunction::getAsYAML() const {
   return YAML.str();
 }
 
+void ScopeFunction::writeJSON(JSONWriter &JSON) const {
+  writeCommonJSON(JSON);
+  JSON.key("attributes");
+  JSON.beginObject();
+
+  JSON.key("declaration");
+  JSON.beginObject();
+  JSON.key("file");
+  if (Reference && isa<ScopeFunction>(*Reference)) {
+    writeFileNameJSON(JSON, *Reference);
+    JSON.key("line");
+    JSON.number(Reference->getLineNumber());
+  } else {
+    JSON.null();
+    JSON.key("line");
+    JSON.null();
+  }
+  JSON.endObject();
+
+  JSON.key("is_template");
+  JSON.boolean(getIsTemplate());
+  JSON.key("static");
+  JSON.boolean(getIsStatic());
+  JSON.key("inline");
+  JSON.boolean(getIsDeclaredInline());
+  JSON.key("is_inlined");
+  JSON.boolean(isa<ScopeFunctionInlined>(*this));
+  JSON.key("is_declaration");
+  JSON.boolean(getIsDeclaration());
+  JSON.endObject();
+}
+
 ScopeFunctionInlined::~ScopeFunctionInlined() {}
 
 std::string ScopeNamespace::getAsText(const PrintSettings &) const {
@@ -358,6 +502,13 @@ std::string ScopeNamespace::getAsYAML() const {
   return getCommonYAML() + std::string("\nattributes: {}");
 }
 
+void ScopeNamespace::writeJSON(JSONWriter &JSON) const {
+  writeCommonJSON(JSON);
+  JSON.key("attributes");
+  JSON.beginObject();
+  JSON.endObject();
+}
+
 std::string ScopeTemplatePack::getAsText(const PrintSettings &Settings) const {
   std::string Result;
   Result += "{";
@@ -395,8 +546,18 @@ std::string ScopeTemplatePack::getAsYAML() const {
   return YAML.str();
 }
 
-void ScopeRoot::setName(const std::string &Name) {
-  Scope::setName(unifyFilePath(Name));
+void ScopeTemplatePack::writeJSON(JSONWriter &JSON) const {
+  writeCommonJSON(JSON);
+  JSON.key("attributes");
+  JSON.beginObject();
+  JSON.key("types");
+  JSON.beginArray();
+  for (const auto *Child : getChildren()) {
+    if (auto *Param = dyn_cast<const TypeTemplateParam>(Child))
+      Param->writeJSONValue(JSON);
+  }
+  JSON.endArray();
+  JSON.endObject();
 }
 
 std::string ScopeRoot::getAsText(const PrintSettings &) const {
@@ -33,6 +33,7 @@
 #include "Object.h"
 #include "Sort.h"
 
+#include <bitset>
 #include <vector>
 
 namespace LibScopeView {
@@ -40,6 +41,12 @@ namespace LibScopeView {
 class Line;
 class Symbol;
 
+/// \brief A half open range [LowPC, HighPC) of code addresses.
+struct AddressRange {
+  Dwarf_Addr LowPC;
+  Dwarf_Addr HighPC;
+};
+
 // TODO: Make Scope pure virtual.
 
 /// \brief Class to represent a DWARF Scope object.
@@ -159,6 +166,13 @@ public:
   const std::vector<Line *> &getLines() const { return TheLines; }
   std::vector<Line *> &getLines() { return TheLines; }
 
+  /// \brief The code addresses covered by the scope (DW_AT_low_pc,
+  /// DW_AT_high_pc and DW_AT_ranges).
+  const std::vector<AddressRange> &getRanges() const { return Ranges; }
+  void addRange(Dwarf_Addr LowPC, Dwarf_Addr HighPC) {
+    Ranges.push_back({LowPC, HighPC});
+  }
+
   void sortScopes(const SortingKey &SortKey);
 
   // bring parent method getQualifiedName into scope.
@@ -175,11 +189,16 @@ private:
   // Vector of objects (types, scopes, symbols).
   std::vector<Object *> Children;
 
+  // Code address ranges, empty for scopes without code.
+  std::vector<AddressRange> Ranges;
+
 public:
   /// \brief Returns a text representation of this DIVA Object.
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 };
 
 /// \brief Class to represent a DWARF Union/Structure/Class object.
@@ -205,6 +224,8 @@ public:
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 };
 
 /// \brief Class to represent a DWARF Template alias object.
@@ -221,6 +242,8 @@ public:
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 };
 
 /// \brief Class to represent a DWARF array object (DW_TAG_array_type).
@@ -233,6 +256,9 @@ public:
     return Obj->getKind() == SV_ScopeArray;
   }
 
+  /// \brief Work out the array name from its type and subranges.
+  std::string getFormulatedArrayName() const;
+
   bool getIsPrintedAsObject() const override { return false; }
   /// \brief Returns a text representation of this DIVA Object.
   std::string getAsText(const PrintSettings &Settings) const override;
@@ -248,12 +274,12 @@ public:
     return Obj->getKind() == SV_ScopeCompileUnit;
   }
 
-  void setName(const std::string &Name) override;
-
   /// \brief Returns a text representation of this DIVA Object.
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 };
 
 /// \brief Class to represent a DWARF enumerator object.
@@ -272,6 +298,8 @@ public:
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 
   void setIsClass() { IsClass = true; }
   bool getIsClass() const { return IsClass; }
@@ -317,10 +345,16 @@ public:
   bool getIsDeclaration() const { return IsDeclaration; }
   void setIsDeclaration() { IsDeclaration = true; }
 
+  /// \brief Work out the function pointer name of a subroutine type from its
+  /// return and parameter types.
+  std::string getFormulatedFunctionPointerName(bool ShowVoid) const;
+
   /// \brief Returns a text representation of this DIVA Object.
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 };
 
 /// \brief Class to represent a DWARF inlined function object.
@@ -358,6 +392,8 @@ public:
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 };
 
 /// \brief Class to represent a DWARF template pack.
@@ -376,6 +412,8 @@ public:
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 };
 
 /// \brief Class to represent an object file (single or multiple CUs).
@@ -388,8 +426,6 @@ public:
     return Obj->getKind() == SV_ScopeRoot;
   }
 
-  void setName(const std::string &Name) override;
-
   bool getIsPrintedAsObject() const override { return false; }
   /// \brief Returns a text representation of this DIVA Object.
   std::string getAsText(const PrintSettings &Settings) const override;
@@ -0,0 +1,107 @@
+//===-- LibScopeView/ScopeJSONPrinter.cpp -----------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the definitions of ScopeJSONPrinter's methods.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ScopeJSONPrinter.h"
+#include "Scope.h"
+
+#include <sstream>
+
+using namespace LibScopeView;
+
+ScopeJSONPrinter::ScopeJSONPrinter(const PrintSettings &Settings,
+                                   const std::string &InputFile,
+                                   const std::string &Version)
+    : ScopePrinter(Settings), InputFile(InputFile), Version(Version),
+      Depth(0), WrotePart(false) {
+  std::stringstream Header;
+  Header << "{\"input_file\":";
+  writeJSONString(Header, InputFile);
+  Header << ",\"output_version\":";
+  writeJSONString(Header, Version);
+  Header << ",\"objects\":[";
+  JSONHeader = Header.str();
+}
+
+void ScopeJSONPrinter::initBeforePrint(const Object *) { WrotePart = false; }
+
+const std::string &ScopeJSONPrinter::getFileExtension() {
+  static std::string JSONExtension = "json";
+  return JSONExtension;
+}
+
+const std::string &ScopeJSONPrinter::getHeader() { return JSONHeader; }
+
+const std::string &ScopeJSONPrinter::getFooter() {
+  static std::string JSONFooter = "]}\n";
+  return JSONFooter;
+}
+
+void ScopeJSONPrinter::printImpl(const Object *Obj,
+                                 std::ostream &OutputStream) {
+  // Each output starts with the first of the objects, after the header.
+  if (Depth == 0)
+    JSON.reset(OutputStream);
+
+  // Don't print anything for the scope root, but do visit the children.
+  if (isa<ScopeRoot>(*Obj)) {
+    ++Depth;
+    printChildren(Obj);
+    --Depth;
+    return;
+  }
+
+  // Skip objects that shouldn't be printed as an object.
+  if (!Obj->getIsPrintedAsObject())
+    return;
+
+  JSON.beginObject();
+  Obj->writeJSON(JSON);
+  JSON.key("children");
+  JSON.beginArray();
+  ++Depth;
+  printChildren(Obj);
+  --Depth;
+  JSON.endArray();
+  JSON.endObject();
+}
+
+std::unique_ptr<ScopePrinter> ScopeJSONPrinter::createSplitPrinter() const {
+  return std::make_unique<ScopeJSONPrinter>(Settings, InputFile, Version);
+}
+
+void ScopeJSONPrinter::writePart(const ScopePrinter &, const std::string &Text,
+                                 std::ostream &Output) {
+  // Each part was printed as if it were the first in the array.
+  if (Text.empty())
+    return;
+  if (WrotePart)
+    Output << ',';
+  Output.write(Text.data(), static_cast<std::streamsize>(Text.size()));
+  WrotePart = true;
+}
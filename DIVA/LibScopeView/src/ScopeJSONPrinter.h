@@ -0,0 +1,74 @@
+//===-- LibScopeView/ScopeJSONPrinter.h -------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the ScopeJSONPrinter class.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SCOPEVIEW_SCOPEJSONPRINTER_H
+#define SCOPEVIEW_SCOPEJSONPRINTER_H
+
+#include "JSONWriter.h"
+#include "ScopePrinter.h"
+
+namespace LibScopeView {
+
+/// \brief A Scope printer that outputs a JSON document, with the same layout
+/// as the YAML output except that the source and DWARF information of each
+/// object are members of the object itself.
+///
+/// \code
+///   {"input_file":"a.o","output_version":"0.1","objects":[
+///   {"object":"CompileUnit","name":"a.cpp",...,"attributes":{},
+///    "children":[...]}]}
+/// \endcode
+class ScopeJSONPrinter : public ScopePrinter {
+public:
+  ScopeJSONPrinter(const PrintSettings &Settings, const std::string &InputFile,
+                   const std::string &Version);
+
+private:
+  void initBeforePrint(const Object *Obj) override;
+  const std::string &getFileExtension() override;
+  const std::string &getHeader() override;
+  const std::string &getFooter() override;
+  void printImpl(const Object *Obj, std::ostream &OutputStream) override;
+  std::unique_ptr<ScopePrinter> createSplitPrinter() const override;
+  void writePart(const ScopePrinter &Part, const std::string &Text,
+                 std::ostream &Output) override;
+
+  const std::string InputFile;
+  const std::string Version;
+  std::string JSONHeader;
+  JSONWriter JSON;
+  // How deep printImpl is in the tree, 0 at the top of each output.
+  uint32_t Depth;
+  // True once writePart has written an object.
+  bool WrotePart;
+};
+
+} // end namespace LibScopeView
+
+#endif // SCOPEVIEW_SCOPEJSONPRINTER_H
@@ -0,0 +1,164 @@
+//===-- LibScopeView/ScopeNDJSONPrinter.cpp ---------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the definitions of ScopeNDJSONPrinter's methods.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ScopeNDJSONPrinter.h"
+#include "Scope.h"
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+using namespace LibScopeView;
+
+namespace {
+const uint64_t NoParent = std::numeric_limits<uint64_t>::max();
+
+const char IDPrefix[] = "{\"id\":";
+const char ParentPrefix[] = ",\"parent\":";
+
+// Append the id at Text[Pos] plus Offset to Out, returning the position after
+// the id.
+size_t appendMovedID(const std::string &Text, size_t Pos, uint64_t Offset,
+                     std::string &Out) {
+  uint64_t ID = 0;
+  for (; Pos < Text.size() && Text[Pos] >= '0' && Text[Pos] <= '9'; ++Pos)
+    ID = ID * 10 + static_cast<uint64_t>(Text[Pos] - '0');
+  Out += std::to_string(ID + Offset);
+  return Pos;
+}
+
+// Append Prefix, which must be at Text[Pos], to Out, returning the position
+// after it.
+size_t appendPrefix(const std::string &Text, size_t Pos, const char *Prefix,
+                    std::string &Out) {
+  size_t Length = strlen(Prefix);
+  assert(Text.compare(Pos, Length, Prefix) == 0 && "Not an NDJSON record");
+  Out.append(Prefix, Length);
+  return Pos + Length;
+}
+
+} // namespace
+
+ScopeNDJSONPrinter::ScopeNDJSONPrinter(const PrintSettings &Settings,
+                                       const std::string &InputFile,
+                                       const std::string &Version)
+    : ScopePrinter(Settings), InputFile(InputFile), Version(Version),
+      Depth(0), NextID(0), ParentID(NoParent), NextPartID(0) {
+  std::stringstream Header;
+  Header << "{\"input_file\":";
+  writeJSONString(Header, InputFile);
+  Header << ",\"output_version\":";
+  writeJSONString(Header, Version);
+  Header << "}\n";
+  NDJSONHeader = Header.str();
+}
+
+void ScopeNDJSONPrinter::initBeforePrint(const Object *) { NextPartID = 0; }
+
+const std::string &ScopeNDJSONPrinter::getFileExtension() {
+  static std::string NDJSONExtension = "ndjson";
+  return NDJSONExtension;
+}
+
+const std::string &ScopeNDJSONPrinter::getHeader() { return NDJSONHeader; }
+
+void ScopeNDJSONPrinter::printImpl(const Object *Obj,
+                                   std::ostream &OutputStream) {
+  // The records of each output are numbered from 0.
+  if (Depth == 0) {
+    JSON.reset(OutputStream);
+    NextID = 0;
+    ParentID = NoParent;
+  }
+
+  // Don't print anything for the scope root, but do visit the children.
+  if (isa<ScopeRoot>(*Obj)) {
+    ++Depth;
+    printChildren(Obj);
+    --Depth;
+    return;
+  }
+
+  // Skip objects that shouldn't be printed as an object.
+  if (!Obj->getIsPrintedAsObject())
+    return;
+
+  uint64_t ID = NextID++;
+  JSON.beginObject();
+  JSON.key("id");
+  JSON.number(ID);
+  JSON.key("parent");
+  if (ParentID == NoParent)
+    JSON.null();
+  else
+    JSON.number(ParentID);
+  Obj->writeJSON(JSON);
+  JSON.endObject();
+  JSON.newline();
+
+  uint64_t EnclosingParentID = ParentID;
+  ParentID = ID;
+  ++Depth;
+  printChildren(Obj);
+  --Depth;
+  ParentID = EnclosingParentID;
+}
+
+std::unique_ptr<ScopePrinter> ScopeNDJSONPrinter::createSplitPrinter() const {
+  return std::make_unique<ScopeNDJSONPrinter>(Settings, InputFile, Version);
+}
+
+void ScopeNDJSONPrinter::writePart(const ScopePrinter &Part,
+                                   const std::string &Text,
+                                   std::ostream &Output) {
+  uint64_t Offset = NextPartID;
+  NextPartID += static_cast<const ScopeNDJSONPrinter &>(Part).NextID;
+  if (Offset == 0) {
+    Output.write(Text.data(), static_cast<std::streamsize>(Text.size()));
+    return;
+  }
+
+  // The records of each part were numbered from 0, so move their ids and
+  // parent ids after the records of the parts before.
+  std::string Moved;
+  Moved.reserve(Text.size() + Text.size() / 8);
+  for (size_t Pos = 0; Pos < Text.size();) {
+    size_t End = Text.find('\n', Pos);
+    End = End == std::string::npos ? Text.size() : End + 1;
+    Pos = appendPrefix(Text, Pos, IDPrefix, Moved);
+    Pos = appendMovedID(Text, Pos, Offset, Moved);
+    Pos = appendPrefix(Text, Pos, ParentPrefix, Moved);
+    if (Text[Pos] != 'n')
+      Pos = appendMovedID(Text, Pos, Offset, Moved);
+    Moved.append(Text, Pos, End - Pos);
+    Pos = End;
+  }
+  Output.write(Moved.data(), static_cast<std::streamsize>(Moved.size()));
+}
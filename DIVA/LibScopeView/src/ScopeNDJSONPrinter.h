@@ -0,0 +1,82 @@
+//===-- LibScopeView/ScopeNDJSONPrinter.h -----------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the ScopeNDJSONPrinter class.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SCOPEVIEW_SCOPENDJSONPRINTER_H
+#define SCOPEVIEW_SCOPENDJSONPRINTER_H
+
+#include "JSONWriter.h"
+#include "ScopePrinter.h"
+
+namespace LibScopeView {
+
+/// \brief A Scope printer that outputs newline delimited JSON, a line with
+/// the input file and then one flat record per object.
+///
+/// Each record has the members that ScopeJSONPrinter prints for the object,
+/// except its children, after an "id" numbering the records of the output
+/// from 0 and the "parent" id of the nearest printed ancestor (null for the
+/// top objects). Parents are printed before their children, so the tree can
+/// be rebuilt as the records are read.
+///
+/// \code
+///   {"input_file":"a.o","output_version":"0.1"}
+///   {"id":0,"parent":null,"object":"CompileUnit","name":"a.cpp",...}
+///   {"id":1,"parent":0,"object":"Function","name":"main",...}
+/// \endcode
+class ScopeNDJSONPrinter : public ScopePrinter {
+public:
+  ScopeNDJSONPrinter(const PrintSettings &Settings,
+                     const std::string &InputFile, const std::string &Version);
+
+private:
+  const std::string &getFileExtension() override;
+  const std::string &getHeader() override;
+  void initBeforePrint(const Object *Obj) override;
+  void printImpl(const Object *Obj, std::ostream &OutputStream) override;
+  std::unique_ptr<ScopePrinter> createSplitPrinter() const override;
+  void writePart(const ScopePrinter &Part, const std::string &Text,
+                 std::ostream &Output) override;
+
+  const std::string InputFile;
+  const std::string Version;
+  std::string NDJSONHeader;
+  JSONWriter JSON;
+  // How deep printImpl is in the tree, 0 at the top of each output.
+  uint32_t Depth;
+  // The id of the next record, and of the parent of the objects being
+  // printed (NoParent for the top objects).
+  uint64_t NextID;
+  uint64_t ParentID;
+  // The id of the first record of the next part for writePart.
+  uint64_t NextPartID;
+};
+
+} // end namespace LibScopeView
+
+#endif // SCOPEVIEW_SCOPENDJSONPRINTER_H
@@ -30,10 +30,18 @@
 #include "ScopePrinter.h"
 #include "Error.h"
 #include "FileUtilities.h"
+#include "GzipStream.h"
+#include "MemoryProfile.h"
 #include "Scope.h"
+#include "Utilities.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 using namespace LibScopeView;
 
@@ -44,7 +52,11 @@ std::string EmptyString;
 
 void ScopePrinter::print(const Object *Obj, std::ostream &Output) {
   initBeforePrint(Obj);
-  printSingleOutput(Obj, Output);
+  const auto *Root = dyn_cast<ScopeRoot>(Obj);
+  if (Root && Root->getChildren().size() > 1 && createSplitPrinter())
+    printParts(Root, Output);
+  else
+    printSingleOutput(Obj, Output);
 }
 
 void ScopePrinter::print(const ScopeRoot *Root, const std::string &OutputDir) {
@@ -61,29 +73,85 @@ void ScopePrinter::print(const ScopeRoot *Root, const std::string &OutputDir) {
     fatalError(LibScopeError::ErrorCode::ERR_FILEIO_MAKE_DIR_FAILURE,
                SplitOutputDir);
   }
-  // Print each compile unit
-  initBeforePrint(Root);
+  // Work out the file for each compile unit. Where compile units have the
+  // same file name only the last is printed, as it would overwrite the
+  // others.
+  std::vector<const Object *> CUs;
+  std::vector<std::string> OutputPaths;
+  std::map<std::string, size_t> PathIndices;
   for (const auto *CU : Root->getChildren()) {
     if (isa<ScopeCompileUnit>(*CU)) {
-      // Open an output file for each CU.
       std::string OutputPath(SplitOutputDir);
       OutputPath += flattenFilePath(CU->getName());
       OutputPath += ".";
       OutputPath += getFileExtension();
+      if (Settings.CompressOutput)
+        OutputPath += ".gz";
 
-      std::ofstream SplitOutputFile(nativeFilePath(OutputPath));
-      if (SplitOutputFile.fail())
-        fatalError(LibScopeError::ErrorCode::ERR_SPLIT_UNABLE_TO_OPEN_FILE,
-                   OutputPath);
-      printSingleOutput(CU, SplitOutputFile);
+      auto Inserted = PathIndices.emplace(OutputPath, CUs.size());
+      if (Inserted.second) {
+        CUs.push_back(CU);
+        OutputPaths.push_back(std::move(OutputPath));
+      } else {
+        CUs[Inserted.first->second] = CU;
+      }
     }
   }
+
+  // Print each compile unit.
+  initBeforePrint(Root);
+  if (CUs.size() < 2 || !createSplitPrinter()) {
+    for (size_t I = 0; I < CUs.size(); ++I)
+      printSplitFile(CUs[I], OutputPaths[I]);
+    return;
+  }
+
+  materializeNames(*Root, getPrintsAllQualifiedNames());
+  runInParallel(CUs.size(), /*ThreadCount*/ 0, [&](size_t I) {
+    std::unique_ptr<ScopePrinter> Printer(createSplitPrinter());
+    Printer->printSplitFile(CUs[I], OutputPaths[I]);
+  });
+}
+
+uint64_t ScopePrinter::getAllocatedBytes() {
+  return getHeapBytes(getHeader()) + getHeapBytes(getFooter());
 }
 
 const std::string &ScopePrinter::getHeader() { return EmptyString; }
 
 const std::string &ScopePrinter::getFooter() { return EmptyString; }
 
+void ScopePrinter::writePart(const ScopePrinter &, const std::string &Text,
+                             std::ostream &Output) {
+  Output.write(Text.data(), static_cast<std::streamsize>(Text.size()));
+}
+
+void ScopePrinter::printParts(const ScopeRoot *Root, std::ostream &Output) {
+  materializeNames(*Root, getPrintsAllQualifiedNames());
+  const auto &Children = Root->getChildren();
+  std::vector<std::unique_ptr<ScopePrinter>> Parts(Children.size());
+  std::vector<std::string> Texts(Children.size());
+
+  // The parts are written as soon as they and those before them are done, so
+  // that only a few are held at once.
+  size_t WindowSize = 2 * std::max(1u, std::thread::hardware_concurrency());
+  Output << getHeader();
+  runInOrder(Children.size(), /*ThreadCount*/ 0, WindowSize,
+             [&](size_t I) {
+               Parts[I] = createSplitPrinter();
+               std::ostringstream PartOutput;
+               Parts[I]->OutputStream = &PartOutput;
+               Parts[I]->visit(Children[I]);
+               Texts[I] = PartOutput.str();
+             },
+             [&](size_t I) {
+               writePart(*Parts[I], Texts[I], Output);
+               Parts[I].reset();
+               std::string().swap(Texts[I]);
+             });
+  Output << getFooter();
+}
+
 void ScopePrinter::printSingleOutput(const Object *Obj, std::ostream &Output) {
   OutputStream = &Output;
   *OutputStream << getHeader();
@@ -91,6 +159,21 @@ void ScopePrinter::printSingleOutput(const Object *Obj, std::ostream &Output) {
   *OutputStream << getFooter();
 }
 
+void ScopePrinter::printSplitFile(const Object *CU,
+                                  const std::string &OutputPath) {
+  std::ofstream SplitOutputFile(nativeFilePath(OutputPath), std::ios::binary);
+  if (SplitOutputFile.fail())
+    fatalError(LibScopeError::ErrorCode::ERR_SPLIT_UNABLE_TO_OPEN_FILE,
+               OutputPath);
+  if (Settings.CompressOutput) {
+    GzipOutputStream CompressedFile(SplitOutputFile);
+    printSingleOutput(CU, CompressedFile);
+    CompressedFile.close();
+  } else {
+    printSingleOutput(CU, SplitOutputFile);
+  }
+}
+
 void ScopePrinter::visitImpl(const Object *Obj) {
   assert(OutputStream && "ScopePrinter methods calling ScopePrinter::visit "
                          "should set OutputStream first");
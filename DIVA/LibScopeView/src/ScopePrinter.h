@@ -33,6 +33,8 @@
 #include "ScopeVisitor.h"
 #include "PrintSettings.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
 namespace LibScopeView {
@@ -68,11 +70,29 @@ public:
   virtual ~ScopePrinter() override {}
 
   /// \brief Print Obj to Output.
+  ///
+  /// If Obj is a ScopeRoot and the printer supports it (see
+  /// createSplitPrinter), the children of the root are printed into buffers
+  /// on several threads, which are written to Output in order. The names of
+  /// the whole tree are worked out first.
   void print(const Object *Obj, std::ostream &Output);
 
   /// \brief Print each CU under the ScopeRoot to a file in OutputDir.
+  ///
+  /// The files are printed on several threads if the printer supports it
+  /// (see createSplitPrinter), which works out the names of the whole tree
+  /// first.
   void print(const ScopeRoot *Root, const std::string &OutputDir);
 
+  /// \brief Heap bytes held by the printer. The output is written straight to
+  /// the stream so this is only the header and footer.
+  uint64_t getAllocatedBytes();
+
+  /// \brief Return true if the printer reads the qualified name of every
+  /// object, rather than only those of types and template parameters (see
+  /// materializeNames).
+  virtual bool getPrintsAllQualifiedNames() const { return true; }
+
 protected:
   void printChildren(const Object *Obj) { visitChildren(Obj); }
 
@@ -97,9 +117,28 @@ private:
   /// bottom of each split file.
   virtual const std::string &getFooter();
 
+  /// \brief Create a printer like this one, set up by initBeforePrint for the
+  /// same tree, to print some of the split files or children of the root on
+  /// another thread. Returns null if they must all be printed in turn by this
+  /// printer.
+  virtual std::unique_ptr<ScopePrinter> createSplitPrinter() const {
+    return nullptr;
+  }
+
+  /// \brief Write Text, printed for a child of the root by Part (a printer
+  /// from createSplitPrinter), to Output after the children before it.
+  virtual void writePart(const ScopePrinter &Part, const std::string &Text,
+                         std::ostream &Output);
+
+  // Print the children of Root on several threads, in order, to Output.
+  void printParts(const ScopeRoot *Root, std::ostream &Output);
+
   // Do the printing for one output.
   void printSingleOutput(const Object *Obj, std::ostream &OutputStream);
 
+  // Print one CU to the split file at OutputPath.
+  void printSplitFile(const Object *CU, const std::string &OutputPath);
+
   // Call printImpl() on the object with the appropriate OutputStream.
   void visitImpl(const Object *Obj) override;
 
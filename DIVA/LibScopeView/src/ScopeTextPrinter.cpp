@@ -88,7 +88,7 @@ private:
   size_t CurrentLevel;
 
   size_t TagNameIndent;
-  uint64_t MaxLine;
+  uint32_t MaxLine;
   size_t MaxLevel;
 
   std::set<Dwarf_Half> SeenDwarfTags;
@@ -256,6 +256,30 @@ void ScopeTextPrinter::printImpl(const Object *Obj,
   printIndentedChildren(Obj);
 }
 
+std::unique_ptr<ScopePrinter> ScopeTextPrinter::createSplitPrinter() const {
+  return std::make_unique<ScopeTextPrinter>(*this);
+}
+
+void ScopeTextPrinter::writePart(const ScopePrinter &Part,
+                                 const std::string &Text,
+                                 std::ostream &Output) {
+  // The part didn't know the file printed last before it, so its first
+  // {Source} line is dropped if it repeats that file.
+  const auto &TextPart = static_cast<const ScopeTextPrinter &>(Part);
+  if (TextPart.FirstFileRef && TextPart.FirstFileRef == CurrentFileRef &&
+      TextPart.FirstFileStart >= 0 &&
+      TextPart.FirstFileEnd <= static_cast<std::streamoff>(Text.size())) {
+    Output.write(Text.data(), TextPart.FirstFileStart);
+    Output.write(Text.data() + TextPart.FirstFileEnd,
+                 static_cast<std::streamsize>(Text.size()) -
+                     TextPart.FirstFileEnd);
+  } else {
+    Output.write(Text.data(), static_cast<std::streamsize>(Text.size()));
+  }
+  if (TextPart.CurrentFileRef)
+    CurrentFileRef = TextPart.CurrentFileRef;
+}
+
 void ScopeTextPrinter::printObjectText(const Object *Obj,
                                        std::ostream &OutputStream) {
   // Print file names.
@@ -264,9 +288,16 @@ void ScopeTextPrinter::printObjectText(const Object *Obj,
     CurrentFileRef = FileNameRef;
     std::string FileName(getFileName(Obj->getFilePath()));
     FileName = FileName.empty() ? "?" : FileName;
+    bool IsFirstFile = !FirstFileRef;
+    if (IsFirstFile) {
+      FirstFileRef = FileNameRef;
+      FirstFileStart = OutputStream.tellp();
+    }
     OutputStream << '\n'
                  << std::string(AttributesIndentSize, ' ') << "{Source} \""
                  << FileName << "\"\n";
+    if (IsFirstFile)
+      FirstFileEnd = OutputStream.tellp();
   }
 
   // Preceding attributes.
@@ -43,6 +43,10 @@ public:
   ScopeTextPrinter(const PrintSettings &PrintingSettings, std::string InputFile,
                    uint8_t IndentSize = 2);
 
+  bool getPrintsAllQualifiedNames() const override {
+    return Settings.ShowQualified;
+  }
+
 private:
   void initBeforePrint(const Object *Obj) override;
 
@@ -50,6 +54,9 @@ private:
   const std::string &getHeader() override;
 
   void printImpl(const Object *Obj, std::ostream &OutputStream) override;
+  std::unique_ptr<ScopePrinter> createSplitPrinter() const override;
+  void writePart(const ScopePrinter &Part, const std::string &Text,
+                 std::ostream &Output) override;
   void printObjectText(const Object *Obj, std::ostream &OutputStream);
   void printIndentedChildren(const Object *Obj);
 
@@ -59,6 +66,12 @@ private:
   size_t IndentLevel = 1;
   StringPoolRef CurrentFileRef = nullptr;
 
+  // The file of the first {Source} line printed, and the positions in the
+  // output of the start and end of the line, for writePart.
+  StringPoolRef FirstFileRef = nullptr;
+  std::streamoff FirstFileStart = 0;
+  std::streamoff FirstFileEnd = 0;
+
   // Indent sizes calculated from the tree being printed.
   size_t LineNumberIndentSize = 0;
   size_t TagIndentSize = 0;
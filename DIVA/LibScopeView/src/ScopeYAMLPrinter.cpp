@@ -71,6 +71,10 @@ const std::string &ScopeYAMLPrinter::getFileExtension() {
 
 const std::string &ScopeYAMLPrinter::getHeader() { return YAMLHeader; }
 
+std::unique_ptr<ScopePrinter> ScopeYAMLPrinter::createSplitPrinter() const {
+  return std::make_unique<ScopeYAMLPrinter>(*this);
+}
+
 void ScopeYAMLPrinter::printImpl(const Object *Obj,
                                  std::ostream &OutputStream) {
   // Don't print anything for the scope root, but do visit the children.
@@ -44,6 +44,7 @@ private:
   const std::string &getFileExtension() override;
   const std::string &getHeader() override;
   void printImpl(const Object *Obj, std::ostream &OutputStream) override;
+  std::unique_ptr<ScopePrinter> createSplitPrinter() const override;
 
   std::string YAMLHeader;
   const uint8_t IndentSize;
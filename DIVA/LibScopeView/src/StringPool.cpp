@@ -28,6 +28,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "StringPool.h"
+#include "MemoryProfile.h"
 
 #include <assert.h>
 #include <iomanip>
@@ -43,3 +44,54 @@ StringPool GlobalStringPool;
 StringPool &LibScopeView::getGlobalStringPool() {
   return GlobalStringPool;
 }
+
+StringPool::StringPool() : RefCount(1), Lookups(0) {
+  for (auto &Segment : Segments)
+    Segment.store(nullptr);
+  StringPoolRef *First = new StringPoolRef[FirstSegmentSize];
+  First[0] = nullptr;
+  Segments[0].store(First);
+}
+
+StringPool::~StringPool() {
+  for (auto &Segment : Segments)
+    delete[] Segment.load();
+}
+
+StringPoolIndex StringPool::getIndex(const std::string &Str) {
+  ++Lookups;
+  std::lock_guard<std::mutex> Lock(Mutex);
+  size_t Count = RefCount.load(std::memory_order_relaxed);
+  auto Inserted = Pool.emplace(Str, static_cast<StringPoolIndex>(Count));
+  if (Inserted.second) {
+    unsigned Segment;
+    size_t Offset;
+    getSegmentOffset(static_cast<StringPoolIndex>(Count), Segment, Offset);
+    StringPoolRef *Refs = Segments[Segment].load(std::memory_order_relaxed);
+    if (!Refs) {
+      Refs = new StringPoolRef[FirstSegmentSize << Segment];
+      Segments[Segment].store(Refs, std::memory_order_release);
+    }
+    Refs[Offset] = &Inserted.first->first;
+    RefCount.store(Count + 1, std::memory_order_release);
+  }
+  return Inserted.first->second;
+}
+
+StringPoolIndex StringPool::findIndex(const std::string &Str) const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto It = Pool.find(Str);
+  return It == Pool.end() ? 0 : It->second;
+}
+
+uint64_t StringPool::getAllocatedBytes() const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  // The nodes of the pool store the hash of each string.
+  uint64_t Bytes = getHashTableBytes(Pool, sizeof(size_t));
+  for (unsigned Segment = 0; Segment < SegmentCount; ++Segment)
+    if (Segments[Segment].load())
+      Bytes += (FirstSegmentSize << Segment) * sizeof(StringPoolRef);
+  for (const auto &Entry : Pool)
+    Bytes += getHeapBytes(Entry.first);
+  return Bytes;
+}
@@ -30,23 +30,100 @@
 #ifndef STRINGPOOL_H_
 #define STRINGPOOL_H_
 
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
 #include <string>
-#include <unordered_set>
+#include <unordered_map>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace LibScopeView {
 
 using StringPoolRef = const std::string *;
 
+/// \brief A compact 32-bit handle to a string in a StringPool.
+///
+/// Index 0 is reserved to mean 'no string' (the equivalent of a null
+/// StringPoolRef).
+using StringPoolIndex = uint32_t;
+
 /// \brief A pool of deduplicated strings.
+///
+/// The pool can be used from several threads at once. Interning a string takes
+/// a lock, but getRef does not, as the index to string table is stored in
+/// segments that are never moved once allocated.
 class StringPool {
 public:
-  StringPoolRef get(const std::string &Str) {
-    auto Inserted = Pool.insert(Str);
-    return &*Inserted.first;
+  StringPool();
+  ~StringPool();
+
+  StringPool(const StringPool &) = delete;
+  StringPool &operator=(const StringPool &) = delete;
+
+  StringPoolRef get(const std::string &Str) { return getRef(getIndex(Str)); }
+
+  /// \brief Intern Str and return its compact index.
+  StringPoolIndex getIndex(const std::string &Str);
+
+  /// \brief Get the index of Str without interning it, or 0 if it is not in
+  /// the pool.
+  StringPoolIndex findIndex(const std::string &Str) const;
+
+  /// \brief Get the string for an index returned by getIndex.
+  StringPoolRef getRef(StringPoolIndex Index) const {
+    assert(Index < RefCount.load(std::memory_order_acquire) &&
+           "Invalid StringPoolIndex");
+    unsigned Segment;
+    size_t Offset;
+    getSegmentOffset(Index, Segment, Offset);
+    return Segments[Segment].load(std::memory_order_acquire)[Offset];
   }
 
+  /// \brief Number of unique strings in the pool.
+  size_t size() const { return RefCount.load() - 1; }
+
+  /// \brief Number of strings that have been interned, including those that
+  /// were already in the pool.
+  uint64_t getLookupCount() const { return Lookups.load(); }
+
+  /// \brief Heap bytes used by the strings and the tables of the pool.
+  uint64_t getAllocatedBytes() const;
+
 private:
-  std::unordered_set<std::string> Pool;
+  // Segment N holds (FirstSegmentSize << N) refs, so that the segments cover
+  // every 32-bit index.
+  static const unsigned FirstSegmentBits = 10;
+  static const size_t FirstSegmentSize = size_t(1) << FirstSegmentBits;
+  static const unsigned SegmentCount = 32 - FirstSegmentBits + 1;
+
+  static unsigned getHighestBit(uint64_t Value) {
+#ifdef _MSC_VER
+    unsigned long Bit;
+    _BitScanReverse64(&Bit, Value);
+    return Bit;
+#else
+    return 63 - __builtin_clzll(Value);
+#endif
+  }
+
+  static void getSegmentOffset(StringPoolIndex Index, unsigned &Segment,
+                               size_t &Offset) {
+    uint64_t Biased = uint64_t(Index) + FirstSegmentSize;
+    unsigned Bit = getHighestBit(Biased);
+    Segment = Bit - FirstSegmentBits;
+    Offset = Biased - (uint64_t(1) << Bit);
+  }
+
+  mutable std::mutex Mutex;
+  std::unordered_map<std::string, StringPoolIndex> Pool;
+  // Index to string lookup, index 0 is always nullptr.
+  std::atomic<StringPoolRef *> Segments[SegmentCount];
+  std::atomic<size_t> RefCount;
+  std::atomic<uint64_t> Lookups;
 };
 
 StringPool &getGlobalStringPool();
@@ -30,12 +30,14 @@
 #include "SummaryTable.h"
 #include "Object.h"
 #include "PrintSettings.h"
+#include "Scope.h"
 #include "ScopeVisitor.h"
+#include "Symbol.h"
+#include "Type.h"
 
 #include <assert.h>
 #include <iomanip>
 #include <ostream>
-#include <vector>
 
 using namespace LibScopeView;
 
@@ -53,41 +55,95 @@ private:
 
 // So the vtable for SummaryTableCounter can be out of line.
 void SummaryTable::SummaryTableCounter::visitImpl(const Object *Obj) {
-  Table.incrementFound(Obj);
-  if (!Settings || Settings->printObject(*Obj))
-    Table.incrementPrinted(Obj);
+  RowKind Row = getRowKind(*Obj);
+  if (Row != RowCount)
+    Table.addObjects(Row, 1, !Settings || Settings->printObject(*Obj));
   visitChildren(Obj);
 }
 
-SummaryTable::SummaryTable(const Object &Root, const PrintSettings *Settings)
-    : TotalFound(0), TotalPrinted(0) {
-  // Create a list of row labels for each DIVA Object.
-  static const std::vector<std::string> RowLabels = {"Alias",
-                                                     "Block",
-                                                     "Class",
-                                                     "CodeLine",
-                                                     "CompileUnit",
-                                                     "Enum",
-                                                     "Function",
-                                                     "Member",
-                                                     "Namespace",
-                                                     "Parameter",
-                                                     "PrimitiveType",
-                                                     "Struct",
-                                                     "TemplateParameter",
-                                                     "Union",
-                                                     "Using",
-                                                     "Variable"};
-
-  // Add a row to the table for each DIVA object.
-  for (auto Label : RowLabels) {
-    Rows.emplace(Label, SummaryTableRow());
-  }
+SummaryTable::SummaryTable() : TotalFound(0), TotalPrinted(0) {}
 
+SummaryTable::SummaryTable(const Object &Root, const PrintSettings *Settings)
+    : SummaryTable() {
   // Gather the stats.
   SummaryTableCounter(*this, Settings).visit(&Root);
 }
 
+SummaryTable::RowKind SummaryTable::getRowKind(const Object &Obj) {
+  // The same classification as Object::getKindAsString, for the kinds that
+  // have a row.
+  switch (Obj.getKind()) {
+  case Object::SV_Line:
+    return CodeLine;
+  case Object::SV_Scope:
+    if (cast<Scope>(Obj).getIsBlock())
+      return Block;
+    break;
+  case Object::SV_ScopeAggregate: {
+    auto &Agg = cast<ScopeAggregate>(Obj);
+    if (Agg.getIsClassType())
+      return Class;
+    if (Agg.getIsStructType())
+      return Struct;
+    if (Agg.getIsUnionType())
+      return Union;
+  } break;
+  case Object::SV_ScopeAlias:
+  case Object::SV_TypeDefinition:
+    return Alias;
+  case Object::SV_ScopeCompileUnit:
+    return CompileUnit;
+  case Object::SV_ScopeEnumeration:
+    return Enum;
+  case Object::SV_ScopeFunction:
+  case Object::SV_ScopeFunctionInlined:
+    return Function;
+  case Object::SV_ScopeNamespace:
+    return Namespace;
+  case Object::SV_ScopeTemplatePack:
+  case Object::SV_TypeTemplateParam:
+    return TemplateParameter;
+  case Object::SV_Symbol: {
+    auto &Sym = cast<Symbol>(Obj);
+    if (Sym.getIsMember())
+      return Member;
+    if (Sym.getIsParameter() || Sym.getIsUnspecifiedParameter())
+      return Parameter;
+    if (Sym.getIsVariable())
+      return Variable;
+  } break;
+  case Object::SV_Type:
+    if (cast<Type>(Obj).getIsBaseType())
+      return PrimitiveType;
+    break;
+  case Object::SV_TypeImport:
+    return Using;
+  case Object::SV_ScopeArray:
+  case Object::SV_ScopeRoot:
+  case Object::SV_TypeEnumerator:
+  case Object::SV_TypeSubrange:
+    break;
+  }
+  return RowCount;
+}
+
+void SummaryTable::addObjects(RowKind Row, uint64_t Found, uint64_t Printed) {
+  assert(Row < RowCount);
+  Rows[Row].ObjectsFound += Found;
+  Rows[Row].ObjectsPrinted += Printed;
+  TotalFound += Found;
+  TotalPrinted += Printed;
+}
+
+void SummaryTable::add(const SummaryTable &Other) {
+  for (unsigned Row = 0; Row < RowCount; ++Row) {
+    Rows[Row].ObjectsFound += Other.Rows[Row].ObjectsFound;
+    Rows[Row].ObjectsPrinted += Other.Rows[Row].ObjectsPrinted;
+  }
+  TotalFound += Other.TotalFound;
+  TotalPrinted += Other.TotalPrinted;
+}
+
 void SummaryTable::printSummaryTable(std::ostream &Out) const {
   // Calculate and create indent and divider strings.
   const uint32_t NumberOfColumns = 2;
@@ -110,12 +166,26 @@ void SummaryTable::printSummaryTable(std::ostream &Out) const {
       << Indent << Divider << "\n";
 
   // Output each row.
-  for (auto Row : Rows) {
-    auto RowLabel = Row.first;
-    auto RowData = Row.second;
-    Out << Indent << std::left << std::setw(LabelWidth) << RowLabel
-        << std::right << std::setw(ColumnWidth) << RowData.ObjectsFound
-        << std::setw(ColumnWidth) << RowData.ObjectsPrinted << "\n";
+  static const char *const RowLabels[RowCount] = {"Alias",
+                                                   "Block",
+                                                   "Class",
+                                                   "CodeLine",
+                                                   "CompileUnit",
+                                                   "Enum",
+                                                   "Function",
+                                                   "Member",
+                                                   "Namespace",
+                                                   "Parameter",
+                                                   "PrimitiveType",
+                                                   "Struct",
+                                                   "TemplateParameter",
+                                                   "Union",
+                                                   "Using",
+                                                   "Variable"};
+  for (unsigned Row = 0; Row < RowCount; ++Row) {
+    Out << Indent << std::left << std::setw(LabelWidth) << RowLabels[Row]
+        << std::right << std::setw(ColumnWidth) << Rows[Row].ObjectsFound
+        << std::setw(ColumnWidth) << Rows[Row].ObjectsPrinted << "\n";
   }
 
   // Output the footer.
@@ -125,30 +195,3 @@ void SummaryTable::printSummaryTable(std::ostream &Out) const {
       << std::setw(ColumnWidth) << TotalPrinted << "\n"
       << "\n";
 }
-
-void SummaryTable::incrementFound(const Object *Obj) {
-  if (SummaryTableRow *Row = getCorrespondingRow(Obj)) {
-    ++(Row->ObjectsFound);
-    ++TotalFound;
-  }
-}
-
-void SummaryTable::incrementPrinted(const Object *Obj) {
-  if (SummaryTableRow *Row = getCorrespondingRow(Obj)) {
-    ++(Row->ObjectsPrinted);
-    ++TotalPrinted;
-  }
-}
-
-SummaryTable::SummaryTableRow *
-SummaryTable::getCorrespondingRow(const Object *Obj) {
-  assert(Obj);
-  if (!Obj)
-    return nullptr;
-
-  auto RowIt = Rows.find(Obj->getKindAsString());
-  if (RowIt == Rows.end())
-    return nullptr;
-
-  return &RowIt->second;
-}
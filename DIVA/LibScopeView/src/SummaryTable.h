@@ -30,8 +30,9 @@
 #ifndef SUMMARY_TABLE_H
 #define SUMMARY_TABLE_H
 
-#include <map>
-#include <string>
+#include <array>
+#include <cstdint>
+#include <iosfwd>
 
 namespace LibScopeView {
 
@@ -40,38 +41,66 @@ class PrintSettings;
 
 class SummaryTable {
 public:
+  /// \brief The kinds of object counted, one for each row of the table in the
+  /// order they are printed.
+  enum RowKind : unsigned {
+    Alias,
+    Block,
+    Class,
+    CodeLine,
+    CompileUnit,
+    Enum,
+    Function,
+    Member,
+    Namespace,
+    Parameter,
+    PrimitiveType,
+    Struct,
+    TemplateParameter,
+    Union,
+    Using,
+    Variable,
+    RowCount
+  };
+
   /// \brief Populate the summary table with stats on \p Root and its children.
   ///
   /// If \p Settings is null then the printed object amounts will equal the
   /// found object amounts.
   SummaryTable(const Object &Root, const PrintSettings *Settings);
 
+  /// \brief Create an empty table, for adding the tables of several trees.
+  SummaryTable();
+
+  /// \brief Get the row that counts Obj, or RowCount if it isn't counted.
+  static RowKind getRowKind(const Object &Obj);
+
+  /// \brief Add Found objects to a row, Printed of which are printed.
+  void addObjects(RowKind Row, uint64_t Found, uint64_t Printed);
+
+  /// \brief Add the amounts of another table to this one.
+  void add(const SummaryTable &Other);
+
   /// \brief Outut the summary table.
   void printSummaryTable(std::ostream &out) const;
 
 private:
-  // Increment a specific column in Obj's row.
-  void incrementFound(const Object *obj);
-  void incrementPrinted(const Object *obj);
-  
   class SummaryTableCounter;
-  
+
   struct SummaryTableRow {
     SummaryTableRow()
         : ObjectsFound(0), ObjectsPrinted(0) {}
     // Each row has numerous fields that can be incremented as needed.
-    uint32_t ObjectsFound;
-    uint32_t ObjectsPrinted;
+    uint64_t ObjectsFound;
+    uint64_t ObjectsPrinted;
   };
 
-  SummaryTableRow *getCorrespondingRow(const Object *Obj);
-
-  // Map of the rows, indexed via the ObjectsClassID string.
-  std::map<std::string, SummaryTableRow> Rows;
+  // The rows, indexed by RowKind.
+  std::array<SummaryTableRow, RowCount> Rows;
 
   // Totals for all columns of the summary table.
-  unsigned int TotalFound;
-  unsigned int TotalPrinted;
+  uint64_t TotalFound;
+  uint64_t TotalPrinted;
 
   // Column width values.
   const static uint32_t LabelWidth = 19;
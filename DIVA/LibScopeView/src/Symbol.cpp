@@ -28,6 +28,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Symbol.h"
+#include "JSONWriter.h"
 #include "PrintSettings.h"
 #include "Scope.h"
 
@@ -139,3 +140,40 @@ std::string Symbol::getAsYAML() const {
   YAML << getCommonYAML() << "\nattributes:" << Attrs.str();
   return YAML.str();
 }
+
+void Symbol::writeJSON(JSONWriter &JSON) const {
+  writeCommonJSON(JSON);
+  JSON.key("attributes");
+  JSON.beginObject();
+
+  // Access specifier.
+  if (getIsMember()) {
+    JSON.key("access_specifier");
+    switch (getAccessSpecifier()) {
+    case AccessSpecifier::Private:
+      JSON.string("private");
+      break;
+    case AccessSpecifier::Protected:
+      JSON.string("protected");
+      break;
+    case AccessSpecifier::Public:
+      JSON.string("public");
+      break;
+    case AccessSpecifier::Unspecified:
+      assert(getParent());
+      if (getParent() && getParent()->getIsClassType())
+        JSON.string("private");
+      else
+        JSON.string("public");
+      break;
+    }
+  }
+
+  auto Loc = getLocation();
+  if (Loc != static_cast<Dwarf_Unsigned>(-1)) {
+    JSON.key("location");
+    JSON.number(Loc);
+  }
+
+  JSON.endObject();
+}
@@ -0,0 +1,154 @@
+//===-- LibScopeView/Trace.cpp ----------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the Tracer and TraceSpan classes.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Trace.h"
+#include "JSONWriter.h"
+
+#include <atomic>
+
+using namespace LibScopeView;
+
+namespace {
+
+std::atomic<Tracer *> GlobalActiveTracer(nullptr);
+
+// Innermost span that is being timed on this thread.
+thread_local TraceSpan *CurrentSpan = nullptr;
+
+uint32_t getTraceThreadID() {
+  static std::atomic<uint32_t> NextThreadID(0);
+  thread_local uint32_t ThreadID = NextThreadID++;
+  return ThreadID;
+}
+
+uint64_t toMicroseconds(std::chrono::steady_clock::duration Duration) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(Duration).count());
+}
+
+} // namespace
+
+Tracer::Tracer() : Epoch(std::chrono::steady_clock::now()) {}
+
+void Tracer::addSpan(const char *Name, std::string &&Detail,
+                     std::chrono::steady_clock::time_point Start,
+                     std::chrono::steady_clock::time_point End,
+                     uint64_t NestedMicroseconds) {
+  uint64_t Duration = toMicroseconds(End - Start);
+  TraceSpanRecord Record{Name,
+                         std::move(Detail),
+                         toMicroseconds(Start - Epoch),
+                         Duration,
+                         Duration > NestedMicroseconds
+                             ? Duration - NestedMicroseconds
+                             : 0,
+                         getTraceThreadID()};
+
+  std::lock_guard<std::mutex> Lock(SpansMutex);
+  Spans.push_back(std::move(Record));
+}
+
+std::map<std::string, uint64_t> Tracer::getSelfTimeByName() const {
+  std::map<std::string, uint64_t> Totals;
+  for (const TraceSpanRecord &Span : Spans)
+    Totals[Span.Name] += Span.SelfMicroseconds;
+  return Totals;
+}
+
+void Tracer::addCounter(const std::string &Name, uint64_t Value) {
+  uint64_t Time = toMicroseconds(std::chrono::steady_clock::now() - Epoch);
+
+  std::lock_guard<std::mutex> Lock(CountersMutex);
+  uint64_t &Total = Counters[Name];
+  Total += Value;
+  CounterUpdates.push_back({Name, Time, Total});
+}
+
+void Tracer::writeChromeTrace(std::ostream &OS) const {
+  // All the events belong to one process, spans are complete ("X") events on
+  // the thread that ran them and counters are counter ("C") events.
+  OS << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  const char *Separator = "\n";
+  for (const TraceSpanRecord &Span : Spans) {
+    OS << Separator << "{\"name\":";
+    writeJSONString(OS, Span.Name);
+    OS << ",\"cat\":\"diva\",\"ph\":\"X\",\"pid\":1,\"tid\":" << Span.ThreadID
+       << ",\"ts\":" << Span.StartMicroseconds
+       << ",\"dur\":" << Span.DurationMicroseconds;
+    if (!Span.Detail.empty()) {
+      OS << ",\"args\":{\"detail\":";
+      writeJSONString(OS, Span.Detail);
+      OS << '}';
+    }
+    OS << '}';
+    Separator = ",\n";
+  }
+  for (const TraceCounterRecord &Update : CounterUpdates) {
+    OS << Separator << "{\"name\":";
+    writeJSONString(OS, Update.Name);
+    OS << ",\"cat\":\"diva\",\"ph\":\"C\",\"pid\":1,\"ts\":"
+       << Update.TimeMicroseconds << ",\"args\":{\"value\":" << Update.Total
+       << "}}";
+    Separator = ",\n";
+  }
+  OS << "\n]}\n";
+}
+
+void LibScopeView::setActiveTracer(Tracer *ActiveTracer) {
+  GlobalActiveTracer = ActiveTracer;
+}
+
+Tracer *LibScopeView::getActiveTracer() { return GlobalActiveTracer; }
+
+TraceSpan::TraceSpan(const char *SpanName)
+    : ActiveTracer(getActiveTracer()), Name(SpanName), NestedMicroseconds(0),
+      Enclosing(nullptr) {
+  if (!ActiveTracer)
+    return;
+  Enclosing = CurrentSpan;
+  CurrentSpan = this;
+  Start = std::chrono::steady_clock::now();
+}
+
+TraceSpan::TraceSpan(const char *SpanName, const std::string &SpanDetail)
+    : TraceSpan(SpanName) {
+  if (ActiveTracer)
+    Detail = SpanDetail;
+}
+
+TraceSpan::~TraceSpan() {
+  if (!ActiveTracer)
+    return;
+  auto End = std::chrono::steady_clock::now();
+  if (Enclosing)
+    Enclosing->NestedMicroseconds += toMicroseconds(End - Start);
+  CurrentSpan = Enclosing;
+  ActiveTracer->addSpan(Name, std::move(Detail), Start, End,
+                        NestedMicroseconds);
+}
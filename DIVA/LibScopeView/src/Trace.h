@@ -0,0 +1,162 @@
+//===-- LibScopeView/Trace.h ------------------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Low overhead timing spans and counters for the phases of reading and
+/// printing a file.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace LibScopeView {
+
+/// \brief A completed timing span.
+struct TraceSpanRecord {
+  /// \brief Name of the phase (e.g. "ReadDIEs").
+  const char *Name;
+  /// \brief Optional extra information (e.g. the compile unit name).
+  std::string Detail;
+  /// \brief Start time in microseconds since the Tracer was created.
+  uint64_t StartMicroseconds;
+  /// \brief Total time spent in the span.
+  uint64_t DurationMicroseconds;
+  /// \brief Time spent in the span excluding any nested spans.
+  uint64_t SelfMicroseconds;
+  /// \brief Small integer identifying the thread the span ran on.
+  uint32_t ThreadID;
+};
+
+/// \brief The total of a counter after it was updated.
+struct TraceCounterRecord {
+  /// \brief Name of the counter (e.g. "DIEs").
+  std::string Name;
+  /// \brief Time of the update in microseconds since the Tracer was created.
+  uint64_t TimeMicroseconds;
+  /// \brief Total of the counter including the update.
+  uint64_t Total;
+};
+
+/// \brief Collects the spans recorded while it is the active tracer.
+///
+/// Typical usage:
+/// \code
+///   Tracer T;
+///   setActiveTracer(&T);
+///   {
+///     TraceSpan Span("Phase");
+///     // ...
+///   }
+///   setActiveTracer(nullptr);
+///   auto Totals = T.getSelfTimeByName();
+/// \endcode
+class Tracer {
+public:
+  Tracer();
+
+  Tracer(const Tracer &) = delete;
+  Tracer &operator=(const Tracer &) = delete;
+
+  /// \brief Record a completed span. Safe to call from several threads.
+  void addSpan(const char *Name, std::string &&Detail,
+               std::chrono::steady_clock::time_point Start,
+               std::chrono::steady_clock::time_point End,
+               uint64_t NestedMicroseconds);
+
+  /// \brief All the recorded spans, in the order they completed.
+  const std::vector<TraceSpanRecord> &getSpans() const { return Spans; }
+
+  /// \brief Sum of the self time (in microseconds) of the spans for each name.
+  std::map<std::string, uint64_t> getSelfTimeByName() const;
+
+  /// \brief Add Value to the counter called Name. Safe to call from several
+  /// threads.
+  ///
+  /// Counters are meant to be updated in bulk (e.g. once per file), hot code
+  /// should count locally and report the total when it is done.
+  void addCounter(const std::string &Name, uint64_t Value);
+
+  /// \brief Every update of a counter, in the order they were made.
+  const std::vector<TraceCounterRecord> &getCounterUpdates() const {
+    return CounterUpdates;
+  }
+
+  /// \brief The final total of each counter.
+  const std::map<std::string, uint64_t> &getCounters() const {
+    return Counters;
+  }
+
+  /// \brief Write the spans and counters in the Chrome trace event JSON format
+  /// (viewable in chrome://tracing or Perfetto).
+  void writeChromeTrace(std::ostream &OS) const;
+
+private:
+  std::chrono::steady_clock::time_point Epoch;
+  std::mutex SpansMutex;
+  std::vector<TraceSpanRecord> Spans;
+  std::mutex CountersMutex;
+  std::vector<TraceCounterRecord> CounterUpdates;
+  std::map<std::string, uint64_t> Counters;
+};
+
+/// \brief Set the Tracer that TraceSpans record to (nullptr disables tracing).
+void setActiveTracer(Tracer *ActiveTracer);
+
+/// \brief Get the Tracer that TraceSpans record to, or nullptr if disabled.
+Tracer *getActiveTracer();
+
+/// \brief Times the enclosing block and records it to the active Tracer.
+///
+/// When no Tracer is active a TraceSpan only costs a load and a branch.
+class TraceSpan {
+public:
+  explicit TraceSpan(const char *SpanName);
+  TraceSpan(const char *SpanName, const std::string &SpanDetail);
+  ~TraceSpan();
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+  Tracer *ActiveTracer;
+  const char *Name;
+  std::string Detail;
+  std::chrono::steady_clock::time_point Start;
+  // Time spent in spans nested directly inside this one.
+  uint64_t NestedMicroseconds;
+  // The span this one is nested in on the same thread.
+  TraceSpan *Enclosing;
+};
+
+} // namespace LibScopeView
+
+#endif // TRACE_H
@@ -28,6 +28,7 @@
 
 #include "Type.h"
 #include "FileUtilities.h"
+#include "JSONWriter.h"
 #include "PrintSettings.h"
 #include "Scope.h"
 #include "StringPool.h"
@@ -84,13 +85,17 @@ void formulateTypeNameImpl(const Object *Obj, std::string &Qualifiers,
 void Type::formulateTypeName(const PrintSettings &Settings) {
   if (!getName().empty() || isa<TypeTemplateParam>(*this))
     return;
+  setName(getFormulatedTypeName(Settings.ShowVoid));
+}
+
+std::string Type::getFormulatedTypeName(bool ShowVoid) const {
   std::string Qualifiers;
   std::string Base;
   std::string Modifiers;
   formulateTypeNameImpl(this, Qualifiers, Base, Modifiers);
-  if (Base.empty() && Settings.ShowVoid)
+  if (Base.empty() && ShowVoid)
     Base = "void";
-  setName(trim(Qualifiers + Base + Modifiers));
+  return trim(Qualifiers + Base + Modifiers);
 }
 
 const std::string &Type::getValue() const {
@@ -134,6 +139,32 @@ std::string Type::getAsYAML() const {
   return YAML.str();
 }
 
+void Type::writeJSON(JSONWriter &JSON) const {
+  assert(getIsBaseType());
+
+  // We can't use writeCommonJSON here as the name is written as the type.
+  JSON.key("object");
+  JSON.string(getKindAsString());
+  JSON.key("name");
+  JSON.null();
+  JSON.key("type");
+  JSON.string(getName());
+  JSON.key("line");
+  JSON.null();
+  JSON.key("file");
+  JSON.null();
+  JSON.key("offset");
+  JSON.number(getDieOffset());
+  JSON.key("tag");
+  writeTagJSON(JSON, getDieTag());
+
+  JSON.key("attributes");
+  JSON.beginObject();
+  JSON.key("size");
+  JSON.number(getByteSize());
+  JSON.endObject();
+}
+
 unsigned Type::getByteSize() const { return ByteSize; }
 
 void Type::setByteSize(unsigned Size) { ByteSize = Size; }
@@ -157,6 +188,13 @@ std::string TypeDefinition::getAsYAML() const {
   return getCommonYAML() + std::string("\nattributes: {}");
 }
 
+void TypeDefinition::writeJSON(JSONWriter &JSON) const {
+  writeCommonJSON(JSON);
+  JSON.key("attributes");
+  JSON.beginObject();
+  JSON.endObject();
+}
+
 const std::string &TypeEnumerator::getValue() const {
   return ValueRef ? *ValueRef : EmptyString;
 }
@@ -182,6 +220,10 @@ std::string TypeEnumerator::getAsYAML() const {
   return "";
 }
 
+void TypeEnumerator::writeJSON(JSONWriter &) const {
+  // Writing enumerators is handled in ScopeEnumeration.
+}
+
 AccessSpecifier TypeImport::getInheritanceAccess() const {
   assert(getIsInheritance() &&
          "getInheritanceAccess only valid for inheritance");
@@ -266,6 +308,15 @@ std::string TypeImport::getAsYAML() const {
   return getUsingAsYAML();
 }
 
+void TypeImport::writeJSON(JSONWriter &JSON) const {
+  // If type import is inheritance, then this object is written as an
+  // attribute of the aggregate.
+  if (!getIsPrintedAsObject())
+    writeInheritanceJSON(JSON);
+  else
+    writeUsingJSON(JSON);
+}
+
 std::string
 TypeImport::getInheritanceAsYAML() const {
   std::stringstream Result;
@@ -344,6 +395,89 @@ std::string TypeImport::getUsingAsYAML() const {
   return Result.str();
 }
 
+void TypeImport::writeInheritanceJSON(JSONWriter &JSON) const {
+  if (!getIsInheritance())
+    return;
+
+  JSON.key("parent");
+  if (getType())
+    JSON.string(getType()->getName());
+  else
+    JSON.string("");
+
+  JSON.key("access_specifier");
+  switch (getInheritanceAccess()) {
+  case AccessSpecifier::Private:
+    JSON.string("private");
+    break;
+  case AccessSpecifier::Protected:
+    JSON.string("protected");
+    break;
+  case AccessSpecifier::Public:
+    JSON.string("public");
+    break;
+  case AccessSpecifier::Unspecified:
+    assert(getParent());
+    if (getParent() && getParent()->getIsClassType())
+      JSON.string("private");
+    else
+      JSON.string("public");
+  }
+}
+
+void TypeImport::writeUsingJSON(JSONWriter &JSON) const {
+  // Determine the UsingType and name for the Using object, as for YAML.
+  const char *UsingType = nullptr;
+  std::string Name;
+  Object *ObjType = getType();
+  if (ObjType) {
+    Scope *Parent = ObjType->getParent();
+    if (getIsImportedModule())
+      UsingType = "namespace";
+    else if (getIsImportedDeclaration()) {
+      if (isa<Type>(*ObjType) || isa<ScopeAggregate>(*ObjType))
+        UsingType = "type";
+      else if (isa<ScopeFunction>(*ObjType))
+        UsingType = "function";
+      else if (Symbol *Sym = dyn_cast<Symbol>(ObjType))
+        if (Sym->getIsVariable() || Sym->getIsMember())
+          UsingType = "variable";
+    }
+
+    if (Parent != nullptr && !isa<ScopeCompileUnit>(*Parent))
+      Parent->getQualifiedName(Name);
+    if (!Name.empty())
+      Name.append("::");
+    Name.append(ObjType->getName());
+  }
+
+  // We can't use writeCommonJSON here as it writes the name of the Using as
+  // its type.
+  JSON.key("object");
+  JSON.string(getKindAsString());
+  JSON.key("name");
+  JSON.string(Name);
+  JSON.key("type");
+  JSON.null();
+  JSON.key("line");
+  JSON.number(getLineNumber());
+  JSON.key("file");
+  writeFileNameJSON(JSON, *this);
+  JSON.key("offset");
+  JSON.number(getDieOffset());
+  JSON.key("tag");
+  writeTagJSON(JSON, getDieTag());
+
+  JSON.key("attributes");
+  JSON.beginObject();
+  JSON.key("using_type");
+  if (UsingType)
+    JSON.string(UsingType);
+  else
+    JSON.null();
+  JSON.endObject();
+}
+
 const std::string &TypeTemplateParam::getValue() const {
   return ValueRef ? *ValueRef : EmptyString;
 }
@@ -408,4 +542,34 @@ std::string TypeTemplateParam::getAsYAML() const {
   return YAML.str();
 }
 
+void TypeTemplateParam::writeJSON(JSONWriter &JSON) const {
+  writeCommonJSON(JSON);
+  JSON.key("attributes");
+  JSON.beginObject();
+  JSON.key("types");
+  JSON.beginArray();
+  writeJSONValue(JSON);
+  JSON.endArray();
+  JSON.endObject();
+}
+
+void TypeTemplateParam::writeJSONValue(JSONWriter &JSON) const {
+  if (getIsTemplateType()) {
+    JSON.beginString();
+    JSON.appendString(getTypeQualifiedName());
+    if (getType())
+      JSON.appendString(getType()->getName());
+    JSON.endString();
+  } else if (getIsTemplateValue()) {
+    // Values that couldn't be read are left empty.
+    if (getValue().empty())
+      JSON.null();
+    else
+      JSON.string(getValue());
+  } else {
+    assert(getIsTemplateTemplate());
+    JSON.string(getValue());
+  }
+}
+
 TypeSubrange::~TypeSubrange() {}
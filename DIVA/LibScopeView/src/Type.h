@@ -31,6 +31,8 @@
 
 #include "Object.h"
 
+#include <bitset>
+
 namespace LibScopeView {
 
 /// \brief Class to represent a DWARF Type object.
@@ -72,6 +74,8 @@ private:
 public:
   /// \brief Work out and set the full name for the type.
   void formulateTypeName(const PrintSettings &Settings);
+  /// \brief Work out the full name for the type from the types it modifies.
+  std::string getFormulatedTypeName(bool ShowVoid) const;
 
   bool getIsBaseType() const { return TypeAttributesFlags[IsBaseType]; }
   void setIsBaseType() { TypeAttributesFlags.set(IsBaseType); }
@@ -149,6 +153,8 @@ public:
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 
 private:
   // DW_AT_byte_size for PrimitiveType.
@@ -174,6 +180,8 @@ public:
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 };
 
 /// \brief Class to represent a DW_TAG_enumerator
@@ -199,6 +207,8 @@ public:
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 };
 
 /// \brief Class to represent DW_TAG_imported_module /
@@ -227,6 +237,8 @@ public:
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
 
 private:
   virtual std::string getInheritanceAsText(const PrintSettings &Settings) const;
@@ -234,6 +246,10 @@ private:
   // Gets a YAML representation of DIVA Object as an Inheritance attribute.
   virtual std::string getInheritanceAsYAML() const;
   virtual std::string getUsingAsYAML() const;
+  // Writes the JSON members of the object as an Inheritance attribute, or as
+  // a Using object.
+  void writeInheritanceJSON(JSONWriter &JSON) const;
+  void writeUsingJSON(JSONWriter &JSON) const;
 };
 
 /// \brief Class to represent a DWARF Template parameter holder.
@@ -262,6 +278,11 @@ public:
   std::string getAsText(const PrintSettings &Settings) const override;
   /// \brief Returns a YAML representation of this DIVA Object.
   std::string getAsYAML() const override;
+  /// \brief Writes a JSON representation of this DIVA Object.
+  void writeJSON(JSONWriter &JSON) const override;
+  /// \brief Writes the type, value or template of the parameter as a JSON
+  /// value, as listed in the attributes of it or its template pack.
+  void writeJSONValue(JSONWriter &JSON) const;
 };
 
 /// \brief Class to represent a DW_TAG_subrange_type
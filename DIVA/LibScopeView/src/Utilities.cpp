@@ -28,12 +28,22 @@
 //===----------------------------------------------------------------------===//
 
 #include "Utilities.h"
+#include "Error.h"
 #include "Platform.h"
 #include "StringPool.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <exception>
+#include <future>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #ifdef PLATFORM_WIN
 #include <Windows.h>
@@ -41,6 +51,9 @@
 #else
 #include <fstream>
 #include <sstream>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif // __GLIBC__
 #endif // PLATFORM_WIN
 
 using namespace LibScopeView;
@@ -54,6 +67,29 @@ void LibScopeView::initialize() {
 
 void LibScopeView::terminate() {}
 
+#ifndef PLATFORM_WIN
+namespace {
+
+// Read the size from the line of /proc/self/status starting with Prefix.
+size_t readProcStatusSize(const std::string &Prefix) {
+  size_t Size = 0;
+  std::ifstream StatusStream("/proc/self/status", std::ios_base::in);
+  std::string Ln;
+  while (std::getline(StatusStream, Ln)) {
+    if (Ln.compare(0, Prefix.size(), Prefix) == 0) {
+      // Read in the number after the prefix which is the usage in kB.
+      std::stringstream LineStream(Ln.substr(Prefix.size()));
+      LineStream >> Size;
+      Size = LineStream.fail() ? 0 : Size * 1024;
+      break;
+    }
+  }
+  return Size;
+}
+
+} // namespace
+#endif // PLATFORM_WIN
+
 size_t  LibScopeView::getPeakMemoryUsage() {
   size_t Size = 0;
 
@@ -63,32 +99,59 @@ size_t  LibScopeView::getPeakMemoryUsage() {
     Size = PMC.PeakWorkingSetSize;
   }
 #else
-  std::ifstream StatusStream("/proc/self/status", std::ios_base::in);
-  std::string Ln;
-  // Look through /proc/self/status for the line starting with "VmHWM:"
   // VmHWM is the peak physical memory used by the process.
-  std::string MemPrefix("VmHWM:");
-  while (std::getline(StatusStream, Ln)) {
-    if (Ln.compare(0, MemPrefix.size(), MemPrefix) == 0) {
-      // Read in the number after "VmHWM:" which is the usage in kB.
-      std::stringstream LineStream(Ln.substr(MemPrefix.size()));
-      LineStream >> Size;
-      Size = LineStream.fail() ? 0 : Size * 1024;
-      break;
-    }
+  Size = readProcStatusSize("VmHWM:");
+#endif // PLATFORM_WIN
+
+  return Size;
+}
+
+size_t LibScopeView::getCurrentMemoryUsage() {
+  size_t Size = 0;
+
+#ifdef PLATFORM_WIN
+  PROCESS_MEMORY_COUNTERS PMC;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &PMC, sizeof(PMC))) {
+    Size = PMC.WorkingSetSize;
   }
+#else
+  // VmRSS is the physical memory currently used by the process.
+  Size = readProcStatusSize("VmRSS:");
 #endif // PLATFORM_WIN
 
   return Size;
 }
 
-void LibScopeView::printMemoryUsage(size_t MemoryUsage) {
+size_t LibScopeView::getHeapMemoryUsage() {
+  size_t Size = 0;
+
+#if defined(PLATFORM_WIN)
+  PROCESS_MEMORY_COUNTERS_EX PMC;
+  if (GetProcessMemoryInfo(GetCurrentProcess(),
+                           reinterpret_cast<PROCESS_MEMORY_COUNTERS *>(&PMC),
+                           sizeof(PMC))) {
+    Size = PMC.PrivateUsage;
+  }
+#elif defined(__GLIBC__)
+  // Bytes in use from the main arena plus large blocks allocated by mmap.
+#if __GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33)
+  struct mallinfo2 Info = mallinfo2();
+#else
+  struct mallinfo Info = mallinfo();
+#endif
+  Size = static_cast<size_t>(Info.uordblks) + static_cast<size_t>(Info.hblkhd);
+#endif // PLATFORM_WIN
+
+  return Size;
+}
+
+void LibScopeView::printMemoryUsage(size_t MemoryUsage, std::ostream &Out) {
   // Breakup memory usage into different chunks (XXX,XXX,XXX kb).
   auto MemoryUsedkB = (MemoryUsage / 1000) % 1000;
   auto MemoryUsedmB = (MemoryUsage / 1000000) % 1000;
   auto MemoryUsedgB = (MemoryUsage / 1000000000);
 
-  // Avoid using manipulators on std::cout directly.
+  // Avoid using manipulators on Out directly.
   std::stringstream Result;
   Result << "\nPeak Memory Usage: ";
   if (MemoryUsedgB > 0) {
@@ -103,7 +166,7 @@ void LibScopeView::printMemoryUsage(size_t MemoryUsage) {
   }
   Result << " KB\n";
 
-  std::cout << Result.str();
+  Out << Result.str();
 }
 
 std::chrono::steady_clock::time_point LibScopeView::getCurrentTime() {
@@ -112,12 +175,202 @@ std::chrono::steady_clock::time_point LibScopeView::getCurrentTime() {
 
 void LibScopeView::printTimeTaken(
     const std::chrono::steady_clock::time_point &StartTime,
-    const std::chrono::steady_clock::time_point &EndTime) {
+    const std::chrono::steady_clock::time_point &EndTime, std::ostream &Out) {
   typedef std::chrono::duration<double, std::ratio<1>> Seconds;
   double TimeTaken =
       std::chrono::duration_cast<Seconds>(EndTime - StartTime).count();
-  std::cout << "\nTime taken: " << std::setprecision(2) << TimeTaken
-            << " seconds\n";
+  // Avoid using manipulators on Out directly.
+  std::stringstream Result;
+  Result << "\nTime taken: " << std::setprecision(2) << TimeTaken
+         << " seconds\n";
+  Out << Result.str();
+}
+
+namespace {
+
+// The number of threads that tasks running on this thread may use, or 0 when
+// not running a task (one per hardware thread). The threads of a call share
+// its budget, so nested calls don't multiply the threads of the process.
+thread_local unsigned ThreadBudget = 0;
+
+unsigned getThreadBudget() {
+  return ThreadBudget ? ThreadBudget
+                      : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Set the calling thread's budget for the lifetime of the object.
+class ThreadBudgetScope {
+public:
+  explicit ThreadBudgetScope(unsigned Budget) : Previous(ThreadBudget) {
+    ThreadBudget = Budget;
+  }
+  ~ThreadBudgetScope() { ThreadBudget = Previous; }
+
+private:
+  unsigned Previous;
+};
+
+// Get the number of threads to use for ThreadCount (0 for the calling
+// thread's budget), with at most one per task.
+size_t getWorkerCount(unsigned ThreadCount, size_t TaskCount) {
+  if (ThreadCount == 0)
+    ThreadCount = getThreadBudget();
+  return std::max<size_t>(1, std::min<size_t>(ThreadCount, TaskCount));
+}
+
+// Get the budget of each of WorkerCount threads sharing the calling thread's.
+unsigned getWorkerBudget(size_t WorkerCount) {
+  return std::max(1u, static_cast<unsigned>(getThreadBudget() / WorkerCount));
+}
+
+// Start a thread running Tasks with a thread budget of Budget, on which fatal
+// errors are thrown rather than exiting the process under the other threads.
+std::future<void> startWorker(std::function<void()> Tasks, unsigned Budget) {
+  return std::async(std::launch::async, [Tasks, Budget]() {
+    struct ThrowOnExitScope {
+      ThrowOnExitScope() { LibScopeError::setThreadThrowOnExit(true); }
+      ~ThrowOnExitScope() { LibScopeError::setThreadThrowOnExit(false); }
+    } ThrowOnExit;
+    ThreadBudgetScope BudgetScope(Budget);
+    Tasks();
+  });
+}
+
+// Wait for the Workers, and then report the first error thrown on any thread
+// (FirstError if set) as fatalError would have.
+void joinWorkers(std::vector<std::future<void>> &Workers,
+                 std::exception_ptr FirstError, bool ThrowOnExit) {
+  for (auto &Worker : Workers) {
+    try {
+      Worker.get();
+    } catch (...) {
+      if (!FirstError)
+        FirstError = std::current_exception();
+    }
+  }
+  LibScopeError::setThreadThrowOnExit(ThrowOnExit);
+
+  if (FirstError) {
+    try {
+      std::rethrow_exception(FirstError);
+    } catch (LibScopeError::ExitException &Exit) {
+      LibScopeError::exitProcess(Exit.getStatus(), Exit.getMessage());
+    }
+  }
+}
+
+} // namespace
+
+void LibScopeView::runInParallel(size_t TaskCount, unsigned ThreadCount,
+                                 const std::function<void(size_t)> &Task) {
+  std::atomic<size_t> NextTask(0);
+  auto RunTasks = [&]() {
+    for (size_t I = NextTask++; I < TaskCount; I = NextTask++) {
+      try {
+        Task(I);
+      } catch (...) {
+        // Stop the other threads taking more tasks.
+        NextTask = TaskCount;
+        throw;
+      }
+    }
+  };
+  size_t WorkerCount = getWorkerCount(ThreadCount, TaskCount);
+  unsigned Budget = getWorkerBudget(WorkerCount);
+
+  // Fatal errors are thrown while the threads run, so that the process
+  // doesn't exit under them, and then reported on this thread. Only the
+  // threads of this call throw, so other callers' errors are unaffected.
+  bool ThrowOnExit = LibScopeError::getThreadThrowOnExit();
+  LibScopeError::setThreadThrowOnExit(true);
+  std::vector<std::future<void>> Workers;
+  for (size_t I = 1; I < WorkerCount; ++I)
+    Workers.push_back(startWorker(RunTasks, Budget));
+  std::exception_ptr FirstError;
+  try {
+    ThreadBudgetScope BudgetScope(Budget);
+    RunTasks();
+  } catch (...) {
+    FirstError = std::current_exception();
+  }
+  joinWorkers(Workers, FirstError, ThrowOnExit);
+}
+
+void LibScopeView::runInOrder(size_t TaskCount, unsigned ThreadCount,
+                              size_t WindowSize,
+                              const std::function<void(size_t)> &Produce,
+                              const std::function<void(size_t)> &Consume) {
+  assert(WindowSize > 0 && "No task could be produced");
+  std::mutex Mutex;
+  std::condition_variable Changed;
+  std::vector<bool> Produced(TaskCount);
+  size_t NextTask = 0;
+  size_t NextConsumed = 0;
+  bool Stop = false;
+
+  auto StopTasks = [&]() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Stop = true;
+    Changed.notify_all();
+  };
+  auto ProduceTasks = [&]() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    for (;;) {
+      Changed.wait(Lock, [&]() {
+        return Stop || NextTask == TaskCount ||
+               NextTask - NextConsumed < WindowSize;
+      });
+      if (Stop || NextTask == TaskCount)
+        return;
+      size_t I = NextTask++;
+      Lock.unlock();
+      try {
+        Produce(I);
+      } catch (...) {
+        StopTasks();
+        throw;
+      }
+      Lock.lock();
+      Produced[I] = true;
+      Changed.notify_all();
+    }
+  };
+  size_t WorkerCount = getWorkerCount(ThreadCount, TaskCount);
+  unsigned Budget = getWorkerBudget(WorkerCount);
+
+  // Errors are handled as for runInParallel.
+  bool ThrowOnExit = LibScopeError::getThreadThrowOnExit();
+  LibScopeError::setThreadThrowOnExit(true);
+  std::vector<std::future<void>> Workers;
+  for (size_t I = 1; I < WorkerCount; ++I)
+    Workers.push_back(startWorker(ProduceTasks, Budget));
+  std::exception_ptr FirstError;
+  try {
+    ThreadBudgetScope BudgetScope(Budget);
+    for (size_t I = 0; I < TaskCount; ++I) {
+      std::unique_lock<std::mutex> Lock(Mutex);
+      if (NextTask == I) {
+        // No other thread has taken the task, so produce it here rather than
+        // wait.
+        ++NextTask;
+        Lock.unlock();
+        Produce(I);
+      } else {
+        Changed.wait(Lock, [&]() { return Stop || Produced[I]; });
+        if (Stop)
+          break;
+        Lock.unlock();
+      }
+      Consume(I);
+      Lock.lock();
+      ++NextConsumed;
+      Changed.notify_all();
+    }
+  } catch (...) {
+    FirstError = std::current_exception();
+  }
+  StopTasks();
+  joinWorkers(Workers, FirstError, ThrowOnExit);
 }
 
 std::string LibScopeView::trim(const std::string &text) {
@@ -31,6 +31,8 @@
 #define UTILITIES_H
 
 #include <chrono>
+#include <functional>
+#include <iostream>
 #include <string>
 
 namespace LibScopeView {
@@ -46,15 +48,46 @@ void terminate();
 /// \brief Get the peak memory usage of the current executable.
 size_t getPeakMemoryUsage();
 
-/// \brief Print program memory usage to std::cout.
-void printMemoryUsage(size_t MemoryUsage);
+/// \brief Get the current memory usage of the current executable.
+size_t getCurrentMemoryUsage();
+
+/// \brief Get the number of bytes allocated from the heap and not yet freed
+/// (the private bytes on Windows), or 0 if it is not known.
+size_t getHeapMemoryUsage();
+
+/// \brief Print program memory usage to Out.
+void printMemoryUsage(size_t MemoryUsage, std::ostream &Out = std::cout);
 
 /// \brief Get the current time.
 std::chrono::steady_clock::time_point getCurrentTime();
 
-/// \brief Print the program run time to std::cout.
+/// \brief Print the program run time to Out.
 void printTimeTaken(const std::chrono::steady_clock::time_point &StartTime,
-                    const std::chrono::steady_clock::time_point &EndTime);
+                    const std::chrono::steady_clock::time_point &EndTime,
+                    std::ostream &Out = std::cout);
+
+/// \brief Call Task with each index from 0 to TaskCount - 1, on up to
+/// ThreadCount threads (0 for one per hardware thread) including the calling
+/// thread. Each thread takes the next index that no other thread has taken.
+/// Fatal errors in the tasks are reported once every thread has stopped.
+///
+/// The threads share the hardware threads of the calling thread, so that a
+/// call made from a task with a ThreadCount of 0 uses only its thread's share
+/// (running serially if that is one) rather than starting one thread per
+/// hardware thread again.
+void runInParallel(size_t TaskCount, unsigned ThreadCount,
+                   const std::function<void(size_t)> &Task);
+
+/// \brief Call Produce with each index from 0 to TaskCount - 1 on up to
+/// ThreadCount threads as runInParallel does, and Consume with each index in
+/// order on the calling thread as soon as it has been produced.
+///
+/// No index is produced WindowSize or more indices ahead of the next one to
+/// consume, which bounds the results waiting to be consumed. The calling
+/// thread produces the next index itself if no other thread has taken it.
+void runInOrder(size_t TaskCount, unsigned ThreadCount, size_t WindowSize,
+                const std::function<void(size_t)> &Produce,
+                const std::function<void(size_t)> &Consume);
 
 /// \brief Remove leading and trailing spaces.
 std::string trim(const std::string &Text);
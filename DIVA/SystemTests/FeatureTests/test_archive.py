@@ -0,0 +1,35 @@
+import py
+
+this_dir = py.path.local(__file__).dirpath()
+
+
+def write_archive(path, names):
+    """Write a GNU static archive of the named objects in this directory."""
+    with open(str(path), 'wb') as archive:
+        archive.write(b'!<arch>\n')
+        for name in names:
+            data = this_dir.join(name).read_binary()
+            header = '{:<16}{:<12}{:<6}{:<6}{:<8}{:<10}`\n'.format(
+                name + '/', 0, 0, 0, 644, len(data))
+            archive.write(header.encode('ascii'))
+            archive.write(data)
+            if len(data) % 2:
+                archive.write(b'\n')
+
+
+def test_archive(diva, tmpdir_autodel):
+    write_archive(tmpdir_autodel.join('lib.a'), ['simple.o', 'all_objects.o'])
+    separate = diva('simple.o all_objects.o')
+    from_archive = diva('lib.a')
+    assert '{InputFile} "lib.a(simple.o)"' in from_archive
+    assert from_archive.replace('lib.a(simple.o)', 'simple.o').replace(
+        'lib.a(all_objects.o)', 'all_objects.o') == separate
+
+
+def test_archive_output_dir(diva, tmpdir_autodel):
+    write_archive(tmpdir_autodel.join('lib.a'), ['simple.o', 'all_objects.o'])
+    output_dir = tmpdir_autodel.join('split')
+    diva('lib.a --output-dir={}'.format(output_dir))
+    assert output_dir.join('simple_o', 'simple_cpp.txt').check(file=True)
+    assert output_dir.join('all_objects_o', 'all_objects_cpp.txt').check(
+        file=True)
@@ -0,0 +1,37 @@
+"""
+Test --list-cus, which lists the compile units from their headers, and --cu,
+which only reads the matching compile units.
+"""
+from test_archive import write_archive
+
+
+def test_list_cus(diva):
+    expected = '''{InputFile} "simple.o"
+
+Offset      Size  Version  Language             Name          Producer
+0x00000000  119   4        DW_LANG_C_plus_plus  "simple.cpp"  "clang version 4.0.1-svn305187-1~exp1 (branches/release_40)"
+'''
+    assert diva('simple.o --list-cus') == expected
+
+
+def test_list_cus_filtered(diva):
+    listed = diva('simple.o all_objects.o --list-cus --cu=all_*')
+    assert '"all_objects.cpp"' in listed
+    assert '"simple.cpp"' not in listed
+    assert listed.count('{InputFile}') == 2
+
+
+def test_list_cus_archive(diva, tmpdir_autodel):
+    write_archive(tmpdir_autodel.join('lib.a'), ['simple.o', 'all_objects.o'])
+    from_archive = diva('lib.a --list-cus')
+    assert from_archive.replace('lib.a(simple.o)', 'simple.o').replace(
+        'lib.a(all_objects.o)', 'all_objects.o') == diva(
+            'simple.o all_objects.o --list-cus')
+
+
+def test_cu(diva):
+    # The units that don't match are left out, without a warning.
+    assert diva('simple.o all_objects.o --cu=simple.*') == diva(
+        'simple.o') + '{InputFile} "all_objects.o"\n'
+    assert diva('all_objects.o --cu=all_objects.* --cu=other.*') == diva(
+        'all_objects.o')
@@ -0,0 +1,33 @@
+"""
+Test --compress, which writes the output as a gzip file.
+"""
+import gzip
+import py
+import subprocess
+
+test_dir = py.path.local(__file__).dirpath()
+
+
+def run_diva(args, cwd):
+    proc = subprocess.Popen(['diva'] + args, cwd=str(cwd),
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    stdout, stderr = proc.communicate()
+    return proc.returncode, stdout, stderr.decode()
+
+
+def test_compress(diva, tmpdir_autodel):
+    expected = diva('simple.o')
+    status, compressed, _ = run_diva(['simple.o', '--compress'],
+                                     tmpdir_autodel)
+    assert status == 0
+    assert gzip.decompress(compressed).decode() == expected
+
+
+def test_compress_with_error(diva, tmpdir_autodel):
+    # The output printed before a fatal error is still a complete gzip file.
+    expected = diva('simple.o')
+    status, compressed, errors = run_diva(
+        ['simple.o', 'missing.o', '--compress'], tmpdir_autodel)
+    assert status == 1
+    assert 'ERR_FILE_NOT_FOUND' in errors
+    assert gzip.decompress(compressed).decode() == expected
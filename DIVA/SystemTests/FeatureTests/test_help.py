@@ -21,7 +21,10 @@ Output options
                                compile unit's output in a separate file. If no
                                dir is given, then diva will use the input_file
                                string to create an output directory.
-      --output=<text|yaml>     A comma separated list of output formats.
+      --output=<json|ndjson|text|yaml>
+                               A comma separated list of output formats.
+      --compress               Compress the output with gzip. The --output-dir
+                               files are given a ".gz" extension.
 
 Sort options
       --sort=<line|name|offset>
@@ -38,10 +41,61 @@ Filter options
       --tree=<text>            Same as --filter, except the whole subtree of any
                                matching object will printed.
       --tree-any=<text>        Same as --filter-any with the whole subtree.
+
+Find options
+      --find=<name>            Instead of the logical view, print the objects
+                               named <name>, or with the qualified name <name>
+                               (e.g. ns::Class::method), and the scopes that
+                               contain them. The names are indexed once, so many
+                               queries cost little more than one.
+      --find-prefix=<text>     Same as --find for the names starting with
+                               <text>.
+      --find-regex=<regex>     Same as --find for the names matching <regex>.
+
+Address lookup options
+      --lookup=<address>       Instead of the logical view, print the innermost
+                               function, inlined functions and blocks, and the
+                               line, that contain the hexadecimal code
+                               <address>. Only the compile units .debug_aranges
+                               shows to contain an address are read.
+      --lookup-stdin           Same as --lookup for each address read from
+                               standard input, separated by whitespace.
+
+Compile unit options
+      --list-cus               Instead of the logical view, list the offset,
+                               size and DWARF version of each compile unit from
+                               its header, and its language, name and producer
+                               from its root DIE. No other DIEs are read.
+      --cu=<glob>              Only read (or list) the compile units whose name
+                               matches <glob>, or whose whole path matches if
+                               <glob> contains a '/'. The other units are
+                               skipped, apart from the DIEs that the units read
+                               reference in them, which are read with the scopes
+                               that contain them.
 """),
     ('--help-more', """\
 Usage: Diva [options] input_file [input_file...]
 
+Input options
+      --input-dir=<dir>        Read every ELF file with debug information, and
+                               every static archive, in <dir> and its
+                               subdirectories. The files found are read on a
+                               pool of threads, largest first, and printed in
+                               order. Any summary table is of all the files.
+      --input-include=<glob>   Only read the --input-dir files whose name
+                               matches <glob>, or whose path under <dir> matches
+                               if <glob> contains a '/'.
+      --input-exclude=<glob>   Skip the --input-dir files that match <glob>, as
+                               for --input-include.
+      --input-list=<file>      Same as --input-dir for the files listed in
+                               <file>, one per line, or read from standard input
+                               if <file> is "-".
+
+Incremental options
+      --incremental            Save the objects read from each input file to
+                               <file>.divastate and on later runs only read the
+                               compile units that have changed since.
+
 More object options
       --show-none              Print no objects, use this to hide all default
                                objects and then individual objects can be added
@@ -77,6 +131,18 @@ The options labeled with a star (*) are enabled by default or when
       --show-union             Print unions*
       --show-using             Print using instances*
       --show-variable          Print variables*
+
+Server options
+      --serve=<socket>         Run as a server listening on the local socket
+                               <socket>, keeping the Scope trees of recently
+                               used input files in memory. Any input files given
+                               are loaded when the server starts.
+      --serve-cache-size=<MB>  The most memory the server's cached Scope trees
+                               may use, the least recently used trees are
+                               discarded first. By default 1024.
+      --connect=<socket>       Send the other options and input files to the
+                               server listening on <socket> and print its
+                               output.
 """),
     ('--help-advanced', """\
 Usage: Diva [options] input_file [input_file...]
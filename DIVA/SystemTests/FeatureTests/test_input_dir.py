@@ -0,0 +1,49 @@
+import py
+
+this_dir = py.path.local(__file__).dirpath()
+
+
+def make_tree(root):
+    """Copy the test objects, and a file without debug information, into a
+    directory tree under root."""
+    objects = root.join('objects')
+    objects.join('sub').ensure(dir=True)
+    this_dir.join('all_objects.o').copy(objects.join('all_objects.o'))
+    this_dir.join('simple.o').copy(objects.join('sub', 'simple.o'))
+    objects.join('sub', 'readme.txt').write('not an object')
+    return ['objects/all_objects.o', 'objects/sub/simple.o']
+
+
+def test_input_dir(diva, tmpdir_autodel):
+    paths = make_tree(tmpdir_autodel)
+    expected = diva(paths, getelfs=False)
+    assert diva('--input-dir=objects', getelfs=False) == expected
+    assert diva('--input-dir=objects/', getelfs=False) == expected
+
+
+def test_input_dir_globs(diva, tmpdir_autodel):
+    paths = make_tree(tmpdir_autodel)
+    assert (diva('--input-dir=objects --input-include=s*.o', getelfs=False) ==
+            diva(paths[1:], getelfs=False))
+    assert (diva('--input-dir=objects --input-exclude=sub/*', getelfs=False) ==
+            diva(paths[:1], getelfs=False))
+
+
+def test_input_list(diva, tmpdir_autodel):
+    paths = make_tree(tmpdir_autodel)
+    tmpdir_autodel.join('inputs.txt').write(
+        '\n'.join(reversed(paths + ['objects/sub/readme.txt'])) + '\n')
+    assert (diva('--input-list=inputs.txt', getelfs=False) ==
+            diva(list(reversed(paths)), getelfs=False))
+
+
+def test_input_dir_summary(diva, tmpdir_autodel):
+    make_tree(tmpdir_autodel)
+    output = diva('--input-dir=objects --show-summary', getelfs=False)
+    assert output.count('Totals') == 1
+
+
+def test_input_dir_missing(diva):
+    returncode, output = diva('--input-dir=missing', nonzero=True)
+    assert returncode != 0
+    assert 'missing' in output
@@ -0,0 +1,76 @@
+"""
+Test the JSON and NDJSON output formats.
+"""
+import json
+import pytest
+import yaml
+
+
+def summary(objects):
+    """The object, name, type, line and children of each object."""
+    return [(obj['object'], obj['name'], obj['type'], obj['line'],
+             summary(obj['children'])) for obj in objects]
+
+
+def yaml_summary(objects):
+    return [(obj['object'], obj['name'], obj['type'], obj['source']['line'],
+             yaml_summary(obj['children'])) for obj in objects]
+
+
+@pytest.mark.parametrize('name', ('all_objects.o', 'simple.o'))
+def test_json(diva, name):
+    output = json.loads(diva('{} --show-all --output=json'.format(name)))
+    assert output['input_file'] == name
+    assert output['output_version'] == '0.1'
+
+    expected = yaml.safe_load(diva('{} --show-all --output=yaml'.format(name)))
+    assert summary(output['objects']) == yaml_summary(expected['objects'])
+
+
+@pytest.mark.parametrize('name', ('all_objects.o', 'simple.o'))
+def test_ndjson(diva, name):
+    lines = diva('{} --show-all --output=ndjson'.format(name)).splitlines()
+    header = json.loads(lines[0])
+    assert header == {'input_file': name, 'output_version': '0.1'}
+
+    # Rebuild the tree from the records, each of which follows its parent.
+    roots = []
+    records = []
+    for index, line in enumerate(lines[1:]):
+        record = json.loads(line)
+        assert record.pop('id') == index
+        parent = record.pop('parent')
+        record['children'] = []
+        if parent is None:
+            roots.append(record)
+        else:
+            assert parent < index
+            records[parent]['children'].append(record)
+        records.append(record)
+
+    expected = json.loads(diva('{} --show-all --output=json'.format(name)))
+    assert roots == expected['objects']
+
+
+@pytest.mark.parametrize('output, extension', (('json', 'json'),
+                                               ('ndjson', 'ndjson')))
+def test_split(diva, tmpdir_autodel, output, extension):
+    split_dir = tmpdir_autodel.join('example_16_CUs')
+    command = 'example_16.elf --show-all --output={}'.format(output)
+    assert diva(command + ' --output-dir={}'.format(split_dir)) == ''
+
+    outfiles = ('example_16_cpp', 'example_16_global_cpp',
+                'example_16_local_cpp')
+    for outfile in outfiles:
+        outfile = split_dir.join('{}.{}'.format(outfile, extension))
+        assert outfile.check(file=True)
+        contents = outfile.read()
+        if output == 'json':
+            objects = json.loads(contents)['objects']
+            assert [obj['object'] for obj in objects] == ['CompileUnit']
+        else:
+            lines = contents.splitlines()
+            assert json.loads(lines[0])['input_file'] == 'example_16.elf'
+            roots = [json.loads(line) for line in lines[1:]]
+            roots = [obj for obj in roots if obj['parent'] is None]
+            assert [obj['object'] for obj in roots] == ['CompileUnit']
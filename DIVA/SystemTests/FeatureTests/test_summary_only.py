@@ -0,0 +1,27 @@
+"""
+Test that --quiet --show-summary, which counts the objects without building
+the scope tree, prints the same summary as the full read.
+"""
+import pytest
+
+
+def summary_of(output):
+    """The summary table at the end of the output."""
+    return output[output.index('\n     ----'):]
+
+
+@pytest.mark.parametrize('name', ('all_objects.o', 'simple.o'))
+@pytest.mark.parametrize('options', ('', '--show-all', '--show-none',
+                                     '--show-none --show-template'))
+def test_summary_only(diva, name, options):
+    full = diva('{} --show-summary {}'.format(name, options))
+    quiet = diva('{} --show-summary --quiet {}'.format(name, options))
+    assert quiet == summary_of(full)
+
+
+def test_summary_only_unknown_tag(diva):
+    # Unknown tags need the full read, which warns about them.
+    quiet = diva('unknown_tag.o --show-summary --quiet')
+    assert quiet.startswith(
+        "\nWarning: Ignoring unknown/unsupported DWARF tag '0x000c'.\n")
+    assert quiet.endswith(summary_of(diva('unknown_tag.o --show-summary')))
@@ -0,0 +1,11 @@
+struct Point {
+    int x;
+    int y;
+};
+
+namespace ns {
+struct Shape {
+    Point Origin;
+    double Area;
+};
+}
@@ -0,0 +1,3 @@
+#include "type_units.h"
+int usePoint(Point P) { return P.x + P.y; }
+double useShape(ns::Shape *S) { return S->Area; }
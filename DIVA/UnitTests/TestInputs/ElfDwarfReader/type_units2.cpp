@@ -0,0 +1,7 @@
+#include "type_units.h"
+Point makePoint() { return Point{1, 2}; }
+ns::Shape Global;
+
+int main() {
+    return makePoint().x;
+}
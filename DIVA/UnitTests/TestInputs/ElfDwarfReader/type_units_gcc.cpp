@@ -0,0 +1,9 @@
+struct S {
+  int a;
+  int b;
+};
+
+S s{1, 2};
+extern int fa(S *);
+
+int main() { return fa(&s); }
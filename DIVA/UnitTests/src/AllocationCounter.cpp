@@ -0,0 +1,314 @@
+//===-- UnitTests/AllocationCounter.cpp -------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Replacements for the global operator new and delete that count the
+/// allocations made while counting is enabled.
+///
+//===----------------------------------------------------------------------===//
+
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif
+
+namespace {
+
+// Number of return addresses recorded for each allocation, including the
+// frames of operator new itself.
+const int CallStackDepth = 32;
+// Number of functions outside of operator new and the standard library that
+// describe a call site.
+const size_t CallSiteFunctions = 3;
+
+using CallStack = std::array<void *, CallStackDepth>;
+
+struct PhaseCounts {
+  std::atomic<uint64_t> Allocations;
+  std::atomic<uint64_t> Bytes;
+};
+
+std::atomic<bool> Counting(false);
+std::atomic<unsigned> CurrentPhase(0);
+PhaseCounts Counts[AllocationPhaseCount];
+
+// The allocations from each call stack in each phase, the functions whose
+// allocations aren't counted, and whether each return address seen so far is
+// in one of them. The maps' own allocations are made with InCounter set so
+// that they aren't counted.
+std::mutex CallStacksMutex;
+std::map<std::pair<unsigned, CallStack>, AllocationCounts> CallStacks;
+std::vector<std::string> ExcludedFunctions;
+std::map<void *, bool> ExcludedFrames;
+
+// Set while an allocation is being counted on this thread.
+thread_local bool InCounter = false;
+
+bool startsWith(const std::string &Str, const char *Prefix) {
+  return Str.compare(0, std::char_traits<char>::length(Prefix), Prefix) == 0;
+}
+
+#ifndef _WIN32
+// Get the demangled name of the function containing Address, or the module
+// and offset of the address if the function isn't exported.
+std::string getFunctionName(void *Address) {
+  Dl_info Info;
+  if (!dladdr(Address, &Info))
+    return "?";
+  if (Info.dli_sname) {
+    int Status = 0;
+    char *Demangled =
+        abi::__cxa_demangle(Info.dli_sname, nullptr, nullptr, &Status);
+    std::string Name = Status == 0 && Demangled ? Demangled : Info.dli_sname;
+    std::free(Demangled);
+    return Name;
+  }
+  std::stringstream Name;
+  Name << (Info.dli_fname ? Info.dli_fname : "?") << "+0x" << std::hex
+       << (static_cast<char *>(Address) - static_cast<char *>(Info.dli_fbase));
+  return Name.str();
+}
+
+// Return true if Stack passes through one of the ExcludedFunctions. The
+// caller must hold CallStacksMutex.
+bool isExcluded(const CallStack &Stack) {
+  if (ExcludedFunctions.empty())
+    return false;
+  for (void *Frame : Stack) {
+    if (!Frame)
+      break;
+    auto Inserted = ExcludedFrames.emplace(Frame, false);
+    if (Inserted.second) {
+      std::string Name = getFunctionName(Frame);
+      for (const std::string &Function : ExcludedFunctions)
+        Inserted.first->second |= startsWith(Name, Function.c_str());
+    }
+    if (Inserted.first->second)
+      return true;
+  }
+  return false;
+}
+
+// Return true if Name is operator new or in the standard library.
+bool isLibraryFunction(const std::string &Name) {
+  std::string Qualified = Name.substr(0, Name.find('('));
+  return startsWith(Name, "operator new") || startsWith(Name, "std::") ||
+         startsWith(Name, "__gnu_cxx::") ||
+         Qualified.find(" std::") != std::string::npos;
+}
+
+// Describe the call site of the allocation with Stack by the first few
+// functions after operator new that aren't in the standard library.
+std::string
+describeCallSite(const CallStack &Stack,
+                 std::map<void *, std::string> &FunctionNames) {
+  std::vector<const std::string *> Names;
+  size_t First = 0;
+  for (size_t I = 0; I < Stack.size() && Stack[I]; ++I) {
+    auto Inserted = FunctionNames.emplace(Stack[I], std::string());
+    if (Inserted.second)
+      Inserted.first->second = getFunctionName(Stack[I]);
+    Names.push_back(&Inserted.first->second);
+    if (startsWith(Inserted.first->second, "operator new"))
+      First = I + 1;
+  }
+
+  std::string Location;
+  size_t Functions = 0;
+  for (size_t I = First; I < Names.size() && Functions < CallSiteFunctions;
+       ++I) {
+    if (isLibraryFunction(*Names[I]))
+      continue;
+    if (Functions++)
+      Location += " <- ";
+    Location += *Names[I];
+  }
+  return Location.empty() ? "?" : Location;
+}
+#endif
+
+void countAllocation(std::size_t Size) {
+  if (!Counting.load(std::memory_order_relaxed) || InCounter)
+    return;
+  InCounter = true;
+  unsigned Phase = CurrentPhase.load(std::memory_order_relaxed);
+#ifndef _WIN32
+  CallStack Stack{};
+  backtrace(Stack.data(), CallStackDepth);
+  {
+    std::lock_guard<std::mutex> Lock(CallStacksMutex);
+    if (isExcluded(Stack)) {
+      InCounter = false;
+      return;
+    }
+    AllocationCounts &Site = CallStacks[std::make_pair(Phase, Stack)];
+    Site.Allocations += 1;
+    Site.Bytes += Size;
+  }
+#endif
+  Counts[Phase].Allocations += 1;
+  Counts[Phase].Bytes += Size;
+  InCounter = false;
+}
+
+void *allocate(std::size_t Size) {
+  countAllocation(Size);
+  if (Size == 0)
+    Size = 1;
+  while (true) {
+    if (void *Ptr = std::malloc(Size))
+      return Ptr;
+    std::new_handler Handler = std::get_new_handler();
+    if (!Handler)
+      return nullptr;
+    Handler();
+  }
+}
+
+void *allocateOrThrow(std::size_t Size) {
+  if (void *Ptr = allocate(Size))
+    return Ptr;
+  throw std::bad_alloc();
+}
+
+} // namespace
+
+void startCountingAllocations() {
+  {
+#ifndef _WIN32
+    // The first backtrace may load the unwinder, so make it before counting.
+    void *Frame;
+    backtrace(&Frame, 1);
+#endif
+    std::lock_guard<std::mutex> Lock(CallStacksMutex);
+    CallStacks.clear();
+  }
+  for (PhaseCounts &Phase : Counts) {
+    Phase.Allocations = 0;
+    Phase.Bytes = 0;
+  }
+  CurrentPhase = 0;
+  Counting = true;
+}
+
+void stopCountingAllocations() { Counting = false; }
+
+void excludeAllocationsFrom(const std::string &FunctionName) {
+  bool WasInCounter = InCounter;
+  InCounter = true;
+  {
+    std::lock_guard<std::mutex> Lock(CallStacksMutex);
+    ExcludedFunctions.push_back(FunctionName);
+    ExcludedFrames.clear();
+  }
+  InCounter = WasInCounter;
+}
+
+void setAllocationPhase(unsigned Phase) {
+  CurrentPhase = std::min(Phase, AllocationPhaseCount - 1);
+}
+
+AllocationCounts getAllocationCounts(unsigned First, unsigned Last) {
+  AllocationCounts Total;
+  for (unsigned Phase = First; Phase <= Last && Phase < AllocationPhaseCount;
+       ++Phase) {
+    Total.Allocations += Counts[Phase].Allocations;
+    Total.Bytes += Counts[Phase].Bytes;
+  }
+  return Total;
+}
+
+std::vector<AllocationCallSite> getAllocationCallSites(unsigned First,
+                                                       unsigned Last) {
+  // Don't count the allocations made while describing the call sites.
+  bool WasInCounter = InCounter;
+  InCounter = true;
+  std::map<std::string, AllocationCounts> Sites;
+#ifndef _WIN32
+  {
+    std::map<void *, std::string> FunctionNames;
+    std::lock_guard<std::mutex> Lock(CallStacksMutex);
+    for (const auto &Stack : CallStacks) {
+      if (Stack.first.first < First || Stack.first.first > Last)
+        continue;
+      AllocationCounts &Site =
+          Sites[describeCallSite(Stack.first.second, FunctionNames)];
+      Site.Allocations += Stack.second.Allocations;
+      Site.Bytes += Stack.second.Bytes;
+    }
+  }
+#endif
+  std::vector<AllocationCallSite> CallSites;
+  for (const auto &Site : Sites)
+    CallSites.push_back({Site.first, Site.second});
+  std::stable_sort(CallSites.begin(), CallSites.end(),
+                   [](const AllocationCallSite &A,
+                      const AllocationCallSite &B) {
+                     return A.Counts.Allocations > B.Counts.Allocations;
+                   });
+  InCounter = WasInCounter;
+  return CallSites;
+}
+
+// Replacements for the global allocation functions.
+
+void *operator new(std::size_t Size) { return allocateOrThrow(Size); }
+void *operator new[](std::size_t Size) { return allocateOrThrow(Size); }
+void *operator new(std::size_t Size, const std::nothrow_t &) noexcept {
+  try {
+    return allocateOrThrow(Size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new[](std::size_t Size, const std::nothrow_t &) noexcept {
+  try {
+    return allocateOrThrow(Size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void operator delete(void *Ptr) noexcept { std::free(Ptr); }
+void operator delete[](void *Ptr) noexcept { std::free(Ptr); }
+void operator delete(void *Ptr, const std::nothrow_t &) noexcept {
+  std::free(Ptr);
+}
+void operator delete[](void *Ptr, const std::nothrow_t &) noexcept {
+  std::free(Ptr);
+}
+void operator delete(void *Ptr, std::size_t) noexcept { std::free(Ptr); }
+void operator delete[](void *Ptr, std::size_t) noexcept { std::free(Ptr); }
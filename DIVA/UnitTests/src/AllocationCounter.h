@@ -0,0 +1,79 @@
+//===-- UnitTests/AllocationCounter.h ---------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Counting of the heap allocations made through operator new, for the
+/// allocation budget tests.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef UNITTESTS_ALLOCATIONCOUNTER_H
+#define UNITTESTS_ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// \brief The number and total size of some allocations.
+struct AllocationCounts {
+  uint64_t Allocations = 0;
+  uint64_t Bytes = 0;
+};
+
+/// \brief The allocations made from one call site, described by the first
+/// few functions outside of operator new and the standard library.
+struct AllocationCallSite {
+  std::string Location;
+  AllocationCounts Counts;
+};
+
+/// \brief Number of phases that allocations can be charged to.
+const unsigned AllocationPhaseCount = 32;
+
+/// \brief Clear the counts and call sites of every phase and count the
+/// allocations made on any thread, charging them to phase 0.
+void startCountingAllocations();
+
+/// \brief Stop counting allocations. The counts are kept until the next
+/// startCountingAllocations.
+void stopCountingAllocations();
+
+/// \brief Don't count the allocations made by the function whose demangled
+/// name starts with FunctionName, or by the functions that it calls. This
+/// only works on platforms with backtrace(), for exported functions.
+void excludeAllocationsFrom(const std::string &FunctionName);
+
+/// \brief Charge the allocations made from now on to Phase.
+void setAllocationPhase(unsigned Phase);
+
+/// \brief The allocations charged to the phases First to Last inclusive.
+AllocationCounts getAllocationCounts(unsigned First, unsigned Last);
+
+/// \brief The call sites of the allocations charged to the phases First to
+/// Last inclusive, with the most allocations first. Call sites are only
+/// recorded on platforms with backtrace().
+std::vector<AllocationCallSite> getAllocationCallSites(unsigned First,
+                                                       unsigned Last);
+
+#endif // UNITTESTS_ALLOCATIONCOUNTER_H
@@ -0,0 +1,132 @@
+//===-- UnitTests/TestSyntheticDwarf.cpp ------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the tests for the synthetic DWARF generator.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ElfDwarfReader.h"
+#include "FileUtilities.h"
+#include "SyntheticDwarf.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+using namespace SyntheticDwarf;
+
+using LibScopeView::dyn_cast;
+
+namespace {
+
+Options getSmallOptions() {
+  Options Opts;
+  Opts.CompileUnits = 3;
+  Opts.DIEsPerCU = 300;
+  Opts.CrossCUReferences = 50;
+  return Opts;
+}
+
+const LibScopeView::Object *getCompileUnit(const LibScopeView::Object *Obj) {
+  while (Obj && !dyn_cast<LibScopeView::ScopeCompileUnit>(Obj))
+    Obj = Obj->getParent();
+  return Obj;
+}
+
+// Count the objects in Parent and its children, and how many of them have a
+// type that is in a different compile unit.
+void countObjects(const LibScopeView::Scope *Parent, size_t &Objects,
+                  size_t &CrossCUTypes) {
+  for (const LibScopeView::Object *Child : Parent->getChildren()) {
+    ++Objects;
+    if (Child->getType() &&
+        getCompileUnit(Child->getType()) != getCompileUnit(Child))
+      ++CrossCUTypes;
+    if (auto *Scp = dyn_cast<LibScopeView::Scope>(Child))
+      countObjects(Scp, Objects, CrossCUTypes);
+  }
+}
+
+} // namespace
+
+TEST(SyntheticDwarf, Reproducible) {
+  Options Opts(getSmallOptions());
+  std::vector<uint8_t> First(generateObject(Opts));
+  std::vector<uint8_t> Second(generateObject(Opts));
+  EXPECT_EQ(First, Second);
+
+  Opts.Seed = 2;
+  std::vector<uint8_t> Reseeded(generateObject(Opts));
+  EXPECT_NE(First, Reseeded);
+}
+
+TEST(SyntheticDwarf, ReadBack) {
+  Options Opts(getSmallOptions());
+  Statistics Stats;
+  ASSERT_TRUE(LibScopeView::recursiveMakeDir(getTestOutputDir()));
+  std::string FileName(getTestOutputFilePath("synthetic.o"));
+  clearTestOutputFile("synthetic.o");
+  writeObject(Opts, FileName, &Stats);
+
+  EXPECT_EQ(Stats.CompileUnits, 3u);
+  EXPECT_GE(Stats.DIEs, 3u * 300u);
+  EXPECT_GT(Stats.CrossCUReferences, 0u);
+  EXPECT_GT(Stats.LineRows, 0u);
+
+  LibScopeView::PrintSettings Settings;
+  ElfDwarfReader::DwarfReader Reader;
+  auto Root = Reader.loadFile(FileName, Settings);
+  ASSERT_TRUE(Root);
+  ASSERT_EQ(Root->getChildren().size(), 3u);
+
+  size_t Objects = 0;
+  size_t CrossCUTypes = 0;
+  countObjects(Root.get(), Objects, CrossCUTypes);
+  // Every DIE is read as an object and every cross unit reference resolves.
+  EXPECT_EQ(Objects, Stats.DIEs);
+  EXPECT_EQ(CrossCUTypes, Stats.CrossCUReferences);
+}
+
+TEST(SyntheticDwarf, ParseTagMix) {
+  TagMix Mix;
+  EXPECT_TRUE(parseTagMix("struct=7,template=0", Mix));
+  EXPECT_EQ(Mix.Structs, 7u);
+  EXPECT_EQ(Mix.Templates, 0u);
+  EXPECT_EQ(Mix.Functions, TagMix().Functions);
+
+  // Invalid text leaves the mix unchanged.
+  EXPECT_FALSE(parseTagMix("struct=1,widget=2", Mix));
+  EXPECT_FALSE(parseTagMix("struct", Mix));
+  EXPECT_FALSE(parseTagMix("struct=-1", Mix));
+  EXPECT_EQ(Mix.Structs, 7u);
+}
+
+TEST(SyntheticDwarf, Presets) {
+  for (const std::string &Name : getPresetNames()) {
+    Options Opts;
+    EXPECT_TRUE(getPreset(Name, Opts)) << Name;
+  }
+  Options Opts;
+  EXPECT_FALSE(getPreset("enormous", Opts));
+}
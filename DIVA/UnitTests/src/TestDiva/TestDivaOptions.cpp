@@ -28,6 +28,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "DivaOptions.h"
+#include "Error.h"
 
 #include "gtest/gtest.h"
 
@@ -45,11 +46,17 @@ TEST(DivaOptions, Defaults) {
   EXPECT_EQ(Output.str(), "");
 
   EXPECT_TRUE(DOpt.InputFiles.empty());
+  EXPECT_TRUE(DOpt.InputDirectories.empty());
+  EXPECT_TRUE(DOpt.InputIncludes.empty());
+  EXPECT_TRUE(DOpt.InputExcludes.empty());
+  EXPECT_TRUE(DOpt.InputList.empty());
+  EXPECT_FALSE(DOpt.hasInputSearch());
 
   EXPECT_FALSE(DOptForQuietDefault.PrintingSettings.QuietMode);
   EXPECT_FALSE(DOpt.ShowSummary);
   EXPECT_FALSE(PSet.SplitOutput);
   EXPECT_TRUE(PSet.OutputDirectory.empty());
+  EXPECT_FALSE(PSet.CompressOutput);
   EXPECT_EQ(DOpt.OutputFormats, std::set<OutputFormat>({OutputFormat::TEXT}));
 
   EXPECT_EQ(PSet.SortKey, LibScopeView::SortingKey::LINE);
@@ -94,6 +101,15 @@ TEST(DivaOptions, Defaults) {
   EXPECT_FALSE(DOpt.ShowPerformanceTime);
   EXPECT_FALSE(DOpt.ShowPerformanceMemory);
   EXPECT_FALSE(DOpt.ShowScopeAllocation);
+  EXPECT_FALSE(DOpt.ShowMemoryBreakdown);
+  EXPECT_TRUE(DOpt.TraceFile.empty());
+
+  EXPECT_FALSE(DOpt.hasFindQueries());
+  EXPECT_FALSE(DOpt.hasLookups());
+
+  EXPECT_TRUE(DOpt.ServeSocket.empty());
+  EXPECT_EQ(DOpt.ServeCacheSize, 1024u * 1024 * 1024);
+  EXPECT_TRUE(DOpt.ConnectSocket.empty());
 }
 
 TEST(DivaOptions, InputFiles) {
@@ -106,6 +122,22 @@ TEST(DivaOptions, InputFiles) {
             std::vector<std::string>({"input1.o", "input2.elf", "input3.o"}));
 }
 
+TEST(DivaOptions, InputSearch) {
+  std::stringstream Output;
+  DivaOptions DOpt({"--input-dir=libs", "--input-include=*.o",
+                    "--input-dir=bin", "--input-exclude=test_*",
+                    "--input-include=*.a", "--input-list=-", "input.o"},
+                   Output, Output, Output);
+
+  EXPECT_EQ(Output.str(), "");
+  EXPECT_TRUE(DOpt.hasInputSearch());
+  EXPECT_EQ(DOpt.InputDirectories, std::vector<std::string>({"libs", "bin"}));
+  EXPECT_EQ(DOpt.InputIncludes, std::vector<std::string>({"*.o", "*.a"}));
+  EXPECT_EQ(DOpt.InputExcludes, std::vector<std::string>({"test_*"}));
+  EXPECT_EQ(DOpt.InputList, "-");
+  EXPECT_EQ(DOpt.InputFiles, std::vector<std::string>({"input.o"}));
+}
+
 TEST(DivaOptions, OutputDir) {
   std::stringstream Output;
 
@@ -129,6 +161,123 @@ TEST(DivaOptions, OutputDir) {
   }
 }
 
+TEST(DivaOptions, TraceFile) {
+  std::stringstream Output;
+  DivaOptions DOpt({"--trace-file=trace.json", "input.o"}, Output, Output,
+                   Output);
+  EXPECT_EQ(Output.str(), "");
+  EXPECT_EQ(DOpt.TraceFile, "trace.json");
+  EXPECT_EQ(DOpt.InputFiles, std::vector<std::string>({"input.o"}));
+}
+
+TEST(DivaOptions, Find) {
+  std::stringstream Output;
+  DivaOptions DOpt({"--find=foo", "--find=ns::bar", "--find-prefix=ba",
+                    "--find-regex=b.*"},
+                   Output, Output, Output);
+  EXPECT_EQ(Output.str(), "");
+  EXPECT_TRUE(DOpt.hasFindQueries());
+  EXPECT_EQ(DOpt.FindNames, std::vector<std::string>({"foo", "ns::bar"}));
+  EXPECT_EQ(DOpt.FindPrefixes, std::vector<std::string>({"ba"}));
+  EXPECT_EQ(DOpt.RawFindRegexs, std::vector<std::string>({"b.*"}));
+  ASSERT_EQ(DOpt.FindRegexs.size(), 1u);
+  EXPECT_TRUE(std::regex_match("bar", DOpt.FindRegexs[0]));
+
+  EXPECT_EXIT({ DivaOptions({"--find-regex=("}, Output, Output, Output); },
+              ExitedWithCode(1), "");
+}
+
+TEST(DivaOptions, Lookup) {
+  std::stringstream Output;
+  DivaOptions DOpt({"--lookup=0x4012f0", "--lookup=ff", "a.out"}, Output,
+                   Output, Output);
+  EXPECT_EQ(Output.str(), "");
+  EXPECT_TRUE(DOpt.hasLookups());
+  EXPECT_FALSE(DOpt.LookupStdin);
+  EXPECT_EQ(DOpt.LookupAddresses, std::vector<uint64_t>({0x4012f0, 0xff}));
+
+  std::stringstream Addresses("0x10\n20 0X30\n");
+  DOpt.addLookupAddresses(Addresses);
+  EXPECT_EQ(DOpt.LookupAddresses,
+            std::vector<uint64_t>({0x4012f0, 0xff, 0x10, 0x20, 0x30}));
+
+  DivaOptions StdinOpt({"--lookup-stdin"}, Output, Output, Output);
+  EXPECT_TRUE(StdinOpt.hasLookups());
+  EXPECT_TRUE(StdinOpt.LookupStdin);
+
+  EXPECT_EXIT({ DivaOptions({"--lookup=0xg"}, Output, Output, Output); },
+              ExitedWithCode(1), "");
+  EXPECT_EXIT({ DivaOptions({"--lookup=-1"}, Output, Output, Output); },
+              ExitedWithCode(1), "");
+}
+
+TEST(DivaOptions, CompileUnits) {
+  std::stringstream Output;
+  DivaOptions DOpt({"--list-cus", "--cu=*.cpp", "--cu=src/*.c", "a.out"},
+                   Output, Output, Output);
+  EXPECT_EQ(Output.str(), "");
+  EXPECT_TRUE(DOpt.ListCompileUnits);
+  EXPECT_EQ(DOpt.CompileUnitPatterns,
+            std::vector<std::string>({"*.cpp", "src/*.c"}));
+
+  // The summary can't be scanned for some of the units.
+  DivaOptions SummaryOpt({"-q", "--show-summary", "--cu=a.cpp"}, Output,
+                         Output, Output);
+  EXPECT_FALSE(SummaryOpt.ListCompileUnits);
+  EXPECT_FALSE(SummaryOpt.isSummaryOnly());
+}
+
+TEST(DivaOptions, ServerOptions) {
+  std::stringstream Output;
+  {
+    DivaOptions DOpt({"--serve=diva.sock", "--serve-cache-size=64", "a.o"},
+                     Output, Output, Output);
+    EXPECT_EQ(Output.str(), "");
+    EXPECT_EQ(DOpt.ServeSocket, "diva.sock");
+    EXPECT_EQ(DOpt.ServeCacheSize, 64u * 1024 * 1024);
+    EXPECT_EQ(DOpt.InputFiles, std::vector<std::string>({"a.o"}));
+  }
+  {
+    DivaOptions DOpt({"--connect=diva.sock", "a.o"}, Output, Output, Output);
+    EXPECT_EQ(Output.str(), "");
+    EXPECT_EQ(DOpt.ConnectSocket, "diva.sock");
+  }
+
+  EXPECT_EXIT(
+      { DivaOptions({"--serve-cache-size=lots"}, Output, Output, Output); },
+      ExitedWithCode(1), "");
+  EXPECT_EXIT(
+      { DivaOptions({"--serve-cache-size=-1"}, Output, Output, Output); },
+      ExitedWithCode(1), "");
+}
+
+TEST(DivaOptions, ThrowOnExit) {
+  // The server turns early exits and errors into exceptions.
+  std::stringstream Output;
+  LibScopeError::setErrorOutput(&Output);
+  LibScopeError::setThrowOnExit(true);
+  int HelpStatus = -1;
+  try {
+    DivaOptions({"--help"}, Output, Output, Output);
+  } catch (LibScopeError::ExitException &Exit) {
+    HelpStatus = Exit.getStatus();
+  }
+  int ErrorStatus = -1;
+  try {
+    DivaOptions({"--not-an-option"}, Output, Output, Output);
+  } catch (LibScopeError::ExitException &Exit) {
+    ErrorStatus = Exit.getStatus();
+  }
+  LibScopeError::setThrowOnExit(false);
+  LibScopeError::setErrorOutput(nullptr);
+
+  EXPECT_EQ(HelpStatus, 0);
+  EXPECT_EQ(ErrorStatus, 1);
+  EXPECT_NE(Output.str().find(
+                "ERR_CMD_UNKNOWN_ARG: Unknown argument '--not-an-option'."),
+            std::string::npos);
+}
+
 TEST(DivaOptions, EarlyExitArgs) {
   std::stringstream Output;
   // Version.
@@ -178,6 +327,13 @@ TEST(DivaOptions, OutputFormat) {
     EXPECT_EQ(DOpt.OutputFormats,
               std::set<OutputFormat>({OutputFormat::TEXT, OutputFormat::YAML}));
   }
+
+  {
+    DivaOptions DOpt({"--output=json,ndjson"}, Output, Output, Output);
+    EXPECT_EQ(Output.str(), "");
+    EXPECT_EQ(DOpt.OutputFormats, std::set<OutputFormat>(
+                                      {OutputFormat::JSON, OutputFormat::NDJSON}));
+  }
 }
 
 TEST(DivaOptions, Sorting) {
@@ -306,6 +462,7 @@ TEST(DivaOptions, FlagArguments) {
 
   CHECK_FLAG("quiet", PrintingSettings.QuietMode);
   CHECK_FLAG("show-summary", ShowSummary);
+  CHECK_FLAG("compress", PrintingSettings.CompressOutput);
 
   CHECK_FLAG("show-alias", PrintingSettings.ShowAlias);
   CHECK_FLAG("show-block", PrintingSettings.ShowBlock);
@@ -343,6 +500,7 @@ TEST(DivaOptions, FlagArguments) {
   CHECK_FLAG("performance-time", ShowPerformanceTime);
   CHECK_FLAG("performance-memory", ShowPerformanceMemory);
   CHECK_FLAG("scope-allocation", ShowScopeAllocation);
+  CHECK_FLAG("show-memory-breakdown", ShowMemoryBreakdown);
 
   EXPECT_EQ(Output.str(), "");
 }
@@ -386,4 +544,14 @@ TEST(DivaOptions, Errors) {
       ExitedWithCode(1),
       "ERR_CMD_INVALID_VALUE: Argument '--output' was given the invalid value "
       "'bad'.");
+
+  // Standard input read for two options.
+  EXPECT_EXIT(
+      {
+        DivaOptions DOpt1({"--lookup-stdin", "--input-list=-"}, Output, Output,
+                          std::cerr);
+      },
+      ExitedWithCode(1),
+      "ERR_CMD_INVALID_VALUE: Argument 'input-list' was given the invalid "
+      "value '-'.");
 }
@@ -0,0 +1,136 @@
+//===-- UnitTests/TestDiva/TestDivaOutput.cpp -------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for reading the input files of diva.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DivaOutput.h"
+#include "FileUtilities.h"
+#include "ScopeTextPrinter.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+using namespace LibScopeView;
+
+namespace {
+
+/// \brief Get the text output of a tree.
+std::string printTree(const ScopeRoot &Root) {
+  PrintSettings Settings;
+  std::stringstream Out;
+  ScopeTextPrinter(Settings, "input").print(&Root, Out);
+  return Out.str();
+}
+
+/// \brief Write a GNU static archive of the named members and contents, with
+/// a table of the long names.
+void writeArchive(
+    const std::string &Path,
+    const std::vector<std::pair<std::string, std::string>> &Members) {
+  std::string LongNames;
+  std::string Contents;
+  auto AddMember = [&Contents](const std::string &Name,
+                               const std::string &Data) {
+    char Header[61];
+    snprintf(Header, sizeof(Header), "%-16s%-12s%-6s%-6s%-8s%-10zu`\n",
+             Name.c_str(), "0", "0", "0", "644", Data.size());
+    Contents.append(Header, 60);
+    Contents += Data;
+    if (Data.size() % 2)
+      Contents += '\n';
+  };
+  for (const auto &Member : Members) {
+    if (Member.first.size() < 16)
+      AddMember(Member.first + "/", Member.second);
+    else {
+      AddMember("/" + std::to_string(LongNames.size()), Member.second);
+      LongNames += Member.first + "/\n";
+    }
+  }
+  std::ofstream Out(Path, std::ios::binary);
+  Out << "!<arch>\n";
+  if (!LongNames.empty()) {
+    std::string Table;
+    std::swap(Table, Contents);
+    AddMember("//", LongNames);
+    Contents += Table;
+  }
+  Out << Contents;
+}
+
+std::string readFile(const std::string &Path) {
+  std::ifstream In(Path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(In),
+                     std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+TEST(DivaOutput, ReadArchive) {
+  const std::vector<std::string> Objects = {"aggregate.o", "array.o",
+                                            "block.o", "enum.o", "lines.o"};
+  std::vector<std::pair<std::string, std::string>> Members;
+  for (const std::string &Object : Objects)
+    Members.emplace_back(Object, readFile(getTestInputFilePath(
+                                     "ElfDwarfReader/" + Object)));
+  Members.emplace_back("notes.txt", "not an object");
+  Members.emplace_back("a_long_member_name.o", Members[0].second);
+  Members.emplace_back("enum.o", Members[3].second);
+
+  ASSERT_TRUE(recursiveMakeDir(getTestOutputDir()));
+  std::string ArchivePath(getTestOutputFilePath("objects.a"));
+  writeArchive(ArchivePath, Members);
+  ASSERT_TRUE(isFileFormatArchive(ArchivePath));
+  EXPECT_FALSE(isFileFormatArchive(getTestInputFilePath("test.o")));
+
+  // Read with more threads than the machine may have, so that the members are
+  // read at the same time.
+  PrintSettings Settings;
+  std::vector<ArchiveMemberTree> Trees(
+      readArchive(ArchivePath, Settings, {}, /*ThreadCount*/ 4));
+
+  // The text file is skipped.
+  ASSERT_EQ(Trees.size(), Objects.size() + 2);
+  for (size_t I = 0; I < Objects.size(); ++I) {
+    EXPECT_EQ(Trees[I].Name, ArchivePath + "(" + Objects[I] + ")");
+    EXPECT_EQ(Trees[I].SplitSubdirectory, flattenFilePath(Objects[I]));
+    ASSERT_TRUE(Trees[I].Root);
+    std::unique_ptr<ScopeRoot> FromFile(readInputFile(
+        getTestInputFilePath("ElfDwarfReader/" + Objects[I]), Settings));
+    EXPECT_EQ(printTree(*Trees[I].Root), printTree(*FromFile));
+  }
+  EXPECT_EQ(Trees[5].Name, ArchivePath + "(a_long_member_name.o)");
+  EXPECT_EQ(printTree(*Trees[5].Root), printTree(*Trees[0].Root));
+  // Repeated member names get their own subdirectories.
+  EXPECT_EQ(Trees[6].Name, ArchivePath + "(enum.o)");
+  EXPECT_EQ(Trees[6].SplitSubdirectory, flattenFilePath("enum.o") + "-2");
+}
@@ -0,0 +1,94 @@
+//===-- UnitTests/TestDiva/TestDivaServer.cpp -------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the requests answered by the diva server.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DivaServer.h"
+#include "DivaOutput.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+namespace {
+
+/// \brief Get the output of diva run without a server.
+std::string runLocally(const std::vector<std::string> &Args) {
+  std::stringstream Out;
+  const DivaOptions Options(Args, Out, Out, Out);
+  for (const std::string &InputFilePath : Options.InputFiles)
+    printInputFile(InputFilePath, Options, Out);
+  return Out.str();
+}
+
+ScopeTreeCache::LoadFunction getLoader() {
+  return [](const std::string &InputFilePath,
+            const LibScopeView::PrintSettings &Settings) {
+    return readInputFile(InputFilePath, Settings);
+  };
+}
+
+} // namespace
+
+TEST(DivaServer, HandleRequest) {
+  std::string Input = getTestInputFilePath("ElfDwarfReader/lto_cross_cu.elf");
+  ScopeTreeCache Cache(1024 * 1024 * 1024, getLoader());
+  std::stringstream Out;
+  std::stringstream Err;
+  std::vector<std::string> Args = {Input, "--show-all"};
+  EXPECT_EQ(handleRequest(Args, Cache, Out, Err), 0);
+  EXPECT_EQ(Out.str(), runLocally(Args));
+  EXPECT_EQ(Err.str(), "");
+  EXPECT_EQ(Cache.getMissCount(), 1u);
+}
+
+TEST(DivaServer, HandleCompileUnitRequests) {
+  std::string Input = getTestInputFilePath("ElfDwarfReader/lto_cross_cu.elf");
+  ScopeTreeCache Cache(1024 * 1024 * 1024, getLoader());
+
+  // The units are listed from their headers, as without a server.
+  std::vector<std::string> ListArgs = {Input, "--list-cus"};
+  std::stringstream ListOut;
+  std::stringstream Err;
+  EXPECT_EQ(handleRequest(ListArgs, Cache, ListOut, Err), 0);
+  EXPECT_EQ(ListOut.str(), runLocally(ListArgs));
+  EXPECT_NE(ListOut.str().find("\"lto_cross_cu2.cpp\""), std::string::npos);
+
+  // Only the selected unit is printed.
+  std::vector<std::string> UnitArgs = {Input, "--show-all",
+                                       "--cu=lto_cross_cu1.cpp"};
+  std::stringstream UnitOut;
+  EXPECT_EQ(handleRequest(UnitArgs, Cache, UnitOut, Err), 0);
+  EXPECT_EQ(UnitOut.str(), runLocally(UnitArgs));
+  EXPECT_NE(UnitOut.str().find("lto_cross_cu1.cpp"), std::string::npos);
+  EXPECT_EQ(UnitOut.str().find("lto_cross_cu2.cpp"), std::string::npos);
+  EXPECT_EQ(Err.str(), "");
+
+  // Neither is read into the cache, whose trees have every unit.
+  EXPECT_EQ(Cache.getTreeCount(), 0u);
+}
@@ -0,0 +1,136 @@
+//===-- UnitTests/TestDiva/TestInputFiles.cpp -------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for searching for and reading many input files.
+///
+//===----------------------------------------------------------------------===//
+
+#include "InputFiles.h"
+#include "DivaOutput.h"
+#include "FileUtilities.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+/// \brief Copy a test input file to Path.
+void copyInputFile(const std::string &FileName, const std::string &Path) {
+  std::ifstream In(getTestInputFilePath(FileName), std::ios::binary);
+  std::ofstream(Path, std::ios::binary) << In.rdbuf();
+}
+
+/// \brief Get the paths of Files.
+std::vector<std::string> getPaths(const std::vector<InputFile> &Files) {
+  std::vector<std::string> Paths;
+  for (const InputFile &File : Files)
+    Paths.push_back(File.Path);
+  return Paths;
+}
+
+} // namespace
+
+TEST(InputFiles, FindInputFiles) {
+  const std::string Dir = getTestOutputFilePath("FindInputFiles");
+  ASSERT_TRUE(LibScopeView::recursiveMakeDir(Dir + "/sub"));
+  copyInputFile("ElfDwarfReader/aggregate.o", Dir + "/aggregate.o");
+  copyInputFile("ElfDwarfReader/enum.o", Dir + "/sub/enum.o");
+  copyInputFile("ElfDwarfReader/lines.o", Dir + "/sub/lines.o");
+  copyInputFile("Test.txt", Dir + "/notes.o");
+  std::stringstream Output;
+  std::stringstream NoList;
+
+  {
+    // Files without debug information are skipped.
+    DivaOptions Options({"--input-dir=" + Dir}, Output, Output, Output);
+    std::vector<InputFile> Files(findInputFiles(Options, NoList));
+    EXPECT_EQ(getPaths(Files),
+              std::vector<std::string>({Dir + "/aggregate.o",
+                                        Dir + "/sub/enum.o",
+                                        Dir + "/sub/lines.o"}));
+    for (const InputFile &File : Files)
+      EXPECT_GT(File.DebugSize, 0u);
+  }
+  {
+    // Globs without a '/' match the file name, others the relative path.
+    DivaOptions Options({"--input-dir=" + Dir + "/", "--input-include=*e*.o",
+                         "--input-exclude=sub/l*"},
+                        Output, Output, Output);
+    EXPECT_EQ(getPaths(findInputFiles(Options, NoList)),
+              std::vector<std::string>(
+                  {Dir + "/aggregate.o", Dir + "/sub/enum.o"}));
+  }
+  {
+    // The list is read after the explicit input files.
+    DivaOptions Options({"--input-list=-", "input.o"}, Output, Output, Output);
+    std::stringstream List(" " + Dir + "/sub/lines.o \r\n\n" + Dir +
+                           "/notes.o\n" + Dir + "/aggregate.o");
+    EXPECT_EQ(getPaths(findInputFiles(Options, List)),
+              std::vector<std::string>(
+                  {"input.o", Dir + "/sub/lines.o", Dir + "/aggregate.o"}));
+    EXPECT_EQ(getPaths(findInputFiles(Options, List, false)),
+              std::vector<std::string>());
+  }
+  EXPECT_EQ(Output.str(), "");
+}
+
+TEST(InputFiles, PrintInputFiles) {
+  std::stringstream Output;
+  DivaOptions Options({"--show-summary"}, Output, Output, Output);
+
+  std::vector<InputFile> Files;
+  for (const char *Object : {"aggregate.o", "array.o", "block.o", "enum.o",
+                             "function.o", "lines.o"}) {
+    Files.emplace_back();
+    Files.back().Path = getTestInputFilePath(std::string("ElfDwarfReader/") +
+                                             Object);
+    // Take the files out of order.
+    Files.back().DebugSize = Files.size() % 3;
+  }
+
+  std::stringstream Expected;
+  LibScopeView::SummaryTable Summary;
+  for (const InputFile &File : Files)
+    printInputFile(File.Path, Options, Expected, {}, &Summary);
+  Expected << '\n';
+  Summary.printSummaryTable(Expected);
+
+  // Read with more threads than the machine may have, so that the files are
+  // read at the same time.
+  std::stringstream Result;
+  printInputFiles(Files, Options, Result, {}, /*ThreadCount*/ 4);
+  EXPECT_EQ(Result.str(), Expected.str());
+
+  // One thread only starts the two files after the last written, so files
+  // are added to those it can take as earlier ones are written.
+  std::stringstream SerialResult;
+  printInputFiles(Files, Options, SerialResult, {}, /*ThreadCount*/ 1);
+  EXPECT_EQ(SerialResult.str(), Expected.str());
+  EXPECT_EQ(Output.str(), "");
+}
@@ -0,0 +1,182 @@
+//===-- UnitTests/TestDiva/TestScopeTreeCache.cpp ---------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the server's cache of Scope trees.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ScopeTreeCache.h"
+#include "FileUtilities.h"
+#include "Symbol.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+
+using namespace LibScopeView;
+
+namespace {
+
+// Counts the trees read by the cache. Each tree holds two symbols: "a" at
+// offset 2 and "b" at offset 1.
+struct TestLoader {
+  std::vector<std::string> Loaded;
+
+  std::unique_ptr<ScopeRoot> operator()(const std::string &Path,
+                                        const PrintSettings &) {
+    Loaded.push_back(Path);
+    auto Root = std::make_unique<ScopeRoot>();
+    auto *A = new Symbol();
+    A->setName("a");
+    A->setDieOffset(2);
+    Root->addChild(A);
+    auto *B = new Symbol();
+    B->setName("b");
+    B->setDieOffset(1);
+    Root->addChild(B);
+    return Root;
+  }
+};
+
+std::string writeInput(const std::string &FileName,
+                       const std::string &Content) {
+  EXPECT_TRUE(recursiveMakeDir(getTestOutputDir()));
+  std::string Path = getTestOutputFilePath(FileName);
+  std::ofstream(Path) << Content;
+  return Path;
+}
+
+} // namespace
+
+TEST(ScopeTreeCache, ReusesTrees) {
+  std::string Path = writeInput("cache_reuse.o", "first");
+  TestLoader Loader;
+  ScopeTreeCache Cache(1024 * 1024, std::ref(Loader));
+  PrintSettings Settings;
+
+  const ScopeRoot *First = &Cache.getTree(Path, Settings);
+  const ScopeRoot *Second = &Cache.getTree(Path, Settings);
+  EXPECT_EQ(First, Second);
+  EXPECT_EQ(Loader.Loaded.size(), 1u);
+  EXPECT_EQ(Cache.getHitCount(), 1u);
+  EXPECT_EQ(Cache.getMissCount(), 1u);
+  ObjectTreeMemory Memory = getObjectTreeMemory(*First);
+  EXPECT_EQ(Cache.getCachedBytes(), Memory.ObjectBytes + Memory.VectorBytes);
+
+  // The "void" setting changes the names, so needs another tree.
+  Settings.ShowVoid = !Settings.ShowVoid;
+  Cache.getTree(Path, Settings);
+  EXPECT_EQ(Loader.Loaded.size(), 2u);
+  EXPECT_EQ(Cache.getTreeCount(), 2u);
+
+  // A changed file is read again.
+  writeInput("cache_reuse.o", "second version");
+  Cache.getTree(Path, Settings);
+  EXPECT_EQ(Loader.Loaded.size(), 3u);
+  EXPECT_EQ(Cache.getTreeCount(), 2u);
+}
+
+TEST(ScopeTreeCache, Resorts) {
+  std::string Path = writeInput("cache_sort.o", "sort");
+  TestLoader Loader;
+  ScopeTreeCache Cache(1024 * 1024, std::ref(Loader));
+  PrintSettings Settings;
+
+  Settings.SortKey = SortingKey::OFFSET;
+  const ScopeRoot &ByOffset = Cache.getTree(Path, Settings);
+  // The loader does not sort, the cache only sorts trees it already has.
+  EXPECT_EQ(ByOffset.getChildren()[0]->getName(), "a");
+
+  Settings.SortKey = SortingKey::NAME;
+  Cache.getTree(Path, Settings);
+  Settings.SortKey = SortingKey::OFFSET;
+  const ScopeRoot &Resorted = Cache.getTree(Path, Settings);
+  EXPECT_EQ(Resorted.getChildren()[0]->getName(), "b");
+  EXPECT_EQ(Resorted.getChildren()[1]->getName(), "a");
+  EXPECT_EQ(Loader.Loaded.size(), 1u);
+}
+
+TEST(ScopeTreeCache, EvictsLeastRecentlyUsed) {
+  std::string PathA = writeInput("cache_a.o", "a");
+  std::string PathB = writeInput("cache_b.o", "b");
+  std::string PathC = writeInput("cache_c.o", "c");
+  PrintSettings Settings;
+
+  // Find the size of one tree.
+  TestLoader SizeLoader;
+  ScopeTreeCache SizeCache(1024 * 1024, std::ref(SizeLoader));
+  SizeCache.getTree(PathA, Settings);
+  uint64_t TreeBytes = SizeCache.getCachedBytes();
+
+  TestLoader Loader;
+  ScopeTreeCache Cache(2 * TreeBytes, std::ref(Loader));
+  Cache.getTree(PathA, Settings);
+  Cache.getTree(PathB, Settings);
+  Cache.getTree(PathA, Settings);
+  // B is now the least recently used.
+  Cache.getTree(PathC, Settings);
+  EXPECT_EQ(Cache.getTreeCount(), 2u);
+  EXPECT_EQ(Cache.getCachedBytes(), 2 * TreeBytes);
+  Cache.getTree(PathA, Settings);
+  Cache.getTree(PathB, Settings);
+  EXPECT_EQ(Loader.Loaded,
+            std::vector<std::string>({PathA, PathB, PathC, PathB}));
+
+  // A single tree larger than the limit is kept until the next is read.
+  ScopeTreeCache Tiny(1, std::ref(Loader));
+  Tiny.getTree(PathA, Settings);
+  EXPECT_EQ(Tiny.getTreeCount(), 1u);
+  Tiny.getTree(PathB, Settings);
+  EXPECT_EQ(Tiny.getTreeCount(), 1u);
+}
+
+TEST(ScopeTreeCache, CountsStringPoolGrowth) {
+  std::string PathA = writeInput("cache_pool_a.o", "a");
+  std::string PathB = writeInput("cache_pool_b.o", "b");
+  PrintSettings Settings;
+
+  TestLoader SizeLoader;
+  ScopeTreeCache SizeCache(1024 * 1024, std::ref(SizeLoader));
+  SizeCache.getTree(PathA, Settings);
+  uint64_t TreeBytes = SizeCache.getCachedBytes();
+
+  // Each tree read interns a new name much larger than a tree.
+  unsigned Reads = 0;
+  ScopeTreeCache Cache(
+      3 * TreeBytes, [&](const std::string &, const PrintSettings &) {
+        auto Root = std::make_unique<ScopeRoot>();
+        auto *A = new Symbol();
+        A->setName(std::string(4 * TreeBytes, 'x') + std::to_string(Reads++));
+        Root->addChild(A);
+        return Root;
+      });
+  Cache.getTree(PathA, Settings);
+  EXPECT_GT(Cache.getPoolBytes(), 4 * TreeBytes);
+  // The names already use more than the limit, so only one tree is kept.
+  Cache.getTree(PathB, Settings);
+  EXPECT_EQ(Cache.getTreeCount(), 1u);
+  EXPECT_GT(Cache.getPoolBytes(), 8 * TreeBytes);
+}
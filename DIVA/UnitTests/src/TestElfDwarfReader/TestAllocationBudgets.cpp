@@ -0,0 +1,327 @@
+//===-- ElfReader/TestAllocationBudgets.cpp ---------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests that reading, resolving and printing each test input stays within
+/// its budget of heap allocations per DIE.
+///
+//===----------------------------------------------------------------------===//
+
+#include "AllocationCounter.h"
+#include "ElfDwarfReader.h"
+#include "FileUtilities.h"
+#include "MemoryProfile.h"
+#include "ScopeTextPrinter.h"
+#include "Trace.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+// The allocations allowed per DIE in one phase.
+struct PhaseBudget {
+  double AllocationsPerDIE;
+  double BytesPerDIE;
+};
+
+enum Phase { Read, Resolve, Print, PhaseCount };
+const char *const PhaseNames[PhaseCount] = {"Reading", "Resolving",
+                                            "Printing"};
+
+struct FileBudget {
+  const char *FileName;
+  PhaseBudget Phases[PhaseCount];
+};
+
+// The budgets of each test input, about a quarter above what was measured (and
+// at least half an allocation of 32 bytes) so that small changes and
+// differences between standard libraries fit. Strings in the global string
+// pool are only allocated by the first read of a file, so they aren't counted.
+//
+// To update a budget, delete its row and copy the one suggested by the test.
+const FileBudget Budgets[] = {
+    {"DwarfHelpers/test.elf",
+     {{40.2, 3961}, {0.5, 32}, {8.1, 761}}},
+    {"ElfDwarfReader/aggregate.o",
+     {{20.3, 1985}, {0.5, 32}, {4.6, 483}}},
+    {"ElfDwarfReader/array.o",
+     {{26.3, 3669}, {0.5, 32}, {4.2, 269}}},
+    {"ElfDwarfReader/block.o",
+     {{33.9, 3607}, {0.5, 32}, {4.5, 379}}},
+    {"ElfDwarfReader/entry_point.elf",
+     {{35.7, 7280}, {0.5, 32}, {8.2, 429}}},
+    {"ElfDwarfReader/enum.o",
+     {{20.7, 1926}, {0.5, 32}, {3.1, 241}}},
+    {"ElfDwarfReader/function.o",
+     {{29.4, 3150}, {0.5, 32}, {6.2, 501}}},
+    {"ElfDwarfReader/function_decls.o",
+     {{24.3, 2476}, {0.5, 32}, {5.4, 496}}},
+    {"ElfDwarfReader/function_pointer.o",
+     {{25.3, 2754}, {2.2, 61}, {6, 421}}},
+    {"ElfDwarfReader/function_static_inline.o",
+     {{26.4, 2188}, {0.5, 32}, {6.6, 561}}},
+    {"ElfDwarfReader/import.o",
+     {{24.8, 2460}, {0.5, 32}, {5.5, 525}}},
+    {"ElfDwarfReader/inheritance.o",
+     {{22.1, 2105}, {0.5, 32}, {4.7, 407}}},
+    {"ElfDwarfReader/invalid_file_index.elf",
+     {{33.8, 7213}, {0.5, 32}, {5, 311}}},
+    {"ElfDwarfReader/label.o",
+     {{41.6, 5342}, {0.5, 32}, {7.5, 472}}},
+    {"ElfDwarfReader/lines.o",
+     {{36.5, 4538}, {0.5, 32}, {6.5, 560}}},
+    {"ElfDwarfReader/lto_cross_cu.elf",
+     {{44.4, 4647}, {0.6, 32}, {8.2, 706}}},
+    {"ElfDwarfReader/members.o",
+     {{26.8, 2474}, {0.5, 32}, {5.1, 483}}},
+    {"ElfDwarfReader/more_types.elf",
+     {{23.8, 3884}, {0.5, 32}, {4.4, 359}}},
+    {"ElfDwarfReader/qualified_name.o",
+     {{26.8, 2825}, {0.5, 32}, {6.9, 606}}},
+    {"ElfDwarfReader/split.elf",
+     {{30.5, 3900}, {0.5, 32}, {6.3, 734}}},
+    {"ElfDwarfReader/split_package.elf",
+     {{29.9, 3550}, {0.5, 32}, {6.5, 699}}},
+    {"ElfDwarfReader/structure.elf",
+     {{28.8, 3334}, {0.5, 32}, {7.3, 733}}},
+    {"ElfDwarfReader/symbol.o",
+     {{29.4, 3112}, {0.5, 32}, {6, 534}}},
+    {"ElfDwarfReader/template.o",
+     {{35.9, 3720}, {0.5, 32}, {6.6, 310}}},
+    {"ElfDwarfReader/template_pack.o",
+     {{29.2, 2696}, {0.5, 32}, {5.5, 419}}},
+    {"ElfDwarfReader/template_template.o",
+     {{29.2, 2866}, {0.5, 32}, {6.7, 446}}},
+    {"ElfDwarfReader/try_catch.elf",
+     {{30, 5124}, {0.5, 32}, {6.3, 678}}},
+    {"ElfDwarfReader/type.o",
+     {{22.5, 2049}, {0.5, 32}, {4.4, 403}}},
+    {"ElfDwarfReader/type_units.elf",
+     {{25.2, 2082}, {0.5, 32}, {6.5, 698}}},
+    {"ElfDwarfReader/type_units_gcc.o",
+     {{26.8, 2650}, {0.5, 32}, {7, 653}}},
+    {"test.o",
+     {{27.5, 3774}, {0.5, 32}, {4.2, 260}}},
+};
+
+// Test inputs without DWARF to read, with DWARF that is too broken to read, or
+// with split DWARF that is only read through the file that uses it.
+const char *const UnreadableInputs[] = {
+    "DwarfHelpers/create_debug_data_error.elf",
+    "DwarfHelpers/empty.o",
+    "DwarfHelpers/first_not_cu_error.elf",
+    "ElfDwarfReader/parent_not_scope.elf",
+    "ElfDwarfReader/split.elf-type_units1.dwo",
+    "ElfDwarfReader/split.elf-type_units2.dwo",
+    "ElfDwarfReader/split_package.elf.dwp",
+};
+
+// The allocations made in each phase by reading, resolving and printing a
+// file, and the phases of the AllocationCounter for each.
+struct FileAllocations {
+  uint64_t DIEs = 0;
+  AllocationCounts Counts[PhaseCount];
+  unsigned FirstPhase[PhaseCount];
+  unsigned LastPhase[PhaseCount];
+};
+
+// Discards the printed output so that only the printer's allocations count.
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int C) override { return C; }
+  std::streamsize xsputn(const char *, std::streamsize Count) override {
+    return Count;
+  }
+};
+
+std::unique_ptr<LibScopeView::ScopeRoot>
+readFile(const std::string &FileName,
+         const LibScopeView::PrintSettings &Settings) {
+  DwarfReader Reader;
+  return Reader.loadFile(FileName, Settings);
+}
+
+FileAllocations measureFile(const std::string &FileName) {
+  LibScopeView::PrintSettings Settings;
+  Settings.showAll();
+  Settings.ShowCodeline = true;
+  FileAllocations Result;
+
+  // Intern the strings of the file, and count its DIEs.
+  {
+    LibScopeView::Tracer Trace;
+    LibScopeView::setActiveTracer(&Trace);
+    readFile(FileName, Settings);
+    LibScopeView::setActiveTracer(nullptr);
+    auto DIEs = Trace.getCounters().find("DIEs");
+    if (DIEs != Trace.getCounters().end())
+      Result.DIEs = DIEs->second;
+  }
+
+  // The reader marks the end of each phase with a memory sample, so each
+  // sample starts a new AllocationCounter phase. The allocations made to take
+  // the samples, or to measure the memory owners, aren't counted.
+  static bool Excluded = false;
+  if (!Excluded) {
+    excludeAllocationsFrom("LibScopeView::MemoryProfile::sample(");
+    excludeAllocationsFrom("LibScopeView::MemoryProfile::measureOwners(");
+    Excluded = true;
+  }
+  LibScopeView::MemoryProfile Profile;
+  unsigned SampleCount = 0;
+  DwarfReader Reader;
+  std::unique_ptr<LibScopeView::ScopeRoot> Root;
+  LibScopeView::setActiveMemoryProfile(&Profile);
+  startCountingAllocations();
+  {
+    LibScopeView::MemoryOwner PhaseMarker(
+        [&SampleCount](LibScopeView::MemoryOwnerBytes &) {
+          setAllocationPhase(++SampleCount);
+        });
+    Root = Reader.loadFile(FileName, Settings);
+  }
+  LibScopeView::setActiveMemoryProfile(nullptr);
+
+  NullBuffer Buffer;
+  std::ostream Null(&Buffer);
+  setAllocationPhase(SampleCount + 1);
+  if (Root)
+    LibScopeView::ScopeTextPrinter(Settings, FileName).print(Root.get(), Null);
+  stopCountingAllocations();
+
+  // Reading ends with the sample taken once libdwarf is finished with.
+  unsigned ReadEnd = 0;
+  const auto &Samples = Profile.getSamples();
+  for (unsigned I = 0; I < Samples.size(); ++I)
+    if (std::strcmp(Samples[I].Phase, "DwarfFinish") == 0)
+      ReadEnd = I + 1;
+  Result.FirstPhase[Read] = 0;
+  Result.LastPhase[Read] = ReadEnd ? ReadEnd - 1 : SampleCount;
+  Result.FirstPhase[Resolve] = ReadEnd ? ReadEnd : SampleCount + 1;
+  Result.LastPhase[Resolve] = SampleCount;
+  Result.FirstPhase[Print] = Result.LastPhase[Print] = SampleCount + 1;
+  for (unsigned P = 0; P < PhaseCount; ++P)
+    Result.Counts[P] =
+        getAllocationCounts(Result.FirstPhase[P], Result.LastPhase[P]);
+  return Result;
+}
+
+double perDIE(uint64_t Count, uint64_t DIEs) {
+  return static_cast<double>(Count) / static_cast<double>(DIEs);
+}
+
+// The table row for a budget about a quarter above Allocations.
+std::string suggestBudget(const std::string &FileName,
+                          const FileAllocations &Allocations) {
+  std::stringstream Row;
+  Row << "    {\"" << FileName << "\",\n     {";
+  for (unsigned P = 0; P < PhaseCount; ++P) {
+    const AllocationCounts &Counts = Allocations.Counts[P];
+    Row << (P ? ", " : "") << '{'
+        << std::max(
+               std::ceil(perDIE(Counts.Allocations, Allocations.DIEs) * 12.5) /
+                   10,
+               0.5)
+        << ", "
+        << std::max(std::ceil(perDIE(Counts.Bytes, Allocations.DIEs) * 1.25),
+                    32.0)
+        << '}';
+  }
+  Row << "}},";
+  return Row.str();
+}
+
+// Describe the allocations of phase P over its budget and their top call
+// sites.
+std::string describeOverBudget(const std::string &FileName,
+                               const FileAllocations &Allocations, Phase P,
+                               const PhaseBudget &Budget) {
+  const AllocationCounts &Counts = Allocations.Counts[P];
+  std::stringstream Message;
+  Message << PhaseNames[P] << ' ' << FileName << " made "
+          << perDIE(Counts.Allocations, Allocations.DIEs) << " allocations ("
+          << perDIE(Counts.Bytes, Allocations.DIEs)
+          << " bytes) per DIE, over the budget of "
+          << Budget.AllocationsPerDIE << " allocations ("
+          << Budget.BytesPerDIE << " bytes). Top call sites:\n";
+  auto CallSites = getAllocationCallSites(Allocations.FirstPhase[P],
+                                          Allocations.LastPhase[P]);
+  CallSites.resize(std::min<size_t>(CallSites.size(), 10));
+  for (const AllocationCallSite &Site : CallSites)
+    Message << std::setw(8) << Site.Counts.Allocations << " allocations"
+            << std::setw(10) << Site.Counts.Bytes << " bytes  "
+            << Site.Location << '\n';
+  Message << "If this is expected, update the budget to:\n"
+          << suggestBudget(FileName, Allocations);
+  return Message.str();
+}
+
+} // namespace
+
+TEST(AllocationBudgets, WithinBudget) {
+  for (const FileBudget &Budget : Budgets) {
+    FileAllocations Allocations =
+        measureFile(getTestInputFilePath(Budget.FileName));
+    ASSERT_NE(0u, Allocations.DIEs) << Budget.FileName;
+    for (unsigned P = 0; P < PhaseCount; ++P) {
+      const PhaseBudget &PhaseLimit = Budget.Phases[P];
+      const AllocationCounts &Counts = Allocations.Counts[P];
+      EXPECT_TRUE(perDIE(Counts.Allocations, Allocations.DIEs) <=
+                      PhaseLimit.AllocationsPerDIE &&
+                  perDIE(Counts.Bytes, Allocations.DIEs) <=
+                      PhaseLimit.BytesPerDIE)
+          << describeOverBudget(Budget.FileName, Allocations, Phase(P),
+                                PhaseLimit);
+    }
+  }
+}
+
+TEST(AllocationBudgets, EveryInputHasBudget) {
+  std::vector<std::string> Files;
+  ASSERT_TRUE(LibScopeView::listFilesRecursively(getTestInputDir(), Files));
+  for (const std::string &File : Files) {
+    std::string FileName = File.substr(getTestInputDir().size() + 1);
+    if (!LibScopeView::isFileFormatElf(File) ||
+        std::find_if(std::begin(UnreadableInputs), std::end(UnreadableInputs),
+                     [&](const char *Name) { return FileName == Name; }) !=
+            std::end(UnreadableInputs))
+      continue;
+    auto HasBudget = [&](const FileBudget &Budget) {
+      return FileName == Budget.FileName;
+    };
+    EXPECT_NE(std::end(Budgets),
+              std::find_if(std::begin(Budgets), std::end(Budgets), HasBudget))
+        << "No allocation budget for " << FileName << ", add:\n"
+        << suggestBudget(FileName, measureFile(File));
+  }
+}
@@ -0,0 +1,171 @@
+//===-- ElfReader/TestDwarfLineProgram.cpp ----------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for decodeLineProgram.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfLineProgram.h"
+#include "FileUtilities.h"
+#include "UtilsForTesting.h"
+
+#include "dwarf.h"
+#include "gtest/gtest.h"
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+// Build a little endian, 32-bit DWARF .debug_line unit of Version with a
+// single file, around Program.
+std::vector<uint8_t> makeLineUnit(uint16_t Version,
+                                  const std::vector<uint8_t> &Program) {
+  std::vector<uint8_t> Header = {
+      1,    // minimum_instruction_length
+      1,    // default_is_stmt
+      0xfb, // line_base (-5)
+      14,   // line_range
+      13,   // opcode_base
+      0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1, // standard_opcode_lengths
+      0,                                  // include_directories
+      'a', '.', 'c', 0, 0, 0, 0,          // file_names
+      0};
+  auto AppendU32 = [](std::vector<uint8_t> &Bytes, uint32_t Value) {
+    for (unsigned I = 0; I < 4; ++I)
+      Bytes.push_back(static_cast<uint8_t>(Value >> (I * 8)));
+  };
+
+  std::vector<uint8_t> Unit;
+  AppendU32(Unit, static_cast<uint32_t>(2 + 4 + Header.size() +
+                                        Program.size()));
+  Unit.push_back(static_cast<uint8_t>(Version));
+  Unit.push_back(static_cast<uint8_t>(Version >> 8));
+  AppendU32(Unit, static_cast<uint32_t>(Header.size()));
+  Unit.insert(Unit.end(), Header.begin(), Header.end());
+  Unit.insert(Unit.end(), Program.begin(), Program.end());
+  return Unit;
+}
+
+} // end anonymous namespace
+
+TEST(DwarfLineProgram, DecodeProgram) {
+  DebugSections Sections;
+  Sections.Line = makeLineUnit(
+      2, {
+             0, 9, DW_LNE_set_address, 0, 0x10, 0, 0, 0, 0, 0, 0,
+             DW_LNS_advance_line, 9, // Line 10.
+             DW_LNS_copy,
+             75, // Address +4, line +1.
+             DW_LNS_negate_stmt, DW_LNS_set_prologue_end,
+             0, 2, DW_LNE_set_discriminator, 3,
+             46, // Address +2.
+             DW_LNS_set_epilogue_begin, DW_LNS_set_file, 2,
+             34, // Address +1, line +2.
+             0, 3, 0x80, 0xaa, 0xbb, // Unknown extended opcode.
+             DW_LNS_advance_pc, 0x10,
+             0, 1, DW_LNE_end_sequence,
+         });
+
+  DwarfLineTable Table;
+  ASSERT_TRUE(decodeLineProgram(Sections, 0, 8, Table));
+  ASSERT_EQ(Table.size(), 5U);
+
+  const Dwarf_Addr Addresses[] = {0x1000, 0x1004, 0x1006, 0x1007, 0x1017};
+  const Dwarf_Unsigned Lines[] = {10, 11, 11, 13, 13};
+  const Dwarf_Unsigned Files[] = {1, 1, 1, 2, 2};
+  const Dwarf_Unsigned Discriminators[] = {0, 0, 3, 0, 0};
+  // The row from the special opcode after DW_LNS_set_epilogue_begin is marked
+  // as ending a sequence, as libdwarf does.
+  const uint8_t Flags[] = {
+      DwarfLineTable::BeginStatement, DwarfLineTable::BeginStatement,
+      DwarfLineTable::PrologEnd,
+      DwarfLineTable::EpilogueBegin | DwarfLineTable::EndSequence,
+      DwarfLineTable::EndSequence};
+  for (size_t Row = 0; Row < Table.size(); ++Row) {
+    EXPECT_EQ(Table.getAddress(Row), Addresses[Row]) << "Row " << Row;
+    EXPECT_EQ(Table.getLineNo(Row), Lines[Row]) << "Row " << Row;
+    EXPECT_EQ(Table.getSrcFileID(Row), Files[Row]) << "Row " << Row;
+    EXPECT_EQ(Table.getDiscriminator(Row), Discriminators[Row])
+        << "Row " << Row;
+    EXPECT_EQ(Table.getFlags(Row), Flags[Row]) << "Row " << Row;
+    EXPECT_EQ(Table.getISA(Row), 0U) << "Row " << Row;
+  }
+}
+
+TEST(DwarfLineProgram, UnsupportedProgram) {
+  const std::vector<uint8_t> Program = {DW_LNS_copy};
+  DebugSections Sections;
+  DwarfLineTable Table;
+
+  // DWARF 5 line tables are left to libdwarf.
+  Sections.Line = makeLineUnit(5, Program);
+  EXPECT_FALSE(decodeLineProgram(Sections, 0, 8, Table));
+  EXPECT_TRUE(Table.empty());
+
+  // Programs that run past the end of the section.
+  Sections.Line = makeLineUnit(4, Program);
+  Sections.Line.pop_back();
+  EXPECT_FALSE(decodeLineProgram(Sections, 0, 8, Table));
+  EXPECT_FALSE(decodeLineProgram(Sections, Sections.Line.size() + 1, 8, Table));
+
+  // Files defined in the program.
+  Sections.Line =
+      makeLineUnit(3, {0, 6, DW_LNE_define_file, 'b', 0, 0, 0, 0, DW_LNS_copy});
+  EXPECT_FALSE(decodeLineProgram(Sections, 0, 8, Table));
+  EXPECT_TRUE(Table.empty());
+}
+
+TEST(DwarfLineProgram, MatchesLibDwarf) {
+  std::string TestElfPath = getTestInputFilePath("DwarfHelpers/test.elf");
+  ASSERT_TRUE(LibScopeView::doesFileExist(TestElfPath));
+  LibScopeView::FileDescriptor FD(TestElfPath);
+  ASSERT_GT(*FD, 0);
+  DwarfDebugData DebugData(*FD);
+
+  DebugSections Sections;
+  ASSERT_TRUE(
+      readDebugSections(TestElfPath, DebugSections::LineSection, Sections));
+
+  auto CompileUnits = DebugData.getCompileUnits();
+  ASSERT_FALSE(CompileUnits.empty());
+  for (const auto &CU : CompileUnits) {
+    DwarfAttrValue StmtList(CU.CUDie.getAttr(DW_AT_stmt_list));
+    ASSERT_EQ(StmtList.getKind(), DwarfAttrValueKind::Reference);
+
+    DwarfLineTable Decoded;
+    ASSERT_TRUE(
+        decodeLineProgram(Sections, StmtList.getReference(), 8, Decoded));
+    DwarfLineTable Expected = CU.CUDie.getLineTable();
+    ASSERT_EQ(Decoded.size(), Expected.size());
+    for (size_t Row = 0; Row < Expected.size(); ++Row) {
+      EXPECT_EQ(Decoded.getAddress(Row), Expected.getAddress(Row));
+      EXPECT_EQ(Decoded.getLineNo(Row), Expected.getLineNo(Row));
+      EXPECT_EQ(Decoded.getSrcFileID(Row), Expected.getSrcFileID(Row));
+      EXPECT_EQ(Decoded.getFlags(Row), Expected.getFlags(Row));
+      EXPECT_EQ(Decoded.getISA(Row), Expected.getISA(Row));
+      EXPECT_EQ(Decoded.getDiscriminator(Row), Expected.getDiscriminator(Row));
+    }
+  }
+}
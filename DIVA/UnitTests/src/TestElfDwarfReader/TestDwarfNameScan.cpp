@@ -0,0 +1,116 @@
+//===-- ElfReader/TestDwarfNameScan.cpp -------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for scanUnitsToSkip.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfNameScan.h"
+#include "ElfDwarfReader.h"
+#include "PrintSettings.h"
+#include "ScopeTextPrinter.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+// The text view of the objects in FileName named Name, reading only the
+// compile units that it needs if NameFilter is set.
+std::string printFiltered(const std::string &FileName, const std::string &Name,
+                          bool NameFilter) {
+  LibScopeView::PrintSettings Settings;
+  Settings.showAll();
+  Settings.ShowCodeline = true;
+  Settings.ShowDWARFTag = true;
+  Settings.Filters.emplace_back(Name);
+  DwarfReader Reader;
+  if (NameFilter)
+    Reader.setNameFilter({Name});
+  auto Root = Reader.loadFile(FileName, Settings);
+  if (!Root)
+    return std::string();
+  std::stringstream Out;
+  LibScopeView::ScopeTextPrinter(Settings, FileName).print(Root.get(), Out);
+  return Out.str();
+}
+
+// The number of units scanUnitsToSkip leaves unread for Names, or -1 if every
+// unit must be read.
+int countUnitsToSkip(const std::string &FileName,
+                     const std::vector<std::string> &Names) {
+  std::vector<uint64_t> UnitsToSkip;
+  if (!scanUnitsToSkip(getTestInputFilePath(FileName), Names, UnitsToSkip, 1))
+    return -1;
+  return static_cast<int>(UnitsToSkip.size());
+}
+
+} // namespace
+
+TEST(DwarfNameScan, MatchesRead) {
+  for (const char *Name :
+       {"DwarfHelpers/test.elf", "ElfDwarfReader/lto_cross_cu.elf",
+        "ElfDwarfReader/structure.elf"}) {
+    std::string FileName = getTestInputFilePath(Name);
+    for (const char *ObjectName :
+         {"main", "foo", "bar", "p", "x", "Class", "method", "int", "test3.cpp",
+          "missing"}) {
+      std::string Expected = printFiltered(FileName, ObjectName, false);
+      ASSERT_FALSE(Expected.empty()) << Name;
+      EXPECT_EQ(Expected, printFiltered(FileName, ObjectName, true))
+          << Name << ' ' << ObjectName;
+    }
+  }
+}
+
+TEST(DwarfNameScan, SkipsUnits) {
+  // test.elf has a unit each for main, foo and bar. The unit with bar has the
+  // longest tag name (DW_TAG_formal_parameter) so it is always read.
+  EXPECT_EQ(2, countUnitsToSkip("DwarfHelpers/test.elf", {"bar"}));
+  EXPECT_EQ(1, countUnitsToSkip("DwarfHelpers/test.elf", {"foo"}));
+  EXPECT_EQ(1, countUnitsToSkip("DwarfHelpers/test.elf", {"main", "p"}));
+  EXPECT_EQ(0, countUnitsToSkip("DwarfHelpers/test.elf", {"main", "foo"}));
+  // The int of each unit.
+  EXPECT_EQ(0, countUnitsToSkip("DwarfHelpers/test.elf", {"int"}));
+
+  // Each unit of lto_cross_cu.elf refers to the other.
+  EXPECT_EQ(0, countUnitsToSkip("ElfDwarfReader/lto_cross_cu.elf", {"bar"}));
+}
+
+TEST(DwarfNameScan, NeedsRead) {
+  // Names that may be formulated rather than read.
+  for (const char *Name : {"const int", "int *", "[4]", "void", "&&", ""})
+    EXPECT_EQ(-1, countUnitsToSkip("DwarfHelpers/test.elf", {"main", Name}))
+        << Name;
+  EXPECT_EQ(-1, countUnitsToSkip("DwarfHelpers/test.elf", {}));
+
+  // A single unit, and a file that isn't ELF.
+  EXPECT_EQ(-1, countUnitsToSkip("ElfDwarfReader/aggregate.o", {"main"}));
+  EXPECT_EQ(-1, countUnitsToSkip("ElfDwarfReader/aggregate.cpp", {"main"}));
+}
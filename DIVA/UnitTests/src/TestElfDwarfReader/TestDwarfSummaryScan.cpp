@@ -0,0 +1,114 @@
+//===-- ElfReader/TestDwarfSummaryScan.cpp ----------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for scanSummaryTable.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfSummaryScan.h"
+#include "ElfDwarfReader.h"
+#include "PrintSettings.h"
+#include "SummaryTable.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+using namespace ElfDwarfReader;
+
+namespace {
+
+std::string printTable(const LibScopeView::SummaryTable &Table) {
+  std::stringstream Out;
+  Table.printSummaryTable(Out);
+  return Out.str();
+}
+
+// The summary table of the tree read from FileName.
+std::string readSummary(const std::string &FileName,
+                        const LibScopeView::PrintSettings &Settings) {
+  DwarfReader Reader;
+  auto Root = Reader.loadFile(FileName, Settings);
+  if (!Root)
+    return std::string();
+  return printTable(LibScopeView::SummaryTable(*Root, &Settings));
+}
+
+// The summary table scanned from FileName, or empty if the scan failed.
+std::string scanSummary(const std::string &FileName,
+                        const LibScopeView::PrintSettings &Settings,
+                        unsigned ThreadCount) {
+  LibScopeView::SummaryTable Table;
+  if (!scanSummaryTable(FileName, &Settings, Table, ThreadCount))
+    return std::string();
+  return printTable(Table);
+}
+
+} // namespace
+
+TEST(DwarfSummaryScan, MatchesRead) {
+  LibScopeView::PrintSettings Defaults;
+  LibScopeView::PrintSettings All;
+  All.showAll();
+  LibScopeView::PrintSettings Templates;
+  Templates.showNone();
+  Templates.ShowTemplate = true;
+
+  for (const char *Name :
+       {"ElfDwarfReader/aggregate.o", "ElfDwarfReader/import.o",
+        "ElfDwarfReader/lines.o", "ElfDwarfReader/structure.elf",
+        "ElfDwarfReader/template.o", "ElfDwarfReader/template_pack.o"}) {
+    std::string FileName = getTestInputFilePath(Name);
+    for (const auto *Settings : {&Defaults, &All, &Templates}) {
+      std::string Expected = readSummary(FileName, *Settings);
+      ASSERT_FALSE(Expected.empty()) << Name;
+      EXPECT_EQ(Expected, scanSummary(FileName, *Settings, 1)) << Name;
+      EXPECT_EQ(Expected, scanSummary(FileName, *Settings, 4)) << Name;
+    }
+  }
+}
+
+TEST(DwarfSummaryScan, NeedsRead) {
+  LibScopeView::PrintSettings Settings;
+  LibScopeView::SummaryTable Table;
+  std::string Empty = printTable(Table);
+
+  // The tree is needed to tell globals from locals.
+  Settings.ShowOnlyGlobals = true;
+  EXPECT_FALSE(scanSummaryTable(
+      getTestInputFilePath("ElfDwarfReader/aggregate.o"), &Settings, Table));
+  EXPECT_EQ(Empty, printTable(Table));
+  Settings.ShowOnlyGlobals = false;
+
+  EXPECT_FALSE(scanSummaryTable(
+      getTestInputFilePath("ElfDwarfReader/aggregate.cpp"), &Settings, Table));
+  EXPECT_EQ(Empty, printTable(Table));
+
+  // The abbreviation table isn't terminated.
+  EXPECT_FALSE(scanSummaryTable(
+      getTestInputFilePath("ElfDwarfReader/try_catch.elf"), &Settings, Table));
+  EXPECT_EQ(Empty, printTable(Table));
+}
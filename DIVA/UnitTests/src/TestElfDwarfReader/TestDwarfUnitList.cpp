@@ -0,0 +1,76 @@
+//===-- ElfReader/TestDwarfUnitList.cpp -------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for listCompileUnits and matchesCompileUnitName.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfUnitList.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+using namespace ElfDwarfReader;
+
+TEST(DwarfUnitList, ListCompileUnits) {
+  std::vector<CompileUnitListing> Units(listCompileUnits(
+      getTestInputFilePath("ElfDwarfReader/lto_cross_cu.elf")));
+  ASSERT_EQ(Units.size(), 2U);
+
+  EXPECT_EQ(Units[0].Offset, 0U);
+  EXPECT_EQ(Units[0].Size, 0x86U);
+  EXPECT_EQ(Units[0].Version, 4U);
+  EXPECT_EQ(Units[0].Name, "lto_cross_cu1.cpp");
+  EXPECT_EQ(Units[0].Producer, "clang version 5.0.0 (trunk 306824)");
+  EXPECT_EQ(Units[0].Language, "DW_LANG_C_plus_plus");
+
+  EXPECT_EQ(Units[1].Offset, 0x86U);
+  EXPECT_EQ(Units[1].Size, 72U);
+  EXPECT_EQ(Units[1].Name, "lto_cross_cu2.cpp");
+}
+
+TEST(DwarfUnitList, ListSplitCompileUnits) {
+  // The skeleton units of split.elf leave their producer and language to the
+  // split units in the .dwo files.
+  std::vector<CompileUnitListing> Units(
+      listCompileUnits(getTestInputFilePath("ElfDwarfReader/split.elf")));
+  ASSERT_EQ(Units.size(), 2U);
+  EXPECT_EQ(Units[0].Name, "type_units1.cpp");
+  EXPECT_EQ(Units[1].Name, "type_units2.cpp");
+  for (const CompileUnitListing &Unit : Units) {
+    EXPECT_NE(Unit.Producer.find("-gsplit-dwarf"), std::string::npos);
+    EXPECT_EQ(Unit.Language, "DW_LANG_C_plus_plus");
+  }
+}
+
+TEST(DwarfUnitList, MatchesCompileUnitName) {
+  EXPECT_TRUE(matchesCompileUnitName({"*.cpp"}, "/src/dir/test.cpp"));
+  EXPECT_FALSE(matchesCompileUnitName({"*.c"}, "/src/dir/test.cpp"));
+  EXPECT_TRUE(matchesCompileUnitName({"*.c", "t?st.cpp"}, "test.cpp"));
+  // Patterns with a '/' match the whole name.
+  EXPECT_TRUE(matchesCompileUnitName({"*/dir/*"}, "/src/dir/test.cpp"));
+  EXPECT_FALSE(matchesCompileUnitName({"dir/*"}, "/src/dir/test.cpp"));
+  EXPECT_FALSE(matchesCompileUnitName({}, "test.cpp"));
+}
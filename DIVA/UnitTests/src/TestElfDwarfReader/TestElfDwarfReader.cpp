@@ -603,6 +603,42 @@ TEST_F(TestElfDwarfReader, ReadGlobals) {
   EXPECT_EQ(getNthScopeIn(CU2, 0)->getType(), StructG);
 }
 
+TEST(ElfDwarfReader, ReadCompileUnitFilter) {
+  // Only CU2 is read, but the type of its function is read from CU1, with
+  // the struct that contains it.
+  LibScopeView::PrintSettings Settings;
+  Settings.SortKey = LibScopeView::SortingKey::OFFSET;
+  DwarfReader Reader;
+  Reader.setCompileUnitFilter({"*2.cpp"});
+  auto Root = Reader.loadFile(
+      getTestInputFilePath("ElfDwarfReader/lto_cross_cu.elf"), Settings);
+  ASSERT_TRUE(Root);
+  ASSERT_EQ(Root->getChildren().size(), 2U);
+
+  auto CU2 = cast<LibScopeView::Scope>(Root->getChildren()[1]);
+  EXPECT_EQ(CU2->getName(), "lto_cross_cu2.cpp");
+  EXPECT_FALSE(CU2->getLines().empty());
+  ASSERT_EQ(CU2->getChildren().size(), 1U);
+  auto Bar = CU2->getChildren()[0];
+  EXPECT_EQ(Bar->getName(), "bar");
+
+  // CU1 only has the DIEs that CU2 needs: A and G, without foo and main, and
+  // the type of G's member. Its lines aren't read.
+  auto CU1 = cast<LibScopeView::Scope>(Root->getChildren()[0]);
+  EXPECT_EQ(CU1->getName(), "lto_cross_cu1.cpp");
+  EXPECT_TRUE(CU1->getLines().empty());
+  ASSERT_EQ(CU1->getChildren().size(), 2U);
+  auto StructA = cast<LibScopeView::Scope>(CU1->getChildren()[0]);
+  EXPECT_EQ(StructA->getName(), "A");
+  ASSERT_EQ(StructA->getChildren().size(), 1U);
+  auto StructG = cast<LibScopeView::Scope>(StructA->getChildren()[0]);
+  EXPECT_EQ(Bar->getType(), StructG);
+  EXPECT_EQ(StructG->getQualifiedName(), "A::");
+  ASSERT_EQ(StructG->getChildren().size(), 1U);
+  EXPECT_EQ(StructG->getChildren()[0]->getType(), CU1->getChildren()[1]);
+  EXPECT_EQ(CU1->getChildren()[1]->getName(), "int");
+}
+
 TEST_F(TestElfDwarfReader, ReadImport) {
   LibScopeView::Scope *CU = nullptr;
   ASSERT_TRUE(loadSingleCUFromTestFile("ElfDwarfReader/import.o", &CU));
@@ -1070,6 +1106,137 @@ TEST_F(TestElfDwarfReader, ReadTypes) {
   EXPECT_EQ(PtrToMem->getType(), Unspec);
 }
 
+TEST_F(TestElfDwarfReader, ReadTypeUnits) {
+  // type_units.elf was built with -fdebug-types-section, so Point and
+  // ns::Shape are each in a type unit in .debug_types, referenced from both
+  // compile units (and from Shape) by signature.
+  LibScopeView::Scope *Root = nullptr;
+  ASSERT_TRUE(loadRootFromTestFile("ElfDwarfReader/type_units.elf", &Root));
+  ASSERT_TRUE(checkChildCount(Root, 4, 0, 0));
+
+  auto getChild = [](const LibScopeView::Scope *Parent,
+                     const std::string &Name) {
+    for (auto *Child : Parent->getChildren())
+      if (Child->getName() == Name)
+        return Child;
+    return static_cast<LibScopeView::Object *>(nullptr);
+  };
+  auto CU1 = cast<LibScopeView::Scope>(getChild(Root, "type_units1.cpp"));
+  auto CU2 = cast<LibScopeView::Scope>(getChild(Root, "type_units2.cpp"));
+  auto PointUnit = cast<LibScopeView::Scope>(getChild(Root, "Point"));
+  auto ShapeUnit = cast<LibScopeView::Scope>(getChild(Root, "Shape"));
+  EXPECT_TRUE(isa<LibScopeView::ScopeCompileUnit>(*PointUnit));
+  EXPECT_EQ(PointUnit->getDieTag(), DW_TAG_type_unit);
+  EXPECT_EQ(ShapeUnit->getDieTag(), DW_TAG_type_unit);
+
+  // Point is created once, in its type unit, with its members.
+  auto Point = cast<LibScopeView::Scope>(getChild(PointUnit, "Point"));
+  EXPECT_TRUE(Point->getIsStructType());
+  EXPECT_TRUE(checkChildCount(Point, 0, 0, 2));
+  EXPECT_EQ(getNthSymbolIn(Point, 0)->getFilePath(), "type_units.h");
+  EXPECT_TRUE(Point->getIsGlobalReference());
+
+  // Both compile units link to the same Point.
+  auto UsePoint = cast<LibScopeView::Scope>(getChild(CU1, "usePoint"));
+  EXPECT_EQ(getNthSymbolIn(UsePoint, 0)->getType(), Point);
+  EXPECT_EQ(getChild(CU2, "makePoint")->getType(), Point);
+
+  // Shape's definition links to Point in the other type unit.
+  auto Shape = cast<LibScopeView::Scope>(getChild(ShapeUnit, "Shape"));
+  EXPECT_EQ(getChild(Shape, "Origin")->getType(), Point);
+  EXPECT_EQ(getChild(CU2, "Global")->getType(), Shape);
+}
+
+TEST_F(TestElfDwarfReader, ReadTypeUnitStubs) {
+  // type_units_gcc.o was built by GCC with -fdebug-types-section, which
+  // declares S in the compile unit with only its DW_AT_signature, and links
+  // s and the pointer to S to that declaration.
+  LibScopeView::Scope *Root = nullptr;
+  ASSERT_TRUE(loadRootFromTestFile("ElfDwarfReader/type_units_gcc.o", &Root));
+  ASSERT_TRUE(checkChildCount(Root, 2, 0, 0));
+
+  auto getChild = [](const LibScopeView::Scope *Parent,
+                     const std::string &Name) {
+    for (auto *Child : Parent->getChildren())
+      if (Child->getName() == Name)
+        return Child;
+    return static_cast<LibScopeView::Object *>(nullptr);
+  };
+  auto CU = cast<LibScopeView::Scope>(getChild(Root, "type_units_gcc.cpp"));
+  auto TypeUnit = cast<LibScopeView::Scope>(getChild(Root, "S"));
+  auto S = cast<LibScopeView::Scope>(getChild(TypeUnit, "S"));
+  EXPECT_TRUE(S->getIsGlobalReference());
+
+  // The declaration is named after the type in the type unit.
+  auto Stub = cast<LibScopeView::Scope>(getChild(CU, "S"));
+  EXPECT_NE(Stub, S);
+  EXPECT_TRUE(Stub->getIsStructType());
+  EXPECT_EQ(getChild(CU, "s")->getType(), Stub);
+
+  auto Fa = cast<LibScopeView::Scope>(getChild(CU, "fa"));
+  auto Param = getNthSymbolIn(Fa, 0);
+  ASSERT_NE(Param->getType(), nullptr);
+  EXPECT_EQ(Param->getType()->getName(), "S *");
+}
+
+TEST_F(TestElfDwarfReader, ReadSplitDwarf) {
+  // split.elf was built with -gsplit-dwarf from the type_units sources in a
+  // directory that has since been removed, so its skeleton units name .dwo
+  // files that are found next to it rather than in DW_AT_comp_dir.
+  LibScopeView::Scope *Root = nullptr;
+  ASSERT_TRUE(loadRootFromTestFile("ElfDwarfReader/split.elf", &Root));
+  ASSERT_TRUE(checkChildCount(Root, 2, 0, 0));
+
+  // The units are named by the split units, and hold their DIEs.
+  auto getChild = [](const LibScopeView::Scope *Parent,
+                     const std::string &Name) {
+    for (auto *Child : Parent->getChildren())
+      if (Child->getName() == Name)
+        return Child;
+    return static_cast<LibScopeView::Object *>(nullptr);
+  };
+  auto CU1 = cast<LibScopeView::Scope>(getChild(Root, "type_units1.cpp"));
+  ASSERT_NE(getChild(Root, "type_units2.cpp"), nullptr);
+
+  auto UsePoint = cast<LibScopeView::Scope>(getChild(CU1, "usePoint"));
+  EXPECT_EQ(UsePoint->getLineNumber(), 2U);
+  auto Point = getChild(CU1, "Point");
+  EXPECT_EQ(Point->getLineNumber(), 1U);
+  EXPECT_EQ(getNthSymbolIn(UsePoint, 0)->getType(), Point);
+
+  // Addresses are indices into the .debug_addr of split.elf.
+  ASSERT_EQ(UsePoint->getRanges().size(), 1U);
+  EXPECT_EQ(UsePoint->getRanges()[0].LowPC, 0x1129U);
+  EXPECT_FALSE(CU1->getRanges().empty());
+}
+
+TEST_F(TestElfDwarfReader, ReadSplitDwarfPackage) {
+  // split_package.elf's split units, and the type units of its
+  // -fdebug-types-section, are in split_package.elf.dwp.
+  LibScopeView::Scope *Root = nullptr;
+  ASSERT_TRUE(
+      loadRootFromTestFile("ElfDwarfReader/split_package.elf", &Root));
+  ASSERT_TRUE(checkChildCount(Root, 4, 0, 0));
+
+  auto getChild = [](const LibScopeView::Scope *Parent,
+                     const std::string &Name) {
+    for (auto *Child : Parent->getChildren())
+      if (Child->getName() == Name)
+        return Child;
+    return static_cast<LibScopeView::Object *>(nullptr);
+  };
+  auto CU1 = cast<LibScopeView::Scope>(getChild(Root, "type_units1.cpp"));
+  auto CU2 = cast<LibScopeView::Scope>(getChild(Root, "type_units2.cpp"));
+  auto PointUnit = cast<LibScopeView::Scope>(getChild(Root, "Point"));
+  auto Point = getChild(PointUnit, "Point");
+
+  auto UsePoint = cast<LibScopeView::Scope>(getChild(CU1, "usePoint"));
+  EXPECT_EQ(getNthSymbolIn(UsePoint, 0)->getType(), Point);
+  EXPECT_EQ(getChild(CU2, "makePoint")->getType(), Point);
+  ASSERT_EQ(UsePoint->getRanges().size(), 1U);
+  EXPECT_EQ(UsePoint->getRanges()[0].LowPC, 0x1129U);
+}
+
 TEST_F(TestElfDwarfReader, ReadInvalidFileIndex) {
   LibScopeView::Scope *CU = nullptr;
   ASSERT_TRUE(
@@ -0,0 +1,289 @@
+//===-- ElfReader/TestIncrementalState.cpp ----------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for IncrementalState and the incremental reading of DwarfReader.
+///
+//===----------------------------------------------------------------------===//
+
+#include "DwarfFingerprint.h"
+#include "ElfDwarfReader.h"
+#include "FileUtilities.h"
+#include "IncrementalState.h"
+#include "Line.h"
+#include "ScopeTextPrinter.h"
+#include "Symbol.h"
+#include "SyntheticDwarf.h"
+#include "Type.h"
+#include "UtilsForTesting.h"
+
+#include "dwarf.h"
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+using namespace ElfDwarfReader;
+using namespace LibScopeView;
+
+namespace {
+
+// Read a file and print it with all objects and attributes shown.
+std::string readAndPrint(const std::string &FileName,
+                         const std::string &StateFile) {
+  PrintSettings Settings;
+  Settings.showAll();
+  Settings.ShowDWARFOffset = true;
+  Settings.ShowIsGlobal = true;
+  Settings.ShowQualified = true;
+  DwarfReader Reader;
+  Reader.setIncrementalStateFile(StateFile);
+  auto Root = Reader.loadFile(FileName, Settings);
+  std::stringstream Output;
+  ScopeTextPrinter(Settings, FileName).print(Root.get(), Output);
+  return Output.str();
+}
+
+void writeFile(const std::string &FileName, const std::vector<uint8_t> &Data) {
+  std::ofstream File(FileName, std::ios::binary | std::ios::trunc);
+  File.write(reinterpret_cast<const char *>(Data.data()),
+             static_cast<std::streamsize>(Data.size()));
+}
+
+} // namespace
+
+TEST(IncrementalState, EncodeDecode) {
+  auto *CU = new ScopeCompileUnit;
+  CU->setDieOffset(0x10b);
+  CU->setDieTag(DW_TAG_compile_unit);
+  CU->setName("unit.cpp");
+  CU->addRange(0x1000, 0x1100);
+  auto *Ln = new Line;
+  Ln->setAddress(0x1004);
+  Ln->setLineNumber(7);
+  Ln->setIsNewStatement();
+  CU->addChild(Ln);
+  auto *Func = new ScopeFunction;
+  Func->setDieOffset(0x120);
+  Func->setDieTag(DW_TAG_subprogram);
+  Func->setName("func");
+  Func->setIsSubprogram();
+  Func->setIsDeclaredInline();
+  CU->addChild(Func);
+  auto *Enumerator = new TypeEnumerator;
+  Enumerator->setDieOffset(0x130);
+  Enumerator->setDieTag(DW_TAG_enumerator);
+  Enumerator->setValue("42");
+  Func->addChild(Enumerator);
+  auto *Sym = new Symbol;
+  Sym->setDieOffset(0x140);
+  Sym->setDieTag(DW_TAG_member);
+  Sym->setIsMember();
+  Sym->setAccessSpecifier(AccessSpecifier::Protected);
+  Func->addChild(Sym);
+  ScopeRoot Root;
+  Root.addChild(CU);
+
+  // The function's type is in this unit and the symbol's in the next.
+  auto GetLinks = [&](const Object &Obj) {
+    ObjectLinks Links;
+    if (&Obj == Func) {
+      Links.HasType = true;
+      Links.TypeOffset = 0x130;
+    } else if (&Obj == Sym) {
+      Links.HasReference = true;
+      Links.ReferenceOffset = 0x208;
+    }
+    return Links;
+  };
+  IncrementalState State;
+  CompileUnitState Unit;
+  ASSERT_TRUE(State.encodeUnit(CU, GetLinks, {0x0, 0x100, 0x200}, Unit));
+  EXPECT_FALSE(Unit.Objects.empty());
+
+  // Move the unit to 0x300 and the next unit to 0x500.
+  std::unique_ptr<Object> Decoded;
+  CreatedObjectList Created;
+  ASSERT_TRUE(State.decodeUnit(
+      Unit, 0x300, {IncrementalState::InvalidUnitOffset, 0x300, 0x500},
+      Decoded, Created));
+  auto *NewCU = dyn_cast<ScopeCompileUnit>(Decoded.get());
+  ASSERT_NE(NewCU, nullptr);
+  EXPECT_EQ(NewCU->getDieOffset(), 0x30bu);
+  EXPECT_EQ(NewCU->getName(), "unit.cpp");
+  ASSERT_EQ(NewCU->getRanges().size(), 1u);
+  EXPECT_EQ(NewCU->getRanges()[0].HighPC, 0x1100u);
+  ASSERT_EQ(NewCU->getLines().size(), 1u);
+  EXPECT_EQ(NewCU->getLines()[0]->getAddress(), 0x1004u);
+  EXPECT_TRUE(NewCU->getLines()[0]->getIsNewStatement());
+
+  // Objects are listed in the order they were read, with relocated links.
+  ASSERT_EQ(Created.size(), 4u);
+  EXPECT_EQ(Created[0].first, NewCU);
+  auto *NewFunc = dyn_cast<ScopeFunction>(Created[1].first);
+  ASSERT_NE(NewFunc, nullptr);
+  EXPECT_TRUE(NewFunc->getIsSubprogram());
+  EXPECT_TRUE(NewFunc->getIsDeclaredInline());
+  EXPECT_FALSE(NewFunc->getIsStatic());
+  EXPECT_TRUE(Created[1].second.HasType);
+  EXPECT_EQ(Created[1].second.TypeOffset, 0x330u);
+  EXPECT_EQ(Created[2].first->getDieOffset(), 0x330u);
+  EXPECT_EQ(cast<Type>(Created[2].first)->getValue(), "42");
+  auto *NewSym = dyn_cast<Symbol>(Created[3].first);
+  ASSERT_NE(NewSym, nullptr);
+  EXPECT_TRUE(NewSym->getIsMember());
+  EXPECT_EQ(NewSym->getAccessSpecifier(), AccessSpecifier::Protected);
+  EXPECT_TRUE(Created[3].second.HasReference);
+  EXPECT_EQ(Created[3].second.ReferenceOffset, 0x508u);
+
+  // A link into a unit that no longer exists can't be decoded.
+  EXPECT_FALSE(State.decodeUnit(
+      Unit, 0x300, {0x0, 0x300, IncrementalState::InvalidUnitOffset}, Decoded,
+      Created));
+  EXPECT_EQ(Decoded, nullptr);
+  EXPECT_TRUE(Created.empty());
+
+  // An object whose kind doesn't match its tag is invalid.
+  Sym->setDieTag(DW_TAG_subprogram);
+  ASSERT_TRUE(State.encodeUnit(CU, GetLinks, {0x0, 0x100, 0x200}, Unit));
+  EXPECT_FALSE(State.decodeUnit(Unit, 0x300, {0x0, 0x300, 0x500}, Decoded,
+                                Created));
+  Sym->setDieTag(DW_TAG_member);
+
+  // As is a symbol that specifies a function in the same unit.
+  auto BadLinks = [&](const Object &Obj) {
+    ObjectLinks Links;
+    if (&Obj == Sym) {
+      Links.HasReference = true;
+      Links.ReferenceOffset = 0x120;
+    }
+    return Links;
+  };
+  ASSERT_TRUE(State.encodeUnit(CU, BadLinks, {0x0, 0x100, 0x200}, Unit));
+  EXPECT_FALSE(State.decodeUnit(Unit, 0x300, {0x0, 0x300, 0x500}, Decoded,
+                                Created));
+}
+
+TEST(IncrementalState, SaveAndLoad) {
+  ASSERT_TRUE(recursiveMakeDir(getTestOutputDir()));
+  std::string FileName(getTestOutputFilePath("state.divastate"));
+
+  IncrementalState State;
+  State.Units.resize(2);
+  State.Units[0].Hash = 0x123456789abcdef0;
+  State.Units[0].Reusable = true;
+  State.Units[0].Objects = "objects";
+  State.Units[1].ReferencedUnits = {0};
+  State.Units[1].UnknownTags = {DW_TAG_dwarf_procedure};
+  State.Units[1].UnknownAttrForms = {{DW_AT_name, DW_FORM_data1}};
+  ASSERT_TRUE(State.save(FileName));
+
+  IncrementalState Loaded;
+  ASSERT_TRUE(Loaded.load(FileName));
+  ASSERT_EQ(Loaded.Units.size(), 2u);
+  EXPECT_EQ(Loaded.Units[0].Hash, 0x123456789abcdef0u);
+  EXPECT_TRUE(Loaded.Units[0].Reusable);
+  EXPECT_EQ(Loaded.Units[0].Objects, "objects");
+  EXPECT_FALSE(Loaded.Units[1].Reusable);
+  EXPECT_EQ(Loaded.Units[1].ReferencedUnits, std::vector<uint32_t>({0}));
+  EXPECT_EQ(Loaded.Units[1].UnknownTags, std::vector<Dwarf_Half>(
+                                             {DW_TAG_dwarf_procedure}));
+  EXPECT_EQ(Loaded.Units[1].UnknownAttrForms.size(), 1u);
+
+  // Truncated and missing files are not loaded.
+  writeFile(FileName, {'D', 'I', 'V', 'A'});
+  EXPECT_FALSE(Loaded.load(FileName));
+  EXPECT_TRUE(Loaded.Units.empty());
+  EXPECT_FALSE(Loaded.load(getTestOutputFilePath("missing.divastate")));
+
+  // Nor is a file with any byte changed after the magic.
+  ASSERT_TRUE(State.save(FileName));
+  std::ifstream File(FileName, std::ios::binary);
+  std::vector<uint8_t> Saved((std::istreambuf_iterator<char>(File)),
+                             std::istreambuf_iterator<char>());
+  File.close();
+  for (size_t I = sizeof("DIVASTATE2"); I < Saved.size(); ++I) {
+    std::vector<uint8_t> Corrupt(Saved);
+    Corrupt[I] ^= 0x10;
+    writeFile(FileName, Corrupt);
+    EXPECT_FALSE(Loaded.load(FileName)) << "Byte " << I;
+  }
+}
+
+TEST(IncrementalState, ReadChangedUnit) {
+  SyntheticDwarf::Options Opts;
+  Opts.CompileUnits = 3;
+  Opts.DIEsPerCU = 300;
+  Opts.CrossCUReferences = 50;
+  std::vector<uint8_t> Data(SyntheticDwarf::generateObject(Opts));
+
+  ASSERT_TRUE(recursiveMakeDir(getTestOutputDir()));
+  std::string FileName(getTestOutputFilePath("incremental.o"));
+  std::string StateFile(FileName + ".divastate");
+  clearTestOutputFile("incremental.o.divastate");
+  writeFile(FileName, Data);
+
+  std::vector<CompileUnitFingerprint> Before(fingerprintCompileUnits(FileName));
+  ASSERT_EQ(Before.size(), 3u);
+  for (const CompileUnitFingerprint &Fingerprint : Before)
+    EXPECT_TRUE(Fingerprint.Complete);
+  // References only go to earlier units.
+  EXPECT_TRUE(Before[0].ReferencedUnits.empty());
+  EXPECT_FALSE(Before[2].ReferencedUnits.empty());
+
+  // The first read saves the state and the second reuses it.
+  std::string Expected(readAndPrint(FileName, ""));
+  EXPECT_EQ(readAndPrint(FileName, StateFile), Expected);
+  ASSERT_TRUE(doesFileExist(StateFile));
+  EXPECT_EQ(readAndPrint(FileName, StateFile), Expected);
+
+  // Change the name of the last unit, which only it uses.
+  std::string Bytes(Data.begin(), Data.end());
+  size_t NameOffset = Bytes.find("cu_2.cpp");
+  ASSERT_NE(NameOffset, std::string::npos);
+  Data[NameOffset] = 'C';
+  writeFile(FileName, Data);
+
+  std::vector<CompileUnitFingerprint> After(fingerprintCompileUnits(FileName));
+  ASSERT_EQ(After.size(), 3u);
+  EXPECT_EQ(After[0].Hash, Before[0].Hash);
+  EXPECT_EQ(After[1].Hash, Before[1].Hash);
+  EXPECT_NE(After[2].Hash, Before[2].Hash);
+
+  Expected = readAndPrint(FileName, "");
+  EXPECT_EQ(readAndPrint(FileName, StateFile), Expected);
+  EXPECT_EQ(readAndPrint(FileName, StateFile), Expected);
+
+  // A corrupted state is ignored rather than changing the output.
+  std::ifstream File(StateFile, std::ios::binary);
+  std::vector<uint8_t> State((std::istreambuf_iterator<char>(File)),
+                             std::istreambuf_iterator<char>());
+  File.close();
+  for (size_t I = 1; I <= 3; ++I)
+    State[State.size() * I / 4] ^= 0x55;
+  writeFile(StateFile, State);
+  EXPECT_EQ(readAndPrint(FileName, StateFile), Expected);
+  EXPECT_EQ(readAndPrint(FileName, StateFile), Expected);
+}
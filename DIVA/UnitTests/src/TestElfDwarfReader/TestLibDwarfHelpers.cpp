@@ -117,6 +117,46 @@ TEST_F(LibDwarfHelpers, DwarfDebugData) {
          "last Die CU offset)";
 }
 
+TEST(DwarfHelpers, TypeUnits) {
+  std::string TestElfPath =
+      getTestInputFilePath("ElfDwarfReader/type_units.elf");
+  ASSERT_TRUE(LibScopeView::doesFileExist(TestElfPath));
+  LibScopeView::FileDescriptor FD(TestElfPath);
+  ASSERT_GT(*FD, 0);
+  DwarfDebugData DebugData(*FD);
+
+  EXPECT_EQ(DebugData.getCompileUnits().size(), 2U);
+  auto TypeUnits = DebugData.getTypeUnits();
+  ASSERT_EQ(TypeUnits.size(), 2U);
+  EXPECT_EQ(TypeUnits[0].HeaderOffset, 0U);
+  EXPECT_EQ(TypeUnits[1].HeaderOffset, TypeUnits[0].NextHeaderOffset);
+  EXPECT_NE(TypeUnits[0].Signature, TypeUnits[1].Signature);
+
+  // The type offset is of the type's DIE, a child of the unit.
+  for (const auto &TU : TypeUnits) {
+    EXPECT_EQ(TU.CUDie.getTag(), DW_TAG_type_unit);
+    bool FoundType = false;
+    for (auto IT = TU.CUDie.childrenBegin(), End = TU.CUDie.childrenEnd();
+         IT != End; ++IT)
+      FoundType |= IT->getGlobalOffset() == TU.TypeOffset &&
+                   IT->getTag() == DW_TAG_structure_type;
+    EXPECT_TRUE(FoundType);
+  }
+
+  // Shape's Origin member references Point by its signature.
+  auto Shape = TypeUnits[0].CUDie.childrenBegin();
+  while (!Shape.atEnd() && Shape->getGlobalOffset() != TypeUnits[0].TypeOffset)
+    ++Shape;
+  ASSERT_FALSE(Shape.atEnd());
+  auto Origin = Shape->childrenBegin();
+  ASSERT_FALSE(Origin.atEnd());
+  EXPECT_EQ(Origin->getName(), "Origin");
+  DwarfAttrValue Type(Origin->getAttr(DW_AT_type));
+  ASSERT_EQ(Type.getKind(), DwarfAttrValueKind::Signature);
+  EXPECT_EQ(Type.getForm(), DW_FORM_ref_sig8);
+  EXPECT_EQ(Type.getSignature(), TypeUnits[1].Signature);
+}
+
 TEST_F(LibDwarfHelpers, DwarfDie) {
   auto CompileUnits = TestDebugData.getCompileUnits();
   ASSERT_NE(CompileUnits.size(), 0U);
@@ -0,0 +1,81 @@
+//===-- ElfDwarfReader/TestObjectTable.cpp ----------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for ObjectTable.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ObjectTable.h"
+#include "Symbol.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+using namespace ElfDwarfReader;
+using namespace LibScopeView;
+
+TEST(ObjectTable, InsertAndFind) {
+  ObjectTable Table;
+  Symbol A, B, C, D;
+  EXPECT_EQ(Table.find(0), nullptr);
+
+  // In order, out of order, and on another page.
+  Table.insert(0xb, &A);
+  Table.insert(0x4f, &B);
+  Table.insert(0x2a, &C);
+  Table.insert(0x123456, &D);
+  EXPECT_EQ(Table.size(), 4U);
+
+  EXPECT_EQ(Table.find(0xb), &A);
+  EXPECT_EQ(Table.find(0x4f), &B);
+  EXPECT_EQ(Table.find(0x2a), &C);
+  EXPECT_EQ(Table.find(0x123456), &D);
+
+  EXPECT_EQ(Table.find(0), nullptr);
+  EXPECT_EQ(Table.find(0xc), nullptr);
+  EXPECT_EQ(Table.find(0x50000), nullptr);
+  EXPECT_EQ(Table.find(0x123457), nullptr);
+  EXPECT_EQ(Table.find(UINT64_MAX), nullptr);
+
+  Table.clear();
+  EXPECT_EQ(Table.size(), 0U);
+  EXPECT_EQ(Table.find(0xb), nullptr);
+}
+
+TEST(ObjectTable, DenseOffsets) {
+  // Every offset of a few pages, inserted backwards within each word.
+  const uint64_t Count = 3 * 4096 + 100;
+  std::vector<Symbol> Objects(Count);
+  ObjectTable Table;
+  for (uint64_t Word = 0; Word < Count; Word += 64)
+    for (uint64_t Offset = std::min(Word + 64, Count); Offset > Word; --Offset)
+      Table.insert(Offset - 1, &Objects[Offset - 1]);
+  ASSERT_EQ(Table.size(), Count);
+  for (uint64_t Offset = 0; Offset < Count; ++Offset)
+    EXPECT_EQ(Table.find(Offset), &Objects[Offset]);
+  EXPECT_EQ(Table.find(Count), nullptr);
+  EXPECT_GE(Table.getAllocatedBytes(), Count * sizeof(Object *));
+}
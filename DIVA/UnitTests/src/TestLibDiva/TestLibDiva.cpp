@@ -0,0 +1,239 @@
+//===-- UnitTests/TestLibDiva/TestLibDiva.cpp -------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the C and C++ interfaces to DIVA.
+///
+//===----------------------------------------------------------------------===//
+
+#include "LibDiva.h"
+#include "LibDivaCpp.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const uint16_t DW_TAG_subprogram = 0x2e;
+
+std::string getInput() {
+  return getTestInputFilePath("DwarfHelpers/test.elf");
+}
+
+// Get the first child of Parent named Name, or null.
+const diva_object *findChild(const diva_object *Parent,
+                             const std::string &Name) {
+  for (size_t I = 0; I < diva_child_count(Parent); ++I)
+    if (diva_object_name(diva_child(Parent, I)) == Name)
+      return diva_child(Parent, I);
+  return nullptr;
+}
+
+std::string render(const diva_tree *Tree,
+                   const std::vector<const char *> &Options) {
+  char *Output = nullptr;
+  size_t OutputSize = 0;
+  EXPECT_EQ(diva_render(Tree, Options.data(), Options.size(), &Output,
+                        &OutputSize),
+            DIVA_OK)
+      << diva_last_error();
+  std::string Text(Output ? Output : "", OutputSize);
+  diva_free(Output);
+  return Text;
+}
+
+} // namespace
+
+TEST(LibDiva, Version) {
+  EXPECT_EQ(diva_api_version(), DIVA_API_VERSION);
+  EXPECT_NE(std::string(diva_version()), "");
+}
+
+TEST(LibDiva, WalksTree) {
+  diva_tree *Tree = nullptr;
+  ASSERT_EQ(diva_open(getInput().c_str(), nullptr, 0, &Tree), DIVA_OK)
+      << diva_last_error();
+  EXPECT_STREQ(diva_tree_warnings(Tree), "");
+
+  ASSERT_EQ(diva_cu_count(Tree), 3u);
+  EXPECT_EQ(diva_cu(Tree, 3), nullptr);
+  const diva_object *CU = diva_cu(Tree, 0);
+  EXPECT_STREQ(diva_object_kind(CU), "CompileUnit");
+  EXPECT_STREQ(diva_object_name(CU), "test1.cpp");
+  EXPECT_STREQ(diva_object_name(diva_cu(Tree, 2)), "test3.cpp");
+  EXPECT_EQ(diva_parent(CU), diva_tree_root(Tree));
+  EXPECT_EQ(diva_parent(diva_tree_root(Tree)), nullptr);
+
+  // The compile unit also holds the types that aren't printed by default.
+  const diva_object *Main = findChild(CU, "main");
+  ASSERT_NE(Main, nullptr);
+  EXPECT_STREQ(diva_object_kind(Main), "Function");
+  EXPECT_STREQ(diva_object_name(Main), "main");
+  EXPECT_STREQ(diva_object_type_name(Main), "int");
+  EXPECT_STREQ(diva_object_name(diva_object_type(Main)), "int");
+  EXPECT_EQ(diva_object_line(Main), 4u);
+  EXPECT_EQ(diva_object_dwarf_tag(Main), DW_TAG_subprogram);
+  EXPECT_NE(diva_object_dwarf_offset(Main), 0u);
+  EXPECT_EQ(diva_child(CU, diva_child_count(CU)), nullptr);
+
+  ASSERT_EQ(diva_child_count(Main), 1u);
+  const diva_object *X = diva_child(Main, 0);
+  EXPECT_STREQ(diva_object_kind(X), "Variable");
+  EXPECT_STREQ(diva_object_name(X), "x");
+  EXPECT_EQ(diva_object_line(X), 5u);
+  EXPECT_EQ(diva_parent(X), Main);
+  EXPECT_EQ(diva_child_count(X), 0u);
+
+  diva_close(Tree);
+}
+
+TEST(LibDiva, ListsLinesLast) {
+  diva_tree *Tree = nullptr;
+  ASSERT_EQ(diva_open(getTestInputFilePath("ElfDwarfReader/lines.o").c_str(),
+                      nullptr, 0, &Tree),
+            DIVA_OK)
+      << diva_last_error();
+  ASSERT_EQ(diva_cu_count(Tree), 1u);
+  const diva_object *CU = diva_cu(Tree, 0);
+  size_t Count = diva_child_count(CU);
+  ASSERT_GT(Count, 1u);
+  const diva_object *Last = diva_child(CU, Count - 1);
+  EXPECT_STREQ(diva_object_kind(Last), "CodeLine");
+  EXPECT_NE(diva_object_line(Last), 0u);
+  EXPECT_NE(findChild(CU, "main"), nullptr);
+  diva_close(Tree);
+}
+
+TEST(LibDiva, Renders) {
+  diva_tree *Tree = nullptr;
+  ASSERT_EQ(diva_open(getInput().c_str(), nullptr, 0, &Tree), DIVA_OK)
+      << diva_last_error();
+
+  std::string Filtered = render(Tree, {"--filter=bar"});
+  EXPECT_NE(Filtered.find("{Function} \"bar\" -> \"int\""), std::string::npos);
+  EXPECT_EQ(Filtered.find("\"main\""), std::string::npos);
+
+  std::string Full = render(Tree, {});
+  EXPECT_NE(Full.find("\"main\""), std::string::npos);
+  EXPECT_NE(render(Tree, {"--output=yaml"}).find("main"), std::string::npos);
+
+  // Rendering can't sort the tree again.
+  const char *Sort[] = {"--sort=name"};
+  char *Output = nullptr;
+  EXPECT_EQ(diva_render(Tree, Sort, 1, &Output, nullptr),
+            DIVA_INVALID_ARGUMENT);
+  EXPECT_EQ(Output, nullptr);
+  EXPECT_NE(std::string(diva_last_error()), "");
+
+  diva_close(Tree);
+}
+
+TEST(LibDiva, ReportsErrors) {
+  diva_tree *Tree = nullptr;
+  EXPECT_EQ(diva_open(getTestInputFilePath("missing.elf").c_str(), nullptr, 0,
+                      &Tree),
+            DIVA_ERROR);
+  EXPECT_EQ(Tree, nullptr);
+  EXPECT_NE(std::string(diva_last_error()).find("ERR_FILE_NOT_FOUND"),
+            std::string::npos);
+
+  const char *Unknown[] = {"--not-an-option"};
+  EXPECT_EQ(diva_open(getInput().c_str(), Unknown, 1, &Tree), DIVA_ERROR);
+  EXPECT_NE(std::string(diva_last_error()).find("ERR_CMD_UNKNOWN_ARG"),
+            std::string::npos);
+
+  const char *Input[] = {"other.elf"};
+  EXPECT_EQ(diva_open(getInput().c_str(), Input, 1, &Tree),
+            DIVA_INVALID_ARGUMENT);
+  EXPECT_EQ(diva_open(nullptr, nullptr, 0, &Tree), DIVA_INVALID_ARGUMENT);
+
+  EXPECT_EQ(diva_open(getTestInputFilePath("Test.txt").c_str(), nullptr, 0,
+                      &Tree),
+            DIVA_ERROR);
+  EXPECT_NE(std::string(diva_last_error()).find("ERR_INVALID_FILE"),
+            std::string::npos);
+}
+
+TEST(LibDiva, SharesTreeBetweenThreads) {
+  diva_tree *Tree = nullptr;
+  ASSERT_EQ(diva_open(getInput().c_str(), nullptr, 0, &Tree), DIVA_OK)
+      << diva_last_error();
+  const std::string Expected = render(Tree, {"--filter=foo"});
+
+  // Each thread renders the shared tree, walks it, and opens and fails to
+  // open files of its own.
+  const size_t ThreadCount = 4;
+  std::vector<std::string> Rendered(ThreadCount);
+  std::vector<std::string> Errors(ThreadCount);
+  std::vector<size_t> CUCounts(ThreadCount);
+  std::vector<std::thread> Threads;
+  for (size_t I = 0; I < ThreadCount; ++I) {
+    Threads.emplace_back([&, I]() {
+      Rendered[I] = render(Tree, {"--filter=foo"});
+      diva_tree *Own = nullptr;
+      if (diva_open(getInput().c_str(), nullptr, 0, &Own) == DIVA_OK) {
+        CUCounts[I] = diva_cu_count(Own);
+        diva_close(Own);
+      }
+      const std::string Missing = "missing" + std::to_string(I) + ".elf";
+      if (diva_open(Missing.c_str(), nullptr, 0, &Own) == DIVA_ERROR)
+        Errors[I] = diva_last_error();
+    });
+  }
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  for (size_t I = 0; I < ThreadCount; ++I) {
+    EXPECT_EQ(Rendered[I], Expected);
+    EXPECT_EQ(CUCounts[I], 3u);
+    EXPECT_NE(Errors[I].find("missing" + std::to_string(I) + ".elf"),
+              std::string::npos);
+  }
+  diva_close(Tree);
+}
+
+TEST(LibDiva, CppInterface) {
+  LibDiva::Tree Tree(getInput());
+  ASSERT_EQ(Tree.getCompileUnitCount(), 3u);
+  LibDiva::ObjectRef Foo(findChild(Tree.getCompileUnit(1).getHandle(), "foo"));
+  ASSERT_TRUE(Foo);
+  EXPECT_EQ(Foo.getParent().getName(), "test2.cpp");
+  EXPECT_EQ(Foo.getTypeName(), "int");
+  EXPECT_EQ(Foo.getLineNumber(), 1u);
+  EXPECT_FALSE(Tree.getCompileUnit(3));
+  EXPECT_NE(Tree.render({"--filter=foo"}).find("\"foo\""), std::string::npos);
+
+  try {
+    LibDiva::Tree Missing(getTestInputFilePath("missing.elf"));
+    FAIL() << "Opened a missing file";
+  } catch (const LibDiva::Error &Error) {
+    EXPECT_EQ(Error.getStatus(), DIVA_ERROR);
+    EXPECT_NE(std::string(Error.what()).find("ERR_FILE_NOT_FOUND"),
+              std::string::npos);
+  }
+}
@@ -0,0 +1,143 @@
+//===-- UnitTests/TestLibScopeView/TestAddressIndex.cpp ---------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the address index.
+///
+//===----------------------------------------------------------------------===//
+
+#include "AddressIndex.h"
+#include "Line.h"
+#include "Scope.h"
+
+#include "gtest/gtest.h"
+
+using namespace LibScopeView;
+
+namespace {
+
+// CU [0x100, 0x200)
+//   Function "foo" [0x100, 0x140)
+//     Inlined "bar" [0x110, 0x120) and [0x130, 0x138)
+//       Block [0x110, 0x118)
+//   Function "baz" [0x180, 0x190)
+//   Lines 0x100, 0x110, 0x130, end 0x140, 0x180, end 0x190
+struct TestTree {
+  ScopeRoot Root;
+  ScopeCompileUnit *CU = new ScopeCompileUnit();
+  ScopeFunction *Foo = new ScopeFunction();
+  ScopeFunctionInlined *Bar = new ScopeFunctionInlined();
+  Scope *Block = new Scope();
+  ScopeFunction *Baz = new ScopeFunction();
+  std::vector<Line *> Lines;
+
+  TestTree() {
+    CU->addRange(0x100, 0x200);
+    Foo->addRange(0x100, 0x140);
+    Bar->addRange(0x110, 0x120);
+    Bar->addRange(0x130, 0x138);
+    Block->addRange(0x110, 0x118);
+    Baz->addRange(0x180, 0x190);
+
+    Root.addChild(CU);
+    CU->addChild(Foo);
+    Foo->addChild(Bar);
+    Bar->addChild(Block);
+    CU->addChild(Baz);
+
+    for (Dwarf_Addr Address : {0x100, 0x110, 0x130, 0x140, 0x180, 0x190}) {
+      auto *Ln = new Line();
+      Ln->setAddress(Address);
+      if (Address == 0x140 || Address == 0x190)
+        Ln->setIsLineEndSequence();
+      CU->addChild(Ln);
+      Lines.push_back(Ln);
+    }
+  }
+};
+
+} // namespace
+
+TEST(AddressIndex, Scopes) {
+  TestTree Tree;
+  AddressIndex Index(Tree.Root);
+
+  EXPECT_EQ(Index.findScope(0xff), nullptr);
+  EXPECT_EQ(Index.findScope(0x100), Tree.Foo);
+  EXPECT_EQ(Index.findScope(0x110), Tree.Block);
+  EXPECT_EQ(Index.findScope(0x117), Tree.Block);
+  EXPECT_EQ(Index.findScope(0x118), Tree.Bar);
+  EXPECT_EQ(Index.findScope(0x120), Tree.Foo);
+  EXPECT_EQ(Index.findScope(0x134), Tree.Bar);
+  EXPECT_EQ(Index.findScope(0x138), Tree.Foo);
+  EXPECT_EQ(Index.findScope(0x140), Tree.CU);
+  EXPECT_EQ(Index.findScope(0x18f), Tree.Baz);
+  EXPECT_EQ(Index.findScope(0x1ff), Tree.CU);
+  EXPECT_EQ(Index.findScope(0x200), nullptr);
+}
+
+TEST(AddressIndex, Lines) {
+  TestTree Tree;
+  AddressIndex Index(Tree.Root);
+
+  EXPECT_EQ(Index.findLine(0xff), nullptr);
+  EXPECT_EQ(Index.findLine(0x100), Tree.Lines[0]);
+  EXPECT_EQ(Index.findLine(0x12f), Tree.Lines[1]);
+  EXPECT_EQ(Index.findLine(0x13f), Tree.Lines[2]);
+  // Between the sequences.
+  EXPECT_EQ(Index.findLine(0x140), nullptr);
+  EXPECT_EQ(Index.findLine(0x185), Tree.Lines[4]);
+  EXPECT_EQ(Index.findLine(0x190), nullptr);
+}
+
+TEST(AddressIndex, SharedStart) {
+  // A function and the block filling it start at the same address, and a
+  // sequence starts where another ends.
+  ScopeRoot Root;
+  auto *Func = new ScopeFunction();
+  auto *Block = new Scope();
+  Func->addRange(0x10, 0x20);
+  Block->addRange(0x10, 0x20);
+  Root.addChild(Func);
+  Func->addChild(Block);
+
+  auto *First = new Line();
+  First->setAddress(0x10);
+  auto *End = new Line();
+  End->setAddress(0x18);
+  End->setIsLineEndSequence();
+  auto *Next = new Line();
+  Next->setAddress(0x18);
+  // The sequence that starts at 0x18 comes first in the table.
+  Func->addChild(Next);
+  Func->addChild(First);
+  Func->addChild(End);
+
+  AddressIndex Index(Root);
+  EXPECT_EQ(Index.findScope(0x10), Block);
+  EXPECT_EQ(Index.findScope(0x1f), Block);
+  EXPECT_EQ(Index.findScope(0x20), nullptr);
+  EXPECT_EQ(Index.findLine(0x17), First);
+  EXPECT_EQ(Index.findLine(0x18), Next);
+}
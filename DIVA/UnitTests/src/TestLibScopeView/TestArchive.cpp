@@ -0,0 +1,115 @@
+//===-- UnitTests/TestLibScopeView/TestArchive.cpp --------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the static archive parsing in LibScopeView/Archive.h.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Archive.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+
+using namespace LibScopeView;
+
+namespace {
+
+/// \brief Append a member header and its contents (padded to an even size) to
+/// Archive.
+void addMember(std::string &Archive, const std::string &Name,
+               const std::string &Contents) {
+  char Header[61];
+  snprintf(Header, sizeof(Header), "%-16s%-12s%-6s%-6s%-8s%-10zu`\n",
+           Name.c_str(), "0", "0", "0", "644", Contents.size());
+  Archive.append(Header, 60);
+  Archive += Contents;
+  if (Contents.size() % 2)
+    Archive += '\n';
+}
+
+} // namespace
+
+TEST(Archive, GnuMembers) {
+  std::string Archive("!<arch>\n");
+  addMember(Archive, "/", std::string("\0\0\0\0", 4));
+  addMember(Archive, "//", "a_long_member_name.o/\nanother long name.o/\n");
+  addMember(Archive, "short.o/", "odd");
+  addMember(Archive, "/0", "first");
+  addMember(Archive, "/22", "second");
+
+  std::vector<ArchiveMember> Members;
+  ASSERT_TRUE(getArchiveMembers(Archive.data(), Archive.size(), Members));
+  ASSERT_EQ(Members.size(), 3u);
+  EXPECT_EQ(Members[0].Name, "short.o");
+  EXPECT_EQ(Archive.substr(Members[0].Offset, Members[0].Size), "odd");
+  EXPECT_EQ(Members[1].Name, "a_long_member_name.o");
+  EXPECT_EQ(Archive.substr(Members[1].Offset, Members[1].Size), "first");
+  EXPECT_EQ(Members[2].Name, "another long name.o");
+  EXPECT_EQ(Archive.substr(Members[2].Offset, Members[2].Size), "second");
+}
+
+TEST(Archive, BsdMembers) {
+  std::string Archive("!<arch>\n");
+  addMember(Archive, "#1/20", std::string("__.SYMDEF SORTED\0\0\0\0", 20));
+  addMember(Archive, "#1/20", std::string("a_long_member.o\0\0\0\0\0", 20) +
+                                  "contents");
+  addMember(Archive, "short.o", "x");
+
+  std::vector<ArchiveMember> Members;
+  ASSERT_TRUE(getArchiveMembers(Archive.data(), Archive.size(), Members));
+  ASSERT_EQ(Members.size(), 2u);
+  EXPECT_EQ(Members[0].Name, "a_long_member.o");
+  EXPECT_EQ(Archive.substr(Members[0].Offset, Members[0].Size), "contents");
+  EXPECT_EQ(Members[1].Name, "short.o");
+  EXPECT_EQ(Archive.substr(Members[1].Offset, Members[1].Size), "x");
+}
+
+TEST(Archive, Malformed) {
+  std::vector<ArchiveMember> Members;
+  std::string Magic("!<arch>\n");
+  EXPECT_TRUE(getArchiveMembers(Magic.data(), Magic.size(), Members));
+  EXPECT_TRUE(Members.empty());
+
+  std::string Thin("!<thin>\n");
+  EXPECT_FALSE(getArchiveMembers(Thin.data(), Thin.size(), Members));
+
+  // A member that is larger than the archive.
+  std::string Truncated(Magic);
+  addMember(Truncated, "a.o/", "contents");
+  Truncated.resize(Truncated.size() - 2);
+  EXPECT_FALSE(getArchiveMembers(Truncated.data(), Truncated.size(), Members));
+
+  // A long name without a table of names.
+  std::string NoNames(Magic);
+  addMember(NoNames, "/0", "contents");
+  EXPECT_FALSE(getArchiveMembers(NoNames.data(), NoNames.size(), Members));
+
+  // A bad header terminator.
+  std::string BadHeader(Magic);
+  addMember(BadHeader, "a.o/", "contents");
+  BadHeader[Magic.size() + 58] = '!';
+  EXPECT_FALSE(getArchiveMembers(BadHeader.data(), BadHeader.size(), Members));
+}
@@ -32,6 +32,8 @@
 
 #include "gtest/gtest.h"
 
+#include <fstream>
+
 using namespace LibScopeView;
 
 // There are currently no unit tests for the following functions:
@@ -202,3 +204,33 @@ TEST(FileUtilities, isElfSucceedsOnElfs) {
   EXPECT_TRUE(isFileFormatElf(FileLocation));
 }
 
+
+TEST(FileUtilities, matchGlob) {
+  EXPECT_TRUE(matchGlob("*.o", "test.o"));
+  EXPECT_TRUE(matchGlob("*.o", ".o"));
+  EXPECT_FALSE(matchGlob("*.o", "test.obj"));
+  EXPECT_TRUE(matchGlob("t?st.*", "test.elf"));
+  EXPECT_FALSE(matchGlob("t?st.*", "tst.elf"));
+  EXPECT_TRUE(matchGlob("lib[abc].a", "libb.a"));
+  EXPECT_FALSE(matchGlob("lib[!abc].a", "libb.a"));
+  EXPECT_TRUE(matchGlob("lib[a-c].a", "libc.a"));
+  EXPECT_TRUE(matchGlob("*/obj/*.o", "src/obj/main.o"));
+  EXPECT_TRUE(matchGlob("*a*b*", "xaybz"));
+  EXPECT_FALSE(matchGlob("*a*b*", "xbyaz"));
+  EXPECT_TRUE(matchGlob("*", ""));
+  EXPECT_FALSE(matchGlob("?", ""));
+}
+
+TEST(FileUtilities, listFilesRecursively) {
+  const std::string Dir = getTestOutputFilePath("ListFiles/");
+  ASSERT_TRUE(recursiveMakeDir(Dir + "b/c"));
+  for (const char *File : {"a.o", "b/d.o", "b/c/e.o"})
+    std::ofstream(Dir + File) << File;
+
+  std::vector<std::string> Files;
+  ASSERT_TRUE(listFilesRecursively(Dir, Files));
+  EXPECT_EQ(Files, std::vector<std::string>(
+                       {Dir + "a.o", Dir + "b/c/e.o", Dir + "b/d.o"}));
+
+  EXPECT_FALSE(listFilesRecursively(Dir + "missing", Files));
+}
@@ -0,0 +1,124 @@
+//===-- UnitTests/TestLibScopeView/TestGzipStream.cpp -----------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for GzipOutputStream.
+///
+//===----------------------------------------------------------------------===//
+
+#include "GzipStream.h"
+
+#include "gtest/gtest.h"
+#include "zlib.h"
+
+#include <sstream>
+
+using namespace LibScopeView;
+
+namespace {
+
+// Decompress gzip data made of one or more members, returning the number of
+// members in MemberCount.
+std::string decompress(const std::string &Compressed, size_t &MemberCount) {
+  std::string Result;
+  MemberCount = 0;
+  z_stream Stream = {};
+  EXPECT_EQ(inflateInit2(&Stream, 15 + 16), Z_OK);
+  Stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(
+      Compressed.data()));
+  Stream.avail_in = static_cast<uInt>(Compressed.size());
+  char Buffer[4096];
+  for (;;) {
+    Stream.next_out = reinterpret_cast<Bytef *>(Buffer);
+    Stream.avail_out = sizeof(Buffer);
+    int Ret = inflate(&Stream, Z_NO_FLUSH);
+    Result.append(Buffer, sizeof(Buffer) - Stream.avail_out);
+    if (Ret == Z_STREAM_END) {
+      ++MemberCount;
+      if (Stream.avail_in == 0)
+        break;
+      inflateReset(&Stream);
+    } else if (Ret != Z_OK) {
+      ADD_FAILURE() << "inflate failed: " << Ret;
+      break;
+    }
+  }
+  inflateEnd(&Stream);
+  return Result;
+}
+
+std::string makeText(size_t Lines) {
+  std::stringstream Text;
+  for (size_t I = 0; I < Lines; ++I)
+    Text << "{Line} " << I << " 0x" << std::hex << I * 16 << std::dec
+         << " \"file.cpp\"\n";
+  return Text.str();
+}
+
+} // namespace
+
+TEST(GzipStream, Empty) {
+  std::stringstream Output;
+  { GzipOutputStream Compressed(Output); }
+
+  // Nothing is written, as for an uncompressed stream.
+  EXPECT_TRUE(Output.str().empty());
+}
+
+TEST(GzipStream, SingleBlock) {
+  std::string Text(makeText(100));
+  std::stringstream Output;
+  GzipOutputStream Compressed(Output);
+  Compressed << Text << std::flush;
+  // Flushing doesn't end the member.
+  EXPECT_TRUE(Output.str().empty());
+  Compressed.close();
+
+  size_t MemberCount;
+  EXPECT_EQ(decompress(Output.str(), MemberCount), Text);
+  EXPECT_EQ(MemberCount, 1U);
+  EXPECT_LT(Output.str().size(), Text.size());
+}
+
+TEST(GzipStream, ParallelBlocks) {
+  std::string Text(makeText(10000));
+  const size_t BlockSize = 4096;
+  for (unsigned Threads : {1U, 2U, 8U}) {
+    std::stringstream Output;
+    GzipOutputStream Compressed(Output, BlockSize, Threads);
+    // Write in pieces that don't line up with the blocks.
+    for (size_t Pos = 0; Pos < Text.size(); Pos += 1000)
+      Compressed << Text.substr(Pos, 1000);
+    Compressed.close();
+    // Writing after close is an error.
+    Compressed << "more";
+    EXPECT_TRUE(Compressed.fail());
+
+    size_t MemberCount;
+    EXPECT_EQ(decompress(Output.str(), MemberCount), Text)
+        << "Threads " << Threads;
+    EXPECT_EQ(MemberCount, (Text.size() + BlockSize - 1) / BlockSize)
+        << "Threads " << Threads;
+  }
+}
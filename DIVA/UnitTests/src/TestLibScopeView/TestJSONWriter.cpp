@@ -0,0 +1,133 @@
+//===-- UnitTests/TestLibScopeView/TestJSONWriter.cpp -----------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for LibScopeView::JSONWriter.
+///
+//===----------------------------------------------------------------------===//
+
+#include "JSONWriter.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+using namespace LibScopeView;
+
+TEST(JSONWriter, Values) {
+  std::stringstream Output;
+  JSONWriter JSON(Output);
+  JSON.beginObject();
+  JSON.key("string");
+  JSON.string("text");
+  JSON.key("true");
+  JSON.boolean(true);
+  JSON.key("false");
+  JSON.boolean(false);
+  JSON.key("number");
+  JSON.number(18446744073709551615ULL);
+  JSON.key("signed");
+  JSON.signedNumber(-5);
+  JSON.key("null");
+  JSON.null();
+  JSON.endObject();
+  EXPECT_EQ(Output.str(), "{\"string\":\"text\",\"true\":true,\"false\":false,"
+                          "\"number\":18446744073709551615,\"signed\":-5,"
+                          "\"null\":null}");
+}
+
+TEST(JSONWriter, Nesting) {
+  std::stringstream Output;
+  JSONWriter JSON(Output);
+  JSON.beginArray();
+  JSON.beginObject();
+  JSON.endObject();
+  JSON.beginArray();
+  JSON.endArray();
+  JSON.beginObject();
+  JSON.key("a");
+  JSON.beginArray();
+  JSON.number(1);
+  JSON.beginObject();
+  JSON.key("b");
+  JSON.beginObject();
+  JSON.endObject();
+  JSON.key("c");
+  JSON.number(2);
+  JSON.endObject();
+  JSON.number(3);
+  JSON.endArray();
+  JSON.key("d");
+  JSON.null();
+  JSON.endObject();
+  JSON.endArray();
+  EXPECT_EQ(Output.str(), "[{},[],{\"a\":[1,{\"b\":{},\"c\":2},3],\"d\":null}]");
+}
+
+TEST(JSONWriter, Escaping) {
+  std::stringstream Output;
+  JSONWriter JSON(Output);
+  const char Raw[] = "\"quoted\" back\\slash\n\r\t\x01\x1f end\0";
+  JSON.string(std::string(Raw, sizeof(Raw) - 1));
+  EXPECT_EQ(Output.str(), "\"\\\"quoted\\\" back\\\\slash\\n\\r\\t\\u0001\\u001f "
+                          "end\\u0000\"");
+
+  Output.str("");
+  writeJSONString(Output, "a\"b");
+  EXPECT_EQ(Output.str(), "\"a\\\"b\"");
+}
+
+TEST(JSONWriter, StringParts) {
+  std::stringstream Output;
+  JSONWriter JSON(Output);
+  JSON.beginArray();
+  JSON.beginString();
+  JSON.appendString("Q::");
+  JSON.appendString(std::string("\"Name\""));
+  JSON.endString();
+  JSON.beginString();
+  JSON.endString();
+  JSON.endArray();
+  EXPECT_EQ(Output.str(), "[\"Q::\\\"Name\\\"\",\"\"]");
+}
+
+TEST(JSONWriter, Lines) {
+  std::stringstream Output;
+  JSONWriter JSON(Output);
+  for (uint64_t ID = 0; ID < 2; ++ID) {
+    JSON.beginObject();
+    JSON.key("id");
+    JSON.number(ID);
+    JSON.endObject();
+    JSON.newline();
+  }
+  EXPECT_EQ(Output.str(), "{\"id\":0}\n{\"id\":1}\n");
+
+  // Reset starts a new document on another stream.
+  std::stringstream Other;
+  JSON.number(2);
+  JSON.reset(Other);
+  JSON.number(3);
+  EXPECT_EQ(Other.str(), "3");
+}
@@ -0,0 +1,143 @@
+//===-- UnitTests/TestLibScopeView/TestMemoryProfile.cpp --------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for LibScopeView::MemoryProfile and LibScopeView::MemoryOwner.
+///
+//===----------------------------------------------------------------------===//
+
+#include "MemoryProfile.h"
+#include "Scope.h"
+#include "Symbol.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+using namespace LibScopeView;
+
+TEST(MemoryProfile, AllocationBytes) {
+  EXPECT_EQ(getAllocationBytes(0), 0u);
+  // Small allocations take the minimum size, larger ones add a header and
+  // round up to the alignment.
+  EXPECT_EQ(getAllocationBytes(1), 4 * sizeof(size_t));
+  EXPECT_EQ(getAllocationBytes(100) % (2 * sizeof(size_t)), 0u);
+  EXPECT_GE(getAllocationBytes(100), 100u + sizeof(size_t));
+
+  EXPECT_EQ(getHeapBytes(std::string("short")), 0u);
+  EXPECT_EQ(getHeapBytes(std::string(100, 'x')),
+            getAllocationBytes(std::string(100, 'x').capacity() + 1));
+
+  std::vector<uint32_t> Vec;
+  EXPECT_EQ(getHeapBytes(Vec), 0u);
+  Vec.reserve(10);
+  EXPECT_EQ(getHeapBytes(Vec), getAllocationBytes(Vec.capacity() * 4));
+}
+
+TEST(MemoryProfile, NoActiveProfile) {
+  setActiveMemoryProfile(nullptr);
+  EXPECT_EQ(getActiveMemoryProfile(), nullptr);
+  // Owners and samples without an active profile are ignored.
+  bool Measured = false;
+  MemoryOwner Owner([&](MemoryOwnerBytes &) { Measured = true; });
+  sampleMemory("Ignored");
+  EXPECT_FALSE(Measured);
+}
+
+TEST(MemoryProfile, Owners) {
+  MemoryProfile Profile;
+  setActiveMemoryProfile(&Profile);
+  {
+    MemoryOwner Owner(
+        [](MemoryOwnerBytes &OwnerBytes) { OwnerBytes["Test"] += 4096; });
+    sampleMemory("First");
+  }
+  {
+    MemoryOwner Owner(
+        [](MemoryOwnerBytes &OwnerBytes) { OwnerBytes["Test"] += 1024; });
+    sampleMemory("Second");
+  }
+  sampleMemory("Third");
+  setActiveMemoryProfile(nullptr);
+
+  const auto &Samples = Profile.getSamples();
+  ASSERT_EQ(Samples.size(), 3u);
+  EXPECT_STREQ(Samples[0].Phase, "First");
+  EXPECT_EQ(Samples[0].OwnerBytes.at("Test"), 4096u);
+  EXPECT_EQ(Samples[1].OwnerBytes.at("Test"), 1024u);
+  // The owners are unregistered when they are destroyed.
+  EXPECT_EQ(Samples[2].OwnerBytes.count("Test"), 0u);
+  // The string pool is always measured.
+  EXPECT_EQ(Samples[2].OwnerBytes.count("StringPool"), 1u);
+
+  EXPECT_EQ(Profile.getPeakBytes().at("Test"), 4096u);
+
+  std::stringstream Out;
+  Profile.print(Out);
+  EXPECT_NE(Out.str().find("Memory Breakdown (KB):"), std::string::npos);
+  EXPECT_NE(Out.str().find("First"), std::string::npos);
+  EXPECT_NE(Out.str().find("Peak "), std::string::npos);
+}
+
+TEST(MemoryProfile, UnattributedOwner) {
+  MemoryProfile Profile;
+  setActiveMemoryProfile(&Profile);
+  std::vector<char> Unmeasured;
+  {
+    UnattributedMemoryOwner Owner("Claimed");
+    Unmeasured.resize(1 << 20);
+    sampleMemory("Claiming");
+  }
+  sampleMemory("Released");
+  setActiveMemoryProfile(nullptr);
+
+  const auto &Samples = Profile.getSamples();
+  ASSERT_EQ(Samples.size(), 2u);
+  EXPECT_EQ(Samples[1].OwnerBytes.count("Claimed"), 0u);
+  // The growth of the heap is only known where it can be measured.
+  if (Samples[0].HeapBytes == 0)
+    return;
+  EXPECT_GE(Samples[0].OwnerBytes.at("Claimed"), 1u << 20);
+  EXPECT_LT(Samples[0].OwnerBytes.at("Other"), 1u << 20);
+}
+
+TEST(MemoryProfile, ObjectTree) {
+  ScopeRoot Root;
+  auto *Func = new ScopeFunction();
+  Root.addChild(Func);
+  Func->addChild(new Symbol());
+  Func->addChild(new Symbol());
+
+  ObjectTreeMemory Memory(getObjectTreeMemory(Root));
+  EXPECT_EQ(Memory.ObjectBytes, getAllocationBytes(sizeof(ScopeRoot)) +
+                                    getAllocationBytes(sizeof(ScopeFunction)) +
+                                    2 * getAllocationBytes(sizeof(Symbol)));
+  EXPECT_EQ(Memory.VectorBytes, getHeapBytes(Root.getChildren()) +
+                                    getHeapBytes(Func->getChildren()));
+
+  MemoryOwnerBytes OwnerBytes;
+  addObjectTreeBytes(Root, OwnerBytes);
+  EXPECT_EQ(OwnerBytes.at("Objects"), Memory.ObjectBytes);
+  EXPECT_EQ(OwnerBytes.at("ObjectVectors"), Memory.VectorBytes);
+}
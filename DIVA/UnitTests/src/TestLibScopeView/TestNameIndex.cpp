@@ -0,0 +1,118 @@
+//===-- UnitTests/TestLibScopeView/TestNameIndex.cpp ------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for the name index.
+///
+//===----------------------------------------------------------------------===//
+
+#include "NameIndex.h"
+#include "Scope.h"
+#include "Symbol.h"
+
+#include "gtest/gtest.h"
+
+using namespace LibScopeView;
+
+namespace {
+
+// CU "test.cpp"
+//   Namespace "ns"
+//     Function "bar" (qualified "ns::bar")
+//       Symbol "bark"
+//   Function "bar"
+struct TestTree {
+  ScopeRoot Root;
+  ScopeCompileUnit *CU = new ScopeCompileUnit();
+  ScopeNamespace *NS = new ScopeNamespace();
+  ScopeFunction *NSBar = new ScopeFunction();
+  Symbol *Bark = new Symbol();
+  ScopeFunction *Bar = new ScopeFunction();
+
+  TestTree() {
+    CU->setName("test.cpp");
+    NS->setName("ns");
+    NSBar->setName("bar");
+    NSBar->setQualifiedName("ns::");
+    Bark->setName("bark");
+    Bar->setName("bar");
+
+    Root.addChild(CU);
+    CU->addChild(NS);
+    NS->addChild(NSBar);
+    NSBar->addChild(Bark);
+    CU->addChild(Bar);
+  }
+};
+
+} // namespace
+
+TEST(NameIndex, Exact) {
+  TestTree Tree;
+  NameIndex Index(Tree.Root);
+  EXPECT_EQ(Index.getObjectCount(), 5u);
+  // Each name plus "ns::bar".
+  EXPECT_EQ(Index.getNameCount(), 5u);
+
+  EXPECT_EQ(Index.findExact("bar"),
+            std::vector<const Object *>({Tree.NSBar, Tree.Bar}));
+  EXPECT_EQ(Index.findExact("ns::bar"),
+            std::vector<const Object *>({Tree.NSBar}));
+  EXPECT_TRUE(Index.findExact("ba").empty());
+  EXPECT_TRUE(Index.findExact("not in the tree").empty());
+}
+
+TEST(NameIndex, Prefix) {
+  TestTree Tree;
+  NameIndex Index(Tree.Root);
+
+  EXPECT_EQ(Index.findPrefix("ba"),
+            std::vector<const Object *>({Tree.NSBar, Tree.Bark, Tree.Bar}));
+  // "ns" and "ns::bar" both start with "ns".
+  EXPECT_EQ(Index.findPrefix("ns"),
+            std::vector<const Object *>({Tree.NS, Tree.NSBar}));
+  EXPECT_EQ(Index.findPrefix("").size(), 5u);
+  EXPECT_TRUE(Index.findPrefix("z").empty());
+}
+
+TEST(NameIndex, Regex) {
+  TestTree Tree;
+  NameIndex Index(Tree.Root);
+
+  // The whole name has to match.
+  EXPECT_EQ(Index.findRegex(std::regex("bar")),
+            std::vector<const Object *>({Tree.NSBar, Tree.Bar}));
+  // An object matching by both names is only returned once.
+  EXPECT_EQ(Index.findRegex(std::regex(".*bar")),
+            std::vector<const Object *>({Tree.NSBar, Tree.Bar}));
+  EXPECT_EQ(Index.findRegex(std::regex("b.*k")),
+            std::vector<const Object *>({Tree.Bark}));
+}
+
+TEST(NameIndex, Ancestors) {
+  TestTree Tree;
+  EXPECT_EQ(NameIndex::getAncestors(*Tree.Bark),
+            std::vector<const Object *>({Tree.CU, Tree.NS, Tree.NSBar}));
+  EXPECT_TRUE(NameIndex::getAncestors(*Tree.CU).empty());
+}
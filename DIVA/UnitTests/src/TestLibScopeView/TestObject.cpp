@@ -27,6 +27,7 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#include "JSONWriter.h"
 #include "Line.h"
 #include "Object.h"
 #include "Scope.h"
@@ -37,48 +38,33 @@
 #include "gtest/gtest.h"
 
 #include <memory>
+#include <sstream>
 
 using namespace LibScopeView;
 
 namespace {
 
-// Object class where the properties can be set and getCommonYAML is public.
+// Object class where getCommonYAML is public.
 class TestObject : public Scope {
 public:
-  TestObject() : Scope(SV_Scope), Type(nullptr) {}
-
-  const std::string &getName() const override { return Name; }
-  void setName(const std::string &N) override { Name = N; }
-  StringPoolRef getNamePoolRef() const override { return nullptr; }
-  virtual void setName(StringPoolRef) override {}
-
-  const std::string &getQualifiedName() const override { return QName; }
-  void setQualifiedName(const std::string &QualName) override {
-    QName = QualName;
-  }
-
-  const std::string &getFilePath() const override {
-    return FilePath;
-  }
-  void setFilePath(const std::string &FP) override { FilePath = FP; }
-  StringPoolRef getFilePathPoolRef() const override { return nullptr; }
-  virtual void setFilePath(StringPoolRef) override {};
-
-  Object *getType() const override { return Type; }
-  void setType(Object *object) override { Type = object; }
+  TestObject() : Scope(SV_Scope) {}
 
   std::string getAsText(const PrintSettings &) const override { return ""; };
   std::string getAsYAML() const override { return ""; };
 
   using Object::getCommonYAML;
-
-private:
-  std::string Name;
-  std::string QName;
-  std::string FilePath;
-  Object *Type;
+  using Object::writeCommonJSON;
 };
 
+std::string getCommonJSON(const TestObject &TO) {
+  std::stringstream JSON;
+  JSONWriter Writer(JSON);
+  Writer.beginObject();
+  TO.writeCommonJSON(Writer);
+  Writer.endObject();
+  return JSON.str();
+}
+
 } // namespace
 
 TEST(Object, getCommonYAML) {
@@ -196,6 +182,35 @@ TEST(Object, getCommonYAML) {
                                 "  tag: \"DW_TAG_variable\"");
 }
 
+TEST(Object, writeCommonJSON) {
+  TestObject TO;
+  TO.setIsBlock(); // For getKindAsString.
+  EXPECT_EQ(getCommonJSON(TO),
+            "{\"object\":\"Block\",\"name\":null,\"type\":null,"
+            "\"line\":null,\"file\":null,\"offset\":0,\"tag\":null}");
+
+  TO.setName("VarName");
+  TO.setQualifiedName("Q::");
+  Type Ty;
+  Ty.setName("Ty");
+  Ty.setQualifiedName("Class::");
+  TO.setType(&Ty);
+  TO.setLineNumber(25);
+  TO.setFilePath("path/file.cpp");
+  TO.setDieOffset(0x201);
+  TO.setDieTag(DW_TAG_variable);
+  EXPECT_EQ(getCommonJSON(TO),
+            "{\"object\":\"Block\",\"name\":\"Q::VarName\","
+            "\"type\":\"Class::Ty\",\"line\":25,\"file\":\"file.cpp\","
+            "\"offset\":513,\"tag\":\"DW_TAG_variable\"}");
+
+  TO.setInvalidFileName();
+  EXPECT_EQ(getCommonJSON(TO),
+            "{\"object\":\"Block\",\"name\":\"Q::VarName\","
+            "\"type\":\"Class::Ty\",\"line\":25,\"file\":\"?\","
+            "\"offset\":513,\"tag\":\"DW_TAG_variable\"}");
+}
+
 TEST(Object, ResolveQualifiedName) {
   ScopeNamespace NS1;
   NS1.setName("NS1");
@@ -264,6 +279,96 @@ TEST(Object, ResolveQualifiedName) {
   }
 }
 
+TEST(Object, DeferredQualifiedName) {
+  ScopeNamespace NS;
+  Symbol Sym;
+  Sym.setParent(&NS);
+
+  // The qualified name is built from the parent when it is first read.
+  Sym.resolveQualifiedName();
+  NS.setName("NS");
+  EXPECT_EQ(Sym.getQualifiedName(), "NS::");
+
+  // Once read it is cached.
+  NS.setName("Other");
+  EXPECT_EQ(Sym.getQualifiedName(), "NS::");
+}
+
+TEST(Object, MaterializeNames) {
+  ScopeRoot Root;
+  auto *NS = new ScopeNamespace;
+  NS->setName("NS");
+  Root.addChild(NS);
+  auto *Used = new ScopeAggregate;
+  auto *Unused = new ScopeAggregate;
+  auto *Sym = new Symbol;
+  NS->addChild(Used);
+  NS->addChild(Unused);
+  NS->addChild(Sym);
+  Used->resolveQualifiedName();
+  Unused->resolveQualifiedName();
+  Sym->setType(Used);
+
+  // Only the qualified names of types are worked out for the text output.
+  materializeNames(Root, /*AllQualifiedNames*/ false);
+  NS->setName("Other");
+  EXPECT_EQ(Used->getQualifiedName(), "NS::");
+
+  auto *Later = new ScopeAggregate;
+  NS->addChild(Later);
+  Later->resolveQualifiedName();
+  materializeNames(Root);
+  NS->setName("Third");
+  EXPECT_EQ(Unused->getQualifiedName(), "Other::");
+  EXPECT_EQ(Later->getQualifiedName(), "Other::");
+}
+
+TEST(Object, DeferredName) {
+  Type Base;
+  Base.setName("int");
+  Type Ptr;
+  Ptr.setIsPointerType();
+  Ptr.setType(&Base);
+  Ptr.deferNameFormulation(true);
+  EXPECT_EQ(Ptr.getName(), "int *");
+
+  // Pending names are formulated through chains of deferred names.
+  Type VoidPtr;
+  VoidPtr.setIsPointerType();
+  Type ConstVoidPtr;
+  ConstVoidPtr.setIsConstType();
+  ConstVoidPtr.setType(&VoidPtr);
+  VoidPtr.deferNameFormulation(true);
+  ConstVoidPtr.deferNameFormulation(true);
+  EXPECT_EQ(ConstVoidPtr.getName(), "const void *");
+  EXPECT_EQ(VoidPtr.getName(), "void *");
+
+  Type HiddenVoidPtr;
+  HiddenVoidPtr.setIsPointerType();
+  HiddenVoidPtr.deferNameFormulation(false);
+  EXPECT_EQ(HiddenVoidPtr.getName(), "*");
+
+  // Function pointer names use the return and parameter types.
+  ScopeFunction Func;
+  Func.setIsSubroutineType();
+  Func.setType(&Ptr);
+  auto *Param = new Symbol;
+  Param->setIsParameter();
+  Param->setType(&Base);
+  Func.addChild(Param);
+  Func.deferNameFormulation(true);
+  EXPECT_EQ(Func.getName(), "int * (*)(int)");
+
+  // Array names use the type and subranges.
+  ScopeArray Array;
+  Array.setType(&Base);
+  auto *Subrange = new TypeSubrange;
+  Subrange->setName("[4]");
+  Array.addChild(Subrange);
+  Array.deferNameFormulation(true);
+  EXPECT_EQ(Array.getName(), "int [4]");
+}
+
 TEST(Object, getKind) {
   std::unique_ptr<Object> Obj;
 
@@ -442,3 +547,34 @@ TEST(Object, object_dyn_cast) {
   EXPECT_EQ(CastedToScope, TestFunction.get());
   EXPECT_EQ(dyn_cast<ScopeAlias>(TestFunction.get()), nullptr);
 }
+
+TEST(Object, printAllocationInfo) {
+  ScopeRoot Root;
+  auto *CU = new ScopeCompileUnit;
+  Root.addChild(CU);
+  CU->addChild(new Symbol);
+
+  std::stringstream Out;
+  printAllocationInfo(Root, Out);
+  std::string Info(Out.str());
+
+  EXPECT_NE(Info.find("Legacy Size"), std::string::npos);
+  EXPECT_NE(Info.find("Bytes per object: "), std::string::npos);
+  EXPECT_NE(Info.find("(legacy layout "), std::string::npos);
+}
+
+TEST(Object, CompactLayout) {
+  // Names, file path and type are stored in Object using 32-bit indices.
+  EXPECT_LE(sizeof(Element), 56u);
+
+  TestObject TO;
+  TO.setName("Name");
+  TestObject Copy;
+  Copy.setNameIndex(TO.getNameIndex());
+  EXPECT_EQ(Copy.getName(), "Name");
+  EXPECT_EQ(Copy.getNamePoolRef(), TO.getNamePoolRef());
+
+  Copy.setName(StringPoolRef(nullptr));
+  EXPECT_EQ(Copy.getName(), "");
+  EXPECT_EQ(Copy.getNamePoolRef(), nullptr);
+}
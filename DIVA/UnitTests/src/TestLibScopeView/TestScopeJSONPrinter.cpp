@@ -0,0 +1,124 @@
+//===-- UnitTests/TestLibScopeView/TestScopeJSONPrinter.cpp -----*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for LibScopeView::ScopeJSONPrinter.
+///
+//===----------------------------------------------------------------------===//
+
+#include "FileUtilities.h"
+#include "JSONWriter.h"
+#include "Scope.h"
+#include "ScopeJSONPrinter.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+using namespace LibScopeView;
+
+namespace {
+
+PrintSettings Settings;
+
+class FakeObject : public Scope {
+public:
+  FakeObject(std::string FakeName) : FakeName(FakeName) {}
+  void writeJSON(JSONWriter &JSON) const override {
+    JSON.key("object");
+    JSON.string("Fake");
+    JSON.key("name");
+    JSON.string(FakeName);
+  }
+  std::string FakeName;
+};
+
+class FakeNoJSONObject : public Scope {
+public:
+  bool getIsPrintedAsObject() const override { return false; }
+};
+
+} // namespace
+
+TEST(ScopeJSONPrinter, PrintNoChildren) {
+  ScopeRoot Root;
+  Root.addChild(new FakeObject("Top"));
+
+  std::stringstream Output;
+  ScopeJSONPrinter(Settings, "In.o", "V0").print(&Root, Output);
+
+  EXPECT_EQ(Output.str(),
+            "{\"input_file\":\"In.o\",\"output_version\":\"V0\",\"objects\":["
+            "{\"object\":\"Fake\",\"name\":\"Top\",\"children\":[]}]}\n");
+}
+
+TEST(ScopeJSONPrinter, Print) {
+  ScopeRoot Root;
+  auto *Top = new FakeObject("Top");
+  auto *Child1 = new FakeObject("Child1");
+  auto *Child2NoJSON = new FakeNoJSONObject;
+  Root.addChild(Top);
+  Root.addChild(new FakeObject("Top2"));
+  Top->addChild(Child1);
+  Top->addChild(Child2NoJSON);
+  Top->addChild(new FakeObject("Child3"));
+  Child1->addChild(new FakeObject("Child4"));
+  Child2NoJSON->addChild(new FakeObject("Child5"));
+
+  std::stringstream Output;
+  ScopeJSONPrinter(Settings, "In\\\"file\".o", "V0").print(&Root, Output);
+
+  EXPECT_EQ(Output.str(),
+            "{\"input_file\":\"In\\\\\\\"file\\\".o\",\"output_version\":"
+            "\"V0\",\"objects\":["
+            "{\"object\":\"Fake\",\"name\":\"Top\",\"children\":["
+            "{\"object\":\"Fake\",\"name\":\"Child1\",\"children\":["
+            "{\"object\":\"Fake\",\"name\":\"Child4\",\"children\":[]}]},"
+            "{\"object\":\"Fake\",\"name\":\"Child3\",\"children\":[]}]},"
+            "{\"object\":\"Fake\",\"name\":\"Top2\",\"children\":[]}]}\n");
+}
+
+TEST(ScopeJSONPrinter, SplitPrint) {
+  ScopeRoot Root;
+  for (const char *Name : {"json/cu/1", "json/cu/2", "json/cu/3"}) {
+    auto *CU = new ScopeCompileUnit;
+    CU->setName(Name);
+    CU->addChild(new FakeObject(std::string(Name) + "/child"));
+    Root.addChild(CU);
+  }
+
+  // The compile units are printed on several threads.
+  ScopeJSONPrinter(Settings, "In.o", "V0").print(&Root, getTestOutputDir());
+  for (const char *Name : {"json/cu/1", "json/cu/2", "json/cu/3"}) {
+    std::string FileName(flattenFilePath(Name));
+    EXPECT_EQ(readTestOutputFile(FileName + ".json"),
+              "{\"input_file\":\"In.o\",\"output_version\":\"V0\",\"objects\":["
+              "{\"object\":\"CompileUnit\",\"name\":\"" +
+                  std::string(Name) +
+                  "\",\"type\":null,\"line\":null,\"file\":null,"
+                  "\"offset\":0,\"tag\":null,\"attributes\":{},\"children\":["
+                  "{\"object\":\"Fake\",\"name\":\"" +
+                  std::string(Name) + "/child\",\"children\":[]}]}]}\n");
+    clearTestOutputFile(FileName + ".json");
+  }
+}
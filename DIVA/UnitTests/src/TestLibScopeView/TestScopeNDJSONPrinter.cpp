@@ -0,0 +1,121 @@
+//===-- UnitTests/TestLibScopeView/TestScopeNDJSONPrinter.cpp ---*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for LibScopeView::ScopeNDJSONPrinter.
+///
+//===----------------------------------------------------------------------===//
+
+#include "FileUtilities.h"
+#include "JSONWriter.h"
+#include "Scope.h"
+#include "ScopeNDJSONPrinter.h"
+#include "UtilsForTesting.h"
+
+#include "gtest/gtest.h"
+
+using namespace LibScopeView;
+
+namespace {
+
+PrintSettings Settings;
+
+class FakeObject : public Scope {
+public:
+  FakeObject(std::string FakeName) : FakeName(FakeName) {}
+  void writeJSON(JSONWriter &JSON) const override {
+    JSON.key("name");
+    JSON.string(FakeName);
+  }
+  std::string FakeName;
+};
+
+class FakeNoJSONObject : public Scope {
+public:
+  bool getIsPrintedAsObject() const override { return false; }
+};
+
+} // namespace
+
+TEST(ScopeNDJSONPrinter, Print) {
+  ScopeRoot Root;
+  auto *Top = new FakeObject("Top");
+  auto *Child1 = new FakeObject("Child1");
+  auto *Child2NoJSON = new FakeNoJSONObject;
+  auto *Top2 = new FakeObject("Top2");
+  Root.addChild(Top);
+  Root.addChild(Top2);
+  Top->addChild(Child1);
+  Top->addChild(Child2NoJSON);
+  Top->addChild(new FakeObject("Child3"));
+  Child1->addChild(new FakeObject("Child4"));
+  Child2NoJSON->addChild(new FakeObject("Child5"));
+  Top2->addChild(new FakeObject("Child6"));
+
+  std::stringstream Output;
+  ScopeNDJSONPrinter Printer(Settings, "In.o", "V0");
+  Printer.print(&Root, Output);
+
+  // The children of objects that aren't printed are skipped, as for YAML.
+  // The ids of the top objects, which are printed separately, follow on.
+  const std::string Expected =
+      "{\"input_file\":\"In.o\",\"output_version\":\"V0\"}\n"
+      "{\"id\":0,\"parent\":null,\"name\":\"Top\"}\n"
+      "{\"id\":1,\"parent\":0,\"name\":\"Child1\"}\n"
+      "{\"id\":2,\"parent\":1,\"name\":\"Child4\"}\n"
+      "{\"id\":3,\"parent\":0,\"name\":\"Child3\"}\n"
+      "{\"id\":4,\"parent\":null,\"name\":\"Top2\"}\n"
+      "{\"id\":5,\"parent\":4,\"name\":\"Child6\"}\n";
+  EXPECT_EQ(Output.str(), Expected);
+
+  // The ids start again for each output.
+  Output.str("");
+  Printer.print(&Root, Output);
+  EXPECT_EQ(Output.str(), Expected);
+}
+
+TEST(ScopeNDJSONPrinter, SplitPrint) {
+  ScopeRoot Root;
+  for (const char *Name : {"ndjson/cu/1", "ndjson/cu/2", "ndjson/cu/3"}) {
+    auto *CU = new ScopeCompileUnit;
+    CU->setName(Name);
+    CU->addChild(new FakeObject("child"));
+    Root.addChild(CU);
+  }
+
+  // The compile units are printed on several threads, each numbered from 0.
+  ScopeNDJSONPrinter(Settings, "In.o", "V0").print(&Root, getTestOutputDir());
+  for (const char *Name : {"ndjson/cu/1", "ndjson/cu/2", "ndjson/cu/3"}) {
+    std::string FileName(flattenFilePath(Name));
+    EXPECT_EQ(readTestOutputFile(FileName + ".ndjson"),
+              "{\"input_file\":\"In.o\",\"output_version\":\"V0\"}\n"
+              "{\"id\":0,\"parent\":null,\"object\":\"CompileUnit\","
+              "\"name\":\"" +
+                  std::string(Name) +
+                  "\",\"type\":null,\"line\":null,\"file\":null,"
+                  "\"offset\":0,\"tag\":null,\"attributes\":{}}\n"
+                  "{\"id\":1,\"parent\":0,\"name\":\"child\"}\n");
+    clearTestOutputFile(FileName + ".ndjson");
+  }
+}
@@ -44,12 +44,12 @@ class FakeObject : public Scope {
 public:
   FakeObject(std::string Name, uint64_t Line, std::string FileName)
       : Scope(SV_Scope), FakeName(Name) {
+    setName(Name);
     setFilePath(FileName);
     setLineNumber(Line);
     setIsBlock(); // For PrintSettings::printObject.
   }
 
-  const std::string &getName() const override { return FakeName; }
   std::string getAsText(const PrintSettings &Settings) const override {
     return std::string("{Fake} ") + FakeName + std::string("\n  - Attr");
   }
@@ -120,6 +120,44 @@ TEST(ScopeTextPrinter, Print) {
   EXPECT_EQ(Output.str(), Expected);
 }
 
+TEST(ScopeTextPrinter, PrintTopObjectsSeparately) {
+  PrintSettings Settings;
+  Settings.showAll();
+
+  // Each top object is printed separately and then joined, so the {Source}
+  // of Top2 must be left out as it is the same as the one before.
+  ScopeRoot Root;
+  auto *Top1 = new FakeObject("Top1", 1, "foo.cpp");
+  auto *Top2 = new FakeObject("Top2", 3, "bar.cpp");
+  auto *Top3 = new FakeObject("Top3", 5, "bar.cpp");
+  Root.addChild(Top1);
+  Root.addChild(Top2);
+  Root.addChild(Top3);
+  Top1->addChild(new FakeObject("Child1", 2, "bar.cpp"));
+  Top2->addChild(new FakeObject("Child2", 4, "foo.cpp"));
+
+  std::stringstream Output;
+  ScopeTextPrinter(Settings, "In.o").print(&Root, Output);
+
+  std::string Expected("{InputFile} \"In.o\"\n\n"
+                       "{Source} \"foo.cpp\"\n"
+                       "1  {Fake} Top1\n"
+                       "     - Attr\n\n"
+                       "{Source} \"bar.cpp\"\n"
+                       "2    {Fake} Child1\n"
+                       "       - Attr\n"
+                       "3  {Fake} Top2\n"
+                       "     - Attr\n\n"
+                       "{Source} \"foo.cpp\"\n"
+                       "4    {Fake} Child2\n"
+                       "       - Attr\n\n"
+                       "{Source} \"bar.cpp\"\n"
+                       "5  {Fake} Top3\n"
+                       "     - Attr\n");
+
+  EXPECT_EQ(Output.str(), Expected);
+}
+
 TEST(ScopeTextPrinter, SkipObjectsWithNoText) {
   PrintSettings Settings;
   Settings.showAll();
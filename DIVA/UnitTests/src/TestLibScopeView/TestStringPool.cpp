@@ -31,6 +31,9 @@
 
 #include "gtest/gtest.h"
 
+#include <future>
+#include <vector>
+
 using namespace LibScopeView;
 
 TEST(StringPool, DeduplicateStrings) {
@@ -51,3 +54,75 @@ TEST(StringPool, DeduplicateStrings) {
   EXPECT_EQ(BarRef, Pool.get(Bar));
   EXPECT_EQ(BazRef, Pool.get(Baz));
 }
+
+TEST(StringPool, CompactIndices) {
+  StringPool Pool;
+  EXPECT_EQ(Pool.size(), 0u);
+  EXPECT_EQ(Pool.getRef(0), nullptr);
+
+  StringPoolIndex FooIndex = Pool.getIndex("foo");
+  StringPoolIndex BarIndex = Pool.getIndex("bar");
+
+  EXPECT_NE(FooIndex, 0u);
+  EXPECT_NE(BarIndex, 0u);
+  EXPECT_NE(FooIndex, BarIndex);
+  EXPECT_EQ(FooIndex, Pool.getIndex("foo"));
+  EXPECT_EQ(Pool.size(), 2u);
+
+  EXPECT_EQ(*Pool.getRef(FooIndex), "foo");
+  EXPECT_EQ(Pool.getRef(BarIndex), Pool.get("bar"));
+}
+
+TEST(StringPool, LookupCount) {
+  StringPool Pool;
+  EXPECT_EQ(Pool.getLookupCount(), 0u);
+
+  Pool.getIndex("foo");
+  Pool.getIndex("foo");
+  Pool.get("bar");
+  EXPECT_EQ(Pool.getLookupCount(), 3u);
+  EXPECT_EQ(Pool.size(), 2u);
+
+  // Looking up an index does not intern anything.
+  Pool.getRef(1);
+  EXPECT_EQ(Pool.getLookupCount(), 3u);
+}
+
+TEST(StringPool, FindIndex) {
+  StringPool Pool;
+  StringPoolIndex FooIndex = Pool.getIndex("foo");
+  EXPECT_EQ(Pool.findIndex("foo"), FooIndex);
+  // Finding a string does not intern it.
+  EXPECT_EQ(Pool.findIndex("bar"), 0u);
+  EXPECT_EQ(Pool.size(), 1u);
+}
+
+TEST(StringPool, ConcurrentInterning) {
+  StringPool Pool;
+  const size_t StringCount = 5000;
+  const size_t ThreadCount = 4;
+
+  // Each thread interns the same strings in a different order, past the end
+  // of the first segment of the index table.
+  auto Intern = [&Pool, StringCount](size_t Start) {
+    std::vector<StringPoolIndex> Indices(StringCount);
+    for (size_t I = 0; I < StringCount; ++I) {
+      size_t N = (Start + I) % StringCount;
+      Indices[N] = Pool.getIndex("string" + std::to_string(N));
+      EXPECT_EQ(*Pool.getRef(Indices[N]), "string" + std::to_string(N));
+    }
+    return Indices;
+  };
+  std::vector<std::future<std::vector<StringPoolIndex>>> Threads;
+  for (size_t T = 0; T < ThreadCount; ++T)
+    Threads.push_back(
+        std::async(std::launch::async, Intern, T * StringCount / ThreadCount));
+
+  std::vector<StringPoolIndex> First(Threads[0].get());
+  for (size_t T = 1; T < ThreadCount; ++T)
+    EXPECT_EQ(Threads[T].get(), First);
+  EXPECT_EQ(Pool.size(), StringCount);
+  EXPECT_EQ(Pool.getLookupCount(), StringCount * ThreadCount);
+  for (size_t N = 0; N < StringCount; ++N)
+    EXPECT_EQ(Pool.findIndex("string" + std::to_string(N)), First[N]);
+}
@@ -315,3 +315,46 @@ TEST(SummaryTable, PrintSettingsSummaryTable) {
 
   EXPECT_EQ(Result.str(), Expected);
 }
+
+TEST(SummaryTable, AddSummaryTables) {
+  ScopeRoot Root;
+  for (uint32_t Kind = 0; Kind != ObjectKindSize; ++Kind)
+    generateTestObject(Root, ObjectKind(Kind));
+  generateTestObject(Root, ObjectKind::Enum);
+
+  // The default settings hide the lines and primitive types.
+  PrintSettings Settings;
+  Settings.ShowEnum = false;
+
+  SummaryTable Total;
+  Total.add(SummaryTable(Root, nullptr));
+  Total.add(SummaryTable(Root, &Settings));
+
+  std::stringstream Result;
+  Total.printSummaryTable(Result);
+
+  std::string Expected = "     -------------------------------------\n"
+                         "     Object                 Total  Printed\n"
+                         "     -------------------------------------\n"
+                         "     Alias                      2        2\n"
+                         "     Block                      2        2\n"
+                         "     Class                      2        2\n"
+                         "     CodeLine                   2        1\n"
+                         "     CompileUnit                2        2\n"
+                         "     Enum                       4        2\n"
+                         "     Function                   2        2\n"
+                         "     Member                     2        2\n"
+                         "     Namespace                  2        2\n"
+                         "     Parameter                  2        2\n"
+                         "     PrimitiveType              2        1\n"
+                         "     Struct                     2        2\n"
+                         "     TemplateParameter          2        2\n"
+                         "     Union                      2        2\n"
+                         "     Using                      2        2\n"
+                         "     Variable                   2        2\n"
+                         "     -------------------------------------\n"
+                         "     Totals                    34       30\n"
+                         "\n";
+
+  EXPECT_EQ(Result.str(), Expected);
+}
@@ -0,0 +1,119 @@
+//===-- UnitTests/TestLibScopeView/TestTrace.cpp ----------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for LibScopeView::Tracer and LibScopeView::TraceSpan.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Trace.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <thread>
+
+using namespace LibScopeView;
+
+TEST(Trace, NoActiveTracer) {
+  setActiveTracer(nullptr);
+  EXPECT_EQ(getActiveTracer(), nullptr);
+  // Spans without an active tracer are ignored.
+  TraceSpan Span("Ignored");
+}
+
+TEST(Trace, NestedSpans) {
+  Tracer T;
+  setActiveTracer(&T);
+  {
+    TraceSpan Outer("Outer");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    {
+      TraceSpan Inner("Inner", "detail");
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+  }
+  setActiveTracer(nullptr);
+
+  const auto &Spans = T.getSpans();
+  ASSERT_EQ(Spans.size(), 2u);
+
+  // Spans are recorded as they complete, so the inner span is first.
+  EXPECT_STREQ(Spans[0].Name, "Inner");
+  EXPECT_EQ(Spans[0].Detail, "detail");
+  EXPECT_EQ(Spans[0].SelfMicroseconds, Spans[0].DurationMicroseconds);
+  EXPECT_GE(Spans[0].DurationMicroseconds, 5000u);
+
+  EXPECT_STREQ(Spans[1].Name, "Outer");
+  EXPECT_LE(Spans[1].StartMicroseconds, Spans[0].StartMicroseconds);
+  EXPECT_GE(Spans[1].DurationMicroseconds, 7000u);
+  EXPECT_EQ(Spans[1].SelfMicroseconds,
+            Spans[1].DurationMicroseconds - Spans[0].DurationMicroseconds);
+
+  auto Totals = T.getSelfTimeByName();
+  EXPECT_EQ(Totals["Inner"], Spans[0].SelfMicroseconds);
+  EXPECT_EQ(Totals["Outer"], Spans[1].SelfMicroseconds);
+}
+
+TEST(Trace, Counters) {
+  Tracer T;
+  T.addCounter("DIEs", 10);
+  T.addCounter("Strings", 3);
+  T.addCounter("DIEs", 5);
+
+  const auto &Updates = T.getCounterUpdates();
+  ASSERT_EQ(Updates.size(), 3u);
+  EXPECT_EQ(Updates[0].Name, "DIEs");
+  EXPECT_EQ(Updates[0].Total, 10u);
+  EXPECT_EQ(Updates[2].Name, "DIEs");
+  EXPECT_EQ(Updates[2].Total, 15u);
+  EXPECT_LE(Updates[0].TimeMicroseconds, Updates[2].TimeMicroseconds);
+
+  const auto &Counters = T.getCounters();
+  ASSERT_EQ(Counters.size(), 2u);
+  EXPECT_EQ(Counters.at("DIEs"), 15u);
+  EXPECT_EQ(Counters.at("Strings"), 3u);
+}
+
+TEST(Trace, ChromeTrace) {
+  Tracer T;
+  setActiveTracer(&T);
+  { TraceSpan Span("Read", "dir\\\"file\".o"); }
+  setActiveTracer(nullptr);
+  T.addCounter("DIEs", 42);
+
+  std::stringstream Out;
+  T.writeChromeTrace(Out);
+  std::string Json(Out.str());
+
+  EXPECT_EQ(Json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u);
+  EXPECT_NE(Json.find("{\"name\":\"Read\",\"cat\":\"diva\",\"ph\":\"X\""),
+            std::string::npos);
+  EXPECT_NE(Json.find("\"args\":{\"detail\":\"dir\\\\\\\"file\\\".o\"}"),
+            std::string::npos);
+  EXPECT_NE(Json.find("{\"name\":\"DIEs\",\"cat\":\"diva\",\"ph\":\"C\""),
+            std::string::npos);
+  EXPECT_NE(Json.find("\"args\":{\"value\":42}}"), std::string::npos);
+  EXPECT_EQ(Json.substr(Json.size() - 4), "\n]}\n");
+}
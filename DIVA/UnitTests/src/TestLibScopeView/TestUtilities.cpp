@@ -0,0 +1,94 @@
+//===-- LibScopeView/TestUtilities.cpp --------------------------*- C++ -*-===//
+///
+/// Copyright (c) 2017 by Sony Interactive Entertainment Inc.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests for LibScopeView::runInParallel and runInOrder.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Utilities.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace LibScopeView;
+
+TEST(Utilities, RunInOrder) {
+  const size_t TaskCount = 100;
+  const size_t WindowSize = 3;
+  std::vector<size_t> Results(TaskCount);
+  std::vector<size_t> Consumed;
+  std::atomic<size_t> NextConsumed(0);
+  std::atomic<bool> OutsideWindow(false);
+
+  runInOrder(TaskCount, 4, WindowSize,
+             [&](size_t I) {
+               if (I >= NextConsumed + WindowSize)
+                 OutsideWindow = true;
+               Results[I] = I * I;
+             },
+             [&](size_t I) {
+               EXPECT_EQ(Results[I], I * I);
+               Consumed.push_back(I);
+               ++NextConsumed;
+             });
+
+  EXPECT_FALSE(OutsideWindow);
+  ASSERT_EQ(Consumed.size(), TaskCount);
+  for (size_t I = 0; I < TaskCount; ++I)
+    EXPECT_EQ(Consumed[I], I);
+}
+
+TEST(Utilities, RunInOrderOnOneThread) {
+  // The calling thread produces each task just before it is consumed.
+  std::vector<int> Events;
+  runInOrder(3, 1, 2, [&](size_t I) { Events.push_back(int(I)); },
+             [&](size_t I) { Events.push_back(-int(I) - 1); });
+  EXPECT_EQ(Events, std::vector<int>({0, -1, 1, -2, 2, -3}));
+}
+
+TEST(Utilities, RunInParallelSharesThreads) {
+  // The tasks of four threads share the hardware threads between them.
+  size_t Share = std::max(1u, std::thread::hardware_concurrency() / 4);
+  std::atomic<size_t> MostThreads(0);
+  runInParallel(4, 4, [&](size_t) {
+    std::mutex Mutex;
+    std::set<std::thread::id> Threads;
+    runInParallel(64, /*ThreadCount*/ 0, [&](size_t) {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      Threads.insert(std::this_thread::get_id());
+    });
+    size_t Count = Threads.size();
+    for (size_t Most = MostThreads; Most < Count;)
+      MostThreads.compare_exchange_weak(Most, Count);
+  });
+  EXPECT_GE(MostThreads.load(), 1u);
+  EXPECT_LE(MostThreads.load(), Share);
+}
@@ -28,10 +28,27 @@
 #include "config.h"
 #include "dwarf_incl.h"
 #include <stdio.h>
+#include <string.h>
 #ifdef TESTING
+#include <stdlib.h>
+#include <time.h>
 #include "pro_encode_nm.h"
 #endif
 
+/*  The SSE2 decoders are built for x86 and x86-64 with GCC, clang
+    and MSVC, and used when the CPU running the code has SSE2. */
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <emmintrin.h>
+#define HAVE_LEB_SSE2 1
+#define LEB_SSE2_TARGET __attribute__((target("sse2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <emmintrin.h>
+#include <intrin.h>
+#define HAVE_LEB_SSE2 1
+#define LEB_SSE2_TARGET
+#endif
+
 /*  10 bytes of leb, 7 bits each part of the number, gives
     room for a 64bit number.
     While any number of leading zeroes would be legal, so
@@ -126,8 +143,12 @@ _dwarf_decode_u_leb128(Dwarf_Small * leb128, Dwarf_Word * leb128_length)
 }
 
 /* Decode ULEB with checking */
-int
-_dwarf_decode_u_leb128_chk(Dwarf_Small * leb128,
+/*  The byte-at-a-time decoders below are used for every value
+    when no vector decoder is available, and by the vector decoders
+    for the values they do not handle themselves (values near the
+    end of the section and erroneous encodings). */
+static int
+decode_u_leb128_chk_scalar(Dwarf_Small * leb128,
     Dwarf_Word * leb128_length,
     Dwarf_Unsigned *outval,
     Dwarf_Byte_Ptr endptr)
@@ -258,8 +279,9 @@ _dwarf_decode_s_leb128(Dwarf_Small * leb128, Dwarf_Word * leb128_length)
     return number;
 }
 
-int
-_dwarf_decode_s_leb128_chk(Dwarf_Small * leb128, Dwarf_Word * leb128_length,
+static int
+decode_s_leb128_chk_scalar(Dwarf_Small * leb128,
+    Dwarf_Word * leb128_length,
     Dwarf_Signed *outval,Dwarf_Byte_Ptr endptr)
 {
     Dwarf_Unsigned byte   = 0;
@@ -315,6 +337,209 @@ _dwarf_decode_s_leb128_chk(Dwarf_Small * leb128, Dwarf_Word * leb128_length,
     return DW_DLV_OK;
 }
 
+#ifdef HAVE_LEB_SSE2
+/*  The vector decoders load 16 bytes at a time, so they only
+    handle values that start at least this far before endptr. */
+#define LEBSSE2LOAD 16
+
+/*  Return the length of the leb starting at leb128 if it ends
+    within BYTESLEBMAX bytes, else 0. One compare of all 16 bytes
+    finds the first byte without the continuation bit set, so
+    there is no branch on each byte of the leb. */
+static LEB_SSE2_TARGET unsigned
+leb128_length_sse2(const Dwarf_Small *leb128)
+{
+    __m128i bytes = _mm_loadu_si128((const __m128i *)leb128);
+    unsigned ends = ~(unsigned)_mm_movemask_epi8(bytes) &
+        ((1u << BYTESLEBMAX) - 1);
+#ifdef _MSC_VER
+    unsigned long first = 0;
+#endif
+
+    if (!ends) {
+        return 0;
+    }
+#ifdef _MSC_VER
+    _BitScanForward(&first, ends);
+    return (unsigned)first + 1;
+#else
+    return (unsigned)__builtin_ctz(ends) + 1;
+#endif
+}
+
+/*  Gather the 7 bit groups of a leb byte_length bytes long
+    (1 to BYTESLEBMAX) into one number. The first 8 bytes are
+    packed in a single word, doubling the width of each group at
+    each step, and the bytes past the end of the leb are masked
+    off rather than tested. x86 is little-endian so the first
+    byte is the low byte. */
+static Dwarf_Unsigned
+leb128_value(const Dwarf_Small *leb128, unsigned byte_length)
+{
+    Dwarf_Unsigned number = 0;
+    unsigned low_bytes = byte_length < 8 ? byte_length : 8;
+    Dwarf_Unsigned high = 0;
+
+    memcpy(&number, leb128, sizeof(number));
+    number &= ~(Dwarf_Unsigned)0 >> (64 - low_bytes * BITSPERBYTE);
+    number &= 0x7f7f7f7f7f7f7f7fULL;
+    number = ((number & 0x7f007f007f007f00ULL) >> 1) |
+        (number & 0x007f007f007f007fULL);
+    number = ((number & 0x3fff00003fff0000ULL) >> 2) |
+        (number & 0x00003fff00003fffULL);
+    number = ((number & 0x0fffffff00000000ULL) >> 4) |
+        (number & 0x000000000fffffffULL);
+
+    /*  Only bit 0 of the tenth byte fits in 64 bits. */
+    high = (leb128[8] & 0x7f) | ((Dwarf_Unsigned)(leb128[9] & 1) << 7);
+    high &= byte_length > 9 ? 0xff : byte_length > 8 ? 0x7f : 0;
+    return number | (high << 56);
+}
+
+static int
+decode_u_leb128_chk_sse2(Dwarf_Small * leb128,
+    Dwarf_Word * leb128_length,
+    Dwarf_Unsigned *outval,
+    Dwarf_Byte_Ptr endptr)
+{
+    unsigned byte_length = 0;
+
+    if (leb128 >= endptr || (endptr - leb128) < LEBSSE2LOAD) {
+        return decode_u_leb128_chk_scalar(leb128,leb128_length,
+            outval,endptr);
+    }
+    byte_length = leb128_length_sse2(leb128);
+    if (!byte_length) {
+        return decode_u_leb128_chk_scalar(leb128,leb128_length,
+            outval,endptr);
+    }
+    if (leb128_length) {
+        *leb128_length = byte_length;
+    }
+    *outval = leb128_value(leb128,byte_length);
+    return DW_DLV_OK;
+}
+
+static int
+decode_s_leb128_chk_sse2(Dwarf_Small * leb128,
+    Dwarf_Word * leb128_length,
+    Dwarf_Signed *outval,Dwarf_Byte_Ptr endptr)
+{
+    unsigned byte_length = 0;
+    unsigned shift = 0;
+    Dwarf_Unsigned number = 0;
+    Dwarf_Unsigned sign = 0;
+
+    if (!outval || leb128 >= endptr ||
+        (endptr - leb128) < LEBSSE2LOAD) {
+        return decode_s_leb128_chk_scalar(leb128,leb128_length,
+            outval,endptr);
+    }
+    byte_length = leb128_length_sse2(leb128);
+    if (!byte_length) {
+        return decode_s_leb128_chk_scalar(leb128,leb128_length,
+            outval,endptr);
+    }
+    number = leb128_value(leb128,byte_length);
+
+    /*  Extend bit 6 of the last byte, unless all 64 bits are set. */
+    shift = byte_length * 7;
+    sign = (leb128[byte_length - 1] >> 6) & 1;
+    sign = (0 - sign) << (shift & 63);
+    number |= shift < sizeof(Dwarf_Signed) * BITSINBYTE ? sign : 0;
+    if (leb128_length) {
+        *leb128_length = byte_length;
+    }
+    *outval = (Dwarf_Signed)number;
+    return DW_DLV_OK;
+}
+
+static int
+cpu_has_sse2(void)
+{
+#ifdef _MSC_VER
+    int info[4];
+
+    __cpuid(info,1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+#endif /* HAVE_LEB_SSE2 */
+
+typedef int (*u_leb128_decoder)(Dwarf_Small *,Dwarf_Word *,
+    Dwarf_Unsigned *,Dwarf_Byte_Ptr);
+typedef int (*s_leb128_decoder)(Dwarf_Small *,Dwarf_Word *,
+    Dwarf_Signed *,Dwarf_Byte_Ptr);
+
+static int select_u_leb128_decoder(Dwarf_Small *,Dwarf_Word *,
+    Dwarf_Unsigned *,Dwarf_Byte_Ptr);
+static int select_s_leb128_decoder(Dwarf_Small *,Dwarf_Word *,
+    Dwarf_Signed *,Dwarf_Byte_Ptr);
+
+/*  The decoders chosen for the CPU we are running on. Until the
+    first call they point at a function that makes the choice. */
+static u_leb128_decoder u_leb128_chk = select_u_leb128_decoder;
+static s_leb128_decoder s_leb128_chk = select_s_leb128_decoder;
+
+static void
+select_leb128_decoders(void)
+{
+#ifdef HAVE_LEB_SSE2
+    if (cpu_has_sse2()) {
+        u_leb128_chk = decode_u_leb128_chk_sse2;
+        s_leb128_chk = decode_s_leb128_chk_sse2;
+        return;
+    }
+#endif
+    u_leb128_chk = decode_u_leb128_chk_scalar;
+    s_leb128_chk = decode_s_leb128_chk_scalar;
+}
+
+static int
+select_u_leb128_decoder(Dwarf_Small * leb128,
+    Dwarf_Word * leb128_length,
+    Dwarf_Unsigned *outval,Dwarf_Byte_Ptr endptr)
+{
+    select_leb128_decoders();
+    return u_leb128_chk(leb128,leb128_length,outval,endptr);
+}
+
+static int
+select_s_leb128_decoder(Dwarf_Small * leb128,
+    Dwarf_Word * leb128_length,
+    Dwarf_Signed *outval,Dwarf_Byte_Ptr endptr)
+{
+    select_leb128_decoders();
+    return s_leb128_chk(leb128,leb128_length,outval,endptr);
+}
+
+int
+_dwarf_decode_u_leb128_chk(Dwarf_Small * leb128,
+    Dwarf_Word * leb128_length,
+    Dwarf_Unsigned *outval,
+    Dwarf_Byte_Ptr endptr)
+{
+    /*  Most values are a single byte, which needs no decoder. */
+    if (leb128 < endptr && (*leb128 & 0x80) == 0) {
+        if (leb128_length) {
+            *leb128_length = 1;
+        }
+        *outval = *leb128;
+        return DW_DLV_OK;
+    }
+    return u_leb128_chk(leb128,leb128_length,outval,endptr);
+}
+
+int
+_dwarf_decode_s_leb128_chk(Dwarf_Small * leb128, Dwarf_Word * leb128_length,
+    Dwarf_Signed *outval,Dwarf_Byte_Ptr endptr)
+{
+    return s_leb128_chk(leb128,leb128_length,outval,endptr);
+}
+
 #ifdef TESTING
 
 static void
@@ -555,12 +780,265 @@ specialtests(void)
     return errcnt;
 }
 
-int main(void)
+/*  Checks that a decoder gives exactly the same result, length
+    and value as the byte-at-a-time decoder for the leb at leb128,
+    including for truncated and overlong encodings. */
+static unsigned
+comparedecoders(const char *name,
+    u_leb128_decoder udecoder, s_leb128_decoder sdecoder,
+    Dwarf_Small *leb128, Dwarf_Byte_Ptr endptr)
+{
+    unsigned errcnt = 0;
+    Dwarf_Word explen = BUFFERLEN;
+    Dwarf_Word len = BUFFERLEN;
+    Dwarf_Unsigned expuval = 0x5a5a5a5a;
+    Dwarf_Unsigned uval = 0x5a5a5a5a;
+    Dwarf_Signed expsval = 0x5a5a5a5a;
+    Dwarf_Signed sval = 0x5a5a5a5a;
+    int expres = 0;
+    int res = 0;
+
+    expres = decode_u_leb128_chk_scalar(leb128,&explen,&expuval,endptr);
+    res = udecoder(leb128,&len,&uval,endptr);
+    if (res != expres || len != explen || uval != expuval) {
+        printf("FAIL %s unsigned decode at %02x, %d bytes available\n",
+            name,*leb128,(int)(endptr - leb128));
+        ++errcnt;
+    }
+    explen = len = BUFFERLEN;
+    expres = decode_s_leb128_chk_scalar(leb128,&explen,&expsval,endptr);
+    res = sdecoder(leb128,&len,&sval,endptr);
+    if (res != expres || len != explen || sval != expsval) {
+        printf("FAIL %s signed decode at %02x, %d bytes available\n",
+            name,*leb128,(int)(endptr - leb128));
+        ++errcnt;
+    }
+    return errcnt;
+}
+
+/*  A small generator so that the tests and benchmark are the same
+    on every run and platform. */
+static Dwarf_Unsigned
+nextrandom(Dwarf_Unsigned *state)
+{
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *state >> 16;
+}
+
+static unsigned
+decodertests(const char *name,
+    u_leb128_decoder udecoder, s_leb128_decoder sdecoder)
+{
+    unsigned errcnt = 0;
+    unsigned char space[BUFFERLEN];
+    Dwarf_Small *leb128 = (Dwarf_Small *)space;
+    Dwarf_Unsigned state = 1;
+    unsigned prefix = 0;
+    unsigned fill = 0;
+    unsigned len = 0;
+    unsigned avail = 0;
+    unsigned t = 0;
+
+    /*  Every 3 byte prefix, followed by bytes that end the leb or
+        that make it overlong, and every 2 byte prefix with every
+        number of bytes available. */
+    for (fill = 0; fill < 2; ++fill) {
+        memset(space,fill ? 0x80 : 0x00,BUFFERLEN);
+        for (prefix = 0; prefix < (1u << 24); ++prefix) {
+            space[0] = prefix & 0xff;
+            space[1] = (prefix >> 8) & 0xff;
+            space[2] = (prefix >> 16) & 0xff;
+            errcnt += comparedecoders(name,udecoder,sdecoder,
+                leb128,leb128 + BUFFERLEN);
+            if (prefix < (1u << 16)) {
+                for (avail = 0; avail <= 20; ++avail) {
+                    errcnt += comparedecoders(name,udecoder,sdecoder,
+                        leb128,leb128 + avail);
+                }
+            }
+            if (errcnt > 10) {
+                return errcnt;
+            }
+        }
+    }
+
+    /*  Random lebs of every length up to well past BYTESLEBMAX,
+        with every number of bytes available around the point
+        where a decoder may switch to reading 16 bytes at once. */
+    for (len = 1; len <= 2 * BYTESLEBMAX; ++len) {
+        for (t = 0; t < 20000; ++t) {
+            unsigned i = 0;
+
+            for (i = 0; i < BUFFERLEN; ++i) {
+                space[i] = nextrandom(&state) & 0xff;
+            }
+            for (i = 0; i < len; ++i) {
+                space[i] |= 0x80;
+            }
+            space[len - 1] &= 0x7f;
+            for (avail = 0; avail <= 2 * BYTESLEBMAX + 4; ++avail) {
+                errcnt += comparedecoders(name,udecoder,sdecoder,
+                    leb128,leb128 + avail);
+            }
+            errcnt += comparedecoders(name,udecoder,sdecoder,
+                leb128,leb128 + BUFFERLEN);
+            if (errcnt > 10) {
+                return errcnt;
+            }
+        }
+    }
+
+    /*  The longest lebs, with each possible last byte. */
+    for (fill = 0; fill < 2; ++fill) {
+        for (t = 0; t < 256; ++t) {
+            memset(space,fill ? 0xff : 0x80,BYTESLEBMAX - 1);
+            memset(space + BYTESLEBMAX - 1,0,BUFFERLEN - BYTESLEBMAX + 1);
+            space[BYTESLEBMAX - 1] = t;
+            errcnt += comparedecoders(name,udecoder,sdecoder,
+                leb128,leb128 + BUFFERLEN);
+        }
+    }
+    return errcnt;
+}
+
+static unsigned
+comparisontests(void)
+{
+    unsigned errcnt = 0;
+
+    errcnt += decodertests("dispatched",
+        _dwarf_decode_u_leb128_chk,_dwarf_decode_s_leb128_chk);
+#ifdef HAVE_LEB_SSE2
+    if (cpu_has_sse2()) {
+        errcnt += decodertests("sse2",
+            decode_u_leb128_chk_sse2,decode_s_leb128_chk_sse2);
+    } else {
+        printf("SKIP sse2 decoder tests, no SSE2 on this CPU\n");
+    }
+#endif
+    return errcnt;
+}
+
+/*  The benchmark decodes a buffer of lebs whose lengths are mixed
+    like those in .debug_info and .debug_line: mostly one byte
+    codes, forms and line advances, some two and three byte sizes
+    and offsets, and a few full 64 bit values. */
+#define BENCHVALUES 1000000
+#define BENCHPASSES 50
+
+static unsigned char *
+makebenchbuffer(int issigned, unsigned *bytes)
+{
+    unsigned char *space = malloc(BENCHVALUES * BYTESLEBMAX + BUFFERLEN);
+    Dwarf_Unsigned state = 2;
+    unsigned used = 0;
+    unsigned t = 0;
+
+    if (!space) {
+        return 0;
+    }
+    for (t = 0; t < BENCHVALUES; ++t) {
+        Dwarf_Unsigned value = nextrandom(&state);
+        unsigned kind = value % 100;
+        int len = 0;
+
+        value = nextrandom(&state);
+        if (kind < 70) {
+            value &= 0x3f;
+        } else if (kind < 90) {
+            value &= 0x1fff;
+        } else if (kind < 98) {
+            value &= 0xfffffff;
+        } else {
+            value |= nextrandom(&state) << 48;
+        }
+        if (issigned) {
+            _dwarf_pro_encode_signed_leb128_nm((kind & 1) ?
+                -(Dwarf_Signed)value : (Dwarf_Signed)value,
+                &len,(char *)space + used,BYTESLEBMAX);
+        } else {
+            _dwarf_pro_encode_leb128_nm(value,&len,
+                (char *)space + used,BYTESLEBMAX);
+        }
+        used += len;
+    }
+    *bytes = used;
+    return space;
+}
+
+static void
+benchdecoders(const char *name,
+    u_leb128_decoder udecoder, s_leb128_decoder sdecoder)
+{
+    int issigned = 0;
+
+    for (issigned = 0; issigned < 2; ++issigned) {
+        unsigned bytes = 0;
+        unsigned char *space = makebenchbuffer(issigned,&bytes);
+        Dwarf_Unsigned check = 0;
+        unsigned pass = 0;
+        clock_t start = 0;
+        double seconds = 0;
+
+        if (!space) {
+            return;
+        }
+        start = clock();
+        for (pass = 0; pass < BENCHPASSES; ++pass) {
+            Dwarf_Small *ptr = (Dwarf_Small *)space;
+            Dwarf_Byte_Ptr endptr = ptr + bytes;
+
+            while (ptr < endptr) {
+                Dwarf_Word len = 0;
+                Dwarf_Unsigned uval = 0;
+                Dwarf_Signed sval = 0;
+
+                if (issigned) {
+                    sdecoder(ptr,&len,&sval,endptr);
+                    check += sval;
+                } else {
+                    udecoder(ptr,&len,&uval,endptr);
+                    check += uval;
+                }
+                ptr += len;
+            }
+        }
+        seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        printf("%-10s %-8s %6.2f ns/value %8.1f MB/s (check %llx)\n",
+            name,issigned ? "signed" : "unsigned",
+            seconds * 1e9 / ((double)BENCHVALUES * BENCHPASSES),
+            (double)bytes * BENCHPASSES / seconds / 1e6,
+            (unsigned long long)check);
+        free(space);
+    }
+}
+
+static void
+benchmark(void)
+{
+    benchdecoders("scalar",
+        decode_u_leb128_chk_scalar,decode_s_leb128_chk_scalar);
+#ifdef HAVE_LEB_SSE2
+    if (cpu_has_sse2()) {
+        benchdecoders("sse2",
+            decode_u_leb128_chk_sse2,decode_s_leb128_chk_sse2);
+    }
+#endif
+    benchdecoders("dispatched",
+        _dwarf_decode_u_leb128_chk,_dwarf_decode_s_leb128_chk);
+}
+
+/*  Run the tests, or with 'bench' time each decoder. */
+int main(int argc, char **argv)
 {
     unsigned slen = sizeof(stest)/sizeof(Dwarf_Signed);
     unsigned ulen = sizeof(utest)/sizeof(Dwarf_Unsigned);
     int errs = 0;
 
+    if (argc > 1 && !strcmp(argv[1],"bench")) {
+        benchmark();
+        return 0;
+    }
     printinteresting();
     errs += signedtest(slen);
 
@@ -568,6 +1046,8 @@ int main(void)
 
     errs += specialtests();
 
+    errs += comparisontests();
+
     if (errs) {
         printf("FAIL. leb encode/decode errors\n");
         return 1;